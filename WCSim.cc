@@ -97,7 +97,7 @@ int main(int argc,char** argv)
 
   runManager->SetUserAction(new WCSimStackingAction(WCSimdetector));
 
-  runManager->SetUserAction(new WCSimSteppingAction);
+  runManager->SetUserAction(new WCSimSteppingAction(WCSimdetector));
 
 
   // Initialize G4 kernel
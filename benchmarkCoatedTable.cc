@@ -0,0 +1,219 @@
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <cfloat>
+#include <chrono>
+#include <random>
+
+#include "WCSimCoatedSurfaceTable.hh"
+#include "G4PhysicalConstants.hh"
+#include "G4SystemOfUnits.hh"
+
+/* Checks & times the coated photocathode tables (WCSimCoatedSurfaceTable) against the film models.
+ *
+ * For each set of photocathode parameters of WCSimConstructMaterials (SK, KCsCb, RbCsCb), each
+ * model (101: Model1, 102: Model2) and each side of the glass/PMT interior surface, a table is
+ * made as WCSimOpBoundaryProcess::GetCoatedTable() does. Then photons at random energies &
+ * incidence angles are sent through the table and the model: this prints the largest difference
+ * of the reflection & transmission probabilities where the table is used, and the time per
+ * photon of both, and the time to make the table.
+ *
+ * When they are made, the tables check each cell on a 9 x 9 grid of points against 3/4 of the
+ * tolerance, so this looks for errors in between the points (e.g. at the kinks of the models).
+ * It returns the number of tables with an error larger than the tolerance (0 if all pass).
+ */
+
+namespace {
+  // The grid & default tolerance of WCSimOpBoundaryProcess
+  const G4int kEnergies = 64;
+  const G4int kAngles   = 256;
+
+  /// A piecewise linear property, as G4MaterialPropertyVector::Value()
+  class Property {
+  public:
+    Property(const G4double * energies, const G4double * values, size_t n)
+      : e(energies, energies + n), v(values, values + n) {}
+    explicit Property(G4double value) : e(1, 0.), v(1, value) {}
+    G4double Value(G4double energy) const {
+      if(e.size() == 1 || energy <= e.front()) return v.front();
+      if(energy >= e.back()) return v.back();
+      const size_t i = std::upper_bound(e.begin(), e.end(), energy) - e.begin() - 1;
+      return v[i] + (v[i + 1] - v[i]) * (energy - e[i]) / (e[i + 1] - e[i]);
+    }
+    G4double Min() const { return e.size() == 1 ? 0. : e.front(); }
+    G4double Max() const { return e.size() == 1 ? DBL_MAX : e.back(); }
+  private:
+    std::vector<G4double> e, v;
+  };
+
+  struct Cathode {
+    const char * name;
+    Property rindex, rindexim;
+    G4double thickness;
+  };
+
+  /// The model of a surface, as evaluated by WCSimOpBoundaryProcess::GetCoatedTable()
+  WCSimCoatedSurfaceTable::Model MakeModel(G4int model, const Property & rindex1, const Property & rindex2,
+					   const Cathode & cathode)
+  {
+    const G4double tolerance = 1E-9; // kCarTolerance
+    return [=](G4double energy, G4double cost, WCSimCoatedCoefficients & c) {
+      const G4double n1 = rindex1.Value(energy);
+      const G4double n2 = rindex2.Value(energy);
+      const G4double nTL = cathode.rindex.Value(energy);
+      const G4double wavelength = h_Planck * c_light / energy;
+      G4double sint = 0., sint2 = 0., sintTL = 0.;
+      if (std::abs(cost) < 1.0 - tolerance) {
+	sint = std::sqrt(1. - cost * cost);
+	sint2 = sint * n1 / n2;
+	sintTL = sint * n1 / nTL;
+      }
+      if (model == 101) {
+	const G4double cost2 = (cost > 0.0 ? 1. : -1.) * std::sqrt(1. - sint2 * sint2);
+	WCSimCoatedSurfaceTable::Model1(n1, n2, nTL, cathode.thickness, true, wavelength,
+					sint, sintTL, cost, cost2, c);
+      }
+      else
+	WCSimCoatedSurfaceTable::Model2(n1, n2, nTL, cathode.rindexim.Value(energy), cathode.thickness,
+					wavelength, cost, sint, c);
+    };
+  }
+
+  /// Keeps the timed loops from being optimised away
+  volatile G4double sink;
+
+  G4double Error(const WCSimCoatedCoefficients & a, const WCSimCoatedCoefficients & b)
+  {
+    return std::max(std::max(std::fabs(a.Rs - b.Rs), std::fabs(a.Rp - b.Rp)),
+		    std::max(std::fabs(a.Ts - b.Ts), std::fabs(a.Tp - b.Tp)));
+  }
+}
+
+void Usage(const char * name) {
+  std::cout << "Usage: " << name << " [-n nphotons] [-t tolerance] [-s seed]" << std::endl
+	    << "  -n nphotons : number of photons per table (default 1000000)" << std::endl
+	    << "  -t tolerance: table tolerance (default 0.001, as setCoatedTableTolerance)" << std::endl
+	    << "  -s seed     : random seed (default 12345)" << std::endl;
+}
+
+int main(int argc, char ** argv)
+{
+  int nphotons = 1000000;
+  G4double tolerance = 1E-3;
+  unsigned int seed = 12345;
+  for(int i = 1; i < argc; i++) {
+    if(!strcmp(argv[i], "-n") && i + 1 < argc) nphotons = atoi(argv[++i]);
+    else if(!strcmp(argv[i], "-t") && i + 1 < argc) tolerance = atof(argv[++i]);
+    else if(!strcmp(argv[i], "-s") && i + 1 < argc) seed = atoi(argv[++i]);
+    else { Usage(argv[0]); return 1; }
+  }
+  if(nphotons <= 0 || tolerance <= 0) { Usage(argv[0]); return 1; }
+
+  // The photocathode parameters of WCSimConstructMaterials
+  const G4double ENERGY_COATED_SK[] = { 1.000*eV, 2.786*eV, 3.061*eV, 3.306*eV, 3.679*eV, 9.000*eV };
+  const G4double COATEDRINDEX_SK[]   = { 3.4, 3.4, 3.1, 2.8, 2.4, 2.4 };
+  const G4double COATEDRINDEXIM_SK[] = { 1.7, 1.7, 1.6, 1.5, 1.4, 1.4 };
+  const G4double ENERGY_COATED_WAV[] =
+    { 1.000*eV, 1.823*eV, 1.864*eV, 1.907*eV, 1.953*eV, 2.000*eV, 2.049*eV, 2.101*eV,
+      2.156*eV, 2.214*eV, 2.275*eV, 2.339*eV, 2.407*eV, 2.480*eV, 2.556*eV, 2.638*eV,
+      2.725*eV, 2.818*eV, 2.917*eV, 3.024*eV, 3.139*eV, 3.263*eV, 9.000*eV };
+  const G4double COATEDRINDEX_KCsCb[] =
+    { 2.96, 2.96, 2.95, 2.95, 2.95, 2.96, 2.98, 3.01, 3.06, 3.12, 3.20, 3.26,
+      3.09, 3.00, 3.00, 3.00, 2.87, 2.70, 2.61, 2.38, 2.18, 1.92, 1.92 };
+  const G4double COATEDRINDEXIM_KCsCb[] =
+    { 0.33, 0.33, 0.34, 0.34, 0.35, 0.37, 0.38, 0.42, 0.46, 0.53, 0.63, 0.86,
+      1.05, 1.06, 1.11, 1.34, 1.44, 1.50, 1.53, 1.71, 1.69, 1.69, 1.69 };
+  const G4double COATEDRINDEX_RbCsCb[] =
+    { 3.13, 3.13, 3.14, 3.14, 3.15, 3.18, 3.22, 3.28, 3.39, 3.32, 3.23, 3.21,
+      3.22, 3.16, 2.99, 2.81, 2.63, 2.50, 2.40, 2.30, 2.22, 2.07, 2.07 };
+  const G4double COATEDRINDEXIM_RbCsCb[] =
+    { 0.35, 0.35, 0.37, 0.37, 0.38, 0.40, 0.43, 0.46, 0.59, 0.76, 0.86, 0.90,
+      1.04, 1.21, 1.37, 1.41, 1.40, 1.35, 1.27, 1.21, 1.17, 1.22, 1.22 };
+  const Cathode cathodes[] = {
+    { "SK",     Property(ENERGY_COATED_SK,  COATEDRINDEX_SK,     6),  Property(ENERGY_COATED_SK,  COATEDRINDEXIM_SK,     6),  11.5*nm },
+    { "KCsCb",  Property(ENERGY_COATED_WAV, COATEDRINDEX_KCsCb,  23), Property(ENERGY_COATED_WAV, COATEDRINDEXIM_KCsCb,  23), 20.0*nm },
+    { "RbCsCb", Property(ENERGY_COATED_WAV, COATEDRINDEX_RbCsCb, 23), Property(ENERGY_COATED_WAV, COATEDRINDEXIM_RbCsCb, 23), 23.4*nm }
+  };
+  // The PMT glass (its dispersion over the Cherenkov spectrum) & the PMT interior
+  const G4double ENERGY_GLASS[] = { 1.0*eV, 4.1*eV, 9.0*eV };
+  const G4double RINDEX_GLASS[] = { 1.510, 1.530, 1.530 };
+  const Property glass(ENERGY_GLASS, RINDEX_GLASS, 3), interior(1.0);
+
+  std::mt19937 engine(seed);
+  std::uniform_real_distribution<G4double> flat(0, 1);
+
+  std::cout << "Tolerance " << tolerance << ", " << nphotons << " photons per table" << std::endl
+	    << std::setw(8) << "cathode" << std::setw(7) << "model" << std::setw(18) << "side"
+	    << std::setw(10) << "model(%)" << std::setw(12) << "build err" << std::setw(12) << "max err"
+	    << std::setw(12) << "table(ns)" << std::setw(12) << "model(ns)" << std::setw(12) << "build(ms)"
+	    << std::setw(8) << "pass" << std::endl;
+
+  int nfail = 0;
+  for(size_t icath = 0; icath < sizeof(cathodes) / sizeof(cathodes[0]); icath++) {
+    const Cathode & cathode = cathodes[icath];
+    for(G4int model = 101; model <= 102; model++) {
+      for(int side = 0; side < 2; side++) {
+	const Property & rindex1 = side ? interior : glass;
+	const Property & rindex2 = side ? glass : interior;
+	const WCSimCoatedSurfaceTable::Model evaluate = MakeModel(model, rindex1, rindex2, cathode);
+
+	// The energies at which all the properties are tabulated
+	const G4double emin = std::max(std::max(rindex1.Min(), rindex2.Min()), cathode.rindex.Min());
+	const G4double emax = std::min(std::min(rindex1.Max(), rindex2.Max()), cathode.rindex.Max());
+	std::chrono::steady_clock::time_point build = std::chrono::steady_clock::now();
+	const WCSimCoatedSurfaceTable table(evaluate, emin, emax, kEnergies, kAngles, tolerance);
+	const G4double buildms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - build).count();
+
+	std::vector<G4double> energies(nphotons), costs(nphotons);
+	for(int i = 0; i < nphotons; i++) {
+	  energies[i] = emin + (emax - emin) * flat(engine);
+	  costs[i] = flat(engine);
+	}
+
+	// The largest error where the table is used
+	G4double maxerror = 0;
+	WCSimCoatedCoefficients fromtable, frommodel;
+	for(int i = 0; i < nphotons; i++) {
+	  if(!table.Interpolate(energies[i], costs[i], fromtable))
+	    continue;
+	  evaluate(energies[i], costs[i], frommodel);
+	  maxerror = std::max(maxerror, Error(fromtable, frommodel));
+	}
+
+	// Time both (the table falling back to the model as in WCSimOpBoundaryProcess)
+	G4double sum = 0;
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	for(int i = 0; i < nphotons; i++) {
+	  if(!table.Interpolate(energies[i], costs[i], fromtable))
+	    evaluate(energies[i], costs[i], fromtable);
+	  sum += fromtable.Rs;
+	}
+	std::chrono::steady_clock::time_point middle = std::chrono::steady_clock::now();
+	for(int i = 0; i < nphotons; i++) {
+	  evaluate(energies[i], costs[i], frommodel);
+	  sum += frommodel.Rs;
+	}
+	std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+	const G4double tablens = std::chrono::duration<double, std::nano>(middle - start).count() / nphotons;
+	const G4double modelns = std::chrono::duration<double, std::nano>(end - middle).count() / nphotons;
+
+	const bool pass = maxerror <= tolerance;
+	if(!pass) nfail++;
+	std::cout << std::setw(8) << cathode.name << std::setw(7) << model
+		  << std::setw(18) << (side ? "interior->glass" : "glass->interior")
+		  << std::setw(10) << std::setprecision(3) << 100 * table.GetModelFraction()
+		  << std::setw(12) << table.GetMaxError() << std::setw(12) << maxerror
+		  << std::setw(12) << tablens << std::setw(12) << modelns << std::setw(12) << buildms
+		  << std::setw(8) << (pass ? "yes" : "NO") << std::endl;
+	sink = sum;
+      }
+    }
+  }
+  if(nfail)
+    std::cout << nfail << " tables are off by more than the tolerance" << std::endl;
+  return nfail;
+}
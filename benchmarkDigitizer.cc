@@ -0,0 +1,181 @@
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <chrono>
+#include <random>
+
+#include "WCSimDAQDigitizer.hh"
+#include "WCSimDAQWaveform.hh"
+
+/* Times the SKI digitizer (WCSimDAQDigitizerSKI) for a range of PMT occupancies.
+ *
+ * Each PMT sees dark noise spread over the event window, plus (occupancy) photoelectrons
+ * spread over the signal time. For each occupancy this prints the number of PMTs & hits
+ * simulated, the time per event of Digitize() and of the original hit-by-hit loop
+ * DigitizeReference(), and checks that the two give the same digits.
+ * It also times the threaded Digitize(), and checks it gives the same digits on one thread,
+ * and the waveform digitizer (WCSimDAQDigitizerWaveform).
+ */
+
+namespace {
+  /// Random numbers from a seeded std::mt19937
+  class BenchmarkRandom : public WCSimDAQRandom {
+  public:
+    BenchmarkRandom(unsigned int seed) : engine(seed) {}
+    double Flat() { return std::uniform_real_distribution<double>(0, 1)(engine); }
+    double Gauss(double mean, double sigma) { return mean + sigma * normal(engine); }
+    long   Poisson(double mean) { return std::poisson_distribution<long>(mean)(engine); }
+  private:
+    std::mt19937 engine;
+    std::normal_distribution<double> normal; ///< Keeps the second of each pair of Gaussians
+  };
+
+  /// A PMT with the time resolution form of WCSimPMTObject
+  class BenchmarkPMTResponse : public WCSimDAQPMTResponse {
+  public:
+    float HitTimeSmearing(float Q, WCSimDAQRandom & random) {
+      float timingResolution = 0.33 + std::sqrt(2.0 / Q);
+      if(timingResolution < 0.58) timingResolution = 0.58;
+      return random.Gauss(0.0, timingResolution);
+    }
+    double SinglePE(WCSimDAQRandom & random) { return std::max(0., random.Gauss(1., 0.3)); }
+    /// The default pulse of WCSimPMTObject
+    double PulseShape(double t) { return t > 0 ? (t/8) * (t/8) * std::exp(2 - t/8) / 4 : 0; }
+    std::string PulseName() { return "benchmark"; }
+  };
+
+  bool SameDigits(const std::vector<WCSimDAQDigit> & a, const std::vector<WCSimDAQDigit> & b)
+  {
+    if(a.size() != b.size()) return false;
+    for(size_t i = 0; i < a.size(); i++)
+      if(a[i].pmt != b[i].pmt || a[i].time != b[i].time || a[i].charge != b[i].charge
+	 || a[i].composition != b[i].composition)
+	return false;
+    return true;
+  }
+}
+
+void Usage(const char * name) {
+  std::cout << "Usage: " << name << " [-p npmt] [-n maxhits] [-r darkrate] [-s spread] [-w window] [-t deadtime] [-e nevents] [-j nthreads] [occupancy ...]" << std::endl
+	    << "  -p npmt      : number of PMTs (default 2000)" << std::endl
+	    << "  -n maxhits   : fewer PMTs are used if there would be more hits per event (default 10000000)" << std::endl
+	    << "  -r darkrate  : dark rate (kHz, default 4.2), over an event window of 3 us" << std::endl
+	    << "  -s spread    : time spread of the signal photoelectrons (ns, default 50)" << std::endl
+	    << "  -w window    : digitizer integration window (ns, default 200)" << std::endl
+	    << "  -t deadtime  : digitizer dead time (ns, default 0)" << std::endl
+	    << "  -e nevents   : number of events (default 5)" << std::endl
+	    << "  -j nthreads  : number of threads for the threaded digitizer (default 0, i.e. one per core)" << std::endl
+	    << "  occupancy ...: signal p.e. per PMT to test (default 0 1 10 100 1000 10000 100000)" << std::endl;
+}
+
+int main(int argc, char ** argv)
+{
+  int npmt_target = 2000, nevents = 5, window = 200, deadtime = 0;
+  unsigned int nthreads = 0;
+  double maxhits = 1E7, darkrate = 4.2, spread = 50;
+  std::vector<double> occupancies;
+  for(int i = 1; i < argc; i++) {
+    if(!strcmp(argv[i], "-h")) { Usage(argv[0]); return 0; }
+    else if(!strcmp(argv[i], "-p") && i + 1 < argc) npmt_target = atoi(argv[++i]);
+    else if(!strcmp(argv[i], "-n") && i + 1 < argc) maxhits     = atof(argv[++i]);
+    else if(!strcmp(argv[i], "-r") && i + 1 < argc) darkrate    = atof(argv[++i]);
+    else if(!strcmp(argv[i], "-s") && i + 1 < argc) spread      = atof(argv[++i]);
+    else if(!strcmp(argv[i], "-w") && i + 1 < argc) window      = atoi(argv[++i]);
+    else if(!strcmp(argv[i], "-t") && i + 1 < argc) deadtime    = atoi(argv[++i]);
+    else if(!strcmp(argv[i], "-e") && i + 1 < argc) nevents     = atoi(argv[++i]);
+    else if(!strcmp(argv[i], "-j") && i + 1 < argc) nthreads    = atoi(argv[++i]);
+    else if(argv[i][0] != '-') occupancies.push_back(atof(argv[i]));
+    else { Usage(argv[0]); return 1; }
+  }
+  if(occupancies.empty()) {
+    occupancies.push_back(0);
+    for(double occ = 1; occ <= 100000; occ *= 10)
+      occupancies.push_back(occ);
+  }
+
+  WCSimDAQDigitizerSKI digitizer;
+  digitizer.SetIntegrationWindow(window);
+  digitizer.SetDeadTime(deadtime);
+  WCSimDAQDigitizerWaveform waveform;
+
+  const double windowlow = -1000, windowhigh = 2000;
+  const double ndark = darkrate * (windowhigh - windowlow) * 1E-6;
+
+  std::cout << ndark << " dark noise hits per PMT, " << nevents << " events, integration window "
+	    << window << " ns, dead time " << deadtime << " ns" << std::endl
+	    << std::setw(12) << "p.e./PMT" << std::setw(8) << "PMTs" << std::setw(12) << "hits/event"
+	    << std::setw(12) << "digits" << std::setw(16) << "kernel(ms/ev)" << std::setw(16) << "loop(ms/ev)"
+	    << std::setw(10) << "speedup" << std::setw(16) << "threads(ms/ev)" << std::setw(16) << "waveform(ms/ev)"
+	    << std::setw(10) << "same" << std::endl;
+
+  for(size_t io = 0; io < occupancies.size(); io++) {
+    const double occupancy = occupancies[io];
+    const int npmt = std::max(1, std::min(npmt_target, (int)(maxhits / (occupancy + ndark))));
+
+    double kernel_ms = 0, loop_ms = 0, threads_ms = 0, waveform_ms = 0;
+    size_t nhits = 0, ndigits = 0;
+    bool same = true;
+    for(int ev = 0; ev < nevents; ev++) {
+      //the hits of each PMT, sorted by time
+      std::mt19937 engine(1000 * io + ev);
+      std::uniform_real_distribution<float> uniform(0, 1);
+      std::poisson_distribution<int> darkcount(ndark);
+      WCSimDAQHits hits;
+      std::vector<float> times;
+      for(int ipmt = 0; ipmt < npmt; ipmt++) {
+	times.clear();
+	const int nd = darkcount(engine);
+	for(int i = 0; i < nd; i++)
+	  times.push_back(windowlow + (windowhigh - windowlow) * uniform(engine));
+	for(int i = 0; i < (int)occupancy; i++)
+	  times.push_back(spread * uniform(engine));
+	std::sort(times.begin(), times.end());
+	hits.AddPMT(ipmt + 1);
+	for(size_t i = 0; i < times.size(); i++)
+	  hits.AddHit(times[i], 2 * uniform(engine));
+      }
+      nhits += hits.GetNumHits();
+
+      typedef std::chrono::steady_clock clock;
+      std::vector<WCSimDAQDigit> digits, reference;
+      BenchmarkPMTResponse response;
+      BenchmarkRandom random(ev);
+      clock::time_point start = clock::now();
+      digitizer.Digitize(hits, random, response, digits);
+      kernel_ms += std::chrono::duration<double, std::milli>(clock::now() - start).count();
+
+      BenchmarkRandom random_ref(ev);
+      start = clock::now();
+      digitizer.DigitizeReference(hits, random_ref, response, reference);
+      loop_ms += std::chrono::duration<double, std::milli>(clock::now() - start).count();
+
+      //the threaded digitizer uses other random numbers, so compare it with itself on one thread
+      std::vector<WCSimDAQDigit> threaded, onethread;
+      start = clock::now();
+      digitizer.Digitize(hits, ev, nthreads, response, threaded);
+      threads_ms += std::chrono::duration<double, std::milli>(clock::now() - start).count();
+      digitizer.Digitize(hits, ev, 1, response, onethread);
+
+      std::vector<WCSimDAQDigit> waveformdigits;
+      BenchmarkRandom random_wave(ev);
+      start = clock::now();
+      waveform.Digitize(hits, random_wave, response, waveformdigits);
+      waveform_ms += std::chrono::duration<double, std::milli>(clock::now() - start).count();
+
+      ndigits += digits.size();
+      same = same && SameDigits(digits, reference) && SameDigits(threaded, onethread);
+    }
+
+    std::cout << std::setw(12) << occupancy << std::setw(8) << npmt << std::setw(12) << nhits / nevents
+	      << std::setw(12) << ndigits / nevents
+	      << std::setw(16) << kernel_ms / nevents << std::setw(16) << loop_ms / nevents
+	      << std::setw(10) << std::setprecision(3) << loop_ms / kernel_ms << std::setprecision(6)
+	      << std::setw(16) << threads_ms / nevents << std::setw(16) << waveform_ms / nevents
+	      << std::setw(10) << (same ? "yes" : "NO") << std::endl;
+  }
+  return 0;
+}
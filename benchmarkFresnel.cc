@@ -0,0 +1,179 @@
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <chrono>
+#include <random>
+
+#include "WCSimFresnel.hh"
+
+/* Checks & times the Fresnel kernel of WCSimOpBoundaryProcess::DielectricDielectric()
+ * (WCSimFresnel.hh) against the original expressions (FresnelReference below).
+ *
+ * Photons with random refractive indices (water, acrylic, glass, gel & air), incidence
+ * angles and polarisations are sent through both, with the same random number for the
+ * choice between reflection & transmission. This prints how many photons end up with a
+ * different status (total internal reflection, reflection, refraction), which should be 0,
+ * the largest difference of their new polarisation components and transmission
+ * probabilities, and the time per photon of both.
+ */
+
+namespace {
+  const double kTolerance = 1E-9; // kCarTolerance, in mm
+
+  enum Status { kTotalInternalReflection, kFresnelReflection, kFresnelRefraction };
+
+  struct Photon {
+    double n1, n2, cost1, E1_perp, E1_parl, u;
+  };
+
+  struct Result {
+    Status status;
+    double TransCoeff, C_perp, C_parl, cost2;
+  };
+
+  /// The original expressions of DielectricDielectric(), for an oblique incidence
+  void FresnelReference(const Photon & p, Result & r)
+  {
+    double sint1, sint2, cost2 = 0;
+    const double Rindex1 = p.n1, Rindex2 = p.n2, cost1 = p.cost1;
+    if (std::abs(cost1) < 1.0-kTolerance){
+      sint1 = std::sqrt(1.-cost1*cost1);
+      sint2 = sint1*Rindex1/Rindex2;
+    }
+    else {
+      sint1 = 0.0;
+      sint2 = 0.0;
+    }
+    r.TransCoeff = 0; r.C_perp = 0; r.C_parl = 0; r.cost2 = 0;
+    if (sint2 >= 1.0) {
+      r.status = kTotalInternalReflection;
+      return;
+    }
+    if (cost1 > 0.0) cost2 =  std::sqrt(1.-sint2*sint2);
+    else             cost2 = -std::sqrt(1.-sint2*sint2);
+    r.cost2 = cost2;
+
+    const double E1_perp = p.E1_perp, E1_parl = p.E1_parl;
+    const double s1 = Rindex1*cost1;
+    double E2_perp = 2.*s1*E1_perp/(Rindex1*cost1+Rindex2*cost2);
+    double E2_parl = 2.*s1*E1_parl/(Rindex2*cost1+Rindex1*cost2);
+    double E2_total = E2_perp*E2_perp + E2_parl*E2_parl;
+    const double s2 = Rindex2*cost2*E2_total;
+
+    if (cost1 != 0.0) r.TransCoeff = s2/s1;
+    else r.TransCoeff = 0.0;
+
+    if (!(p.u < r.TransCoeff)) {
+      r.status = kFresnelReflection;
+      E2_parl  = Rindex2*E2_parl/Rindex1 - E1_parl;
+      E2_perp  = E2_perp - E1_perp;
+      E2_total = E2_perp*E2_perp + E2_parl*E2_parl;
+    }
+    else
+      r.status = kFresnelRefraction;
+    const double E2_abs = std::sqrt(E2_total);
+    r.C_parl = E2_parl/E2_abs;
+    r.C_perp = E2_perp/E2_abs;
+  }
+
+  /// The same, with the kernel
+  void FresnelKernel(const Photon & p, Result & r)
+  {
+    double sint1, sint2, cost2;
+    r.TransCoeff = 0; r.C_perp = 0; r.C_parl = 0; r.cost2 = 0;
+    if (!WCSimFresnel::Refract(p.cost1, p.n1/p.n2, kTolerance, sint1, sint2, cost2)) {
+      r.status = kTotalInternalReflection;
+      return;
+    }
+    r.cost2 = cost2;
+    double E2_perp, E2_parl, E2_total;
+    r.TransCoeff = WCSimFresnel::Transmission(p.n1, p.n2, p.cost1, cost2, p.E1_perp, p.E1_parl,
+					      E2_perp, E2_parl, E2_total);
+    if (!(p.u < r.TransCoeff)) {
+      r.status = kFresnelReflection;
+      WCSimFresnel::Reflection(p.n1, p.n2, p.E1_perp, p.E1_parl, E2_perp, E2_parl, E2_total);
+    }
+    else
+      r.status = kFresnelRefraction;
+    WCSimFresnel::Direction(E2_perp, E2_parl, E2_total, r.C_perp, r.C_parl);
+  }
+
+  template <typename F>
+  double Time(F fresnel, const std::vector<Photon> & photons, std::vector<Result> & results, int nrepeat)
+  {
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for(int i = 0; i < nrepeat; i++)
+      for(size_t j = 0; j < photons.size(); j++)
+	fresnel(photons[j], results[j]);
+    std::chrono::duration<double, std::nano> t = std::chrono::steady_clock::now() - start;
+    return t.count() / nrepeat / photons.size();
+  }
+}
+
+void Usage(const char * name) {
+  std::cout << "Usage: " << name << " [-n nphotons] [-r nrepeat] [-s seed]" << std::endl
+	    << "  -n nphotons : number of photons (default 1000000)" << std::endl
+	    << "  -r nrepeat  : times each is timed over all the photons (default 10)" << std::endl
+	    << "  -s seed     : random seed (default 12345)" << std::endl;
+}
+
+int main(int argc, char ** argv)
+{
+  int nphotons = 1000000, nrepeat = 10;
+  unsigned int seed = 12345;
+  for(int i = 1; i < argc; i++) {
+    if(!strcmp(argv[i], "-n") && i + 1 < argc) nphotons = atoi(argv[++i]);
+    else if(!strcmp(argv[i], "-r") && i + 1 < argc) nrepeat = atoi(argv[++i]);
+    else if(!strcmp(argv[i], "-s") && i + 1 < argc) seed = atoi(argv[++i]);
+    else { Usage(argv[0]); return 1; }
+  }
+  if(nphotons <= 0 || nrepeat <= 0) { Usage(argv[0]); return 1; }
+
+  // Refractive index ranges of the WCSim media (air, water, gel, acrylic, glass)
+  const double nmin[] = {1.0002, 1.33, 1.40, 1.48, 1.46};
+  const double nmax[] = {1.0003, 1.36, 1.42, 1.52, 1.55};
+  std::mt19937 engine(seed);
+  std::uniform_real_distribution<double> flat(0, 1);
+  std::vector<Photon> photons(nphotons);
+  for(int i = 0; i < nphotons; i++) {
+    Photon & p = photons[i];
+    const int m1 = engine() % 5, m2 = engine() % 5;
+    p.n1 = nmin[m1] + flat(engine) * (nmax[m1] - nmin[m1]);
+    p.n2 = nmin[m2] + flat(engine) * (nmax[m2] - nmin[m2]);
+    // mostly from the front, some from the back (after a refraction), some at normal incidence
+    const double r = flat(engine);
+    p.cost1 = r < 0.01 ? 1. : (r < 0.1 ? -flat(engine) : flat(engine));
+    p.E1_perp = 2. * flat(engine) - 1.;
+    p.E1_parl = std::sqrt(1. - p.E1_perp * p.E1_perp);
+    p.u = flat(engine);
+  }
+
+  std::vector<Result> reference(nphotons), kernel(nphotons);
+  const double tref = Time(FresnelReference, photons, reference, nrepeat);
+  const double tker = Time(FresnelKernel, photons, kernel, nrepeat);
+
+  long ndiffer = 0, nstatus[3] = {0, 0, 0};
+  double maxdiffC = 0, maxdiffT = 0, maxdiffcos = 0;
+  for(int i = 0; i < nphotons; i++) {
+    const Result & a = reference[i], & b = kernel[i];
+    nstatus[a.status]++;
+    if(a.status != b.status) { ndiffer++; continue; }
+    maxdiffC = std::max(maxdiffC, std::max(std::abs(a.C_perp - b.C_perp), std::abs(a.C_parl - b.C_parl)));
+    maxdiffT = std::max(maxdiffT, std::abs(a.TransCoeff - b.TransCoeff));
+    maxdiffcos = std::max(maxdiffcos, std::abs(a.cost2 - b.cost2));
+  }
+
+  std::cout << nphotons << " photons: " << nstatus[kTotalInternalReflection] << " total internal reflections, "
+	    << nstatus[kFresnelReflection] << " reflections, " << nstatus[kFresnelRefraction] << " refractions" << std::endl
+	    << "Photons with a different status:      " << ndiffer << std::endl
+	    << "Largest difference of TransCoeff:     " << maxdiffT << std::endl
+	    << "Largest difference of cost2:          " << maxdiffcos << std::endl
+	    << "Largest difference of C_perp, C_parl: " << maxdiffC << std::endl
+	    << std::fixed << std::setprecision(2)
+	    << "Time per photon: reference " << tref << " ns, kernel " << tker << " ns" << std::endl;
+  return ndiffer ? 1 : 0;
+}
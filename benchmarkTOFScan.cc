@@ -0,0 +1,135 @@
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <string>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <chrono>
+
+#include "WCSimTOFGrid.hh"
+
+/* Times the TOFScan trigger's vertex scan (WCSimTOFGrid) for a range of grid spacings.
+ *
+ * The detector is a cylinder of PMTs (WCTE-sized by default). Each event is dark noise
+ * spread over the event window, plus a burst of hits from a random vertex in the tank.
+ * For each grid spacing this prints the number of vertices, the TOF table size,
+ * the time to build the grid, the time per event for the scan,
+ * and how often the burst was found.
+ */
+
+void Usage(const char * name) {
+  std::cout << "Usage: " << name << " [-r radius] [-l length] [-p npmt] [-d ndark] [-s nsignal] [-e nevents] [-j nthreads] [spacing ...]" << std::endl
+	    << "  -r radius    : cylinder radius (cm, default 170)" << std::endl
+	    << "  -l length    : cylinder length (cm, default 300)" << std::endl
+	    << "  -p npmt      : approximate number of PMTs (default 2000)" << std::endl
+	    << "  -d ndark     : dark noise digits per event, spread over 1 us (default 500)" << std::endl
+	    << "  -s nsignal   : signal digits per event, from a single vertex (default 20)" << std::endl
+	    << "  -e nevents   : number of events (default 20)" << std::endl
+	    << "  -j nthreads  : number of threads (default 0, i.e. one per core)" << std::endl
+	    << "  spacing ...  : grid spacings to test (cm, default 100 50 25 12.5)" << std::endl;
+}
+
+int main(int argc, char ** argv)
+{
+  double radius = 170, length = 300;
+  int npmt_target = 2000, ndark = 500, nsignal = 20, nevents = 20;
+  unsigned int nthreads = 0;
+  std::vector<double> spacings;
+  for(int i = 1; i < argc; i++) {
+    if(!strcmp(argv[i], "-h")) { Usage(argv[0]); return 0; }
+    else if(!strcmp(argv[i], "-r") && i + 1 < argc) radius      = atof(argv[++i]);
+    else if(!strcmp(argv[i], "-l") && i + 1 < argc) length      = atof(argv[++i]);
+    else if(!strcmp(argv[i], "-p") && i + 1 < argc) npmt_target = atoi(argv[++i]);
+    else if(!strcmp(argv[i], "-d") && i + 1 < argc) ndark       = atoi(argv[++i]);
+    else if(!strcmp(argv[i], "-s") && i + 1 < argc) nsignal     = atoi(argv[++i]);
+    else if(!strcmp(argv[i], "-e") && i + 1 < argc) nevents     = atoi(argv[++i]);
+    else if(!strcmp(argv[i], "-j") && i + 1 < argc) nthreads    = atoi(argv[++i]);
+    else if(argv[i][0] != '-') spacings.push_back(atof(argv[i]));
+    else { Usage(argv[0]); return 1; }
+  }
+  if(spacings.empty()) {
+    spacings.push_back(100);
+    spacings.push_back(50);
+    spacings.push_back(25);
+    spacings.push_back(12.5);
+  }
+
+  // PMTs evenly spread over the barrel & caps
+  const double area = 2 * M_PI * radius * length + 2 * M_PI * radius * radius;
+  const double pitch = std::sqrt(area / npmt_target);
+  std::vector<double> x, y, z;
+  const int nphi = std::max(1, (int)(2 * M_PI * radius / pitch));
+  for(int iz = 0; iz < (int)(length / pitch); iz++)
+    for(int iphi = 0; iphi < nphi; iphi++) {
+      x.push_back(radius * std::cos(2 * M_PI * iphi / nphi));
+      y.push_back(radius * std::sin(2 * M_PI * iphi / nphi));
+      z.push_back(-0.5 * length + (iz + 0.5) * pitch);
+    }
+  for(double r = 0.5 * pitch; r < radius; r += pitch) {
+    const int nring = std::max(1, (int)(2 * M_PI * r / pitch));
+    for(int iphi = 0; iphi < nring; iphi++)
+      for(int cap = -1; cap <= 1; cap += 2) {
+	x.push_back(r * std::cos(2 * M_PI * iphi / nring));
+	y.push_back(r * std::sin(2 * M_PI * iphi / nring));
+	z.push_back(cap * 0.5 * length);
+      }
+  }
+  const size_t npmt = x.size();
+
+  // The events (with a fixed seed, so every spacing sees the same events)
+  srand(12345);
+  const double lightspeed = WCSimTOFGrid::kDefaultLightSpeed;
+  std::vector< std::vector<float> > times(nevents);
+  std::vector< std::vector<int> >   rows(nevents);
+  for(int ev = 0; ev < nevents; ev++) {
+    for(int i = 0; i < ndark; i++) {
+      rows[ev].push_back(rand() % npmt);
+      times[ev].push_back(1000. * rand() / RAND_MAX);
+    }
+    double vr = radius * std::sqrt((double)rand() / RAND_MAX) * 0.9;
+    double vphi = 2 * M_PI * rand() / RAND_MAX;
+    double vx = vr * std::cos(vphi), vy = vr * std::sin(vphi);
+    double vz = length * 0.9 * ((double)rand() / RAND_MAX - 0.5);
+    for(int i = 0; i < nsignal; i++) {
+      const int p = rand() % npmt;
+      const double d = std::sqrt((x[p]-vx)*(x[p]-vx) + (y[p]-vy)*(y[p]-vy) + (z[p]-vz)*(z[p]-vz));
+      rows[ev].push_back(p);
+      times[ev].push_back(500 + d / lightspeed + 2. * rand() / RAND_MAX);
+    }
+  }
+
+  std::cout << npmt << " PMTs, " << ndark << " dark + " << nsignal << " signal digits per event, "
+	    << nevents << " events" << std::endl
+	    << std::setw(12) << "spacing(cm)" << std::setw(12) << "vertices" << std::setw(12) << "table(MB)"
+	    << std::setw(12) << "build(ms)" << std::setw(16) << "scan(ms/event)" << std::setw(12) << "found" << std::endl;
+
+  const float window = 10;
+  const int threshold = nsignal / 2;
+  for(size_t is = 0; is < spacings.size(); is++) {
+    typedef std::chrono::steady_clock clock;
+    WCSimTOFGrid grid;
+    clock::time_point start = clock::now();
+    grid.Build(npmt, &x[0], &y[0], &z[0], spacings[is]);
+    const double build_ms = std::chrono::duration<double, std::milli>(clock::now() - start).count();
+
+    int nfound = 0;
+    std::vector<WCSimTOFGrid::Candidate> candidates;
+    start = clock::now();
+    for(int ev = 0; ev < nevents; ev++) {
+      grid.Scan(&times[ev][0], &rows[ev][0], times[ev].size(), window, threshold, nthreads, candidates);
+      for(size_t ic = 0; ic < candidates.size(); ic++)
+	if(candidates[ic].time > 480 && candidates[ic].time < 520) {
+	  nfound++;
+	  break;
+	}
+    }
+    const double scan_ms = std::chrono::duration<double, std::milli>(clock::now() - start).count() / nevents;
+
+    std::cout << std::setw(12) << spacings[is] << std::setw(12) << grid.GetNumVertices()
+	      << std::setw(12) << grid.GetTableSize() / 1048576.
+	      << std::setw(12) << build_ms << std::setw(16) << scan_ms
+	      << std::setw(9) << nfound << "/" << nevents << std::endl;
+  }
+  return 0;
+}
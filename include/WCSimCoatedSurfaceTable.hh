@@ -0,0 +1,109 @@
+#ifndef WCSimCoatedSurfaceTable_h
+#define WCSimCoatedSurfaceTable_h 1
+
+/////////////////////////////////////////////////////////////////
+//
+// The thin film models of the coated (photocathode) surfaces of
+// WCSimOpBoundaryProcess, and a table of them against photon
+// energy & incidence angle, to save evaluating the complex
+// Fresnel equations for every photon
+//
+/////////////////////////////////////////////////////////////////
+
+#include "globals.hh"
+
+#include <functional>
+#include <vector>
+
+/// Reflection & transmission of the film, for s (TE) & p (TM) polarised light
+struct WCSimCoatedCoefficients
+{
+  G4double Rs, Rp; ///< Reflection probabilities
+  G4double Ts, Tp; ///< Transmission probabilities (the rest is absorbed)
+  G4double rs, rp; ///< Real parts of the reflection amplitudes (their signs set the polarisation)
+  G4double ts, tp; ///< Real parts of the transmission amplitudes
+
+  /// The reflection probability of a photon with polarisation components E1_perp (s) & E1_parl (p)
+  G4double Reflectivity(G4double E1_perp, G4double E1_parl) const {
+    return (Rs * E1_perp * E1_perp + Rp * E1_parl * E1_parl) / (E1_perp * E1_perp + E1_parl * E1_parl);
+  }
+  /// As Reflectivity(), for transmission
+  G4double Transmittance(G4double E1_perp, G4double E1_parl) const {
+    return (Ts * E1_perp * E1_perp + Tp * E1_parl * E1_parl) / (E1_perp * E1_perp + E1_parl * E1_parl);
+  }
+};
+
+/**
+ * \class WCSimCoatedSurfaceTable
+ *
+ * \brief The coefficients of a coated surface, tabulated against photon energy & cos(incidence angle)
+ *
+ * The model is evaluated on a grid of nenergy x ncos nodes, evenly spaced in energy over
+ * [emin, emax] and in cos(angle) over [0, 1], and is bilinearly interpolated in between.
+ *
+ * Each cell of the grid is checked against the model on a 9 x 9 grid of points over it.
+ * Where any probability is off by more than 3/4 of the tolerance (which allows for the
+ * error between the points, see benchmarkCoatedTable), or an amplitude has the wrong sign
+ * (e.g. around the critical angle), the cell is left to the model: Interpolate() returns false
+ * & the caller evaluates the model itself
+ */
+
+class WCSimCoatedSurfaceTable
+{
+public:
+  /// Evaluates the model for a photon energy & cos(incidence angle)
+  typedef std::function<void(G4double energy, G4double cost, WCSimCoatedCoefficients & c)> Model;
+
+  WCSimCoatedSurfaceTable(const Model & model, G4double emin, G4double emax,
+			  G4int nenergy, G4int ncos, G4double tolerance);
+
+  /// The interpolated coefficients. False if the point is outside the table or in a cell left to the model
+  G4bool Interpolate(G4double energy, G4double cost, WCSimCoatedCoefficients & c) const {
+    if(!(energy >= fEnergyMin && energy <= fEnergyMax && cost >= 0 && cost <= 1))
+      return false;
+    const G4double x = (energy - fEnergyMin) / fEnergyStep;
+    const G4double y = cost / fCosStep;
+    G4int ie = (G4int)x, ic = (G4int)y;
+    if(ie > fNEnergy - 2) ie = fNEnergy - 2;
+    if(ic > fNCos - 2)    ic = fNCos - 2;
+    if(!fTabulated[ie * (fNCos - 1) + ic])
+      return false;
+    Bilinear(ie, ic, x - ie, y - ic, c);
+    return true;
+  }
+
+  G4double GetModelFraction() const { return fModelFraction; } ///< Fraction of the cells left to the model
+  G4double GetMaxError()      const { return fMaxError; }      ///< Largest error of the tabulated cells, at the points checked
+
+  /**
+   * Model1 of WCSimOpBoundaryProcess (https://ieeexplore.ieee.org/document/9875513): a film of real refractive index.
+   * Fills Rs & Rp, with the angles of incidence (1), in the film (TL) & of refraction (2) given as in
+   * WCSimOpBoundaryProcess::CoatedDielectricDielectric_Model1()
+   */
+  static void Model1(G4double Rindex1, G4double Rindex2, G4double CoatedRindex, G4double CoatedThickness,
+		     G4bool FrustratedTransmission, G4double wavelength,
+		     G4double sint1, G4double sinTL, G4double costh1, G4double costh2,
+		     WCSimCoatedCoefficients & c);
+
+  /**
+   * Model2 of WCSimOpBoundaryProcess (https://arxiv.org/abs/physics/0408075v1): a film of complex refractive index.
+   * Fills all the coefficients. Rindex1 & Rindex2 are those of the incident & far media (n2 & n4 of the paper),
+   * so they swap when a photon goes back through the film
+   */
+  static void Model2(G4double Rindex1, G4double Rindex2, G4double CoatedRindex, G4double CoatedRindexIm,
+		     G4double CoatedThickness, G4double wavelength, G4double cost1, G4double sint1,
+		     WCSimCoatedCoefficients & c);
+
+private:
+  static G4bool Finite(const WCSimCoatedCoefficients & c);
+  void Bilinear(G4int ie, G4int ic, G4double fx, G4double fy, WCSimCoatedCoefficients & c) const;
+
+  G4double fEnergyMin, fEnergyMax, fEnergyStep, fCosStep;
+  G4int    fNEnergy, fNCos;
+  std::vector<WCSimCoatedCoefficients> fNodes; ///< Index ienergy * fNCos + icos
+  std::vector<char> fTabulated;                ///< Per cell, index ienergy * (fNCos - 1) + icos
+  G4double fModelFraction;
+  G4double fMaxError;
+};
+
+#endif
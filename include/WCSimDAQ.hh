@@ -0,0 +1,88 @@
+#ifndef WCSimDAQ_h
+#define WCSimDAQ_h 1
+
+/////////////////////////////////////////////////////////////////
+//
+// Common types of the standalone DAQ library (libWCSimDAQ):
+// the digitizer, dark noise and trigger algorithms, working on
+// plain arrays of hits and digits.
+//
+// The library depends on neither Geant4 nor ROOT. In WCSim it is
+// driven by the G4VDigitizerModule adapters (WCSimWCDigitizer,
+// WCSimWCAddDarkNoise, WCSimWCTrigger), which copy the Geant4
+// collections into these arrays and back.
+//
+// Random numbers & the PMT response come through the two
+// interfaces below, so that the library gives the same results
+// as the Geant4 modules for the same random engine.
+//
+/////////////////////////////////////////////////////////////////
+
+#include <stddef.h>
+#include <string>
+#include <vector>
+
+/// Source of random numbers for the DAQ algorithms
+class WCSimDAQRandom {
+public:
+  virtual ~WCSimDAQRandom() {}
+  /// Uniform in (0,1)
+  virtual double Flat() = 0;
+  virtual double Gauss(double mean, double sigma) = 0;
+  virtual long   Poisson(double mean) = 0;
+};
+
+/// The response of the PMTs. The random numbers come from the caller, so that
+/// the multithreaded algorithms can call it from several threads at once
+class WCSimDAQPMTResponse {
+public:
+  virtual ~WCSimDAQPMTResponse() {}
+  /// A random digit time smearing (ns) for charge Q (p.e.)
+  virtual float  HitTimeSmearing(float Q, WCSimDAQRandom & random) = 0;
+  /// A random single photoelectron charge (p.e.)
+  virtual double SinglePE(WCSimDAQRandom & random) = 0;
+  /// The single photoelectron pulse at t (ns) after the photoelectron, with a peak height of 1.
+  /// Only used by the waveform digitizer, which tabulates it once per PulseName()
+  virtual double PulseShape(double t) = 0;
+  /// Name of the pulse shape (e.g. the PMT type), the key of the pulse template cache
+  virtual std::string PulseName() = 0;
+};
+
+/**
+ * The hits (photoelectrons, or digits) of one event, grouped by PMT.
+ *
+ * PMT i has tube ID tube[i], and its hits are [start[i], start[i+1]) of time & charge.
+ * start has one more entry than tube.
+ */
+struct WCSimDAQHits {
+  std::vector<int>    tube;
+  std::vector<size_t> start;
+  std::vector<float>  time;   ///< ns
+  std::vector<float>  charge; ///< p.e.
+
+  WCSimDAQHits() : start(1, 0) {}
+  size_t GetNumPMT()  const { return tube.size(); }
+  size_t GetNumHits() const { return time.size(); }
+  void Clear() { tube.clear(); start.assign(1, 0); time.clear(); charge.clear(); }
+  /// Add a PMT, then its hits with AddHit()
+  void AddPMT(int tubeID) { tube.push_back(tubeID); start.push_back(start.back()); }
+  void AddHit(float t, float q) { time.push_back(t); charge.push_back(q); start.back()++; }
+};
+
+/// A digit made by the digitizer
+struct WCSimDAQDigit {
+  int   pmt;    ///< Index of the PMT in the input WCSimDAQHits
+  float time;   ///< ns
+  float charge; ///< p.e.
+  std::vector<int> composition; ///< Indices, within the PMT, of the hits that make the digit
+};
+
+/// A digit in the time-sorted view of all digits of an event, used by the trigger algorithms
+struct WCSimDAQSortedDigit {
+  float time;  ///< Digit time
+  int   pmt;   ///< Index of the PMT in the input collection
+  int   tube;  ///< Tube ID of the PMT
+  int   digit; ///< Index of the digit on the PMT
+};
+
+#endif
@@ -0,0 +1,47 @@
+#ifndef WCSimDAQDarkNoise_h
+#define WCSimDAQDarkNoise_h 1
+
+/////////////////////////////////////////////////////////////////
+//
+// Standalone dark noise algorithms (see WCSimDAQ.hh).
+// Used by WCSimWCAddDarkNoise.
+//
+/////////////////////////////////////////////////////////////////
+
+#include "WCSimDAQ.hh"
+
+#include <vector>
+#include <utility>
+
+class WCSimDAQDarkNoise
+{
+public:
+  /// A dark noise hit
+  struct NoiseHit {
+    int   tube;   ///< Tube ID, from 1 to the number of PMTs
+    float time;   ///< ns
+    float charge; ///< p.e.
+  };
+
+  /**
+   * Find the time ranges in which to add dark noise: a window of width (ns) centred on every hit.
+   *
+   * result is filled with the non-overlapping union of the windows, in time order.
+   * If there are no hits, result is the single empty range [0,0]
+   */
+  static void FindRanges(const std::vector<float> & times, float width,
+			 std::vector<std::pair<float, float> > & result);
+
+  /**
+   * Generate the dark noise hits of npmt identical PMTs (tube IDs 1 to npmt) in [low, high] (ns).
+   *
+   * The number of hits is Poisson distributed, with mean npmt x rate (kHz) x conversion x (high - low).
+   * Each hit is on a random PMT, at a uniformly random time, with a single p.e. charge from response.
+   * The hits are appended to hits, in the order they were generated
+   */
+  static void Generate(int npmt, double rate, double conversion, float low, float high,
+		       WCSimDAQRandom & random, WCSimDAQPMTResponse & response,
+		       std::vector<NoiseHit> & hits);
+};
+
+#endif
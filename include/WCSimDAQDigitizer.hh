@@ -0,0 +1,94 @@
+#ifndef WCSimDAQDigitizer_h
+#define WCSimDAQDigitizer_h 1
+
+/////////////////////////////////////////////////////////////////
+//
+// Standalone digitizer algorithms (see WCSimDAQ.hh).
+// Used by WCSimWCDigitizer.
+//
+/////////////////////////////////////////////////////////////////
+
+#include "WCSimDAQ.hh"
+
+#include <stdint.h>
+#include <vector>
+
+/**
+ * \class WCSimDAQDigitizerSKI
+ *
+ * \brief The SKI digitizer: integrates the charge on each PMT in a window starting at the first hit
+ *
+ * After each integration window the PMT is dead for the dead time. Digits must pass the
+ * SK threshold function; their times are smeared by the PMT timing resolution, and
+ * their charge and time are truncated to the digitizer precisions
+ */
+
+class WCSimDAQDigitizerSKI
+{
+public:
+  WCSimDAQDigitizerSKI();
+
+  void SetDeadTime         (int deadtime)       { DeadTime = deadtime; }           ///< ns
+  void SetIntegrationWindow(int inttime)        { IntegrationWindow = inttime; }   ///< ns
+  void SetTimingPrecision  (double precision)   { TimingPrecision = precision; }   ///< ns
+  void SetPEPrecision      (double precision)   { PEPrecision = precision; }       ///< p.e.
+
+  /**
+   * Digitize the hits of every PMT. The hits of each PMT must be sorted by time.
+   *
+   * The digits are appended to digits, in PMT order then time order.
+   * Their composition holds the indices (within the PMT) of the hits in the integration window.
+   *
+   * The integration windows are found by searching the time array of each PMT,
+   * rather than by testing each hit in turn, so that the hits in the dead time are never visited
+   */
+  void Digitize(const WCSimDAQHits & hits, WCSimDAQRandom & random, WCSimDAQPMTResponse & response,
+		std::vector<WCSimDAQDigit> & digits) const;
+
+  /**
+   * As above, with the PMTs split between nthreads threads (0: one per core).
+   *
+   * The random numbers of each PMT come from its own substream (WCSimDAQRandomStream), made from
+   * seed and the tube ID. So the digits depend on seed but not on nthreads, and are in the same order.
+   * response must be thread safe
+   */
+  void Digitize(const WCSimDAQHits & hits, uint64_t seed, unsigned int nthreads,
+		WCSimDAQPMTResponse & response, std::vector<WCSimDAQDigit> & digits) const;
+
+  ///The original hit-by-hit integration loop. Gives the same digits as Digitize() (for the same random numbers)
+  void DigitizeReference(const WCSimDAQHits & hits, WCSimDAQRandom & random, WCSimDAQPMTResponse & response,
+			 std::vector<WCSimDAQDigit> & digits) const;
+
+  ///Round value down to a multiple of precision (no rounding if precision is 0)
+  static double Truncate(double value, double precision) {
+    if(precision < 1E-10) return value;
+    return precision * (int)(value / precision);
+  }
+
+  ///The SK threshold function. Sets iflag to 1 (and pe to 0) if the charge fails the threshold, else smears pe
+  static void Threshold(double& pe, int& iflag, WCSimDAQRandom & random);
+
+private:
+  ///Digitize the hits of PMT ipmt. digi_comp is workspace
+  void DigitizePMT(const WCSimDAQHits & hits, size_t ipmt, WCSimDAQRandom & random, WCSimDAQPMTResponse & response,
+		   std::vector<WCSimDAQDigit> & digits, std::vector<int> & digi_comp) const;
+  void DigitizePMTReference(const WCSimDAQHits & hits, size_t ipmt, WCSimDAQRandom & random, WCSimDAQPMTResponse & response,
+			    std::vector<WCSimDAQDigit> & digits) const;
+
+  ///Apply the threshold, efficiency & time smearing to the charge integrated in the window starting at intgr_start,
+  ///and add the digit. composition is left empty
+  void MakeDigit(int pmt, float intgr_start, double peSmeared, std::vector<int> & composition,
+		 WCSimDAQRandom & random, WCSimDAQPMTResponse & response,
+		 std::vector<WCSimDAQDigit> & digits) const;
+
+  ///Truncate and save a digit, if its charge is positive. On success composition is moved into the digit
+  bool AddDigit(int pmt, float digihittime, float peSmeared, std::vector<int> & composition,
+		std::vector<WCSimDAQDigit> & digits) const;
+
+  int    DeadTime;          ///< ns
+  int    IntegrationWindow; ///< ns
+  double TimingPrecision;   ///< ns
+  double PEPrecision;       ///< p.e.
+};
+
+#endif
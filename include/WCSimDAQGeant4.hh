@@ -0,0 +1,42 @@
+#ifndef WCSimDAQGeant4_h
+#define WCSimDAQGeant4_h 1
+
+// Geant4 implementations of the interfaces of the standalone DAQ library (WCSimDAQ.hh),
+// used by the digitizer, dark noise and trigger G4VDigitizerModules
+
+#include "WCSimDAQ.hh"
+#include "WCSimPMTObject.hh"
+#include "WCSimWCPMT.hh"
+#include "Randomize.hh"
+
+#include <stdint.h>
+
+/// Random numbers from the Geant4 (CLHEP) random engine
+class WCSimDAQG4Random : public WCSimDAQRandom {
+public:
+  double Flat()                           { return G4UniformRand(); }
+  double Gauss(double mean, double sigma) { return G4RandGauss::shoot(mean, sigma); }
+  long   Poisson(double mean)             { return CLHEP::RandPoisson::shoot(mean); }
+  /// A seed for the per-PMT random number substreams of the multithreaded algorithms (WCSimDAQParallel.hh)
+  static uint64_t Seed() {
+    const uint64_t high = (uint64_t)(G4UniformRand() * 4294967296.);
+    const uint64_t low  = (uint64_t)(G4UniformRand() * 4294967296.);
+    return (high << 32) | low;
+  }
+};
+
+/// The response of the PMT type of the detector: time smearing & pulse shape from WCSimPMTObject,
+/// single p.e. charge from its qpe table (as WCSimWCPMT::rn1pe())
+class WCSimDAQG4PMTResponse : public WCSimDAQPMTResponse {
+public:
+  WCSimDAQG4PMTResponse(WCSimPMTObject * pmt) : PMT(pmt), qpe(pmt->Getqpe()) {}
+  float  HitTimeSmearing(float Q, WCSimDAQRandom & random) { return PMT->HitTimeSmearing(Q, random); }
+  double SinglePE(WCSimDAQRandom & random)                 { return WCSimWCPMT::rn1pe(qpe, random); }
+  double PulseShape(double t)                              { return PMT->PulseShape(t); }
+  std::string PulseName()                                  { return PMT->GetPMTName(); }
+private:
+  WCSimPMTObject * PMT;
+  const G4float  * qpe;
+};
+
+#endif
@@ -0,0 +1,62 @@
+#ifndef WCSimDAQParallel_h
+#define WCSimDAQParallel_h 1
+
+/////////////////////////////////////////////////////////////////
+//
+// Tools for running the per-PMT DAQ algorithms on several
+// threads (see WCSimDAQ.hh).
+//
+// Each PMT gets its own random number substream, made from a
+// seed (drawn once per event) and the tube ID, so the results
+// depend on the seed but not on the number of threads.
+//
+/////////////////////////////////////////////////////////////////
+
+#include "WCSimDAQ.hh"
+
+#include <stdint.h>
+#include <functional>
+
+/**
+ * \class WCSimDAQRandomStream
+ *
+ * \brief A random number substream: a SplitMix64 generator whose state is made from (seed, stream)
+ *
+ * It is cheap to create, so one can be made for each PMT of each event.
+ * It is also a UniformRandomBitGenerator, so can be used with the <random> distributions
+ */
+
+class WCSimDAQRandomStream : public WCSimDAQRandom
+{
+public:
+  WCSimDAQRandomStream(uint64_t seed, uint64_t stream);
+
+  double Flat();
+  double Gauss(double mean, double sigma);
+  long   Poisson(double mean);
+
+  typedef uint64_t result_type;
+  static constexpr result_type min() { return 0; }
+  static constexpr result_type max() { return ~result_type(0); }
+  result_type operator()();
+
+private:
+  uint64_t state;
+  bool     hasSpareGauss; ///< The polar method makes Gaussians in pairs
+  double   spareGauss;
+};
+
+class WCSimDAQParallel
+{
+public:
+  /**
+   * Call task(first, last) for the ranges [first, last) that split [0, n) into chunks of (at most) chunk,
+   * on nthreads threads (0: one per core). Chunks are handed out in order as the threads become free.
+   *
+   * task must be thread safe. The ranges, and so anything the task stores per range, do not depend on nthreads
+   */
+  static void For(size_t n, size_t chunk, unsigned int nthreads,
+		  const std::function<void(size_t first, size_t last)> & task);
+};
+
+#endif
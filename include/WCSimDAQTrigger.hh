@@ -0,0 +1,68 @@
+#ifndef WCSimDAQTrigger_h
+#define WCSimDAQTrigger_h 1
+
+/////////////////////////////////////////////////////////////////
+//
+// Standalone trigger algorithms (see WCSimDAQ.hh).
+// Used by WCSimWCTrigger.
+//
+// All work on the time-sorted view of the digits of an event
+// (a vector of WCSimDAQSortedDigit), with an optional per digit
+// bitmask (parallel to it) to hide digits from an algorithm.
+//
+/////////////////////////////////////////////////////////////////
+
+#include "WCSimDAQ.hh"
+
+#include <vector>
+
+class WCSimDAQTrigger
+{
+public:
+  /// A digit saved in a trigger window by SelectTriggeredDigits()
+  struct TriggeredDigit {
+    int    trigger; ///< Index of the trigger
+    size_t digit;   ///< Index of the digit in the time-sorted view
+    float  time;    ///< Digit time relative to the trigger, plus the offset (ns)
+  };
+
+  ///Orders digits by time
+  static bool CompareTime(const WCSimDAQSortedDigit & a, const WCSimDAQSortedDigit & b) { return a.time < b.time; }
+
+  ///Sort digits by time. Stable, so that digits at the same time stay in PMT order
+  static void SortByTime(std::vector<WCSimDAQSortedDigit> & digits);
+
+  /**
+   * \brief The NDigits trigger algorithm
+   *
+   * Slides a window (ns) along the time-sorted digits, counting the number of digits in it.
+   * If the count passes above threshold, a trigger is issued, and the search restarts
+   * postTriggerWindow (ns) after the trigger time.
+   * Digits with any of the bits in ignore_mask set in masks are not counted
+   *
+   * For each trigger, the time of the first digit above threshold (rounded down to 5 ns) is appended
+   * to triggerTimes, and the number of digits in the window to triggerInfos.
+   * Returns the number of triggers
+   */
+  static int NDigits(const std::vector<WCSimDAQSortedDigit> & digits, const std::vector<unsigned int> & masks,
+		     unsigned int ignore_mask, int threshold, int window, int postTriggerWindow,
+		     std::vector<float> & triggerTimes, std::vector< std::vector<float> > & triggerInfos);
+
+  /**
+   * \brief Find the digits to save in the readout windows of the triggers
+   *
+   * The triggers must be in time order. Trigger i reads out [triggerTimes[i] + preTriggerWindows[i],
+   * triggerTimes[i] + postTriggerWindows[i]]; each digit is saved at most once, in the earliest
+   * window it is in. If multiDigitsPerTrigger is false, only the earliest digit of each PMT is saved per trigger
+   *
+   * selected is filled trigger by trigger, and within a trigger in PMT then digit order
+   */
+  static void SelectTriggeredDigits(const std::vector<WCSimDAQSortedDigit> & digits,
+				    const std::vector<float> & triggerTimes,
+				    const std::vector<int> & preTriggerWindows,
+				    const std::vector<int> & postTriggerWindows,
+				    bool multiDigitsPerTrigger, double offset,
+				    std::vector<TriggeredDigit> & selected);
+};
+
+#endif
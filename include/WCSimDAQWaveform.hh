@@ -0,0 +1,154 @@
+#ifndef WCSimDAQWaveform_h
+#define WCSimDAQWaveform_h 1
+
+/////////////////////////////////////////////////////////////////
+//
+// Standalone waveform digitizer (see WCSimDAQ.hh): renders the
+// sampled waveform of each PMT from single p.e. pulse templates,
+// then runs a discriminator & charge integrator on it.
+// Used by WCSimWCDigitizerWaveform.
+//
+/////////////////////////////////////////////////////////////////
+
+#include "WCSimDAQ.hh"
+
+#include <stdint.h>
+#include <vector>
+
+/**
+ * \class WCSimDAQPulseTemplate
+ *
+ * \brief The single p.e. pulse of a PMT type, tabulated at the sample times
+ *
+ * The photoelectron time within a sample is split into NPhases sub-sample phases.
+ * For each phase there is a row of the Length samples that follow the photoelectron
+ * (Length is a multiple of 8, so that the rendering loop vectorises without a remainder).
+ *
+ * It also holds a table of single p.e. transit time spreads (response.HitTimeSmearing(1)),
+ * from which the photoelectron times are smeared.
+ *
+ * The templates are made once per (pulse shape, sample width, phases) and shared, see Get()
+ */
+
+class WCSimDAQPulseTemplate
+{
+public:
+  WCSimDAQPulseTemplate(WCSimDAQPMTResponse & response, double samplewidth, int nphases);
+
+  /**
+   * The template of the pulse shape of response, from the cache.
+   * It is made on the first call for each (response.PulseName(), samplewidth, nphases). Thread safe
+   */
+  static const WCSimDAQPulseTemplate & Get(WCSimDAQPMTResponse & response, double samplewidth, int nphases);
+
+  double GetSampleWidth() const { return SampleWidth; } ///< ns
+  int    GetNumPhases()   const { return NPhases; }
+  size_t GetLength()      const { return Length; }      ///< Samples per row
+  double GetDuration()    const { return Length * SampleWidth; } ///< ns
+  /// Sum of the samples of a single p.e. pulse (averaged over the phases)
+  double GetArea()        const { return Area; }
+
+  /// The phase of a photoelectron at fraction (in [0,1)) of the way through a sample
+  int GetPhaseIndex(double fraction) const {
+    int iphase = (int)(fraction * NPhases);
+    if(iphase >= NPhases) iphase = NPhases - 1;
+    if(iphase < 0)        iphase = 0;
+    return iphase;
+  }
+  /// The samples that follow a photoelectron of phase iphase.
+  /// The first sample is that in which the photoelectron arrives
+  const float * GetRow(int iphase) const { return &Samples[iphase * Length]; }
+  /// The samples that follow a photoelectron at fraction (in [0,1)) of the way through a sample
+  const float * GetPhase(double fraction) const { return GetRow(GetPhaseIndex(fraction)); }
+
+  /// The time (ns) after the photoelectron at which a single p.e. pulse first reaches threshold (-1 if it never does)
+  double GetThresholdDelay(double threshold) const;
+
+  /// Random single p.e. transit time spreads (ns). The size is a power of 2
+  const std::vector<float> & GetTransitTimes() const { return TransitTimes; }
+
+private:
+  double SampleWidth;
+  int    NPhases;
+  size_t Length;
+  double Area;
+  std::vector<float> Samples; ///< NPhases rows of Length samples
+  std::vector<float> TransitTimes;
+};
+
+/**
+ * \class WCSimDAQDigitizerWaveform
+ *
+ * \brief A digitizer that works on the sampled waveform of each PMT
+ *
+ * Each photoelectron is smeared by the single p.e. transit time spread, and adds the
+ * pulse template of its phase, scaled by its charge, to the waveform. Where there are more
+ * photoelectrons than samples, their charges are first summed in bins of (sample, phase),
+ * and each bin adds the template once: the waveform is the same, at a cost that no longer
+ * grows with the number of photoelectrons.
+ * Gaussian noise is added to each sample. The transit times & the noise come from tables,
+ * read from a random offset for each stretch of waveform, rather than a Gaussian for
+ * every photoelectron & sample.
+ *
+ * A digit is made when the waveform crosses the threshold. Its charge is the sum of the samples
+ * in the integration window (which starts at the sample before the crossing) divided by the
+ * single p.e. pulse area. Its time is the (interpolated) crossing time, less the time a single
+ * p.e. pulse takes to reach threshold. After the integration window the digitizer is dead for
+ * the dead time, then rearms when the waveform goes below threshold.
+ *
+ * Only the stretches of waveform around the photoelectrons are rendered, so noise alone
+ * makes no digits (the dark noise is in the hits).
+ */
+
+class WCSimDAQDigitizerWaveform
+{
+public:
+  WCSimDAQDigitizerWaveform();
+
+  void SetDeadTime         (int deadtime)       { DeadTime = deadtime; }           ///< ns
+  void SetIntegrationWindow(int inttime)        { IntegrationWindow = inttime; }   ///< ns
+  void SetTimingPrecision  (double precision)   { TimingPrecision = precision; }   ///< ns
+  void SetPEPrecision      (double precision)   { PEPrecision = precision; }       ///< p.e.
+  void SetSampleWidth      (double width)       { SampleWidth = width; }           ///< ns
+  void SetNPhases          (int nphases)        { NPhases = nphases; }             ///< Sub-sample phases of the pulse templates
+  void SetThreshold        (double threshold)   { Threshold = threshold; }         ///< Fraction of the single p.e. pulse height
+  void SetNoise            (double noise)       { Noise = noise; }                 ///< Noise RMS, as a fraction of the single p.e. pulse height
+
+  /**
+   * Digitize the hits of every PMT. The hits of each PMT must be sorted by time.
+   *
+   * The digits are appended to digits, in PMT order then time order.
+   * Their composition holds the indices (within the PMT) of the hits that arrived in the integration window,
+   * or between it and the previous one
+   */
+  void Digitize(const WCSimDAQHits & hits, WCSimDAQRandom & random, WCSimDAQPMTResponse & response,
+		std::vector<WCSimDAQDigit> & digits) const;
+
+  ///As above, with the PMTs split between nthreads threads, as WCSimDAQDigitizerSKI::Digitize()
+  void Digitize(const WCSimDAQHits & hits, uint64_t seed, unsigned int nthreads,
+		WCSimDAQPMTResponse & response, std::vector<WCSimDAQDigit> & digits) const;
+
+private:
+  ///Per-thread workspace of DigitizePMT()
+  struct Workspace {
+    std::vector<float>  time;        ///< Smeared photoelectron times
+    std::vector<float>  wave;
+    std::vector<float>  binned;      ///< Charge in each (sample, phase) bin
+    std::vector<double> windowend;   ///< End time of each integration window
+    std::vector<long>   windowdigit; ///< Digit of each integration window
+  };
+
+  void DigitizePMT(const WCSimDAQHits & hits, size_t ipmt, const WCSimDAQPulseTemplate & pulse, double delay,
+		   WCSimDAQRandom & random, std::vector<WCSimDAQDigit> & digits, Workspace & work) const;
+
+  int    DeadTime;          ///< ns
+  int    IntegrationWindow; ///< ns
+  double TimingPrecision;   ///< ns
+  double PEPrecision;       ///< p.e.
+  double SampleWidth;       ///< ns
+  int    NPhases;
+  double Threshold;         ///< Fraction of the single p.e. pulse height
+  double Noise;             ///< Fraction of the single p.e. pulse height
+};
+
+#endif
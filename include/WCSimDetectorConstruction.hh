@@ -19,6 +19,7 @@
 // warning : hash_map is not part of the standard
 //#include <ext/hash_map>       //TF: deprecated, but need new C++ features, probably from gcc4.2 onwards
 #include <unordered_map>     //--> need to fix the "using" and namespace statements
+#include <unordered_set>
 
 //instead of using forward declaration, just include:
 #include "G4Material.hh"
@@ -112,6 +113,7 @@ public:
   G4int    UsePMT_Coll_Eff(){return PMT_Coll_Eff;}
 
   G4double GetPMTSize1() {return WCPMTSize;}
+  G4String GetGeometryTableFileName() {return geoTableFileName;}
 
   G4float GetPMTQE(G4String,G4float, G4int, G4float, G4float, G4float);
   G4float GetPMTCollectionEfficiency(G4float theta_angle, G4String CollectionName) { return GetPMTPointer(CollectionName)->GetCollectionEfficiency(theta_angle); };
@@ -293,6 +295,15 @@ public:
   void SetPMTPositionInput(G4String choice) {pmtPositionFile = choice; readFromTable = true;}
   G4String GetPMTPositionInput() {return pmtPositionFile;}
 
+  // Optical photons are killed by WCSimSteppingAction as soon as they enter
+  // one of these logical volumes, which must have no path to a PMT.
+  // The names are looked up in the logical volume store by Construct()
+  void AddOpticalKillVolume(G4String name) {opticalKillVolumeNames.push_back(name);}
+  void ClearOpticalKillVolumes() {opticalKillVolumeNames.clear(); opticalKillVolumes.clear();}
+  void ResolveOpticalKillVolumes();
+  G4bool HasOpticalKillVolumes() const {return !opticalKillVolumes.empty();}
+  G4bool IsOpticalKillVolume(const G4LogicalVolume* lv) const {return opticalKillVolumes.count(lv) != 0;}
+
   void   SetPMTType(G4String type) {
     WCPMTType = type;
     //And update everything that is affected by a new PMT
@@ -568,6 +579,10 @@ private:
   std::vector<G4ThreeVector> pmtPos, pmtDir;
   std::vector<G4bool> pmtUse;
   std::string pmtPositionFile;
+
+  // Volumes where optical photons are killed
+  std::vector<G4String> opticalKillVolumeNames;
+  std::unordered_set<const G4LogicalVolume*> opticalKillVolumes;
   void ReadGeometryTableFromFile();
   G4int PMTID;
 
@@ -645,7 +660,7 @@ private:
 
   // Variables related to the geometry
 
-  std::ofstream geoFile;   // File for text output
+  G4String geoTableFileName;   // Binary PMT geometry table written by DumpGeometryTableToFile
 
   G4int totalNumPMTs;      // The number of PMTs for this configuration     
   G4int totalNum_mPMTs;   // The number of mPMTs (+1 for single PMT, +1 for mPMT)
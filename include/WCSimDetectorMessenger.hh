@@ -84,6 +84,11 @@ class WCSimDetectorMessenger: public G4UImessenger
   G4UIcmdWithADoubleAndUnit* PMTPosVar;
   G4UIcmdWith3VectorAndUnit* TankRadiusChange;
   G4UIcmdWithAString* SetPMTPositionInput;
+
+  //Optical photon kill volumes
+  G4UIdirectory* OpticalKillDir;
+  G4UIcmdWithAString* OpticalKillVolume;
+  G4UIcmdWithoutParameter* OpticalKillClear;
 };
 
 #endif
@@ -7,12 +7,15 @@ typedef enum ETriggerType {
   kTriggerUndefined = -1,
   kTriggerNDigits,
   kTriggerNDigitsTest,
+  kTriggerLocalNHits,
+  kTriggerTOFScan,
   kTriggerFailure // this should always be the last entry (for looping)
 } TriggerType_t;
 
 typedef enum EDigitizerType {
   kDigitizerUndefined = -1,
-  kDigitizerSKI
+  kDigitizerSKI,
+  kDigitizerWaveform
 } DigitizerType_t;
 
 typedef enum EInteractionMode {
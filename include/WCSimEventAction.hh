@@ -46,6 +46,7 @@ public:
   WCSimRunAction* GetRunAction(){return runAction;}
   void SetDigitizerChoice(G4String digitizer) { DigitizerChoice = digitizer; }
   void SetTriggerChoice  (G4String trigger)   { TriggerChoice   = trigger;   }
+  void SetDAQNThreads    (G4int nthreads)     { DAQNThreads     = nthreads;  }
 
   void FillFlatTree(G4int,
 		    const struct ntupleStruct&, 
@@ -62,9 +63,15 @@ private:
 
   ///Create instances of the user-chosen digitizer and trigger classes
   void  CreateDAQInstances();
+  ///Run the PMT response & dark noise on the p.e. in [low - margin, high + margin), then the digitizer & trigger
+  /// (only the continuous readout time slices in [low, high) are written). RunDAQ(-DBL_MAX, DBL_MAX, 0) does the whole event
+  void  RunDAQ(double low, double high, double margin);
+  ///Delete a digi collection of this event, to free its memory before the end of the event
+  void  DeleteDigiCollection(const G4String & name);
 
   G4String DigitizerChoice;
   G4String TriggerChoice;
+  G4int    DAQNThreads; ///< Threads for the per-PMT loops of the PMT response & digitizer (0: not threaded)
   bool     ConstructedDAQClasses;
   bool     SavedOptions;
 };
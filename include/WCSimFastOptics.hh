@@ -0,0 +1,100 @@
+#ifndef WCSimFastOptics_h
+#define WCSimFastOptics_h 1
+
+#include "WCSimPhotonTable.hh"
+#include "WCSimWCHit.hh"
+#include "WCSimRootOptions.hh"
+#include "G4ThreeVector.hh"
+#include "globals.hh"
+
+#include <vector>
+
+class G4Event;
+class G4Step;
+class WCSimDetectorConstruction;
+class WCSimFastOpticsMessenger;
+
+// Fast optical simulation with photon detection probability tables (WCSimPhotonTable).
+//
+// Building a table (/WCSim/FastOptics/BuildTable & /mygen/generator photontable):
+// each event emits PhotonsPerCell optical photons from one (position, direction)
+// cell, uniformly over the cell, with the Cherenkov spectrum of the local material.
+// They are tracked in full, and the p.e. they make are added to the table.
+//
+// Using a table (/WCSim/FastOptics/UseTable): optical photons are not tracked.
+// Instead, each step of a charged particle emits its expected number of Cherenkov
+// photons on its cone (in ConeSamples directions, at random points along the step),
+// and the p.e. of each PMT are drawn from the table entries of the cells hit: a
+// Poisson number for the expected p.e., at times sampled from the arrival time
+// quantiles. The p.e. are added to the hits collection at the end of the event.
+class WCSimFastOptics
+{
+public:
+  WCSimFastOptics(WCSimDetectorConstruction*);
+  ~WCSimFastOptics();
+
+  // Set by the messenger
+  void SetBuildFileName(G4String fname) { buildFileName = fname; }
+  void SetVoxelSize(G4double size)      { voxelSize = size; }
+  void SetNCosTheta(G4int n)            { nCosTheta = n; }
+  void SetNPhi(G4int n)                 { nPhi = n; }
+  void SetPhotonsPerCell(G4int n)       { photonsPerCell = n; }
+  void SetMinProbability(G4double p)    { minProbability = p; }
+  void SetConeSamples(G4int n)          { coneSamples = n; }
+  void UseTable(G4String fname);
+
+  void BeginOfRun();
+  void EndOfRun();
+  void SaveOptionsToOutput(WCSimRootOptions * wcopt);
+
+  // Building a table
+  G4bool IsBuilding() { return table.IsWriting(); }
+  /// The photons of the next cell. False once all cells are done
+  G4bool GenerateCellPhotons(G4Event* anEvent);
+  /// Add the p.e. of the event to its cell
+  void EndCell(WCSimWCHitsCollection* WCHC);
+
+  // Using a table
+  G4bool IsFast() { return table.IsOpen(); }
+  /// Sample the p.e. of the Cherenkov light of a step
+  void ProcessStep(const G4Step* aStep);
+  /// The primary parent ID of the p.e. of the track that just ended
+  void EndOfTrack(G4int trackID, G4int primaryParentID);
+  /// Move the p.e. of the event to the hits collection
+  void FillHits(WCSimWCHitsCollection* WCHC);
+
+private:
+  // A p.e. sampled from the table, waiting for the end of the event
+  struct PendingPe {
+    G4int         tube;
+    G4float       time;
+    G4int         parentID;
+    G4float       startTime;
+    G4ThreeVector startPos;
+  };
+
+  WCSimDetectorConstruction* myDetector;
+  WCSimFastOpticsMessenger* messenger;
+  WCSimPhotonTable table;
+
+  // Table building
+  G4String buildFileName;
+  G4double voxelSize;
+  G4int    nCosTheta;
+  G4int    nPhi;
+  G4int    photonsPerCell;
+  G4double minProbability;
+  uint64_t nextCell;
+  uint64_t cellPhotons; // photons emitted from the current cell
+
+  // Table use
+  G4String tableFileName;
+  G4int    coneSamples;
+  std::vector<PendingPe> pending;
+  G4int  currentTrackID; // track whose p.e. start at currentTrackFirst
+  size_t currentTrackFirst;
+  G4int  currentEventID;
+  std::vector<int> HitIndex; // index in the hits collection of each tube's hit (-1 if none yet)
+};
+
+#endif
@@ -0,0 +1,37 @@
+#ifndef WCSimFastOpticsMessenger_h
+#define WCSimFastOpticsMessenger_h 1
+
+#include "G4UImessenger.hh"
+
+class G4UIcommand;
+class G4UIdirectory;
+class G4UIcmdWithAString;
+class G4UIcmdWithAnInteger;
+class G4UIcmdWithADouble;
+class G4UIcmdWithADoubleAndUnit;
+class WCSimFastOptics;
+
+class WCSimFastOpticsMessenger: public G4UImessenger
+{
+public:
+  WCSimFastOpticsMessenger(WCSimFastOptics*);
+
+  ~WCSimFastOpticsMessenger();
+
+  void SetNewValue(G4UIcommand* command, G4String newValue);
+
+private:
+  WCSimFastOptics* WCSimFastOpt;
+
+  G4UIdirectory* WCSimDir;
+  G4UIcmdWithAString* BuildTable;
+  G4UIcmdWithADoubleAndUnit* VoxelSize;
+  G4UIcmdWithAnInteger* NCosTheta;
+  G4UIcmdWithAnInteger* NPhi;
+  G4UIcmdWithAnInteger* PhotonsPerCell;
+  G4UIcmdWithADouble* MinProbability;
+  G4UIcmdWithAString* UseTable;
+  G4UIcmdWithAnInteger* ConeSamples;
+};
+
+#endif
@@ -0,0 +1,80 @@
+#ifndef WCSimFresnel_h
+#define WCSimFresnel_h 1
+
+/////////////////////////////////////////////////////////////////
+//
+// Scalar kernel of the Fresnel equations of a dielectric-dielectric
+// boundary, as used by WCSimOpBoundaryProcess::DielectricDielectric()
+//
+// The kernel works on the cosines of the angles and the s (perp) &
+// p (parl) components of the polarisation, so it depends on neither
+// Geant4 nor CLHEP, and can be checked & timed on its own
+// (benchmarkFresnel). Compared to the original expressions it has no
+// branch on the sign of the cosines and fewer divisions: it gives
+// the same results to rounding, and draws no random numbers.
+//
+/////////////////////////////////////////////////////////////////
+
+#include <cmath>
+#include <algorithm>
+
+namespace WCSimFresnel {
+
+  /// Snell's law, from medium 1 into medium 2, with ratio = n1/n2.
+  /// cost1 is the cosine of the incidence angle (negative when the
+  /// photon hits the surface from the other side), and incidence within
+  /// tolerance of the normal counts as normal (sint1 = sint2 = 0).
+  /// Returns false for total internal reflection, else the cosine of the
+  /// refraction angle (of the same sign as cost1) is set
+  inline bool Refract(double cost1, double ratio, double tolerance,
+		      double & sint1, double & sint2, double & cost2)
+  {
+    const bool oblique = std::abs(cost1) < 1.0 - tolerance;
+    sint1 = oblique ? std::sqrt(std::max(0., 1. - cost1*cost1)) : 0.;
+    sint2 = sint1 * ratio;
+    if (sint2 >= 1.0)
+      return false;
+    const double c2 = std::sqrt(1. - sint2*sint2);
+    cost2 = cost1 > 0.0 ? c2 : -c2;
+    return true;
+  }
+
+  /// Amplitudes of the transmitted s & p components, for incident
+  /// components E1_perp & E1_parl, and the transmission probability
+  /// n2 cost2 |E2|^2 / (n1 cost1), which is 0 at grazing incidence
+  inline double Transmission(double n1, double n2, double cost1, double cost2,
+			     double E1_perp, double E1_parl,
+			     double & E2_perp, double & E2_parl, double & E2_total)
+  {
+    const double s1 = n1*cost1;
+    const double inv_perp = 1./(s1 + n2*cost2);
+    const double inv_parl = 1./(n2*cost1 + n1*cost2);
+    const double a_perp = E1_perp*inv_perp;
+    const double a_parl = E1_parl*inv_parl;
+    E2_perp  = 2.*s1*a_perp;
+    E2_parl  = 2.*s1*a_parl;
+    E2_total = E2_perp*E2_perp + E2_parl*E2_parl;
+    return 4.*s1*n2*cost2*(a_perp*a_perp + a_parl*a_parl);
+  }
+
+  /// Amplitudes of the reflected s & p components (for an oblique
+  /// incidence), from the incident & transmitted ones
+  inline void Reflection(double n1, double n2, double E1_perp, double E1_parl,
+			 double & E2_perp, double & E2_parl, double & E2_total)
+  {
+    E2_parl  = n2*E2_parl/n1 - E1_parl;
+    E2_perp  = E2_perp - E1_perp;
+    E2_total = E2_perp*E2_perp + E2_parl*E2_parl;
+  }
+
+  /// Unit s & p components of a polarisation of amplitudes E2_perp, E2_parl
+  inline void Direction(double E2_perp, double E2_parl, double E2_total,
+			double & C_perp, double & C_parl)
+  {
+    const double inv = 1./std::sqrt(E2_total);
+    C_perp = E2_perp*inv;
+    C_parl = E2_parl*inv;
+  }
+}
+
+#endif
@@ -0,0 +1,114 @@
+#ifndef WCSimGeometryTable_h
+#define WCSimGeometryTable_h 1
+
+/////////////////////////////////////////////////////////////////
+//
+// Binary PMT geometry table
+//
+// Written by WCSimDetectorConstruction (geofile_<detector>.bin)
+// and read back with mmap, e.g. to fill WCSimRootGeom or directly
+// by reconstruction. Depends on neither Geant4 nor ROOT.
+// Write() replaces the file atomically (write & rename), so a table
+// can be mapped while another job of the same directory rewrites it.
+//
+// File layout (native endian, all sections 64 byte aligned):
+//   WCSimGeometryTableHeader
+//   one array of numPMT values for each column, in EColumn order
+//     (int32 for IDs/locations, double for positions (cm) & directions)
+//
+/////////////////////////////////////////////////////////////////
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string>
+#include <vector>
+
+struct WCSimGeometryTableHeader {
+  char     magic[8];        // "WCSIMGEO"
+  uint32_t version;
+  uint32_t headerSize;      // sizeof(WCSimGeometryTableHeader), to catch layout changes
+  uint32_t numPMT;
+  int32_t  geoType;
+  int32_t  orientation;
+  int32_t  reserved;
+  double   cylRadius;       // cm
+  double   cylLength;       // cm
+  double   pmtRadius;       // cm
+  double   offset[3];       // cm
+  uint64_t columnOffset[10];// byte offset of each column from the start of the file
+  uint64_t fileSize;
+};
+
+class WCSimGeometryTable {
+public:
+  enum EColumn {
+    kTubeID = 0,
+    kmPMTID,
+    kmPMT_PMTID,
+    kCylLocation,
+    kPositionX,
+    kPositionY,
+    kPositionZ,
+    kDirectionX,
+    kDirectionY,
+    kDirectionZ,
+    kNColumns
+  };
+  static const uint32_t kVersion = 1;
+
+  WCSimGeometryTable();
+  ~WCSimGeometryTable();
+
+  // Building & writing a table
+  void SetDetector(int geoType, double cylRadius, double cylLength, double pmtRadius,
+		   int orientation, double offsetx, double offsety, double offsetz);
+  void AddPMT(int tubeID, int mPMTID, int mPMT_PMTID, int cylLocation,
+	      double x, double y, double z, double dirx, double diry, double dirz);
+  bool Write(const std::string & filename) const;
+
+  // Reading a table (mmaps the file; pointers are valid until Close())
+  bool Open(const std::string & filename);
+  void Close();
+  bool IsOpen() const { return fMap != 0; }
+
+  unsigned int GetNumPMT()      const { return fHeader->numPMT; }
+  int          GetGeoType()     const { return fHeader->geoType; }
+  int          GetOrientation() const { return fHeader->orientation; }
+  double       GetCylRadius()   const { return fHeader->cylRadius; }
+  double       GetCylLength()   const { return fHeader->cylLength; }
+  double       GetPMTRadius()   const { return fHeader->pmtRadius; }
+  double       GetOffset(int i) const { return fHeader->offset[i]; }
+
+  const int32_t * GetTubeID()      const { return IntColumn(kTubeID); }
+  const int32_t * GetmPMTID()      const { return IntColumn(kmPMTID); }
+  const int32_t * GetmPMT_PMTID()  const { return IntColumn(kmPMT_PMTID); }
+  const int32_t * GetCylLocation() const { return IntColumn(kCylLocation); }
+  const double  * GetPositionX()   const { return DoubleColumn(kPositionX); }
+  const double  * GetPositionY()   const { return DoubleColumn(kPositionY); }
+  const double  * GetPositionZ()   const { return DoubleColumn(kPositionZ); }
+  const double  * GetDirectionX()  const { return DoubleColumn(kDirectionX); }
+  const double  * GetDirectionY()  const { return DoubleColumn(kDirectionY); }
+  const double  * GetDirectionZ()  const { return DoubleColumn(kDirectionZ); }
+
+private:
+  const int32_t * IntColumn(EColumn c) const
+  { return reinterpret_cast<const int32_t*>(fMap + fHeader->columnOffset[c]); }
+  const double  * DoubleColumn(EColumn c) const
+  { return reinterpret_cast<const double*>(fMap + fHeader->columnOffset[c]); }
+
+  // Reading
+  const char * fMap;
+  size_t fMapSize;
+  const WCSimGeometryTableHeader * fHeader;
+
+  // Building
+  WCSimGeometryTableHeader fNewHeader;
+  std::vector<int32_t> fIntColumns[kPositionX];
+  std::vector<double>  fDoubleColumns[kNColumns - kPositionX];
+
+  // Not copyable (owns the mapping)
+  WCSimGeometryTable(const WCSimGeometryTable &);
+  WCSimGeometryTable & operator=(const WCSimGeometryTable &);
+};
+
+#endif
@@ -0,0 +1,102 @@
+#ifndef WCSimHitLibrary_h
+#define WCSimHitLibrary_h 1
+
+/////////////////////////////////////////////////////////////////
+//
+// Binary library of PMT hits, one entry per simulated event
+//
+// Written by WCSimRunAction (/WCSimIO/SaveHitLibrary) and read
+// back with mmap, e.g. by the pile-up overlay (WCSimWCOverlay) to
+// sample pre-simulated backgrounds without running Geant4 again.
+// Depends on neither Geant4 nor ROOT.
+//
+// File layout (native endian, all sections 64 byte aligned):
+//   WCSimHitLibraryHeader
+//   numHits WCSimHitLibraryHit records, entry after entry
+//   numEntries+1 uint64 entry boundaries (indices into the hits)
+//
+// Hits are streamed to disk as each entry is finished, so a
+// library can be much larger than memory. The header and entry
+// index are only written by Finish(); an unfinished library is
+// rejected by Open().
+//
+/////////////////////////////////////////////////////////////////
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <string>
+#include <vector>
+
+struct WCSimHitLibraryHeader {
+  char     magic[8];        // "WCSIMHIT"
+  uint32_t version;
+  uint32_t headerSize;      // sizeof(WCSimHitLibraryHeader), to catch layout changes
+  uint32_t level;           // WCSimHitLibrary::EHitLevel
+  uint32_t reserved;
+  uint64_t numEntries;
+  uint64_t numHits;
+  uint64_t hitOffset;       // byte offset of the hit records from the start of the file
+  uint64_t entryOffset;     // byte offset of the entry boundaries
+  uint64_t fileSize;
+};
+
+struct WCSimHitLibraryHit {
+  int32_t tube;             // tube ID (1..NPMT)
+  float   time;             // ns, relative to the start of the simulated event
+  float   charge;           // pe. Only meaningful for kRawSignal libraries
+  int32_t parentID;         // track ID of the primary parent of the photon
+};
+
+class WCSimHitLibrary {
+public:
+  enum EHitLevel {
+    kPhotonHits = 0,        // WCSimWCHit photons (before the PMT response)
+    kRawSignal              // WCRawPMTSignalCollection content (after the PMT response)
+  };
+  static const uint32_t kVersion = 1;
+
+  WCSimHitLibrary();
+  ~WCSimHitLibrary();
+
+  // Writing a library
+  bool Create(const std::string & filename, EHitLevel level);
+  void AddHit(int tube, float time, float charge, int parentID);
+  bool EndEntry();
+  bool Finish();
+  bool IsWriting() const { return fFile != 0; }
+
+  // Reading a library (mmaps the file; pointers are valid until Close())
+  bool Open(const std::string & filename);
+  void Close();
+  bool IsOpen() const { return fMap != 0; }
+
+  EHitLevel GetLevel()      const { return (EHitLevel)fHeader->level; }
+  uint64_t  GetNumEntries() const { return fHeader->numEntries; }
+  uint64_t  GetNumHits()    const { return fHeader->numHits; }
+  /// Number of hits in an entry
+  uint64_t  GetEntrySize(uint64_t entry) const { return fEntries[entry + 1] - fEntries[entry]; }
+  /// First hit of an entry
+  const WCSimHitLibraryHit * GetEntry(uint64_t entry) const { return fHits + fEntries[entry]; }
+
+private:
+  // Reading
+  const char * fMap;
+  size_t fMapSize;
+  const WCSimHitLibraryHeader * fHeader;
+  const WCSimHitLibraryHit * fHits;
+  const uint64_t * fEntries;
+
+  // Writing
+  FILE * fFile;
+  std::string fFileName;
+  EHitLevel fNewLevel;
+  std::vector<WCSimHitLibraryHit> fNewEntry;
+  std::vector<uint64_t> fNewEntries;
+
+  // Not copyable (owns the mapping / file)
+  WCSimHitLibrary(const WCSimHitLibrary &);
+  WCSimHitLibrary & operator=(const WCSimHitLibrary &);
+};
+
+#endif
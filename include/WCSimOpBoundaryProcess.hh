@@ -98,6 +98,15 @@
 #include "G4OpticalPhoton.hh"
 #include "G4TransportationManager.hh"
 
+#include "WCSimCoatedSurfaceTable.hh"
+
+#include <map>
+#include <memory>
+#include <tuple>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
 // Class Description:
 // Discrete Process -- reflection/refraction at optical interfaces.
 // Class inherits publicly from G4VDiscreteProcess.
@@ -193,6 +202,20 @@ public:
         void SetInvokeSD(G4bool );
         // Set flag for call to InvokeSD method.
 
+        void SetCoatedTable(G4bool );
+        // Set flag to tabulate the film coefficients of the coated
+        // (photocathode) surfaces against photon energy & incidence angle,
+        // rather than evaluate the film model for each photon.
+
+        void SetCoatedTableTolerance(G4double );
+        // Set the largest error allowed in the tabulated probabilities.
+        // The parts of the table that are less accurate use the model.
+
+        void BuildPhysicsTable(const G4ParticleDefinition& );
+        // Clears the caches of material & surface properties. Called at
+        // the start of each run after the geometry, materials or physics
+        // have changed, so they are then filled from the new tables.
+
 private:
 
         G4bool G4BooleanRand(const G4double prob) const;
@@ -226,16 +249,73 @@ private:
 
         // Implementation of photocathode physics
         void CoatedDielectricDielectric_Model1();
-        G4double GetReflectivityThroughThinLayer(G4double sinTL, G4double E1_perp,
-                                           G4double E1_parl, G4double wavelength,
-                                           G4double costh1, G4double costh2);
         void CoatedDielectricDielectric_Model2();
+        // The film models are in WCSimCoatedSurfaceTable
+
+        const WCSimCoatedSurfaceTable* GetCoatedTable(G4int model);
+        // The table of the film coefficients of OpticalSurface, for photons
+        // going from Material1 to Material2 (made on the first call). NULL if
+        // the tables are off, or the surface or materials lack a property
 
         void BoundaryProcessVerbose(void) const;
 
         // Invoke SD for post step point if the photon is 'detected'
         G4bool InvokeSD(const G4Step* step);
 
+        // The properties used by the process, looked up by name in the
+        // material & surface property tables the first time each material,
+        // surface & pair of volumes is met. Each step then only reads pointers
+        struct MaterialCache {
+          G4bool built = false;
+          G4MaterialPropertiesTable* Table = NULL;
+          G4MaterialPropertyVector* Rindex = NULL;
+          G4MaterialPropertyVector* GroupVel = NULL;
+          G4MaterialPropertyVector* RealRindex = NULL;
+          G4MaterialPropertyVector* ImaginaryRindex = NULL;
+        };
+
+        struct SurfaceCache {
+          G4MaterialPropertiesTable* Table = NULL;
+          G4MaterialPropertyVector* Rindex = NULL;
+          G4MaterialPropertyVector* Reflectivity = NULL;
+          G4MaterialPropertyVector* RealRindex = NULL;
+          G4MaterialPropertyVector* ImaginaryRindex = NULL;
+          G4MaterialPropertyVector* Efficiency = NULL;
+          G4MaterialPropertyVector* Transmittance = NULL;
+          G4MaterialPropertyVector* SpecularLobe = NULL;
+          G4MaterialPropertyVector* SpecularSpike = NULL;
+          G4MaterialPropertyVector* BackScatter = NULL;
+          G4MaterialPropertyVector* CoatedRindex = NULL;
+          G4MaterialPropertyVector* CoatedRindexIm = NULL;
+          G4bool hasSurfaceRoughness = false;
+          G4double SurfaceRoughness = 0.;
+          G4bool hasCoatedThickness = false;
+          G4double CoatedThickness = 0.;
+          G4bool hasCoatedFrustratedTransmission = false;
+          G4bool CoatedFrustratedTransmission = true;
+          // facet normal sampling (GetFacetNormal)
+          G4double SigmaAlpha = 0.;
+          G4double FacetMax = 0.;  // min(1, 4 SigmaAlpha)
+          G4double Polish = 1.;
+        };
+
+        struct VolumePairHash {
+          size_t operator()(const std::pair<const G4VPhysicalVolume*,
+                                            const G4VPhysicalVolume*>& p) const
+          {
+            const size_t h1 = std::hash<const void*>()(p.first);
+            return h1 ^ (std::hash<const void*>()(p.second) + 0x9e3779b9 + (h1 << 6) + (h1 >> 2));
+          }
+        };
+
+        const MaterialCache& GetMaterialCache(const G4Material* material);
+        const SurfaceCache& GetSurfaceCache(const G4OpticalSurface* surface);
+
+        G4LogicalSurface* GetLogicalSurface(G4VPhysicalVolume* thePrePV,
+                                            G4VPhysicalVolume* thePostPV);
+        // The border surface between the volumes, or else the skin surface
+        // of the daughter then the mother volume (NULL if there is none)
+
 private:
 
         G4double thePhotonMomentum;
@@ -288,6 +368,23 @@ private:
         G4double fCoatedRindex, fCoatedRindexIm, fCoatedThickness;
         G4bool fCoatedFrustratedTransmission = true;
 
+        // Property caches, see GetMaterialCache(). Index of fMaterialCache
+        // is G4Material::GetIndex()
+        std::vector<MaterialCache> fMaterialCache;
+        std::unordered_map<const G4OpticalSurface*, SurfaceCache> fSurfaceCache;
+        std::unordered_map<std::pair<const G4VPhysicalVolume*, const G4VPhysicalVolume*>,
+                           G4LogicalSurface*, VolumePairHash> fLogicalSurfaceCache;
+
+        // Coated surface tables, see GetCoatedTable()
+        G4bool fUseCoatedTable;
+        G4double fCoatedTableTolerance;
+        std::map<std::tuple<const G4OpticalSurface*, const G4Material*, const G4Material*>,
+                 std::unique_ptr<WCSimCoatedSurfaceTable> > fCoatedTables;
+
+        // The caches of Material1, Material2 & OpticalSurface in this step
+        const MaterialCache* fMaterial1Cache;
+        const MaterialCache* fMaterial2Cache;
+        const SurfaceCache* fOpticalSurfaceCache;
 
         G4bool fInvokeSD;
 };
@@ -323,6 +420,20 @@ void WCSimOpBoundaryProcess::SetInvokeSD(G4bool flag)
   fInvokeSD = flag;
 }
 
+inline
+void WCSimOpBoundaryProcess::SetCoatedTable(G4bool flag)
+{
+  fUseCoatedTable = flag;
+  fCoatedTables.clear();
+}
+
+inline
+void WCSimOpBoundaryProcess::SetCoatedTableTolerance(G4double tolerance)
+{
+  fCoatedTableTolerance = tolerance;
+  fCoatedTables.clear();
+}
+
 inline
 void WCSimOpBoundaryProcess::ChooseReflection()
 {
@@ -91,6 +91,12 @@ class WCSimOpticalPhysics : public G4VPhysicsConstructor
 
     void SetTrackSecondariesFirst(G4OpticalProcessIndex, G4bool );
 
+    // photon weighting (see WCSimStackingAction & WCSimWCSD)
+    void SetPhotonWeight(G4double );
+    static G4double GetPhotonWeight() { return fPhotonWeight; }
+    void SetPhotonBudget(G4int );
+    static G4int GetPhotonBudget() { return fPhotonBudget; }
+
     // Cerenkov
     void SetMaxNumPhotonsPerStep(G4int);
     void SetMaxBetaChangePerStep(G4double);
@@ -116,6 +122,8 @@ class WCSimOpticalPhysics : public G4VPhysicsConstructor
     //boundary
     void SetBoundaryVerbosity(G4int);
     void SetInvokeSD(G4bool );
+    void SetCoatedTable(G4bool );
+    void SetCoatedTableTolerance(G4double );
 
     void SetAbsorptionVerbosity(G4int);
     void SetRayleighVerbosity(G4int);
@@ -136,6 +144,15 @@ class WCSimOpticalPhysics : public G4VPhysicsConstructor
     // the option to track secondaries before finishing their parent track
     std::vector<G4bool>         fProcessTrackSecondariesFirst;
 
+    /// weight of the optical photons tracked: only 1 in fPhotonWeight of
+    /// the photons is kept, with this weight. Read by the stacking action
+    static G4double             fPhotonWeight;
+
+    /// photons waiting in the stack: when there are fPhotonBudget of them,
+    /// 1 in 2 is kept with twice the weight, as are the next photons of the
+    /// event. Applied by the stacking action. 0: no cap
+    static G4int                fPhotonBudget;
+
     // scintillation /////////////////
     static G4ThreadLocal G4Scintillation* fScintillationProcess;
     /// scintillation yield factor
@@ -191,6 +208,9 @@ class WCSimOpticalPhysics : public G4VPhysicsConstructor
     /// WCSimOpBoundaryProcess to call InvokeSD method
     G4bool                      fInvokeSD;
     G4int                       fBoundaryVerbosity;
+    /// WCSimOpBoundaryProcess to tabulate the coated surface models
+    G4bool                      fCoatedTable;
+    G4double                    fCoatedTableTolerance;
 };
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
@@ -103,6 +103,12 @@ private:
   /// setTrackSecondariesFirst command
   G4UIcommand*           fTrackSecondariesFirstCmd;
 
+  /// photonWeight command
+  G4UIcmdWithADouble*    fPhotonWeightCmd;
+
+  /// photonBudget command
+  G4UIcmdWithAnInteger*  fPhotonBudgetCmd;
+
   // Cerenkov
 
   /// setCerenkovMaxPhotons command
@@ -160,6 +166,9 @@ private:
   G4UIcmdWithABool*      fBoundaryInvokeSDCmd;
   G4UIcmdWithABool*      fBoundaryInvokeSD1Cmd;
   G4UIcmdWithAnInteger*  fBoundaryVerbosityCmd;
+  /// setCoatedTable & setCoatedTableTolerance commands
+  G4UIcmdWithABool*      fBoundaryCoatedTableCmd;
+  G4UIcmdWithADouble*    fBoundaryCoatedTableToleranceCmd;
 
   G4UIcmdWithAnInteger*  fAbsorptionVerbosityCmd;
   G4UIcmdWithAnInteger*  fRayleighVerbosityCmd;
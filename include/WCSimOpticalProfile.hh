@@ -0,0 +1,76 @@
+#ifndef WCSimOpticalProfile_h
+#define WCSimOpticalProfile_h 1
+
+#include "globals.hh"
+
+#include <vector>
+#include <unordered_map>
+#include <chrono>
+
+class G4Step;
+class G4LogicalVolume;
+class TDirectory;
+
+// Optical profiling mode (/WCSimIO/OpticalProfile): where the optical photon
+// tracking time goes, by logical volume.
+//
+// For each logical volume the photons step through, this counts the optical
+// photon steps and their wall time (also as a histogram of the time per step),
+// and for the volume on the other side of each step (the post-step volume),
+// the photons that end there and the status of the boundary process.
+// The volumes are given a dense index the first time they are seen, so each
+// step only costs a pointer comparison (or a hash lookup when the photon
+// changes volume) and a few array increments.
+//
+// The time of a step is from the end of the previous one (or the start of the
+// track) to the stepping action, so it includes the work of all the processes
+// and of the user actions. It is wall time (std::chrono::steady_clock), so it
+// also counts the time the job waits for the CPU. At the end of the run the counters are written to
+// the wcsimOpticalProfileT tree, one entry per logical volume.
+class WCSimOpticalProfile
+{
+public:
+  /// Bins of the step time histograms: bin i is [2^i, 2^(i+1)) ns, the last one is the overflow
+  static const G4int kNTimeBins = 24;
+
+  WCSimOpticalProfile();
+  ~WCSimOpticalProfile();
+
+  void SetEnabled(G4bool choice) { enabled = choice; }
+  G4bool IsEnabled() { return enabled; }
+
+  void BeginOfRun();
+  /// Start the clock of a new optical photon
+  void StartTrack() { lastTime = std::chrono::steady_clock::now(); }
+  /// Count a step of an optical photon, with the status of the boundary process at its end
+  void Step(const G4Step* aStep, G4int boundaryStatus);
+  /// Write the counters as a tree in dir, and print the volumes with the most time
+  void EndOfRun(TDirectory* dir);
+
+  /// Names of the WCSimOpBoundaryProcessStatus values, which are also the branch names of the tree
+  static const char* GetStatusName(G4int status);
+
+private:
+  struct VolumeCounters {
+    G4long   steps;
+    G4long   kills;
+    G4double time;   // s
+    G4long   timeHist[kNTimeBins];
+    std::vector<G4long> boundary; // by status
+  };
+
+  G4int Index(const G4LogicalVolume* lv);
+
+  G4bool enabled;
+
+  std::vector<const G4LogicalVolume*> volumes;
+  std::vector<VolumeCounters> counters;
+  std::unordered_map<const G4LogicalVolume*, G4int> volumeIndex;
+  // Photons take most of their steps in the same volume as the previous one
+  const G4LogicalVolume* lastVolume;
+  G4int lastIndex;
+
+  std::chrono::steady_clock::time_point lastTime;
+};
+
+#endif
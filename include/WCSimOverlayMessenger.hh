@@ -0,0 +1,33 @@
+#ifndef WCSimOverlayMessenger_h
+#define WCSimOverlayMessenger_h 1
+
+
+#include "G4UImessenger.hh"
+
+class G4UIcommand;
+class G4UIdirectory;
+class G4UIcmdWithADoubleAndUnit;
+class G4UIcmdWithoutParameter;
+class WCSimWCOverlay;
+
+class WCSimOverlayMessenger: public G4UImessenger
+{
+public:
+  WCSimOverlayMessenger(WCSimWCOverlay*);
+
+  ~WCSimOverlayMessenger();
+
+  void SetNewValue(G4UIcommand* command, G4String newValue);
+
+private:
+  WCSimWCOverlay* WCSimOverlay;
+
+  G4UIdirectory* WCSimDir;
+  G4UIcommand* AddRateSource;
+  G4UIcommand* AddFixedSource;
+  G4UIcmdWithoutParameter* ClearSources;
+  G4UIcmdWithADoubleAndUnit* SetWindowLow;
+  G4UIcmdWithADoubleAndUnit* SetWindowHigh;
+};
+
+#endif
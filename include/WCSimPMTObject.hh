@@ -2,6 +2,7 @@
 #define WCSimWCPMTObject_h 1
 
 #include "WCSimDetectorConstruction.hh"
+#include "WCSimDAQ.hh"
 #include "globals.hh"
 #include "Randomize.hh"
 #include <map>
@@ -20,10 +21,13 @@ public:
   virtual G4float* GetQEWavelength()=0;
   virtual G4float  GetmaxQE()=0;
   virtual G4float  GetCollectionEfficiency(float);
-  virtual float    HitTimeSmearing(float)=0;
+  /// Random time smearing (ns) of a digit of charge Q, with the random numbers of random. Must be thread safe
+  virtual float    HitTimeSmearing(float, WCSimDAQRandom &)=0;
   virtual G4double GetPMTGlassThickness()=0;
   virtual G4float  GetDarkRate()=0;
   virtual G4float  GetDarkRateConversionFactor()=0;
+  /// The single p.e. pulse at t (ns) after the photoelectron, with a peak height of 1. Used by the waveform digitizer
+  virtual G4double PulseShape(G4double t);
 protected:
   virtual G4float* GetCollectionEfficiencyArray();
   virtual G4float* GetCollectionEfficiencyAngle();
@@ -46,7 +50,7 @@ public:
   G4double* GetQE();
   G4float* GetQEWavelength();
   G4float  GetmaxQE();
-  float    HitTimeSmearing(float);
+  float    HitTimeSmearing(float, WCSimDAQRandom &);
   G4double GetPMTGlassThickness();
   G4float  GetDarkRate();
   G4float  GetDarkRateConversionFactor();
@@ -70,7 +74,7 @@ public:
   G4double* GetQE();
   G4float* GetQEWavelength();
   G4float  GetmaxQE();
-  float    HitTimeSmearing(float);
+  float    HitTimeSmearing(float, WCSimDAQRandom &);
   G4double GetPMTGlassThickness();
   G4float  GetDarkRate();
   G4float  GetDarkRateConversionFactor();
@@ -92,7 +96,7 @@ public:
   G4double* GetQE();
   G4float* GetQEWavelength();
   G4float  GetmaxQE();
-  float    HitTimeSmearing(float);
+  float    HitTimeSmearing(float, WCSimDAQRandom &);
   G4double GetPMTGlassThickness();
   G4float  GetDarkRate();
   G4float  GetDarkRateConversionFactor();
@@ -114,7 +118,7 @@ public:
   G4double* GetQE();
   G4float* GetQEWavelength();
   G4float  GetmaxQE();
-  float    HitTimeSmearing(float);
+  float    HitTimeSmearing(float, WCSimDAQRandom &);
   G4double GetPMTGlassThickness();
   G4float  GetDarkRate();
   G4float  GetDarkRateConversionFactor();
@@ -136,7 +140,7 @@ public:
   G4double* GetQE();
   G4float* GetQEWavelength();
   G4float  GetmaxQE();
-  float    HitTimeSmearing(float);
+  float    HitTimeSmearing(float, WCSimDAQRandom &);
   G4double GetPMTGlassThickness();
   G4float  GetDarkRate();
   G4float  GetDarkRateConversionFactor();
@@ -158,7 +162,7 @@ public:
   G4double* GetQE();
   G4float* GetQEWavelength();
   G4float  GetmaxQE();
-  float    HitTimeSmearing(float);
+  float    HitTimeSmearing(float, WCSimDAQRandom &);
   G4double GetPMTGlassThickness();
   G4float  GetDarkRate();
   G4float  GetDarkRateConversionFactor();
@@ -179,7 +183,7 @@ public:
   G4double* GetQE();
   G4float* GetQEWavelength();
   G4float  GetmaxQE();
-  float    HitTimeSmearing(float);
+  float    HitTimeSmearing(float, WCSimDAQRandom &);
   G4double GetPMTGlassThickness();
   G4float  GetDarkRate();
   G4float  GetDarkRateConversionFactor();
@@ -200,7 +204,7 @@ public:
   G4double* GetQE();
   G4float* GetQEWavelength();
   G4float  GetmaxQE();
-  float    HitTimeSmearing(float);
+  float    HitTimeSmearing(float, WCSimDAQRandom &);
   G4double GetPMTGlassThickness();
   G4float  GetDarkRate();
   G4float  GetDarkRateConversionFactor();
@@ -222,7 +226,7 @@ public:
   G4double* GetQE();
   G4float* GetQEWavelength();
   G4float  GetmaxQE();
-  float    HitTimeSmearing(float);
+  float    HitTimeSmearing(float, WCSimDAQRandom &);
   G4double GetPMTGlassThickness();
   G4float  GetDarkRate();
   G4float  GetDarkRateConversionFactor();
@@ -246,7 +250,7 @@ public:
   G4double* GetQE();
   G4float* GetQEWavelength();
   G4float  GetmaxQE();
-  float    HitTimeSmearing(float);
+  float    HitTimeSmearing(float, WCSimDAQRandom &);
   G4double GetPMTGlassThickness();
   G4float  GetDarkRate();
   G4float  GetDarkRateConversionFactor();
@@ -270,7 +274,7 @@ public:
   G4double* GetQE();                 //has to be double due to double math inside array ("narrowing conversion" error in C++11)
   G4float* GetQEWavelength();
   G4float  GetmaxQE();
-  float    HitTimeSmearing(float);
+  float    HitTimeSmearing(float, WCSimDAQRandom &);
   G4double GetPMTGlassThickness();
   G4float  GetDarkRate();
   G4float  GetDarkRateConversionFactor();
@@ -294,7 +298,7 @@ public:
   G4double* GetQE();
   G4float* GetQEWavelength();
   G4float  GetmaxQE();
-  float    HitTimeSmearing(float);
+  float    HitTimeSmearing(float, WCSimDAQRandom &);
   G4double GetPMTGlassThickness();
   G4float  GetDarkRate();
   G4float  GetDarkRateConversionFactor();
@@ -321,7 +325,7 @@ public:
   G4double* GetQE();
   G4float* GetQEWavelength();
   G4float  GetmaxQE();
-  float    HitTimeSmearing(float);
+  float    HitTimeSmearing(float, WCSimDAQRandom &);
   G4double GetPMTGlassThickness();
   G4float  GetDarkRate();
   G4float  GetDarkRateConversionFactor();
@@ -346,7 +350,7 @@ public:
   G4double* GetQE();
   G4float* GetQEWavelength();
   G4float  GetmaxQE();
-  float    HitTimeSmearing(float);
+  float    HitTimeSmearing(float, WCSimDAQRandom &);
   G4double GetPMTGlassThickness();
   G4float  GetDarkRate();
   G4float  GetDarkRateConversionFactor();
@@ -371,7 +375,7 @@ public:
   G4double* GetQE();
   G4float* GetQEWavelength();
   G4float  GetmaxQE();
-  float    HitTimeSmearing(float);
+  float    HitTimeSmearing(float, WCSimDAQRandom &);
   G4double GetPMTGlassThickness();
   G4float  GetDarkRate();
   G4float  GetDarkRateConversionFactor();
@@ -0,0 +1,97 @@
+#ifndef WCSimPhotonLibrary_h
+#define WCSimPhotonLibrary_h 1
+
+/////////////////////////////////////////////////////////////////
+//
+// Binary library of optical photons, one entry per simulated event
+//
+// Written by WCSimRunAction (/WCSimIO/SavePhotons) with the optical
+// photons of every event, as they are stacked, and read back with
+// mmap by the photon replay generator (/mygen/generator photonreplay)
+// to redo only the optical transport, e.g. with other water
+// parameters. Depends on neither Geant4 nor ROOT.
+//
+// File layout (native endian, all sections 64 byte aligned):
+//   WCSimPhotonLibraryHeader
+//   numPhotons WCSimPhotonLibraryPhoton records, entry after entry
+//   numEntries+1 uint64 entry boundaries (indices into the photons)
+//
+// As for WCSimHitLibrary, photons are streamed to disk as each
+// entry is finished, and the header and entry index are only
+// written by Finish(); an unfinished library is rejected by Open().
+//
+/////////////////////////////////////////////////////////////////
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <string>
+#include <vector>
+
+struct WCSimPhotonLibraryHeader {
+  char     magic[8];        // "WCSIMOPH"
+  uint32_t version;
+  uint32_t headerSize;      // sizeof(WCSimPhotonLibraryHeader), to catch layout changes
+  uint64_t numEntries;
+  uint64_t numPhotons;
+  uint64_t photonOffset;    // byte offset of the photon records from the start of the file
+  uint64_t entryOffset;     // byte offset of the entry boundaries
+  uint64_t fileSize;
+};
+
+struct WCSimPhotonLibraryPhoton {
+  float   pos[3];           // cm
+  float   dir[3];           // unit momentum direction
+  float   pol[3];           // polarisation
+  float   energy;           // eV
+  float   time;             // ns, relative to the start of the simulated event
+  float   weight;           // photons this one stands for (/process/optical/photonWeight)
+  int32_t parentID;         // track ID of the primary parent of the photon
+};
+
+class WCSimPhotonLibrary {
+public:
+  static const uint32_t kVersion = 1;
+
+  WCSimPhotonLibrary();
+  ~WCSimPhotonLibrary();
+
+  // Writing a library
+  bool Create(const std::string & filename);
+  void AddPhoton(const WCSimPhotonLibraryPhoton & photon) { fNewEntry.push_back(photon); }
+  bool EndEntry();
+  bool Finish();
+  bool IsWriting() const { return fFile != 0; }
+
+  // Reading a library (mmaps the file; pointers are valid until Close())
+  bool Open(const std::string & filename);
+  void Close();
+  bool IsOpen() const { return fMap != 0; }
+
+  uint64_t GetNumEntries() const { return fHeader->numEntries; }
+  uint64_t GetNumPhotons() const { return fHeader->numPhotons; }
+  /// Number of photons in an entry
+  uint64_t GetEntrySize(uint64_t entry) const { return fEntries[entry + 1] - fEntries[entry]; }
+  /// First photon of an entry
+  const WCSimPhotonLibraryPhoton * GetEntry(uint64_t entry) const { return fPhotons + fEntries[entry]; }
+
+private:
+  // Reading
+  const char * fMap;
+  size_t fMapSize;
+  const WCSimPhotonLibraryHeader * fHeader;
+  const WCSimPhotonLibraryPhoton * fPhotons;
+  const uint64_t * fEntries;
+
+  // Writing
+  FILE * fFile;
+  std::string fFileName;
+  std::vector<WCSimPhotonLibraryPhoton> fNewEntry;
+  std::vector<uint64_t> fNewEntries;
+
+  // Not copyable (owns the mapping / file)
+  WCSimPhotonLibrary(const WCSimPhotonLibrary &);
+  WCSimPhotonLibrary & operator=(const WCSimPhotonLibrary &);
+};
+
+#endif
@@ -0,0 +1,134 @@
+#ifndef WCSimPhotonTable_h
+#define WCSimPhotonTable_h 1
+
+/////////////////////////////////////////////////////////////////
+//
+// Binary table of photon detection probabilities
+//
+// For each cell of (emission position, emission direction), the
+// probability that an optical photon emitted there makes a p.e. in
+// each PMT, and quantiles of the p.e. arrival times. Built by full
+// optical tracking of photons from every cell (/mygen/generator
+// photontable) and read back with mmap by the fast optical
+// simulation (WCSimFastOptics). Depends on neither Geant4 nor ROOT.
+//
+// Positions are binned in a box of nx x ny x nz cubic voxels,
+// directions in ncost bins of cos(theta) (-1..1) x nphi bins of phi
+// (-pi..pi), about the z axis. Cell index:
+//   ((ix * ny + iy) * nz + iz) * ncost * nphi + icost * nphi + iphi
+//
+// File layout (native endian, all sections 64 byte aligned):
+//   WCSimPhotonTableHeader
+//   numEntries WCSimPhotonTableEntry records, cell after cell
+//   numCells+1 uint64 cell boundaries (indices into the entries)
+//
+// As for WCSimHitLibrary, entries are streamed to disk as each cell
+// is finished, and the header and cell index are only written by
+// Finish(); an unfinished table is rejected by Open().
+//
+/////////////////////////////////////////////////////////////////
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <string>
+#include <vector>
+
+struct WCSimPhotonTableHeader {
+  char     magic[8];        // "WCSIMPDT"
+  uint32_t version;
+  uint32_t headerSize;      // sizeof(WCSimPhotonTableHeader), to catch layout changes
+  uint32_t numTubes;        // of the detector the table was built for
+  uint32_t numQuantiles;    // WCSimPhotonTable::kNTimeQuantiles
+  uint32_t nBins[5];        // nx, ny, nz, ncost, nphi
+  uint32_t reserved;
+  double   origin[3];       // cm, low corner of the voxel box
+  double   voxelSize;       // cm
+  uint64_t photonsPerCell;  // photons generated in each cell (the probabilities are per photon actually emitted)
+  uint64_t numCells;
+  uint64_t numEntries;
+  uint64_t entryOffset;     // byte offset of the entries from the start of the file
+  uint64_t cellOffset;      // byte offset of the cell boundaries
+  uint64_t fileSize;
+  char     detectorName[64];
+};
+
+struct WCSimPhotonTableEntry {
+  int32_t tube;             // tube ID (1..NPMT)
+  float   probability;      // p.e. in this tube per photon emitted from the cell
+  float   time[8];          // ns after emission: quantiles 0, 1/7, ..., 1 of the p.e. arrival times
+};
+
+class WCSimPhotonTable {
+public:
+  static const uint32_t kVersion = 1;
+  static const int kNTimeQuantiles = 8;
+
+  WCSimPhotonTable();
+  ~WCSimPhotonTable();
+
+  // Writing a table. Cells are filled in index order: the hits of
+  // one cell, then EndCell()
+  bool Create(const std::string & filename, const std::string & detectorName, int numTubes,
+	      const double origin[3], double voxelSize, const int nBins[5], uint64_t photonsPerCell);
+  void AddHit(int tube, float time);
+  /// Make the entries of the cell from its hits, made by numPhotons photons. Tubes with a lower
+  /// probability than minProbability are dropped
+  bool EndCell(uint64_t numPhotons, double minProbability);
+  /// Cells not filled yet are left empty
+  bool Finish();
+  bool IsWriting() const { return fFile != 0; }
+  uint64_t GetNumCellsWritten() const { return fNewCells.empty() ? 0 : fNewCells.size() - 1; }
+
+  // Reading a table (mmaps the file; pointers are valid until Close())
+  bool Open(const std::string & filename);
+  void Close();
+  bool IsOpen() const { return fMap != 0; }
+
+  // The grid: of the table read, or of the table being written
+  const WCSimPhotonTableHeader & GetHeader() const { return fHeader ? *fHeader : fNewHeader; }
+  uint64_t GetNumCells() const { return GetHeader().numCells; }
+  /// The cell of a position (cm) & unit direction; -1 if outside the voxel box
+  int64_t GetCellIndex(double x, double y, double z, double dx, double dy, double dz) const;
+  /// The box of positions (cm) & ranges of cos(theta) and phi of a cell
+  void GetCellBounds(uint64_t cell, double low[3], double high[3],
+		     double & costLow, double & costHigh, double & phiLow, double & phiHigh) const;
+
+  /// Number of tubes hit from a cell
+  uint64_t GetCellSize(uint64_t cell) const { return fCells[cell + 1] - fCells[cell]; }
+  /// First entry of a cell
+  const WCSimPhotonTableEntry * GetCell(uint64_t cell) const { return fEntries + fCells[cell]; }
+
+  /// A p.e. arrival time (ns after emission) from the quantiles of an entry, for a uniform random number u
+  static float SampleTime(const WCSimPhotonTableEntry & entry, double u)
+  {
+    const double x = u * (kNTimeQuantiles - 1);
+    int i = (int)x;
+    if(i > kNTimeQuantiles - 2) i = kNTimeQuantiles - 2;
+    return entry.time[i] + (x - i) * (entry.time[i + 1] - entry.time[i]);
+  }
+
+private:
+  // Reading
+  const char * fMap;
+  size_t fMapSize;
+  const WCSimPhotonTableHeader * fHeader;
+  const WCSimPhotonTableEntry * fEntries;
+  const uint64_t * fCells;
+
+  // Writing
+  FILE * fFile;
+  std::string fFileName;
+  WCSimPhotonTableHeader fNewHeader;
+  std::vector< std::pair<int32_t, float> > fNewHits; // tube, time
+  std::vector<WCSimPhotonTableEntry> fNewCell;
+  std::vector<uint64_t> fNewCells;
+
+  bool WriteCell();
+
+  // Not copyable (owns the mapping / file)
+  WCSimPhotonTable(const WCSimPhotonTable &);
+  WCSimPhotonTable & operator=(const WCSimPhotonTable &);
+};
+
+#endif
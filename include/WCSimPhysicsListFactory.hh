@@ -8,6 +8,7 @@
 #include "G4OpticalPhysics.hh"
 
 #include "WCSimPhysicsListFactoryMessenger.hh"
+#include "WCSimPhysicsTableCache.hh"
 #include "WCSimRootOptions.hh"
 
 //class WCSimPhysicsList;
@@ -22,7 +23,10 @@ class WCSimPhysicsListFactory : public G4VModularPhysicsList
     void SetnCaptModel(G4String newvalue);  // called by messenger
     void InitializeList();
 
-    //G4String GetPhysicsListName() {return PhysicsListName;}
+    G4String GetPhysicsListName() {return PhysicsListName;}
+    G4String GetnCaptModel() {return nCaptModelChoice;}
+
+    void SetTableCacheDir(G4String dir);  // called by messenger
 
     void ConstructParticle();
     void ConstructProcess();
@@ -39,6 +43,7 @@ class WCSimPhysicsListFactory : public G4VModularPhysicsList
 
     WCSimPhysicsListFactoryMessenger* PhysicsMessenger;
     G4PhysListFactory* factory;
+    WCSimPhysicsTableCache* tableCache;
 
 };
 
@@ -24,6 +24,7 @@ private:
   G4UIdirectory*      WCSimDir;
   G4UIcmdWithAString* physListCmd;
   G4UIcmdWithAString* nCaptureModelCmd;
+  G4UIcmdWithAString* tableCacheCmd;
 
 };
 
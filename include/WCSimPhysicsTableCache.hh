@@ -0,0 +1,59 @@
+#ifndef WCSimPhysicsTableCache_h
+#define WCSimPhysicsTableCache_h 1
+
+/////////////////////////////////////////////////////////////////
+//
+// On-disk cache of the Geant4 physics tables (/WCSim/physics/TableCache)
+//
+// The (mostly electromagnetic) physics tables take most of the start
+// up time of a job, and only depend on the Geant4 version, physics
+// list, materials of the geometry (with their density & composition)
+// and production cuts. These are hashed into the name of a
+// sub-directory of the cache: if it exists, the tables are retrieved
+// from it, otherwise they are built and then stored in it, for the
+// next jobs.
+//
+// The optical processes do not store their tables, so they are always
+// built from the current material properties: jobs that only differ by
+// the /WCSim/tuning/ parameters (e.g. a scan of rayff, bsrff, abwff,
+// mieff) all share the same cached tables.
+//
+// The cache is looked up when the state changes from Idle to Init at
+// the start of each run, i.e. just before the tables are built, and
+// filled when the geometry is closed, after they are built. The tables
+// are written to a temporary directory which is then renamed, so that
+// many jobs can share the same cache.
+//
+/////////////////////////////////////////////////////////////////
+
+#include "globals.hh"
+#include "G4VStateDependent.hh"
+
+class WCSimPhysicsListFactory;
+
+class WCSimPhysicsTableCache : public G4VStateDependent
+{
+public:
+  WCSimPhysicsTableCache(WCSimPhysicsListFactory* physicsList);
+  ~WCSimPhysicsTableCache();
+
+  void SetDirectory(G4String dir) {cacheDir = dir; currentKey = "";}
+  G4String GetDirectory() {return cacheDir;}
+
+  G4bool Notify(G4ApplicationState requestedState);
+
+private:
+  /// Description of everything the stored tables depend on
+  G4String MakeKey();
+  /// Write the tables just built to tableDir
+  void Store();
+
+  WCSimPhysicsListFactory* physicsList;
+
+  G4String cacheDir;   ///< empty: no cache
+  G4String currentKey; ///< key of the tables of the last run
+  G4String tableDir;   ///< directory of the tables of currentKey
+  G4bool   storeTables;///< tableDir does not exist yet: store the tables once built
+};
+
+#endif
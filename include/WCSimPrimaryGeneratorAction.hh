@@ -11,6 +11,8 @@
 #include <fstream>
 
 #include "WCSimRootOptions.hh"
+#include "WCSimHitLibrary.hh"
+#include "WCSimPhotonLibrary.hh"
 #include "TFile.h"
 #include "TTree.h"
 #include "TNRooTrackerVtx.hh"
@@ -33,6 +35,8 @@ class WCSimPrimaryGeneratorAction : public G4VUserPrimaryGeneratorAction
         void SetupBranchAddresses(NRooTrackerVtx* nrootrackervtx);
         void OpenRootrackerFile(G4String fileName);
         void CopyRootrackerVertex(NRooTrackerVtx* nrootrackervtx);
+        void OpenReplayLibrary(G4String fileName);
+        void OpenPhotonLibrary(G4String fileName);
         bool GetIsRooTrackerFileFinished(){return (fEvNum==fNEntries);}
 
         // Gun, laser & gps setting calls these functions to fill jhfNtuple and Root tree
@@ -81,6 +85,9 @@ class WCSimPrimaryGeneratorAction : public G4VUserPrimaryGeneratorAction
         G4bool   useGunEvt;
         G4bool   useLaserEvt;  //T. Akiri: Laser flag
         G4bool   useGPSEvt;
+        G4bool   useReplayEvt;
+        G4bool   usePhotonTableEvt;
+        G4bool   usePhotonReplayEvt;
         std::fstream inputFile;
         G4String vectorFileName;
         G4bool   GenerateVertexInRock;
@@ -111,6 +118,16 @@ class WCSimPrimaryGeneratorAction : public G4VUserPrimaryGeneratorAction
         int fNEntries;
         TFile* fInputRootrackerFile;
 
+        // Raw signal library replayed (one entry per event) by the replay generator
+        WCSimHitLibrary fReplayLibrary;
+        uint64_t fReplayEntry; // entry of the current event
+        uint64_t fReplayNext;
+
+        // Photon library replayed (one entry per event) by the photon replay generator
+        WCSimPhotonLibrary fPhotonLibrary;
+        uint64_t fPhotonEntry; // entry of the current event
+        uint64_t fPhotonNext;
+
         // Pointers to Rootracker vertex objects
         // Temporary vertex that is saved if desired, according to WCSimIO macro option
         TTree* fRooTrackerTree;
@@ -145,6 +162,25 @@ class WCSimPrimaryGeneratorAction : public G4VUserPrimaryGeneratorAction
         inline void SetGPSEvtGenerator(G4bool choice) { useGPSEvt = choice; }
         inline G4bool IsUsingGPSEvtGenerator()  { return useGPSEvt; }
 
+        // Replay: no particles are generated. Instead the PMT signals of one entry of a raw signal
+        // library (/WCSimIO/SaveRawSignalLibrary) are put through dark noise, digitizer & trigger
+        inline void SetReplayEvtGenerator(G4bool choice) { useReplayEvt = choice; }
+        inline G4bool IsUsingReplayEvtGenerator()  { return useReplayEvt; }
+        inline const WCSimHitLibraryHit * GetReplayHits() { return fReplayLibrary.GetEntry(fReplayEntry); }
+        inline uint64_t GetReplayNumHits() { return fReplayLibrary.GetEntrySize(fReplayEntry); }
+
+        // Photon table: each event emits the optical photons of one cell of the photon table
+        // being built (/WCSim/FastOptics/BuildTable)
+        inline void SetPhotonTableEvtGenerator(G4bool choice) { usePhotonTableEvt = choice; }
+        inline G4bool IsUsingPhotonTableEvtGenerator()  { return usePhotonTableEvt; }
+
+        // Photon replay: the optical photons of one entry of a photon library (/WCSimIO/SavePhotons)
+        // are the primaries, so only the optical transport is simulated
+        inline void SetPhotonReplayEvtGenerator(G4bool choice) { usePhotonReplayEvt = choice; }
+        inline G4bool IsUsingPhotonReplayEvtGenerator()  { return usePhotonReplayEvt; }
+        /// The saved photon of the primary track with this ID
+        inline const WCSimPhotonLibraryPhoton & GetReplayPhoton(G4int trackID) { return fPhotonLibrary.GetEntry(fPhotonEntry)[trackID - 1]; }
+
         inline void OpenVectorFile(G4String fileName) 
         {
             if ( inputFile.is_open() ) 
@@ -129,6 +129,7 @@ public:
   virtual ~WCSimRootCherenkovHitTime() { }
 
   Float_t   GetTruetime() { return fTruetime;}
+  // The primary parent of the photon; -1 for dark noise, -2 for overlaid pile-up (WCSimWCOverlay)
   Int_t     GetParentID() { return fPrimaryParentID;}
   Float_t   GetPhotonStartTime() { return fPhotonStartTime; }
   Float_t   GetPhotonStartPos(int i) { return (i<3) ? fPhotonStartPos[i] : 0; }
@@ -415,6 +416,12 @@ public:
 					  std::vector<Float_t>   photonStartTime,
 					  std::vector<TVector3>   photonStartPos,
 					  std::vector<TVector3>   photonEndPos);
+  // Tube-level hit only, without the per-photon WCSimRootCherenkovHitTime's.
+  // GetTotalPe(0) is then -1 and GetTotalPe(1) the number of photons
+  WCSimRootCherenkovHit   *AddCherenkovHit(Int_t                tubeID,
+					   Int_t                mPMTID,
+					   Int_t                mPMT_PMTID,
+					   Int_t                npe);
   TClonesArray        *GetCherenkovHits() const {return fCherenkovHits;}
   TClonesArray        *GetCherenkovHitTimes() const {return fCherenkovHitTimes;}
 
@@ -13,7 +13,10 @@
 #include "TObject.h"
 #include "TClonesArray.h"
 
+#include <vector>
+
 class TDirectory;
+struct WCSimRootPMTCache;
 
 //////////////////////////////////////////////////////////////////////////
 
@@ -44,8 +47,8 @@ public:
   Int_t GetmPMTNo() const {return fmPMTNo;}
   Int_t GetmPMT_PMTNo() const {return fmPMT_PMTNo;}
   Int_t GetCylLoc() const {return fCylLoc;}
-  Float_t GetOrientation(Int_t i=0) {return (i<3) ? fOrientation[i] : 0;}
-  Float_t GetPosition(Int_t i=0) {return (i<3) ? fPosition[i] : 0;}
+  Float_t GetOrientation(Int_t i=0) const {return (i<3) ? fOrientation[i] : 0;}
+  Float_t GetPosition(Int_t i=0) const {return (i<3) ? fPosition[i] : 0;}
 
   ClassDef(WCSimRootPMT,2)  //WCSimPMT structure
 };
@@ -74,6 +77,13 @@ private:
   //WCSimRootPMT          fPMTArray[maxNumPMT];  // Array of PMTs
   TClonesArray           *fPMTArray;
 
+  // Cached SoA view of fPMTArray, built by the first of the fast accessors below to be called
+  // (under a lock, so the const accessors can be used from many threads at once).
+  // Transient: reset whenever the PMTs change, or the object is read from file (see WCSimRootLinkDef.hh)
+  WCSimRootPMTCache*     fPMTCache;  //!
+
+  const WCSimRootPMTCache & GetPMTCache() const;
+
 public:
 
   WCSimRootGeom();
@@ -86,7 +96,7 @@ public:
 
   void SetGeo_Type(Int_t f){fgeo_type = f;}
 
-  void  SetWCNumPMT(Int_t i) {fWCNumPMT= i;}
+  void  SetWCNumPMT(Int_t i) {fWCNumPMT= i; InvalidatePMTCache();}
   void  SetWCPMTRadius(Float_t f) {fWCPMTRadius = f;}
   void  SetWCOffset(Float_t x, Float_t y, Float_t z) 
            {fWCOffset[0]=x; fWCOffset[1]=y; fWCOffset[2] = z;}
@@ -95,6 +105,9 @@ public:
   void  SetPMT(Int_t i, Int_t tubeno, Int_t mPMTNo, Int_t mPMT_PMTno, Int_t cyl_loc, Float_t rot[3], Float_t pos[3], bool expand=true);
   void  SetOrientation(Int_t o) {fOrientation = o;}
 
+  // Fill everything from a binary table written by WCSimDetectorConstruction (see WCSimGeometryTable)
+  Bool_t ReadGeometryTable(const char * filename);
+
   Float_t GetWCCylRadius() const {return fWCCylRadius;}
   Float_t GetWCCylLength() const {return fWCCylLength;}
 
@@ -109,6 +122,23 @@ public:
   //WCSimRootPMT GetPMT(Int_t i){return *(new WCSimRootPMT());}
   WCSimRootPMT GetPMT(Int_t i){return *(WCSimRootPMT*)(*fPMTArray)[i];}
 
+  // Fast accessors, indexed like GetPMT(i). No copies, no casts
+  const WCSimRootPMT & GetPMTRef(Int_t i) const {return *(const WCSimRootPMT*)fPMTArray->UncheckedAt(i);}
+  const std::vector<Float_t> & GetPMTx()  const;
+  const std::vector<Float_t> & GetPMTy()  const;
+  const std::vector<Float_t> & GetPMTz()  const;
+  const std::vector<Float_t> & GetPMTdx() const;
+  const std::vector<Float_t> & GetPMTdy() const;
+  const std::vector<Float_t> & GetPMTdz() const;
+  // Index for GetPMT()/GetPMTRef()/the arrays above, or -1 if there is no such PMT
+  Int_t GetPMTIndexFromTubeNo(Int_t tubeNo) const;
+  Int_t GetPMTIndexFrommPMT(Int_t mPMTNo, Int_t mPMT_PMTNo) const;
+  // Tube ID of a PMT in an mPMT, or -1 if there is no such PMT
+  Int_t GetTubeNo(Int_t mPMTNo, Int_t mPMT_PMTNo) const;
+
+  // Drop the cache, after the PMTs change. Not thread safe: no accessor may be in use
+  void InvalidatePMTCache();
+
   ClassDef(WCSimRootGeom,1)  //WCSimRootEvent structure
 };
 
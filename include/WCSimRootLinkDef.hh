@@ -18,6 +18,8 @@
 #pragma link C++ class WCSimRootCapture+;
 #pragma link C++ class WCSimRootCaptureGamma+;
 #pragma link C++ class WCSimRootGeom+;
+// Rebuild the PMT lookup cache after reading a geometry from file
+#pragma read sourceClass="WCSimRootGeom" targetClass="WCSimRootGeom" version="[1-]" source="" target="" code="{ newObj->InvalidatePMTCache(); }"
 #pragma link C++ class WCSimRootPMT+;
 #pragma link C++ class WCSimPmtInfo+;
 #pragma link C++ class WCSimEnumerations+;
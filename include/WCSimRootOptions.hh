@@ -11,6 +11,7 @@
 #include "TObject.h"
 #include "TClonesArray.h"
 #include <string>
+#include <vector>
 
 #include "WCSimEnumerations.hh"
 
@@ -51,18 +52,38 @@ public:
   double GetDarkLow() {return DarkLow;}
   double GetDarkWindow() {return DarkWindow;}
   int    GetDarkMode() {return DarkMode;}
+  //WCSimWCOverlay sets
+  void SetOverlayFiles(std::vector<string> iOverlayFiles) {OverlayFiles = iOverlayFiles;}
+  void SetOverlayRates(std::vector<double> iOverlayRates) {OverlayRates = iOverlayRates;}
+  void SetOverlayOffsets(std::vector<double> iOverlayOffsets) {OverlayOffsets = iOverlayOffsets;}
+  void SetOverlayWindowLow(double iOverlayWindowLow) {OverlayWindowLow = iOverlayWindowLow;}
+  void SetOverlayWindowHigh(double iOverlayWindowHigh) {OverlayWindowHigh = iOverlayWindowHigh;}
+  //WCSimWCOverlay gets
+  std::vector<string> GetOverlayFiles() {return OverlayFiles;}
+  std::vector<double> GetOverlayRates() {return OverlayRates;}
+  std::vector<double> GetOverlayOffsets() {return OverlayOffsets;}
+  double GetOverlayWindowLow() {return OverlayWindowLow;}
+  double GetOverlayWindowHigh() {return OverlayWindowHigh;}
   //WCSimWCDigitizer* sets
   void SetDigitizerClassName(string iDigitizerClassName) {DigitizerClassName = iDigitizerClassName;}
   void SetDigitizerDeadTime(int iDigitizerDeadTime) {DigitizerDeadTime = iDigitizerDeadTime;}
   void SetDigitizerIntegrationWindow(int iDigitizerIntegrationWindow) {DigitizerIntegrationWindow = iDigitizerIntegrationWindow;}
   void SetDigitizerTimingPrecision(double iDigitizerTimingPrecision) {DigitizerTimingPrecision = iDigitizerTimingPrecision;}
   void SetDigitizerPEPrecision(double iDigitizerPEPrecision) {DigitizerPEPrecision = iDigitizerPEPrecision;}
+  void SetWaveformSampleWidth(double iWaveformSampleWidth) {WaveformSampleWidth = iWaveformSampleWidth;}
+  void SetWaveformNPhases(int iWaveformNPhases) {WaveformNPhases = iWaveformNPhases;}
+  void SetWaveformThreshold(double iWaveformThreshold) {WaveformThreshold = iWaveformThreshold;}
+  void SetWaveformNoise(double iWaveformNoise) {WaveformNoise = iWaveformNoise;}
   //WCSimWCDigitizer* gets
   string GetDigitizerClassName() {return DigitizerClassName;}
   int    GetDigitizerDeadTime() {return DigitizerDeadTime;}
   int    GetDigitizerIntegrationWindow() {return DigitizerIntegrationWindow;}
   int    GetDigitizerTimingPrecision() {return DigitizerTimingPrecision;}
   int    GetDigitizerPEPrecision() {return DigitizerPEPrecision;}
+  double GetWaveformSampleWidth() {return WaveformSampleWidth;}
+  int    GetWaveformNPhases() {return WaveformNPhases;}
+  double GetWaveformThreshold() {return WaveformThreshold;}
+  double GetWaveformNoise() {return WaveformNoise;}
   //WCSimWCTrigger* sets
   void SetTriggerClassName(string itriggerClassName) {TriggerClassName = itriggerClassName;};
   void SetMultiDigitsPerTrigger(bool imultiDigitsPerTrigger) {MultiDigitsPerTrigger = imultiDigitsPerTrigger;};
@@ -73,6 +94,20 @@ public:
   void SetNDigitsPreTriggerWindow(int indigitsPreTriggerWindow) {NDigitsPreTriggerWindow = indigitsPreTriggerWindow;};
   void SetNDigitsPostTriggerWindow(int indigitsPostTriggerWindow) {NDigitsPostTriggerWindow = indigitsPostTriggerWindow;};
   void SetTriggerOffset(double value) {TriggerOffset = value;};
+  //localnhits
+  void SetLocalNHitsThreshold(int ilocalNHitsThreshold) {LocalNHitsThreshold = ilocalNHitsThreshold;};
+  void SetLocalNHitsWindow(int ilocalNHitsWindow) {LocalNHitsWindow = ilocalNHitsWindow;};
+  void SetLocalNHitsNeighbourRadius(double ilocalNHitsNeighbourRadius) {LocalNHitsNeighbourRadius = ilocalNHitsNeighbourRadius;};
+  void SetLocalNHitsPreTriggerWindow(int ilocalNHitsPreTriggerWindow) {LocalNHitsPreTriggerWindow = ilocalNHitsPreTriggerWindow;};
+  void SetLocalNHitsPostTriggerWindow(int ilocalNHitsPostTriggerWindow) {LocalNHitsPostTriggerWindow = ilocalNHitsPostTriggerWindow;};
+  //tofscan
+  void SetTOFScanThreshold(int itofScanThreshold) {TOFScanThreshold = itofScanThreshold;};
+  void SetTOFScanWindow(int itofScanWindow) {TOFScanWindow = itofScanWindow;};
+  void SetTOFScanGridSpacing(double itofScanGridSpacing) {TOFScanGridSpacing = itofScanGridSpacing;};
+  void SetTOFScanPreTriggerWindow(int itofScanPreTriggerWindow) {TOFScanPreTriggerWindow = itofScanPreTriggerWindow;};
+  void SetTOFScanPostTriggerWindow(int itofScanPostTriggerWindow) {TOFScanPostTriggerWindow = itofScanPostTriggerWindow;};
+  //continuous
+  void SetTimeSliceLength(int itimeSliceLength) {TimeSliceLength = itimeSliceLength;};
   //savefailures
   void SetSaveFailuresMode(int isaveFailuresMode) {SaveFailuresMode = isaveFailuresMode;};
   void SetSaveFailuresTime(double isaveFailuresTime) {SaveFailuresTime = isaveFailuresTime;};
@@ -88,6 +123,20 @@ public:
   int    GetNDigitsPreTriggerWindow() {return NDigitsPreTriggerWindow;}
   int    GetNDigitsPostTriggerWindow() {return NDigitsPostTriggerWindow;}
   double GetTriggerOffset() {return TriggerOffset;}
+  //localnhits
+  int    GetLocalNHitsThreshold() {return LocalNHitsThreshold;}
+  int    GetLocalNHitsWindow() {return LocalNHitsWindow;}
+  double GetLocalNHitsNeighbourRadius() {return LocalNHitsNeighbourRadius;}
+  int    GetLocalNHitsPreTriggerWindow() {return LocalNHitsPreTriggerWindow;}
+  int    GetLocalNHitsPostTriggerWindow() {return LocalNHitsPostTriggerWindow;}
+  //tofscan
+  int    GetTOFScanThreshold() {return TOFScanThreshold;}
+  int    GetTOFScanWindow() {return TOFScanWindow;}
+  double GetTOFScanGridSpacing() {return TOFScanGridSpacing;}
+  int    GetTOFScanPreTriggerWindow() {return TOFScanPreTriggerWindow;}
+  int    GetTOFScanPostTriggerWindow() {return TOFScanPostTriggerWindow;}
+  //continuous
+  int    GetTimeSliceLength() {return TimeSliceLength;}
   //savefailures
   int    GetSaveFailuresMode() {return SaveFailuresMode;}
   double GetSaveFailuresTime() {return SaveFailuresTime;}
@@ -113,6 +162,18 @@ public:
   void SetPhysicsListName(string iPhysicsListName) {PhysicsListName = iPhysicsListName;}
   //WCSimPhysicsListFactory gets
   string GetPhysicsListName() {return PhysicsListName;}
+  //WCSimOpticalPhysics sets
+  void SetPhotonWeight(double iPhotonWeight) {PhotonWeight = iPhotonWeight;}
+  void SetPhotonBudget(int iPhotonBudget) {PhotonBudget = iPhotonBudget;}
+  //WCSimOpticalPhysics gets
+  double GetPhotonWeight() {return PhotonWeight;}
+  int    GetPhotonBudget() {return PhotonBudget;}
+  //WCSimFastOptics sets
+  void SetFastOpticsTable(string iFastOpticsTable) {FastOpticsTable = iFastOpticsTable;}
+  void SetFastOpticsConeSamples(int iFastOpticsConeSamples) {FastOpticsConeSamples = iFastOpticsConeSamples;}
+  //WCSimFastOptics gets
+  string GetFastOpticsTable() {return FastOpticsTable;}
+  int    GetFastOpticsConeSamples() {return FastOpticsConeSamples;}
   //WCSimPrimaryGeneratorAction sets
   void SetVectorFileName(string iVectorFileName) {VectorFileName = iVectorFileName;}
   void SetGeneratorType(string iGeneratorType) {GeneratorType = iGeneratorType;}
@@ -125,6 +186,18 @@ public:
   //WCSimRandomParameters gets
   int                    GetRandomSeed() {return RandomSeed;}
   WCSimRandomGenerator_t GetRandomGenerator() {return RandomGenerator;}
+  //WCSimRunAction sets
+  void SetSaveHitTimes(bool iSaveHitTimes) {SaveHitTimes = iSaveHitTimes;}
+  void SetSavePhotonStartTime(bool iSavePhotonStartTime) {SavePhotonStartTime = iSavePhotonStartTime;}
+  void SetSavePhotonStartPos(bool iSavePhotonStartPos) {SavePhotonStartPos = iSavePhotonStartPos;}
+  void SetSavePhotonEndPos(bool iSavePhotonEndPos) {SavePhotonEndPos = iSavePhotonEndPos;}
+  void SetSaveTracks(bool iSaveTracks) {SaveTracks = iSaveTracks;}
+  //WCSimRunAction gets
+  bool GetSaveHitTimes() {return SaveHitTimes;}
+  bool GetSavePhotonStartTime() {return SavePhotonStartTime;}
+  bool GetSavePhotonStartPos() {return SavePhotonStartPos;}
+  bool GetSavePhotonEndPos() {return SavePhotonEndPos;}
+  bool GetSaveTracks() {return SaveTracks;}
 
 private:
   //WCSimDetector*
@@ -141,12 +214,23 @@ private:
   double DarkWindow; // ns
   int    DarkMode;
 
+  //WCSimWCOverlay
+  std::vector<string> OverlayFiles; // hit libraries
+  std::vector<double> OverlayRates; // kHz. 0 for fixed sources
+  std::vector<double> OverlayOffsets; // ns. Fixed sources only
+  double OverlayWindowLow; // ns
+  double OverlayWindowHigh; // ns
+
   //WCSimWCDigitizer*
   string DigitizerClassName;
   int    DigitizerDeadTime; // ns
   int    DigitizerIntegrationWindow; // ns
   int    DigitizerTimingPrecision; // 
   int    DigitizerPEPrecision; // 
+  double WaveformSampleWidth; // ns
+  int    WaveformNPhases;
+  double WaveformThreshold; // single p.e. pulse heights
+  double WaveformNoise; // single p.e. pulse heights
 
   //WCSimWCTrigger*
   string TriggerClassName;
@@ -158,6 +242,20 @@ private:
   int    NDigitsPreTriggerWindow; // ns
   int    NDigitsPostTriggerWindow; // ns
   double TriggerOffset; //ns
+  //localnhits
+  int    LocalNHitsThreshold; // hit PMTs
+  int    LocalNHitsWindow; // ns
+  double LocalNHitsNeighbourRadius; // cm. 0 means neighbourhoods are mPMTs
+  int    LocalNHitsPreTriggerWindow; // ns
+  int    LocalNHitsPostTriggerWindow; // ns
+  //tofscan
+  int    TOFScanThreshold; // digitized hits
+  int    TOFScanWindow; // ns, TOF-corrected
+  double TOFScanGridSpacing; // cm
+  int    TOFScanPreTriggerWindow; // ns
+  int    TOFScanPostTriggerWindow; // ns
+  //continuous
+  int    TimeSliceLength; // ns
   //savefailures
   int    SaveFailuresMode;
   double SaveFailuresTime; // ns
@@ -176,6 +274,14 @@ private:
   //WCSimPhysicsListFactory
   string PhysicsListName;
 
+  //WCSimOpticalPhysics
+  double PhotonWeight;
+  int    PhotonBudget; // photons per event before thinning. 0 if not capped
+
+  //WCSimFastOptics
+  string FastOpticsTable; // photon table used. Empty if the optical photons were tracked
+  int    FastOpticsConeSamples;
+
   //WCSimPrimaryGeneratorAction
   string VectorFileName;
   string GeneratorType;
@@ -183,8 +289,15 @@ private:
   //WCSimRandomParameters
   int                    RandomSeed;
   WCSimRandomGenerator_t RandomGenerator;
+
+  //WCSimRunAction
+  bool SaveHitTimes;
+  bool SavePhotonStartTime;
+  bool SavePhotonStartPos;
+  bool SavePhotonEndPos;
+  bool SaveTracks;
   
-  ClassDef(WCSimRootOptions,2)  //WCSimRootEvent structure
+  ClassDef(WCSimRootOptions,11)  //WCSimRootEvent structure
 };
 
 
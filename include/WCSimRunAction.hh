@@ -12,6 +12,9 @@
 
 #include "TStopwatch.h"
 
+#include <string>
+#include <vector>
+
 #include "WCSimRootEvent.hh"
 #include "WCSimRootGeom.hh"
 #include "WCSimRootOptions.hh"
@@ -19,6 +22,10 @@
 #include "WCSimEnumerations.hh"                //ToDo: move more Enums over there!
 #include "evNtuple.h"
 #include "WCSimRandomParameters.hh"
+#include "WCSimHitLibrary.hh"
+#include "WCSimPhotonLibrary.hh"
+#include "WCSimFastOptics.hh"
+#include "WCSimOpticalProfile.hh"
 
 
 #include "TNRooTrackerVtx.hh"
@@ -111,17 +118,114 @@ public:
   }
 
   void SetUseTimer(bool use) { useTimer = use; }
+
+  // Per-column switches for the truth information in the default ROOT file.
+  // Photon start/end columns are also not recorded upstream (WCSimWCSD, WCSimWCPMT)
+  // when switched off, to save memory and CPU as well as disk
+  void SetSaveHitTimes(G4bool choice)        { saveHitTimes = choice; }
+  void SetSavePhotonStartTime(G4bool choice) { savePhotonStartTime = choice; }
+  void SetSavePhotonStartPos(G4bool choice)  { savePhotonStartPos = choice; }
+  void SetSavePhotonEndPos(G4bool choice)    { savePhotonEndPos = choice; }
+  void SetSaveTracks(G4bool choice)          { saveTracks = choice; }
+  G4bool GetSaveHitTimes()        { return saveHitTimes; }
+  G4bool GetSavePhotonStartTime() { return saveHitTimes && savePhotonStartTime; }
+  G4bool GetSavePhotonStartPos()  { return saveHitTimes && savePhotonStartPos; }
+  G4bool GetSavePhotonEndPos()    { return saveHitTimes && savePhotonEndPos; }
+  G4bool GetSaveTracks()          { return saveTracks; }
+  void SaveOptionsToOutput(WCSimRootOptions * wcopt);
+
+  // Chunked output: roll over to a new pair of output files every N events and/or M MB.
+  // Finished chunks are closed, and listed in <RootFileName>_manifest.txt
+  void SetChunkEvents(G4int n)    { chunkEvents = n; }
+  void SetChunkMaxMB(G4double mb) { chunkMaxMB = mb; }
+  G4bool GetUseChunks() { return chunkEvents > 0 || chunkMaxMB > 0; }
+  void EndOfEventChunkCheck(G4int event_id);
+
+  // Continuous readout: write one time slice (digits sorted by time then tube) as an entry of wcsimSliceT.
+  // The tree is only created if slices are written
+  void FillTimeSlice(G4int slice, G4double startTime, G4double length,
+		     const std::vector<float> & times, const std::vector<float> & charges, const std::vector<int> & tubes);
+
+  // Hit library: save the photon hits of every event (one library entry each), to be overlaid on other events.
+  // GetHitLibrary() is NULL unless a library is being written
+  void SetHitLibraryFileName(G4String fname) { hitLibraryFileName = fname; }
+  WCSimHitLibrary * GetHitLibrary() { return hitLibrary.IsWriting() ? &hitLibrary : NULL; }
+  // Raw signal library: save the PMT signals of every event (before dark noise), to be replayed through the DAQ
+  // with /mygen/generator replay. GetRawSignalLibrary() is NULL unless a library is being written
+  void SetRawSignalLibraryFileName(G4String fname) { rawSignalLibraryFileName = fname; }
+  WCSimHitLibrary * GetRawSignalLibrary() { return rawSignalLibrary.IsWriting() ? &rawSignalLibrary : NULL; }
+  // Photon library: save the optical photons of every event as they are stacked (after the QE cut), to replay
+  // only their optical transport with /mygen/generator photonreplay. GetPhotonLibrary() is NULL unless a library
+  // is being written. The saved photons are also tracked, unless SetTrackSavedPhotons(false)
+  void SetPhotonLibraryFileName(G4String fname) { photonLibraryFileName = fname; }
+  WCSimPhotonLibrary * GetPhotonLibrary() { return photonLibrary.IsWriting() ? &photonLibrary : NULL; }
+  void SetTrackSavedPhotons(G4bool choice) { trackSavedPhotons = choice; }
+  G4bool GetTrackSavedPhotons() { return trackSavedPhotons; }
+
+  // Fast optical simulation: building & use of photon detection probability tables
+  WCSimFastOptics * GetFastOptics() { return fastOptics; }
+
+  // Optical profiling: optical photon steps, boundary interactions, kills & time by logical volume,
+  // written to wcsimOpticalProfileT at the end of the run
+  void SetOpticalProfile(G4bool choice) { opticalProfile->SetEnabled(choice); }
+  WCSimOpticalProfile * GetOpticalProfile() { return opticalProfile; }
   
 private:
+  // One output chunk in the manifest
+  struct OutputChunk {
+    std::string file;       // default ROOT file (empty if not written)
+    std::string flatfile;   // flat ROOT file
+    std::string rndmfile;   // random engine state at the start of the chunk
+    G4int firstEvent;
+    G4int lastEvent;
+    G4int nEvents;
+    G4bool closed;
+  };
+  void StartChunk();
+  void RollOverChunk();
+  void WriteManifest();
+  void AddFlatFriends();
+  void CreateSliceTree();
+
+  G4int chunkEvents;
+  G4double chunkMaxMB;
+  std::string chunkBaseName;
+  std::vector<OutputChunk> chunks;
+
   // MFechner : set by the messenger
   std::string RootFileName;
   // Only required for verification scripts and current fiTQun tuning
   // But making initialization very slow due to large TCloneArray init.
   G4bool useDefaultROOTout;
+  // Truth columns to record. Set by the messenger
+  G4bool saveHitTimes;
+  G4bool savePhotonStartTime;
+  G4bool savePhotonStartPos;
+  G4bool savePhotonEndPos;
+  G4bool saveTracks;
 
   //
   TTree* WCSimTree;
   TTree* geoTree;
+  TTree* sliceTree;
+  // wcsimSliceT entry
+  Int_t    slice_run;
+  Int_t    slice_event;
+  Int_t    slice_index;
+  Double_t slice_start;
+  Double_t slice_length;
+  std::vector<float> slice_t;
+  std::vector<float> slice_q;
+  std::vector<int>   slice_tube;
+  std::string hitLibraryFileName;
+  WCSimHitLibrary hitLibrary;
+  std::string rawSignalLibraryFileName;
+  WCSimHitLibrary rawSignalLibrary;
+  std::string photonLibraryFileName;
+  WCSimPhotonLibrary photonLibrary;
+  G4bool trackSavedPhotons;
+  WCSimFastOptics* fastOptics;
+  WCSimOpticalProfile* opticalProfile;
   TTree* optionsTree;
   WCSimRootEvent* wcsimrootsuperevent;
   WCSimRootGeom* wcsimrootgeom;
@@ -5,6 +5,8 @@ class WCSimRunAction;
 class G4UIdirectory;
 class G4UIcmdWithAString;
 class G4UIcmdWithABool;
+class G4UIcmdWithAnInteger;
+class G4UIcmdWithADouble;
 
 #include "G4UImessenger.hh"
 #include "globals.hh"
@@ -31,6 +33,22 @@ class WCSimRunActionMessenger: public G4UImessenger
 
   G4UIcmdWithABool*   UseTimer;
 
+  G4UIcmdWithABool* SaveHitTimes;
+  G4UIcmdWithABool* SavePhotonStartTime;
+  G4UIcmdWithABool* SavePhotonStartPos;
+  G4UIcmdWithABool* SavePhotonEndPos;
+  G4UIcmdWithABool* SaveTracks;
+
+  G4UIcmdWithAnInteger* ChunkEvents;
+  G4UIcmdWithADouble*   ChunkMaxSize;
+
+  G4UIcmdWithAString* SaveHitLibrary;
+  G4UIcmdWithAString* SaveRawSignalLibrary;
+  G4UIcmdWithAString* SavePhotons;
+  G4UIcmdWithABool* TrackSavedPhotons;
+
+  G4UIcmdWithABool* OpticalProfile;
+
 };
 
 #endif
@@ -21,6 +21,13 @@ class WCSimStackingAction : public G4UserStackingAction {
   private:
 	  WCSimDetectorConstruction*   DetConstruct;
 
+	  // For /process/optical/photonBudget: the optical photons in the waiting
+	  // stack, the weight of the photons of this event from the thinning of
+	  // the stack, and whether the stack is being thinned (re-classified)
+	  G4int nWaitingPhotons;
+	  G4double budgetWeight;
+	  G4bool thinning;
+
 };
 
 #endif
@@ -7,12 +7,15 @@
 
 class G4HCofThisEvent;
 class G4Event;
+class WCSimDetectorConstruction;
+class WCSimOpBoundaryProcess;
 
 class WCSimSteppingAction : public G4UserSteppingAction
 {
 
 public:
-  WCSimSteppingAction()
+  WCSimSteppingAction(WCSimDetectorConstruction* myDetector)
+    : detector(myDetector), boundary(NULL)
   {};
 
   ~WCSimSteppingAction()
@@ -32,15 +35,12 @@ public:
 		      G4double y,
 		      G4int xy);
 
-
-  static G4int n_photons_through_mPMTLV;
-  static G4int n_photons_through_acrylic;
-  static G4int n_photons_through_gel;
-  static G4int n_photons_on_blacksheet;
-  static G4int n_photons_on_smallPMT;
-
 private:
 
+  WCSimDetectorConstruction* detector;
+  // The optical boundary process, found at the first step
+  WCSimOpBoundaryProcess* boundary;
+
   G4double ret[2];
 
 };
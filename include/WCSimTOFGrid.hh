@@ -0,0 +1,93 @@
+#ifndef WCSimTOFGrid_h
+#define WCSimTOFGrid_h 1
+
+/////////////////////////////////////////////////////////////////
+//
+// Precomputed vertex-to-PMT time-of-flight grid, and the
+// vertex-scanning coincidence search that uses it
+//
+// The candidate vertices are a cubic lattice filling the bounding
+// box of the PMTs. Vertex positions are stored as separate x/y/z
+// float arrays, and the TOFs as one contiguous float array per
+// vertex (indexed by PMT row), so the inner loop over digits reads
+// memory linearly. The table takes 4 x vertices x PMTs bytes, i.e. it
+// grows as 1/spacing^3: Build() can refuse grids above a size limit.
+//
+// Used by the TOFScan trigger and by benchmarkTOFScan.
+// Depends on neither Geant4 nor ROOT.
+//
+/////////////////////////////////////////////////////////////////
+
+#include <stddef.h>
+#include <vector>
+
+class WCSimTOFGrid {
+public:
+  /// A coincidence found by Scan()
+  struct Candidate {
+    float time;   ///< Start of the time window, in TOF-corrected (i.e. vertex) time (ns)
+    int   count;  ///< Number of digits in the window
+    int   vertex; ///< Index of the grid vertex with the most digits in the window
+  };
+
+  static const float kDefaultLightSpeed; ///< Effective speed of light in water (cm/ns)
+
+  WCSimTOFGrid();
+
+  /// Number of vertices of the grid for npmt PMTs at (x,y,z) (cm) with the given spacing (cm),
+  /// without building it
+  static size_t GetNumVertices(size_t npmt, const double * x, const double * y, const double * z,
+			       double spacing);
+
+  /// Build the grid for npmt PMTs at (x,y,z) (cm), with the given vertex spacing (cm).
+  /// PMT i is row i of the TOF table. If maxTableSize (bytes) is not 0 and the TOF table
+  /// would be larger, nothing is allocated and false is returned
+  bool Build(size_t npmt, const double * x, const double * y, const double * z,
+	     double spacing, double lightSpeed = kDefaultLightSpeed, size_t maxTableSize = 0);
+
+  size_t GetNumVertices() const { return fVertexX.size(); }
+  size_t GetNumPMT()      const { return fNumPMT; }
+  /// Size of the TOF table, in bytes
+  size_t GetTableSize()   const { return fTOF.size() * sizeof(float); }
+  float  GetVertexX(int v) const { return fVertexX[v]; }
+  float  GetVertexY(int v) const { return fVertexY[v]; }
+  float  GetVertexZ(int v) const { return fVertexZ[v]; }
+  /// TOFs from vertex v to all PMTs (ns)
+  const float * GetTOF(int v) const { return &fTOF[v * fNumPMT]; }
+  /// Shortest TOF from vertex v to any PMT (ns): adding it to a TOF-corrected time
+  /// gives the detector time of the earliest digit light from v can make
+  float GetMinTOF(int v) const { return fMinTOF[v]; }
+
+  /**
+   * Find the time windows with more than threshold TOF-corrected digits, for any vertex.
+   *
+   * times and rows hold the time (ns) and PMT row of each of the ndigits digits.
+   * For every vertex the corrected times are binned in half windows, and each pair of
+   * neighbouring bins is a window, so every group of digits within half a window of each
+   * other is counted together. The cost is O(vertices x digits), independent of the
+   * length of the event. Vertices are split between nthreads threads (0: one per core).
+   *
+   * candidates is filled, in time order, with each window above threshold and its best
+   * vertex. The result does not depend on nthreads.
+   */
+  void Scan(const float * times, const int * rows, size_t ndigits,
+	    float window, int threshold, unsigned int nthreads,
+	    std::vector<Candidate> & candidates) const;
+
+private:
+  /// Best count & vertex per window, for the vertices [vfirst, vlast)
+  void ScanVertices(const float * times, const int * rows, size_t ndigits,
+		    float tmin, float invhalfwindow, size_t nwindows,
+		    size_t vfirst, size_t vlast,
+		    std::vector<int> & bestcount, std::vector<int> & bestvertex) const;
+
+  size_t fNumPMT;
+  float  fMaxTOF;
+  std::vector<float> fVertexX;
+  std::vector<float> fVertexY;
+  std::vector<float> fVertexZ;
+  std::vector<float> fTOF; ///< fTOF[v * fNumPMT + pmt]
+  std::vector<float> fMinTOF; ///< Per vertex
+};
+
+#endif
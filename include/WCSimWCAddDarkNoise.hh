@@ -33,10 +33,15 @@ public:
   void SetDarkHigh(int idarkhigh){DarkHigh = idarkhigh;}
   void SetDarkLow(int idarklow){DarkLow = idarklow;}
   void SetDarkWindow(int idarkwindow){DarkWindow = idarkwindow;}
+  int GetDarkMode() { return DarkMode; }
+  double GetDarkHigh() { return DarkHigh; }
+  double GetDarkLow() { return DarkLow; }
+  //Only add noise in [low, high) (the continuous readout chunks, see WCSimEventAction). Default (-DBL_MAX, DBL_MAX)
+  void SetTimeRange(double low, double high) { TimeLow = low; TimeHigh = high; }
   void SaveOptionsToOutput(WCSimRootOptions * wcopt);
   
 private:
-  void ReInitialize() { ranges.clear(); result.clear();}
+  void ReInitialize() { result.clear();}
   void SetPMTDarkDefaults();
 
   WCSimDarkRateMessenger *DarkRateMessenger;
@@ -47,11 +52,12 @@ private:
   double DarkWindow; //ns
   int DarkMode;
   bool fCalledAddDarkNoise;
+  double TimeLow; //ns
+  double TimeHigh; //ns
 
   WCSimDetectorConstruction* myDetector;
 
-  std::vector<std::pair<float, float> > ranges;
-  std::vector<std::pair<float, float> > result;
+  std::vector<std::pair<float, float> > result; ///< The time ranges in which to add noise
   
 };
 
@@ -42,6 +42,7 @@ private:
   G4UIcmdWithABool*   MultiDigitsPerTrigger;
   G4bool              StoreMultiDigitsPerTrigger;
   G4bool              MultiDigitsPerTriggerSet;
+  G4UIcmdWithAnInteger* NThreads;
 
   G4UIdirectory*        DigitizerDir;
   G4UIcmdWithAnInteger* DigitizerDeadTime;
@@ -53,6 +54,16 @@ private:
   G4UIcmdWithADouble*   DigitizerPEPrecision;
   G4double              StoreDigitizerPEPrecision;
 
+  G4UIdirectory*        WaveformDigitizerDir;
+  G4UIcmdWithADouble*   WaveformSampleWidth;
+  G4double              StoreWaveformSampleWidth;
+  G4UIcmdWithAnInteger* WaveformNPhases;
+  G4int                 StoreWaveformNPhases;
+  G4UIcmdWithADouble*   WaveformThreshold;
+  G4double              StoreWaveformThreshold;
+  G4UIcmdWithADouble*   WaveformNoise;
+  G4double              StoreWaveformNoise;
+
   G4UIdirectory*        SaveFailuresTriggerDir;
   G4UIcmdWithAnInteger* SaveFailuresTriggerMode;
   G4int                 StoreSaveFailuresMode;
@@ -74,6 +85,41 @@ private:
   G4int                 StoreNDigitsPreWindow;
   G4UIcmdWithAnInteger* NDigitsPostTriggerWindow;
   G4int                 StoreNDigitsPostWindow;
+
+  G4UIdirectory*        LocalNHitsTriggerDir;
+  G4UIcmdWithAnInteger* LocalNHitsTriggerThreshold;
+  G4int                 StoreLocalNHitsThreshold;
+  G4UIcmdWithAnInteger* LocalNHitsTriggerWindow;
+  G4int                 StoreLocalNHitsWindow;
+  G4UIcmdWithADouble*   LocalNHitsTriggerNeighbourRadius;
+  G4double              StoreLocalNHitsNeighbourRadius;
+  G4UIcmdWithAnInteger* LocalNHitsPreTriggerWindow;
+  G4int                 StoreLocalNHitsPreWindow;
+  G4UIcmdWithAnInteger* LocalNHitsPostTriggerWindow;
+  G4int                 StoreLocalNHitsPostWindow;
+
+  G4UIdirectory*        TOFScanTriggerDir;
+  G4UIcmdWithAnInteger* TOFScanTriggerThreshold;
+  G4int                 StoreTOFScanThreshold;
+  G4UIcmdWithAnInteger* TOFScanTriggerWindow;
+  G4int                 StoreTOFScanWindow;
+  G4UIcmdWithADouble*   TOFScanTriggerGridSpacing;
+  G4double              StoreTOFScanGridSpacing;
+  G4UIcmdWithADouble*   TOFScanTriggerMaxTableSize;
+  G4double              StoreTOFScanMaxTableSize;
+  G4UIcmdWithAnInteger* TOFScanTriggerNThreads;
+  G4int                 StoreTOFScanNThreads;
+  G4UIcmdWithAnInteger* TOFScanPreTriggerWindow;
+  G4int                 StoreTOFScanPreWindow;
+  G4UIcmdWithAnInteger* TOFScanPostTriggerWindow;
+  G4int                 StoreTOFScanPostWindow;
+
+  G4UIdirectory*        ContinuousTriggerDir;
+  G4UIcmdWithAnInteger* ContinuousSliceLength;
+  G4int                 StoreContinuousSliceLength;
+  G4UIcmdWithAnInteger* ContinuousSlicesPerChunk;
+  G4int                 StoreContinuousSlicesPerChunk;
+
   G4UIcmdWithADouble* TriggerOffset;
   G4double            StoreTriggerOffset;
 
@@ -100,10 +100,10 @@ public:
   inline void AddPhotonToDigiComposition(int digi_number, int photon_number){
     fDigiComp[digi_number].push_back(photon_number);
   }
-  // Add a whole vector for one digit to fDigiComp. Clear input vector once added.
+  // Add a whole vector for one digit to fDigiComp. The input vector is moved in, so is empty once added.
   void AddDigiCompositionInfo(std::vector<int> & digi_comp){
     const size_t size = fDigiComp.size();
-    fDigiComp[size] = digi_comp;
+    fDigiComp[size].swap(digi_comp);
     digi_comp.clear();
   }
 
@@ -159,6 +159,12 @@ public:
     int index_primaryparentid;
     float index_photonstarttime;
     G4ThreeVector index_photonstartpos;
+    G4ThreeVector index_photonendpos;
+    // The photon truth maps are only filled if requested (see /WCSimIO/).
+    // Don't touch them with operator[] otherwise, as that would fill them
+    const bool sort_starttime = !photonStartTime.empty();
+    const bool sort_startpos  = !photonStartPos.empty();
+    const bool sort_endpos    = !photonEndPos.empty();
     for (i = 1; i < (int) time.size(); ++i)
       {
         index_time  = time[i];
@@ -166,15 +172,17 @@ public:
         index_pe = pe[i];
 	index_digicomp = fDigiComp[i];
 	index_primaryparentid = primaryParentID[i];
-	index_photonstarttime = photonStartTime[i];
-	index_photonstartpos = photonStartPos[i];
+	if(sort_starttime) index_photonstarttime = photonStartTime[i];
+	if(sort_startpos)  index_photonstartpos = photonStartPos[i];
+	if(sort_endpos)    index_photonendpos = photonEndPos[i];
         for (j = i; j > 0 && time[j-1] > index_time; j--) {
           time[j] = time[j-1];
           pe[j] = pe[j-1];
 	  fDigiComp[j] = fDigiComp[j-1];
 	  primaryParentID[j] = primaryParentID[j-1];
-	  photonStartTime[j] = photonStartTime[j-1];
-	  photonStartPos[j] = photonStartPos[j-1];
+	  if(sort_starttime) photonStartTime[j] = photonStartTime[j-1];
+	  if(sort_startpos)  photonStartPos[j] = photonStartPos[j-1];
+	  if(sort_endpos)    photonEndPos[j] = photonEndPos[j-1];
           //G4cout <<"swapping "<<time[j-1]<<" "<<index_time<<G4endl;
         }
         
@@ -183,8 +191,9 @@ public:
         pe[j] = index_pe;
 	fDigiComp[j] = index_digicomp;
 	primaryParentID[j] = index_primaryparentid;
-	photonStartTime[j] = index_photonstarttime;
-	photonStartPos[j] = index_photonstartpos;
+	if(sort_starttime) photonStartTime[j] = index_photonstarttime;
+	if(sort_startpos)  photonStartPos[j] = index_photonstartpos;
+	if(sort_endpos)    photonEndPos[j] = index_photonendpos;
       }    
   }
   
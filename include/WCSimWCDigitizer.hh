@@ -9,6 +9,8 @@
 #include "G4VDigitizerModule.hh"
 #include "WCSimWCDigi.hh"
 #include "WCSimWCHit.hh"
+#include "WCSimDAQDigitizer.hh"
+#include "WCSimDAQWaveform.hh"
 #include "globals.hh"
 #include "Randomize.hh"
 #include <map>
@@ -26,7 +28,8 @@ public:
   WCSimWCDigitizerBase(G4String name, WCSimDetectorConstruction*, WCSimWCDAQMessenger*, DigitizerType_t);
   virtual ~WCSimWCDigitizerBase();
   
-  bool AddNewDigit(int tube, int gate, float digihittime, float peSmeared, std::vector<int> digi_comp);
+  ///Save a digit (already truncated to the digitizer precision) in the output collection. digi_comp is cleared
+  void AddNewDigit(int tube, int gate, float digihittime, float peSmeared, std::vector<int> & digi_comp);
   virtual void DigitizeHits(WCSimWCDigitsCollection* WCHCPMT) = 0;
   void DigitizeGate(WCSimWCDigitsCollection* WCHC,G4int G);
   void Digitize();
@@ -36,19 +39,30 @@ public:
   void SetDigitizerIntegrationWindow(int inttime ) { DigitizerIntegrationWindow = inttime; }; ///< Override the default digitizer integration window (ns)
   void SetDigitizerTimingPrecision  (double precision) { DigitizerTimingPrecision = precision; }; ///< Override the default digitizer timing resolution (ns)
   void SetDigitizerPEPrecision      (double precision) { DigitizerPEPrecision     = precision; }; ///< Override the default digitizer charge resolution (p.e.)
+  int GetDigitizerDeadTime()          { return DigitizerDeadTime;          } ///< The digitizer deadtime (ns)
+  int GetDigitizerIntegrationWindow() { return DigitizerIntegrationWindow; } ///< The digitizer integration window (ns)
+  ///Number of threads for the per-PMT loops (0: not threaded). See /DAQ/NThreads
+  void SetNThreads(int nthreads) { NThreads = nthreads; }
 
-  double Truncate(double value, double precision) {
-    if(precision < 1E-10) return value;
-    return precision * (int)(value / precision);
-  }
+  //Waveform digitizer options
+  void SetWaveformSampleWidth(double width)     { WaveformSampleWidth = width;     }; ///< Override the default waveform sampling period (ns)
+  void SetWaveformNPhases    (int nphases)      { WaveformNPhases     = nphases;   }; ///< Override the default number of sub-sample phases of the pulse templates
+  void SetWaveformThreshold  (double threshold) { WaveformThreshold   = threshold; }; ///< Override the default discriminator threshold (fraction of the single p.e. pulse height)
+  void SetWaveformNoise      (double noise)     { WaveformNoise       = noise;     }; ///< Override the default noise RMS (fraction of the single p.e. pulse height)
 
   ///Save current values of options
   void SaveOptionsToOutput(WCSimRootOptions * wcopt);
   
 protected:
-  void ReInitialize() { DigiStoreHitMap.clear(); }
+  void ReInitialize() { DigiStoreHitMap.clear(); DAQHits.Clear(); DAQDigits.clear(); }
 
-  G4double peSmeared;
+  ///Copy the raw hits into DAQHits, the input of the DAQ library digitizers. Sorts the hits of each PMT by time
+  void FillDAQHits(WCSimWCDigitsCollection* WCHCPMT);
+  ///Save DAQDigits, the output of the DAQ library digitizers, in the output collection
+  void StoreDAQDigits();
+
+  WCSimDAQHits               DAQHits;   ///< The raw hits, grouped by PMT
+  std::vector<WCSimDAQDigit> DAQDigits; ///< The digits, in PMT order
 
   WCSimDetectorConstruction* myDetector; ///< Get the geometry information
   WCSimWCDAQMessenger* DAQMessenger;     ///< Get the /DAQ/ .mac options
@@ -63,12 +77,24 @@ protected:
   double DigitizerTimingPrecision; ///< Digitizer time precision (ns)
   double DigitizerPEPrecision;     ///< Digitizer charge precision (p.e.)
 
+  //Waveform digitizer properties
+  double WaveformSampleWidth; ///< Sampling period (ns)
+  int    WaveformNPhases;     ///< Sub-sample phases of the pulse templates
+  double WaveformThreshold;   ///< Discriminator threshold (fraction of the single p.e. pulse height)
+  double WaveformNoise;       ///< Noise RMS (fraction of the single p.e. pulse height)
+
   DigitizerType_t DigitizerType; ///< Enumeration to say which digitizer we've constructed
 
+  int NThreads; ///< Threads for the per-PMT loops. If >0 each PMT has its own random number substream
+
   virtual int GetDefaultDeadTime() = 0;          ///< Set the default digitizer-specific deadtime (in ns) (overridden by .mac)
   virtual int GetDefaultIntegrationWindow() = 0; ///< Set the default digitizer-specific integration window (in ns) (overridden by .mac)
   virtual double GetDefaultTimingPrecision() = 0;   ///< Set the default digitizer-specific timing resolution (in ns) (overridden by .mac)
   virtual double GetDefaultPEPrecision() = 0;       ///< Set the default digitizer-specific charge resolution (in p.e.) (overridden by .mac)
+  virtual double GetDefaultWaveformSampleWidth() { return 8;    } ///< Set the default waveform sampling period (in ns) (overridden by .mac)
+  virtual int    GetDefaultWaveformNPhases()     { return 16;   } ///< Set the default number of sub-sample phases (overridden by .mac)
+  virtual double GetDefaultWaveformThreshold()   { return 0.25; } ///< Set the default discriminator threshold (in single p.e. pulse heights) (overridden by .mac)
+  virtual double GetDefaultWaveformNoise()       { return 0.03; } ///< Set the default noise RMS (in single p.e. pulse heights) (overridden by .mac)
 
   void GetVariables(); ///< Get the default deadtime, etc. from the derived class, and override with read from the .mac file
 };
@@ -96,28 +122,26 @@ private:
   double GetDefaultTimingPrecision()   { return 0.4; } ///< SKI digitizer timing precision is 0.4 ns (SK NIM Sec 5.1)
   double GetDefaultPEPrecision()       { return 0;   } ///< SKI digitizer charge precision is 0.2 pC (SK NIM Sec 5.1), but conversion to PE not specified
 
-  static void Threshold(double& pe,int& iflag){
-    //   CLHEP::HepRandom::setTheSeed(pe+2014);
-    double x = pe+0.1; iflag=0;
-    double thr; double RDUMMY,err;
-    if ( x<1.1) {
-      thr = std::min(1.0,
-		     -0.06374+x*(3.748+x*(-63.23+x*(452.0+x*(-1449.0+x*(2513.0
-									+x*(-2529.+x*(1472.0+x*(-452.2+x*(51.34+x*2.370))))))))));
-    } else {
-      thr = 1.0;
-    }
-    RDUMMY = G4UniformRand();
-    if (thr < RDUMMY) {
-      pe = 0.0;
-      iflag = 1;
-    }
-    else {
-      err = G4RandGauss::shoot(0.0,0.03);
-      /////      call rngaus(0.0, 0.03, err);
-      pe = pe+err;
-    }
-  }
+  WCSimDAQDigitizerSKI DAQDigitizer; ///< The digitizer algorithm (see WCSimDAQDigitizer.hh)
+};
+
+// Waveform digitizer class: renders the sampled waveform of each PMT, then discriminates & integrates it
+class WCSimWCDigitizerWaveform : public WCSimWCDigitizerBase
+{
+public:
+
+  WCSimWCDigitizerWaveform(G4String name, WCSimDetectorConstruction*, WCSimWCDAQMessenger*);
+  ~WCSimWCDigitizerWaveform();
+
+  void DigitizeHits(WCSimWCDigitsCollection* WCHCPMT);
+
+private:
+  int GetDefaultDeadTime()          { return 0; }   ///< The discriminator rearms when the waveform goes below threshold
+  int GetDefaultIntegrationWindow() { return 128; } ///< Covers the default single p.e. pulse (WCSimPMTObject::PulseShape())
+  double GetDefaultTimingPrecision()   { return 0; } ///< The time is interpolated between samples
+  double GetDefaultPEPrecision()       { return 0; } ///<
+
+  WCSimDAQDigitizerWaveform DAQDigitizer; ///< The digitizer algorithm (see WCSimDAQWaveform.hh)
 };
 
 
@@ -70,7 +70,7 @@ class WCSimWCHit : public G4VHit
   // This is temporarily used for the drawing scale
   void SetMaxPe(G4int number = 0)  {maxPe   = number;};
 
-  void AddPe(G4float hitTime)  
+  void AddPe(G4float hitTime, G4double weight = 1.)
   {
     // First increment the totalPe number
     totalPe++; 
@@ -79,7 +79,22 @@ class WCSimWCHit : public G4VHit
       maxPe = totalPe;
 
     time.push_back(hitTime);
+
+    // The weights are only kept once a weighted photon hits the tube
+    if (weight != 1. && photonWeight.empty())
+      photonWeight.assign(totalPe - 1, 1.);
+    if (!photonWeight.empty())
+      photonWeight.push_back(weight);
   }
+
+  // Replace the weighted photons by a Poisson number of p.e. (mean: the sum of the weights),
+  // each a copy of one of the photons, picked with probability proportional to its weight
+  void ResampleWeightedPe();
+
+  // Put the p.e. (and their photon truth) in time order
+  void SortPeByTime();
+  // Index of the first p.e. at or after t. The p.e. must be in time order (see SortPeByTime())
+  G4int GetFirstPeAfter(G4float t) { return std::lower_bound(time.begin(), time.end(), t) - time.begin(); }
  
   G4int         GetTubeID()     { return tubeID; };
   G4int         GetTrackID()    { return trackID; };
@@ -170,6 +185,7 @@ class WCSimWCHit : public G4VHit
   std::vector<G4float>  photonStartTime;
   std::vector<G4ThreeVector> photonStartPos;
   std::vector<G4ThreeVector> photonEndPos;
+  std::vector<G4float>  photonWeight; // Empty if all the photons have weight 1
   G4int                 totalPeInGate;
 };
 
@@ -0,0 +1,75 @@
+#ifndef WCSimWCOverlay_h
+#define WCSimWCOverlay_h 1
+
+#include "WCSimDetectorConstruction.hh"
+#include "G4VDigitizerModule.hh"
+#include "WCSimWCHit.hh"
+#include "WCSimHitLibrary.hh"
+#include "WCSimRootOptions.hh"
+#include "globals.hh"
+#include <vector>
+
+class WCSimOverlayMessenger;
+
+// Pile-up overlay: adds the photon hits of pre-simulated events (read from
+// WCSimHitLibrary files) to the hits of the current event, with time offsets,
+// before the PMT response (WCSimWCPMT::Digitize) is applied.
+//
+// Two kinds of source:
+//  - rate sources: a Poisson number of library entries (rate x overlay window)
+//    is overlaid per event, each at a uniformly random time in the window
+//  - fixed sources: one library entry per event (in order, looping), at a fixed
+//    time offset
+//
+// The overlaid p.e. have no photon truth: their parent ID is kOverlayParentID
+// (-2, as dark noise p.e. have -1, see WCSimWCAddDarkNoise), and their photon
+// start time, start & end positions (when saved) are kOverlayPhotonTruth (-1).
+// Select the overlaid p.e. on the parent ID, as -1 is also a possible time or
+// position.
+class WCSimWCOverlay : public G4VDigitizerModule
+{
+public:
+  /// Parent ID of the overlaid p.e. (dark noise p.e. have -1)
+  static const G4int kOverlayParentID = -2;
+  /// Photon start time & start/end position coordinates of the overlaid p.e.
+  static constexpr G4float kOverlayPhotonTruth = -1;
+
+  WCSimWCOverlay(G4String name, WCSimDetectorConstruction*);
+  ~WCSimWCOverlay();
+
+public:
+  void Overlay(WCSimWCHitsCollection* WCHC);
+  //As it inherits from G4VDigitizerModule it needs a digitize class.  Not used
+  void Digitize() { }
+  void AddRateSource (G4String filename, double rate);   // kHz
+  void AddFixedSource(G4String filename, double offset); // ns
+  void ClearSources();
+  void SetWindowLow (double low)  { WindowLow  = low; }
+  void SetWindowHigh(double high) { WindowHigh = high; }
+  bool HasSources() { return !Sources.empty(); }
+  void SaveOptionsToOutput(WCSimRootOptions * wcopt);
+
+private:
+  struct OverlaySource {
+    G4String         filename;
+    WCSimHitLibrary* library;
+    bool             fixed;
+    double           rate;   // kHz. Rate sources only
+    double           offset; // ns. Fixed sources only
+    uint64_t         next;   // next entry. Fixed sources only
+  };
+  bool AddSource(OverlaySource & source);
+  void OverlayEntry(WCSimWCHitsCollection* WCHC, const OverlaySource & source, uint64_t entry, double offset);
+
+  WCSimOverlayMessenger *OverlayMessenger;
+  std::vector<OverlaySource> Sources;
+  double WindowLow;  // ns
+  double WindowHigh; // ns
+
+  WCSimDetectorConstruction* myDetector;
+
+  // Index in the hits collection of each tube's hit (-1 if none yet). Rebuilt every event
+  std::vector<int> HitIndex;
+};
+
+#endif
@@ -6,6 +6,8 @@
 #include "G4VDigitizerModule.hh"
 #include "WCSimWCDigi.hh"
 #include "WCSimWCHit.hh"
+#include "WCSimHitLibrary.hh"
+#include "WCSimDAQ.hh"
 #include "globals.hh"
 #include "Randomize.hh"
 #include <map>
@@ -20,6 +22,14 @@ public:
   ~WCSimWCPMT();
   
    void ReInitialize() { DigiHitMapPMT.clear(); TriggerTimes.clear(); }
+
+  /// Number of threads for MakePeCorrection(). 0 runs serially with the Geant4 random engine,
+  /// >0 uses one random number substream per tube, so the result does not depend on the number of threads
+  void SetNThreads(G4int n) { NThreads = n; }
+
+  /// Only convert the p.e. with times in [low, high) (the continuous readout chunks, see WCSimEventAction).
+  /// Unless the range is (-DBL_MAX, DBL_MAX) (the default), the p.e. of each hit must be in time order (WCSimWCHit::SortPeByTime())
+  void SetTimeRange(G4double low, G4double high) { TimeLow = low; TimeHigh = high; }
     
    
 public:
@@ -27,11 +37,15 @@ public:
   void AddPMTDarkRate(WCSimWCDigitsCollection*);
   void MakePeCorrection(WCSimWCHitsCollection*);
   void Digitize();
+  /// Add already-simulated PMT signals (e.g. from a kRawSignal hit library) to the collection made by Digitize()
+  void AddRawSignal(const WCSimHitLibraryHit* hits, uint64_t nhits);
   G4double GetTriggerTime(int i) { return TriggerTimes[i];}
   // void SetConversion(double iconvrate){ ConvRate = iconvrate; }
   //  static G4double GetLongTime() { return LongTime;}
   
   G4double rn1pe();
+  /// A random single p.e. charge from the qpe table of a PMT (WCSimPMTObject::Getqpe()), with the random numbers of random
+  static G4double rn1pe(const G4float * qpe0, WCSimDAQRandom & random);
   G4double peSmeared;
   // double ConvRate; // kHz
   std::vector<G4double> TriggerTimes;
@@ -40,6 +54,17 @@ public:
   WCSimWCDigitsCollection*  DigitsCollection;  
   WCSimDetectorConstruction* myDetector;
 
+private:
+  /// Add the photoelectrons of hit to Digi, with random single p.e. charges
+  void AddPhotoelectrons(WCSimWCHit * hit, WCSimWCDigi * Digi, const G4float * qpe, WCSimDAQRandom & random,
+			 bool savePhotonStartTime, bool savePhotonStartPos, bool savePhotonEndPos);
+  /// The p.e. [first, last) of hit that are in the time range
+  void GetPeInTimeRange(WCSimWCHit * hit, G4int & first, G4int & last);
+
+  G4int NThreads;
+  G4double TimeLow;  ///< ns
+  G4double TimeHigh; ///< ns
+
 };
 
 #endif
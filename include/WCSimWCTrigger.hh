@@ -8,6 +8,8 @@
 #include "G4VDigitizerModule.hh"
 #include "WCSimWCDigi.hh"
 #include "WCSimWCHit.hh"
+#include "WCSimTOFGrid.hh"
+#include "WCSimDAQTrigger.hh"
 #include "globals.hh"
 #include "Randomize.hh"
 #include <map>
@@ -40,7 +42,7 @@ public:
   
   virtual ~WCSimWCTriggerBase();
 
-  ///The main user-callable routine of the class. Gets the input & creates the output WCSimWCTriggeredDigitsCollection's, then calls DoTheWork()
+  ///The main user-callable routine of the class. Gets the input, builds the time-sorted digit view, calls DoTheWork(), then creates the output WCSimWCTriggeredDigitsCollection
   void Digitize();
 
   ///Returns the number of trigger gates in the event (i.e. the number of triggers passed)
@@ -51,6 +53,11 @@ public:
   TriggerType_t        GetTriggerType(int i) { return TriggerTypes[i];}
   ///Get the additional trigger information associated with the ith trigger
   std::vector<Float_t> GetTriggerInfo(int i) { return TriggerInfos[i];}
+  ///Get the name of the trigger class (e.g. "Continuous")
+  G4String GetTriggerClassName() { return triggerClassName; }
+
+  /// A digit in the time-sorted view of the input WCSimWCDigitsCollection (pmt is the index of the WCSimWCDigi in the collection)
+  typedef WCSimDAQSortedDigit SortedDigit;
 
   //
   // Trigger algorithm option set methods
@@ -71,6 +78,46 @@ public:
   ///Set the posttrigger window for the NDigits trigger (value will be forced positive)
   void SetNDigitsPostTriggerWindow(G4int window) { ndigitsPostTriggerWindow = + abs(window); }
 
+  // LocalNHits options
+  ///Set the threshold for the LocalNHits trigger (number of hit PMTs in a neighbourhood)
+  void SetLocalNHitsThreshold(G4int threshold) { localNHitsThreshold = threshold; }
+  ///Set the time window for the LocalNHits trigger
+  void SetLocalNHitsWindow(G4int window) { localNHitsWindow = window; }
+  ///Set the neighbourhood radius (in cm) for the LocalNHits trigger. 0 means group the PMTs by mPMT
+  void SetLocalNHitsNeighbourRadius(G4double radius) { localNHitsNeighbourRadius = radius; }
+  ///Set the pretrigger window for the LocalNHits trigger (value will be forced negative)
+  void SetLocalNHitsPreTriggerWindow(G4int window)  { localNHitsPreTriggerWindow  = - abs(window); }
+  ///Set the posttrigger window for the LocalNHits trigger (value will be forced positive)
+  void SetLocalNHitsPostTriggerWindow(G4int window) { localNHitsPostTriggerWindow = + abs(window); }
+
+  // TOFScan options
+  ///Set the threshold for the TOFScan trigger (number of digits in the TOF-corrected window)
+  void SetTOFScanThreshold(G4int threshold) { tofScanThreshold = threshold; }
+  ///Set the TOF-corrected time window for the TOFScan trigger
+  void SetTOFScanWindow(G4int window) { tofScanWindow = window; }
+  ///Set the spacing (in cm) of the grid of candidate vertices for the TOFScan trigger
+  void SetTOFScanGridSpacing(G4double spacing) { tofScanGridSpacing = spacing; }
+  ///Set the number of threads for the TOFScan trigger (0 = one per core)
+  void SetTOFScanNThreads(G4int nthreads) { tofScanNThreads = nthreads; }
+  ///Set the largest TOF table (in MB) the TOFScan trigger may allocate (0 = no limit)
+  void SetTOFScanMaxTableSize(G4double mb) { tofScanMaxTableSize = mb; }
+  ///Set the pretrigger window for the TOFScan trigger (value will be forced negative)
+  void SetTOFScanPreTriggerWindow(G4int window)  { tofScanPreTriggerWindow  = - abs(window); }
+  ///Set the posttrigger window for the TOFScan trigger (value will be forced positive)
+  void SetTOFScanPostTriggerWindow(G4int window) { tofScanPostTriggerWindow = + abs(window); }
+
+  // Continuous readout options
+  ///Set the length of the continuous readout time slices
+  void SetTimeSliceLength(G4int length) { timeSliceLength = length; }
+  ///Set the number of continuous readout time slices digitized at once (see WCSimEventAction)
+  void SetTimeSlicesPerChunk(G4int n) { timeSlicesPerChunk = n; }
+  G4int GetTimeSliceLength()    { return timeSliceLength; }
+  G4int GetTimeSlicesPerChunk() { return timeSlicesPerChunk; }
+  ///Start the time slices of a new event: the first slice written is that of the first digit
+  void BeginTimeSlices() { timeSliceStarted = false; }
+  ///Only write the time slices of the digits in [low, high) (one chunk of the event). Default (-DBL_MAX, DBL_MAX)
+  void SetTimeSliceRange(double low, double high) { timeSliceLow = low; timeSliceHigh = high; }
+
   ///Set the timing offset
   void SetTriggerOffset(G4double value) { offset = value; }
 
@@ -92,7 +139,17 @@ public:
   
 protected:
 
-  ///This should call the trigger algorithms, and handle any temporary DigitsCollection's
+  /**
+   * \brief Run the trigger pipeline: call one or more Alg* trigger algorithms
+   *
+   * All algorithms share the read-only, time-sorted view of the input digits (SortedDigits).
+   * To chain algorithms (e.g. run a second algorithm only on digits outside the readout windows
+   * of the first), use MaskDigitsInTriggerWindows() with a bit per pipeline stage,
+   * and pass that bit as the ignore_mask of the later algorithms.
+   * The input WCSimWCDigitsCollection must not be modified or copied.
+   *
+   * The output digits collection is filled once, from all triggers found, after this returns
+   */
   virtual void DoTheWork(WCSimWCDigitsCollection* WCDCPMT) = 0;
 
   /// Get the default threshold, etc. from the derived class, and override with read from the .mac file
@@ -110,6 +167,34 @@ protected:
   virtual int GetDefaultNDigitsPostTriggerWindow() { return 950; }
   ///Set the default trigger class specific NDigits posttrigger window (in ns) (overridden by .mac)
   virtual int GetDefaultTriggerOffset() { return 950; }
+  ///Set the default trigger class specific LocalNHits threshold (in hit PMTs) (overridden by .mac)
+  virtual int GetDefaultLocalNHitsThreshold()         { return 3; }
+  ///Set the default trigger class specific LocalNHits window (in ns) (overridden by .mac)
+  virtual int GetDefaultLocalNHitsWindow()            { return 20; }
+  ///Set the default trigger class specific LocalNHits neighbourhood radius (in cm, 0 = group by mPMT) (overridden by .mac)
+  virtual double GetDefaultLocalNHitsNeighbourRadius() { return 0; }
+  ///Set the default trigger class specific LocalNHits pretrigger window (in ns) (overridden by .mac)
+  virtual int GetDefaultLocalNHitsPreTriggerWindow()  { return -400; }
+  ///Set the default trigger class specific LocalNHits posttrigger window (in ns) (overridden by .mac)
+  virtual int GetDefaultLocalNHitsPostTriggerWindow() { return 950; }
+  ///Set the default trigger class specific TOFScan threshold (in digits) (overridden by .mac)
+  virtual int GetDefaultTOFScanThreshold()         { return 10; }
+  ///Set the default trigger class specific TOFScan TOF-corrected window (in ns) (overridden by .mac)
+  virtual int GetDefaultTOFScanWindow()            { return 10; }
+  ///Set the default trigger class specific TOFScan vertex grid spacing (in cm) (overridden by .mac)
+  virtual double GetDefaultTOFScanGridSpacing()    { return 50; }
+  ///Set the default trigger class specific TOFScan number of threads (0 = one per core) (overridden by .mac)
+  virtual int GetDefaultTOFScanNThreads()          { return 1; }
+  ///Set the default trigger class specific TOFScan TOF table size limit (in MB) (overridden by .mac)
+  virtual double GetDefaultTOFScanMaxTableSize()   { return 1024; }
+  ///Set the default trigger class specific TOFScan pretrigger window (in ns) (overridden by .mac)
+  virtual int GetDefaultTOFScanPreTriggerWindow()  { return -400; }
+  ///Set the default trigger class specific TOFScan posttrigger window (in ns) (overridden by .mac)
+  virtual int GetDefaultTOFScanPostTriggerWindow() { return 950; }
+  ///Set the default trigger class specific continuous readout time slice length (in ns) (overridden by .mac)
+  virtual int GetDefaultTimeSliceLength()          { return 1000; }
+  ///Set the default trigger class specific number of continuous readout time slices digitized at once (overridden by .mac)
+  virtual int GetDefaultTimeSlicesPerChunk()       { return 100; }
 
   ///Get the pretrigger window for a given trigger algorithm
   int GetPreTriggerWindow(TriggerType_t t);
@@ -121,8 +206,9 @@ protected:
   /**
    * \brief An NDigits trigger algorithm
    *
-   * Looks through the input WCSimWCDigitsCollection and integrates the number of hits in a (specified) time window
-   * If the integral passes above a (specified) threshold, a trigger is issued
+   * Slides a (specified) time window along the time-sorted digits, counting the number of digits in it
+   * If the count passes above a (specified) threshold, a trigger is issued.
+   * Digits with any of the bits in ignore_mask set (see MaskDigitsInTriggerWindows()) are not counted
    *
    * The trigger type is kTriggerNDigits
    *
@@ -133,7 +219,66 @@ protected:
    * Currently setup with the optional 'test' argument which runs the algorithm with half the hit threshold
    * for testing purposes. Triggers issued in this mode have type kTriggerNDigitsTest
    */
-  void AlgNDigits(WCSimWCDigitsCollection* WCDCPMT, bool remove_hits, bool test=false);
+  void AlgNDigits(unsigned int ignore_mask, bool test=false);
+
+  /**
+   * \brief A local NHits trigger algorithm
+   *
+   * Slides a short (specified) time window along the time-sorted digits, counting the number of hit PMTs
+   * in each neighbourhood of the detector: either each mPMT, or the PMTs within a (specified) radius of each PMT.
+   * If the count in any neighbourhood passes above a (specified) threshold, a trigger is issued.
+   * Digits with any of the bits in ignore_mask set (see MaskDigitsInTriggerWindows()) are not counted
+   *
+   * Each digit enters and leaves the window once, and updates only the neighbourhoods its PMT is in,
+   * so the cost is linear in the number of digits
+   *
+   * The trigger type is kTriggerLocalNHits
+   *
+   * The trigger time is the time of the digit that took the neighbourhood above threshold
+   *
+   * The trigger information is the number of hit PMTs in the neighbourhood,
+   * and the neighbourhood ID (the mPMT ID, or the tube ID of the PMT at the centre)
+   */
+  void AlgLocalNHits(unsigned int ignore_mask);
+
+  /**
+   * \brief A time-of-flight corrected, vertex scanning trigger algorithm
+   *
+   * For each vertex of a (specified spacing) grid filling the detector, subtracts the
+   * precomputed time-of-flight to each PMT from the digit times, and counts the digits
+   * in a short (specified) window of the corrected times (see WCSimTOFGrid::Scan()).
+   * If the count for any vertex passes above a (specified) threshold, a trigger is issued.
+   * Digits with any of the bits in ignore_mask set (see MaskDigitsInTriggerWindows()) are not counted
+   *
+   * The trigger type is kTriggerTOFScan
+   *
+   * The trigger time is in detector time, like that of the other triggers: the start of the
+   * TOF-corrected window plus the shortest TOF from the best vertex to a PMT, i.e. the earliest
+   * time a digit from light emitted at the start of the window can have
+   *
+   * The trigger information is the number of digits in the window, the x, y, z (cm) of the best vertex,
+   * and the start of the window in TOF-corrected time (i.e. the vertex time, ns)
+   */
+  void AlgTOFScan(unsigned int ignore_mask);
+
+  /**
+   * \brief Continuous (triggerless) readout
+   *
+   * Splits the digits in [timeSliceLow, timeSliceHigh) into consecutive, fixed (specified) length time slices [k * length, (k+1) * length),
+   * and writes each slice, as soon as it is complete, as one entry of the wcsimSliceT output tree
+   * (see WCSimRunAction::FillTimeSlice()). Every slice from the first to the last digit of the event is written, including empty ones,
+   * also when the event is digitized in several chunks (i.e. several calls, see SetTimeSliceRange() & BeginTimeSlices())
+   * In a slice, the digits are sorted by time then tube, and their times are not offset
+   *
+   * No triggers are issued, so nothing is added to the output digits collection
+   */
+  void AlgTimeSlices(WCSimWCDigitsCollection* WCDCPMT);
+
+  ///Set stage_mask on every digit inside the readout windows of triggers [first_trigger, NumberOfGatesInThisEvent()), hiding them from later algorithms that ignore stage_mask
+  void MaskDigitsInTriggerWindows(unsigned int first_trigger, unsigned int stage_mask);
+
+  std::vector<SortedDigit>  SortedDigits; ///< All input digits, sorted by time. Built once per event, shared by all trigger algorithms
+  std::vector<unsigned int> DigitMasks;   ///< Per digit (parallel to SortedDigits) bitmask. Bit n set if pipeline stage n has claimed the digit
 
   WCSimWCTriggeredDigitsCollection*   DigitsCollection; ///< The main output of the class - collection of digits in the trigger window
   std::map<int,int>          DigiHitMap; ///< Keeps track of the PMTs that have been added to the output WCSimWCTriggeredDigitsCollection
@@ -145,12 +290,14 @@ protected:
   WCSimWCDAQMessenger*       DAQMessenger; ///< Get the options from the .mac file
   WCSimDetectorConstruction* myDetector;   ///< Know about the detector, so can add appropriate PMT time smearing
 
-  /// Clear the Trigger* vectors and DigiHitMap
+  /// Clear the Trigger* vectors, DigiHitMap, and the digit view
   void ReInitialize() {
     TriggerTimes.clear(); 
     TriggerTypes.clear(); 
     TriggerInfos.clear(); 
     DigiHitMap.clear();
+    SortedDigits.clear();
+    DigitMasks.clear();
   }
 
   double PMTDarkRate;    ///< Dark noise rate of the PMTs
@@ -163,6 +310,27 @@ protected:
   G4bool ndigitsAdjustForNoise;    ///< Automatically adjust the NDigits trigger threshold based on the average dark noise rate?
   G4int  ndigitsPreTriggerWindow;  ///< The pretrigger window to save before an NDigits trigger
   G4int  ndigitsPostTriggerWindow; ///< The posttrigger window to save after an NDigits trigger
+  //LocalNHits
+  G4int    localNHitsThreshold;         ///< The threshold for the LocalNHits trigger
+  G4int    localNHitsWindow;            ///< The time window for the LocalNHits trigger
+  G4double localNHitsNeighbourRadius;   ///< The neighbourhood radius (cm) for the LocalNHits trigger. 0 means group by mPMT
+  G4int    localNHitsPreTriggerWindow;  ///< The pretrigger window to save before a LocalNHits trigger
+  G4int    localNHitsPostTriggerWindow; ///< The posttrigger window to save after a LocalNHits trigger
+  //TOFScan
+  G4int    tofScanThreshold;         ///< The threshold for the TOFScan trigger
+  G4int    tofScanWindow;            ///< The TOF-corrected time window for the TOFScan trigger
+  G4double tofScanGridSpacing;       ///< The spacing (cm) of the TOFScan vertex grid
+  G4int    tofScanNThreads;          ///< The number of threads used by the TOFScan trigger
+  G4double tofScanMaxTableSize;      ///< The largest TOF table (MB) the TOFScan trigger may allocate
+  G4int    tofScanPreTriggerWindow;  ///< The pretrigger window to save before a TOFScan trigger
+  G4int    tofScanPostTriggerWindow; ///< The posttrigger window to save after a TOFScan trigger
+  //Continuous readout
+  G4int    timeSliceLength;          ///< The length of the continuous readout time slices
+  G4int    timeSlicesPerChunk;       ///< The number of continuous readout time slices digitized at once
+  double   timeSliceLow;             ///< Only the digits in [timeSliceLow, timeSliceHigh) are written in time slices
+  double   timeSliceHigh;
+  int      nextTimeSlice;            ///< The next time slice of the event to write
+  bool     timeSliceStarted;         ///< Has a time slice of the event been written yet?
   //Save failures
   G4int    saveFailuresMode;              ///< The mode for saving events which don't pass triggers
   G4double saveFailuresTime;              ///< The dummy trigger time for failed events
@@ -177,8 +345,29 @@ private:
   ///modify the NDigits threshold based on the average dark noise rate
   void AdjustNDigitsThresholdForNoise();
 
-  ///takes all trigger times, then loops over all Digits & fills the output DigitsCollection
-  void FillDigitsCollection(WCSimWCDigitsCollection* WCDCPMT, bool remove_hits, TriggerType_t save_triggerType);
+  ///fills the LocalNHits neighbourhood lists from the geometry table. Called once, on the first use of AlgLocalNHits()
+  void BuildLocalNeighbourhoods();
+
+  //LocalNHits neighbourhoods, in compressed row format:
+  // the neighbourhoods that tube t is in are LocalGroupList[LocalGroupStart[t]] to LocalGroupList[LocalGroupStart[t+1]-1]
+  std::vector<int> LocalGroupStart; ///< Indexed by tube ID
+  std::vector<int> LocalGroupList;  ///< Neighbourhood indices
+  std::vector<int> LocalGroupID;    ///< Per neighbourhood, the ID saved in the trigger information
+  bool localNeighbourhoodsBuilt;
+
+  ///fills TOFGrid & TOFRowOfTube from the geometry table. Called once, on the first use of AlgTOFScan().
+  ///Exits if the TOF table would be larger than tofScanMaxTableSize
+  void BuildTOFGrid();
+
+  WCSimTOFGrid     TOFGrid;      ///< The TOFScan vertex grid & TOF table
+  std::vector<int> TOFRowOfTube; ///< Indexed by tube ID, the PMT row in TOFGrid (-1 if none)
+  bool tofGridBuilt;
+
+  ///fills SortedDigits & DigitMasks from the input collection
+  void BuildSortedDigits(WCSimWCDigitsCollection* WCDCPMT);
+
+  ///takes all trigger times (from all algorithms), then fills the output DigitsCollection with the digits in each trigger window
+  void FillDigitsCollection(WCSimWCDigitsCollection* WCDCPMT);
 
   ///sort the Trigger vectors (Time, Type, Info) by Trigger Time
   void SortTriggersByTime() {
@@ -202,11 +391,50 @@ private:
   }
   
   //static const double offset;        ///< Hit time offset (ns)
-  static const double LongTime;      ///< An arbitrary long time to use in loops (ns)
 
   bool   digitizeCalled; ///< Has Digitize() been called yet?
 };
 
+// *******************************************
+// TRIGGER REGISTRY
+// *******************************************
+
+/**
+ * \class WCSimWCTriggerRegistry
+ *
+ * \brief Maps /DAQ/Trigger choices to trigger classes
+ *
+ * Trigger classes add themselves with WCSIM_REGISTER_TRIGGER(choice, class) in their .cc file.
+ * WCSimEventAction creates the chosen class with Create(), and WCSimWCDAQMessenger
+ * gets the list of valid /DAQ/Trigger choices from GetChoices()
+ */
+
+typedef WCSimWCTriggerBase* (*WCSimWCTriggerCreator)(G4String, WCSimDetectorConstruction*, WCSimWCDAQMessenger*);
+
+class WCSimWCTriggerRegistry
+{
+public:
+  static WCSimWCTriggerRegistry & Instance();
+
+  ///Add a trigger class. Returns true, so it can be used to initialise a static
+  bool Register(G4String choice, WCSimWCTriggerCreator creator);
+  ///Create the trigger class for choice. Returns NULL if choice is not registered
+  WCSimWCTriggerBase* Create(G4String choice, G4String name, WCSimDetectorConstruction*, WCSimWCDAQMessenger*) const;
+  ///Space separated list of the registered choices
+  G4String GetChoices() const;
+
+private:
+  WCSimWCTriggerRegistry() {}
+  std::map<G4String, WCSimWCTriggerCreator> creators;
+};
+
+#define WCSIM_REGISTER_TRIGGER(CHOICE, CLASS)				\
+  namespace {								\
+    WCSimWCTriggerBase* Create##CLASS(G4String name, WCSimDetectorConstruction* det, WCSimWCDAQMessenger* messenger) \
+    { return new CLASS(name, det, messenger); }				\
+    const bool Registered##CLASS = WCSimWCTriggerRegistry::Instance().Register(CHOICE, Create##CLASS); \
+  }
+
 // *******************************************
 // CONTAINER CLASS
 // *******************************************
@@ -233,9 +461,9 @@ public:
   inline void SetPe    (G4int gate, G4float Q) {   pe.insert(std::pair<int,float>(gate,Q)); }
   inline void SetTime  (G4int gate, G4float T) { time.insert(std::pair<int,float>(gate,T)); }
 
-  /// Add a whole vector for one digit to fDigiComp. Clear input vector once added.
+  /// Add a whole vector for one digit to fDigiComp. The input vector is moved in, so is empty once added.
   void AddDigiCompositionInfo(G4int gate, std::vector<int> &digi_comp){
-    fDigiComp.insert(std::pair<int, std::vector<int> >(gate, digi_comp));
+    fDigiComp.insert(std::pair<int, std::vector<int> >(gate, std::vector<int>()))->second.swap(digi_comp);
     digi_comp.clear();
   }
 
@@ -336,8 +564,10 @@ private:
 /**
  * \class WCSimWCTriggerNDigits2
  *
- * \brief An (incomplete) example of running two trigger algorithms, one after the other
+ * \brief An example of a trigger pipeline: two trigger algorithms, one after the other
  *
+ * The second algorithm (NDigits with half the threshold) only sees the digits outside the
+ * readout windows of the first (NDigits)
  */
 
 class WCSimWCTriggerNDigits2 : public WCSimWCTriggerBase
@@ -360,5 +590,88 @@ private:
 };
 
 
+/**
+ * \class WCSimWCTriggerLocalNHits
+ *
+ * \brief A trigger on coincidences within an mPMT, or within a neighbourhood of PMTs
+ *
+ * For mPMT detectors, where dark noise summed over the whole detector forces a high NDigits threshold
+ */
+
+class WCSimWCTriggerLocalNHits : public WCSimWCTriggerBase
+{
+public:
+
+  ///Create WCSimWCTriggerLocalNHits instance with knowledge of the detector and DAQ options
+  WCSimWCTriggerLocalNHits(G4String name, WCSimDetectorConstruction*, WCSimWCDAQMessenger*);
+
+  ~WCSimWCTriggerLocalNHits();
+
+private:
+  ///Calls the workhorse of this class: AlgLocalNHits
+  void DoTheWork(WCSimWCDigitsCollection* WCDCPMT);
+
+  bool GetDefaultMultiDigitsPerTrigger()    { return false; } ///< SKI saves only earliest digit on a PMT in the trigger window
+  int  GetDefaultTriggerOffset() { return 950;   }
+};
+
+
+/**
+ * \class WCSimWCTriggerTOFScan
+ *
+ * \brief A trigger on the number of digits in a short window after subtracting the time-of-flight from candidate vertices
+ *
+ * Similar to the SK low energy software triggers. For low energy events, whose digits are spread
+ * by the time-of-flight over a longer window than their true time spread
+ */
+
+class WCSimWCTriggerTOFScan : public WCSimWCTriggerBase
+{
+public:
+
+  ///Create WCSimWCTriggerTOFScan instance with knowledge of the detector and DAQ options
+  WCSimWCTriggerTOFScan(G4String name, WCSimDetectorConstruction*, WCSimWCDAQMessenger*);
+
+  ~WCSimWCTriggerTOFScan();
+
+private:
+  ///Calls the workhorse of this class: AlgTOFScan
+  void DoTheWork(WCSimWCDigitsCollection* WCDCPMT);
+
+  bool GetDefaultMultiDigitsPerTrigger()    { return false; } ///< SKI saves only earliest digit on a PMT in the trigger window
+  int  GetDefaultTriggerOffset() { return 950;   }
+};
+
+
+/**
+ * \class WCSimWCTriggerContinuous
+ *
+ * \brief Continuous (triggerless) readout: all digits are written in consecutive fixed-length time slices
+ *
+ * For beam spill and supernova studies. The slices are written to wcsimSliceT, rather than as trigger gates in wcsimT
+ *
+ * WCSimEventAction digitizes the event in chunks of /DAQ/TriggerContinuous/SlicesPerChunk slices, so only the
+ * PMT signals, digits and SortedDigits of one chunk are in memory at a time. The Geant4 hits of the event are still all held.
+ * SaveFailures is ignored: it would save all the digits of the event in wcsimT
+ */
+
+class WCSimWCTriggerContinuous : public WCSimWCTriggerBase
+{
+public:
+
+  ///Create WCSimWCTriggerContinuous instance with knowledge of the detector and DAQ options
+  WCSimWCTriggerContinuous(G4String name, WCSimDetectorConstruction*, WCSimWCDAQMessenger*);
+
+  ~WCSimWCTriggerContinuous();
+
+private:
+  ///Calls the workhorse of this class: AlgTimeSlices
+  void DoTheWork(WCSimWCDigitsCollection* WCDCPMT);
+
+  bool GetDefaultMultiDigitsPerTrigger()    { return true;  } ///< Irrelevant: there are no trigger windows
+  int  GetDefaultTriggerOffset() { return 950;   }
+};
+
+
 
 #endif //WCSimWCTrigger_h
@@ -0,0 +1,381 @@
+#include <iostream>
+#include <string>
+#include <vector>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+#include <atomic>
+
+#include <RVersion.h>
+#include <TROOT.h>
+#include <TFile.h>
+#include <TTree.h>
+#include <TChain.h>
+#include <TStreamerInfo.h>
+#if ROOT_VERSION_CODE < ROOT_VERSION(6,0,0)
+#include <TThread.h>
+#endif
+
+#include "WCSimRootEvent.hh"
+#include "WCSimRootGeom.hh"
+#include "WCSimRootOptions.hh"
+
+/* Merges the default ROOT output (wcsimT, wcsimGeoT, wcsimRootOptionsT,
+ * fRooTrackerOutputTree, wcsimSliceT & Settings) of many WCSim jobs into a single file.
+ *
+ * - The geometry and options of every input file are checked against the first
+ *   file (in parallel), and only a single copy of each is written
+ * - wcsimT is concatenated basket-by-basket, without the events being
+ *   unzipped/streamed (fast). The event numbers in the merged file are written
+ *   to the small wcsimMergeT tree instead, a friend of wcsimT with one entry per
+ *   event: the new event number (the entry number in the merged file), the index
+ *   of the input file and the entry number in that file.
+ *   With -r the event headers are renumbered instead, which needs the events to
+ *   be read in & written out again (slow); with -n neither is done
+ * - fRooTrackerOutputTree & wcsimSliceT are always copied basket-by-basket (fast),
+ *   so the continuous readout slices keep their original event numbers
+ * - With ROOT 6, -j also enables ROOT implicit multi-threading for
+ *   the (de)compression of the event tree
+ */
+
+void Usage(const char * name) {
+  std::cout << "Usage: " << name << " [-j nthreads] [-r | -n] [-f] -o output.root input1.root [input2.root ...]" << std::endl
+	    << "  -o output.root : the merged file" << std::endl
+	    << "  -j nthreads    : number of threads to use (default 1)" << std::endl
+	    << "  -r             : renumber the event headers, rather than writing the event numbers to wcsimMergeT."
+	    << " The event tree is then unzipped & streamed (slow)" << std::endl
+	    << "  -n             : don't renumber the events at all (no wcsimMergeT)" << std::endl
+	    << "  -f             : force overwriting of output.root" << std::endl;
+}
+
+// Options that must be the same in all the input files. why is set to the first one that differs
+bool CompareOptions(WCSimRootOptions * a, WCSimRootOptions * b, std::string & why) {
+#define WCSIM_COMPARE_OPTION(getter)					\
+  if(a->getter() != b->getter()) { why = #getter; return false; }
+  WCSIM_COMPARE_OPTION(GetDetectorName);
+  WCSIM_COMPARE_OPTION(GetSavePi0);
+  WCSIM_COMPARE_OPTION(GetPMTQEMethod);
+  WCSIM_COMPARE_OPTION(GetPMTCollEff);
+  WCSIM_COMPARE_OPTION(GetPMTDarkRate);
+  WCSIM_COMPARE_OPTION(GetConvRate);
+  WCSIM_COMPARE_OPTION(GetDarkHigh);
+  WCSIM_COMPARE_OPTION(GetDarkLow);
+  WCSIM_COMPARE_OPTION(GetDarkWindow);
+  WCSIM_COMPARE_OPTION(GetDarkMode);
+  WCSIM_COMPARE_OPTION(GetOverlayFiles);
+  WCSIM_COMPARE_OPTION(GetOverlayRates);
+  WCSIM_COMPARE_OPTION(GetOverlayOffsets);
+  WCSIM_COMPARE_OPTION(GetOverlayWindowLow);
+  WCSIM_COMPARE_OPTION(GetOverlayWindowHigh);
+  WCSIM_COMPARE_OPTION(GetDigitizerClassName);
+  WCSIM_COMPARE_OPTION(GetDigitizerDeadTime);
+  WCSIM_COMPARE_OPTION(GetDigitizerIntegrationWindow);
+  WCSIM_COMPARE_OPTION(GetDigitizerTimingPrecision);
+  WCSIM_COMPARE_OPTION(GetDigitizerPEPrecision);
+  WCSIM_COMPARE_OPTION(GetTriggerClassName);
+  WCSIM_COMPARE_OPTION(GetMultiDigitsPerTrigger);
+  WCSIM_COMPARE_OPTION(GetNDigitsThreshold);
+  WCSIM_COMPARE_OPTION(GetNDigitsWindow);
+  WCSIM_COMPARE_OPTION(GetNDigitsAdjustForNoise);
+  WCSIM_COMPARE_OPTION(GetNDigitsPreTriggerWindow);
+  WCSIM_COMPARE_OPTION(GetNDigitsPostTriggerWindow);
+  WCSIM_COMPARE_OPTION(GetTriggerOffset);
+  WCSIM_COMPARE_OPTION(GetLocalNHitsThreshold);
+  WCSIM_COMPARE_OPTION(GetLocalNHitsWindow);
+  WCSIM_COMPARE_OPTION(GetLocalNHitsNeighbourRadius);
+  WCSIM_COMPARE_OPTION(GetLocalNHitsPreTriggerWindow);
+  WCSIM_COMPARE_OPTION(GetLocalNHitsPostTriggerWindow);
+  WCSIM_COMPARE_OPTION(GetTOFScanThreshold);
+  WCSIM_COMPARE_OPTION(GetTOFScanWindow);
+  WCSIM_COMPARE_OPTION(GetTOFScanGridSpacing);
+  WCSIM_COMPARE_OPTION(GetTOFScanPreTriggerWindow);
+  WCSIM_COMPARE_OPTION(GetTOFScanPostTriggerWindow);
+  WCSIM_COMPARE_OPTION(GetTimeSliceLength);
+  WCSIM_COMPARE_OPTION(GetSaveFailuresMode);
+  WCSIM_COMPARE_OPTION(GetSaveFailuresTime);
+  WCSIM_COMPARE_OPTION(GetSaveFailuresPreTriggerWindow);
+  WCSIM_COMPARE_OPTION(GetSaveFailuresPostTriggerWindow);
+  WCSIM_COMPARE_OPTION(GetRayff);
+  WCSIM_COMPARE_OPTION(GetBsrff);
+  WCSIM_COMPARE_OPTION(GetAbwff);
+  WCSIM_COMPARE_OPTION(GetRgcff);
+  WCSIM_COMPARE_OPTION(GetMieff);
+  WCSIM_COMPARE_OPTION(GetTvspacing);
+  WCSIM_COMPARE_OPTION(GetTopveto);
+  WCSIM_COMPARE_OPTION(GetPhysicsListName);
+  WCSIM_COMPARE_OPTION(GetPhotonWeight);
+  WCSIM_COMPARE_OPTION(GetPhotonBudget);
+  WCSIM_COMPARE_OPTION(GetFastOpticsTable);
+  WCSIM_COMPARE_OPTION(GetFastOpticsConeSamples);
+  WCSIM_COMPARE_OPTION(GetGeneratorType);
+  WCSIM_COMPARE_OPTION(GetRandomGenerator);
+  WCSIM_COMPARE_OPTION(GetSaveHitTimes);
+  WCSIM_COMPARE_OPTION(GetSavePhotonStartTime);
+  WCSIM_COMPARE_OPTION(GetSavePhotonStartPos);
+  WCSIM_COMPARE_OPTION(GetSavePhotonEndPos);
+  WCSIM_COMPARE_OPTION(GetSaveTracks);
+#undef WCSIM_COMPARE_OPTION
+  //RandomSeed & VectorFileName are different for every job
+  return true;
+}
+
+bool CompareGeometry(WCSimRootGeom * a, WCSimRootGeom * b, std::string & why) {
+  const float tolerance = 1E-3; //cm
+  if(a->GetGeo_Type() != b->GetGeo_Type()) { why = "Geo_Type"; return false; }
+  if(a->GetWCNumPMT() != b->GetWCNumPMT()) { why = "WCNumPMT"; return false; }
+  if(a->GetOrientation() != b->GetOrientation()) { why = "Orientation"; return false; }
+  if(std::fabs(a->GetWCCylRadius() - b->GetWCCylRadius()) > tolerance) { why = "WCCylRadius"; return false; }
+  if(std::fabs(a->GetWCCylLength() - b->GetWCCylLength()) > tolerance) { why = "WCCylLength"; return false; }
+  if(std::fabs(a->GetWCPMTRadius() - b->GetWCPMTRadius()) > tolerance) { why = "WCPMTRadius"; return false; }
+  for(int j = 0; j < 3; j++)
+    if(std::fabs(a->GetWCOffset(j) - b->GetWCOffset(j)) > tolerance) { why = "WCOffset"; return false; }
+  for(int i = 0; i < a->GetWCNumPMT(); i++) {
+    WCSimRootPMT pa = a->GetPMT(i);
+    WCSimRootPMT pb = b->GetPMT(i);
+    if(pa.GetTubeNo() != pb.GetTubeNo() ||
+       pa.GetmPMTNo() != pb.GetmPMTNo() ||
+       pa.GetmPMT_PMTNo() != pb.GetmPMT_PMTNo() ||
+       pa.GetCylLoc() != pb.GetCylLoc()) {
+      why = "PMT IDs"; return false;
+    }
+    for(int j = 0; j < 3; j++) {
+      if(std::fabs(pa.GetPosition(j) - pb.GetPosition(j)) > tolerance ||
+	 std::fabs(pa.GetOrientation(j) - pb.GetOrientation(j)) > tolerance) {
+	why = "PMT positions/orientations"; return false;
+      }
+    }
+  }
+  return true;
+}
+
+// Read the first entry of a single-entry tree (geometry/options) into obj
+template<class T> bool ReadSingleEntry(TFile * f, const char * treename, const char * branchname, T *& obj) {
+  TTree * t = (TTree*)f->Get(treename);
+  if(!t || t->GetEntries() < 1)
+    return false;
+  t->SetBranchAddress(branchname, &obj);
+  t->GetEntry(0);
+  t->ResetBranchAddresses();
+  return true;
+}
+
+// Returns an empty string if filename is consistent with the reference geometry & options
+std::string CheckFile(const std::string & filename, WCSimRootGeom * refgeo, WCSimRootOptions * refopt) {
+  TFile * f = TFile::Open(filename.c_str(), "READ");
+  if(!f || f->IsZombie()) {
+    delete f;
+    return "could not be opened";
+  }
+  std::string why;
+  WCSimRootGeom * geo = 0;
+  WCSimRootOptions * opt = 0;
+  if(!ReadSingleEntry(f, "wcsimGeoT", "wcsimrootgeom", geo))
+    why = "has no wcsimGeoT";
+  else if(!ReadSingleEntry(f, "wcsimRootOptionsT", "wcsimrootoptions", opt))
+    why = "has no wcsimRootOptionsT";
+  else if(!CompareGeometry(refgeo, geo, why))
+    why = "has a different geometry: " + why;
+  else if(!CompareOptions(refopt, opt, why))
+    why = "has different options: " + why;
+  else if(!f->Get("wcsimT"))
+    why = "has no wcsimT";
+  delete geo;
+  delete opt;
+  f->Close();
+  delete f;
+  return why;
+}
+
+int main(int argc, char ** argv)
+{
+  std::string outname;
+  std::vector<std::string> innames;
+  int nthreads = 1;
+  enum { kMergeTree, kHeaders, kNone } renumber = kMergeTree;
+  bool force = false;
+  for(int i = 1; i < argc; i++) {
+    if(!strcmp(argv[i], "-o") && i + 1 < argc)
+      outname = argv[++i];
+    else if(!strcmp(argv[i], "-j") && i + 1 < argc)
+      nthreads = atoi(argv[++i]);
+    else if(!strcmp(argv[i], "-r"))
+      renumber = kHeaders;
+    else if(!strcmp(argv[i], "-n"))
+      renumber = kNone;
+    else if(!strcmp(argv[i], "-f"))
+      force = true;
+    else if(!strcmp(argv[i], "-h") || !strcmp(argv[i], "--help")) {
+      Usage(argv[0]);
+      return 0;
+    }
+    else if(argv[i][0] == '-') {
+      std::cerr << "Unknown option " << argv[i] << std::endl;
+      Usage(argv[0]);
+      return -1;
+    }
+    else
+      innames.push_back(argv[i]);
+  }
+  if(outname.empty() || innames.empty()) {
+    Usage(argv[0]);
+    return -1;
+  }
+  if(nthreads < 1)
+    nthreads = 1;
+
+#if ROOT_VERSION_CODE >= ROOT_VERSION(6,0,0)
+  ROOT::EnableThreadSafety();
+#ifdef R__USE_IMT
+  if(nthreads > 1)
+    ROOT::EnableImplicitMT(nthreads);
+#endif
+#else
+  TThread::Initialize();
+#endif
+
+  // Same as WCSimRunAction
+  WCSimRootEvent::Class()->GetStreamerInfo()->Optimize(kFALSE);
+  WCSimRootTrigger::Class()->GetStreamerInfo()->Optimize(kFALSE);
+
+  // The first file is the reference for geometry and options
+  TFile * reffile = TFile::Open(innames[0].c_str(), "READ");
+  if(!reffile || reffile->IsZombie()) {
+    std::cerr << "Could not open " << innames[0] << std::endl;
+    return -1;
+  }
+  WCSimRootGeom * refgeo = 0;
+  WCSimRootOptions * refopt = 0;
+  if(!ReadSingleEntry(reffile, "wcsimGeoT", "wcsimrootgeom", refgeo) ||
+     !ReadSingleEntry(reffile, "wcsimRootOptionsT", "wcsimrootoptions", refopt)) {
+    std::cerr << innames[0] << " has no geometry/options tree. Is it a WCSim file?" << std::endl;
+    return -1;
+  }
+
+  // Check all the other files in parallel. Each thread opens its own files
+  std::vector<std::string> problems(innames.size());
+  std::atomic<size_t> next(1);
+  std::vector<std::thread> workers;
+  for(int it = 0; it < nthreads; it++) {
+    workers.push_back(std::thread([&]() {
+	  for(size_t ifile = next++; ifile < innames.size(); ifile = next++)
+	    problems[ifile] = CheckFile(innames[ifile], refgeo, refopt);
+	}));
+  }
+  for(size_t it = 0; it < workers.size(); it++)
+    workers[it].join();
+  bool ok = true;
+  for(size_t ifile = 1; ifile < innames.size(); ifile++) {
+    if(!problems[ifile].empty()) {
+      std::cerr << innames[ifile] << " " << problems[ifile] << std::endl;
+      ok = false;
+    }
+  }
+  if(!ok) {
+    std::cerr << "Input files are inconsistent with " << innames[0] << ". Not merging" << std::endl;
+    return -1;
+  }
+  std::cout << "Geometry and options of " << innames.size() << " files are consistent" << std::endl;
+
+  TFile * outfile = TFile::Open(outname.c_str(), force ? "RECREATE" : "CREATE", "WCSim ROOT file");
+  if(!outfile || outfile->IsZombie()) {
+    std::cerr << "Could not create " << outname << ". Use -f to overwrite an existing file" << std::endl;
+    return -1;
+  }
+  outfile->SetCompressionLevel(2);
+
+  // A single copy of the geometry, options & nuPRISM settings trees
+  const char * single_trees[3] = {"wcsimGeoT", "wcsimRootOptionsT", "Settings"};
+  for(int i = 0; i < 3; i++) {
+    TTree * t = (TTree*)reffile->Get(single_trees[i]);
+    if(!t) continue;
+    outfile->cd();
+    TTree * tout = t->CloneTree(-1, "fast");
+    tout->Write();
+  }
+
+  // The event tree
+  TChain events("wcsimT");
+  for(size_t ifile = 0; ifile < innames.size(); ifile++)
+    events.Add(innames[ifile].c_str());
+  Long64_t nevents = events.GetEntries();
+  outfile->cd();
+  if(renumber == kHeaders) {
+    WCSimRootEvent * wcsimrootsuperevent = 0;
+    events.SetBranchAddress("wcsimrootevent", &wcsimrootsuperevent);
+    TTree * eventsout = events.CloneTree(0);
+    int treenumber = -1;
+    for(Long64_t ievent = 0; ievent < nevents; ievent++) {
+      events.GetEntry(ievent);
+      if(events.GetTreeNumber() != treenumber) {
+	treenumber = events.GetTreeNumber();
+	std::cout << "Events from " << innames[treenumber] << " start at event " << ievent << std::endl;
+      }
+      // All the triggers in an event share the event number
+      for(int itrigger = 0; itrigger < wcsimrootsuperevent->GetNumberOfEvents(); itrigger++) {
+	WCSimRootEventHeader * header = wcsimrootsuperevent->GetTrigger(itrigger)->GetHeader();
+	header->Set(ievent, header->GetRun(), header->GetDate(), header->GetSubEvtNumber());
+      }
+      eventsout->Fill();
+    }
+    eventsout->Write();
+    events.ResetBranchAddresses();
+  }
+  else {
+    TTree * eventsout = events.CloneTree(0);
+    eventsout->CopyEntries(&events, -1, "fast");
+    if(renumber == kMergeTree) {
+      // The entry offset of each input file, from the tree headers only
+      Int_t event, file, fileentry;
+      TTree * mergeout = new TTree("wcsimMergeT", "Event numbers of the merged wcsimT");
+      mergeout->Branch("event", &event, "event/I");
+      mergeout->Branch("file", &file, "file/I");
+      mergeout->Branch("fileentry", &fileentry, "fileentry/I");
+      const Long64_t * offsets = events.GetTreeOffset();
+      for(file = 0; file < events.GetNtrees(); file++) {
+	std::cout << "Events from " << innames[file] << " start at event " << offsets[file] << std::endl;
+	for(Long64_t ievent = offsets[file]; ievent < offsets[file + 1]; ievent++) {
+	  event = ievent;
+	  fileentry = ievent - offsets[file];
+	  mergeout->Fill();
+	}
+      }
+      mergeout->Write();
+      // Read along with wcsimT from the same file, e.g. wcsimT->Draw("wcsimMergeT.event")
+      eventsout->AddFriend("wcsimMergeT");
+    }
+    eventsout->Write();
+  }
+  std::cout << "Merged " << nevents << " events" << std::endl;
+
+  // The RooTracker trees, if saved
+  if(reffile->Get("fRooTrackerOutputTree")) {
+    TChain vertices("fRooTrackerOutputTree");
+    for(size_t ifile = 0; ifile < innames.size(); ifile++)
+      vertices.Add(innames[ifile].c_str());
+    outfile->cd();
+    TTree * verticesout = vertices.CloneTree(0);
+    verticesout->CopyEntries(&vertices, -1, "fast");
+    verticesout->Write();
+  }
+
+  // The continuous readout time slices, if written
+  if(reffile->Get("wcsimSliceT")) {
+    TChain slices("wcsimSliceT");
+    for(size_t ifile = 0; ifile < innames.size(); ifile++)
+      slices.Add(innames[ifile].c_str());
+    outfile->cd();
+    TTree * slicesout = slices.CloneTree(0);
+    slicesout->CopyEntries(&slices, -1, "fast");
+    slicesout->Write();
+    std::cout << "Merged " << slices.GetEntries() << " time slices" << std::endl;
+  }
+
+  outfile->Close();
+  delete outfile;
+  delete refgeo;
+  delete refopt;
+  reffile->Close();
+  delete reffile;
+  return 0;
+}
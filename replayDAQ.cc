@@ -0,0 +1,243 @@
+#include <iostream>
+#include <fstream>
+#include <vector>
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+
+#include "WCSimHitLibrary.hh"
+#include "WCSimDAQDigitizer.hh"
+#include "WCSimDAQDarkNoise.hh"
+#include "WCSimDAQTrigger.hh"
+
+/* Runs the DAQ on a raw signal library (/WCSimIO/SaveRawSignalLibrary), without Geant4 or ROOT.
+ *
+ * Each library entry goes through the standalone DAQ library as in WCSim: dark noise (WCSimDAQDarkNoise),
+ * the SKI digitizer (WCSimDAQDigitizerSKI) and the NDigits trigger (WCSimDAQTrigger), with the WCSim
+ * defaults. The PMT response is generic (Gaussian single p.e. charge, the time resolution form of
+ * WCSimPMTObject), as the PMT type is not saved in the library.
+ *
+ * For each entry this prints the number of raw signals, digits & triggers, and (with -o) writes the
+ * triggers and their digits to a text file:
+ *   entry <entry> <ntriggers>
+ *   trigger <time> <ndigits in the NDigits window> <ndigits saved>
+ *   <tube> <time relative to the trigger + offset> <charge>
+ */
+
+namespace {
+  /// Random numbers from a seeded std::mt19937
+  class ReplayRandom : public WCSimDAQRandom {
+  public:
+    ReplayRandom(unsigned int seed) : engine(seed) {}
+    double Flat() { return std::uniform_real_distribution<double>(0, 1)(engine); }
+    double Gauss(double mean, double sigma) { return mean + sigma * normal(engine); }
+    long   Poisson(double mean) { return std::poisson_distribution<long>(mean)(engine); }
+  private:
+    std::mt19937 engine;
+    std::normal_distribution<double> normal; ///< Keeps the second of each pair of Gaussians
+  };
+
+  /// A PMT with the time resolution form of WCSimPMTObject
+  class ReplayPMTResponse : public WCSimDAQPMTResponse {
+  public:
+    float HitTimeSmearing(float Q, WCSimDAQRandom & random) {
+      float timingResolution = 0.33 + std::sqrt(2.0 / Q);
+      if(timingResolution < 0.58) timingResolution = 0.58;
+      return random.Gauss(0.0, timingResolution);
+    }
+    double SinglePE(WCSimDAQRandom & random) { return std::max(0., random.Gauss(1., 0.3)); }
+    /// The default pulse of WCSimPMTObject
+    double PulseShape(double t) { return t > 0 ? (t/8) * (t/8) * std::exp(2 - t/8) / 4 : 0; }
+    std::string PulseName() { return "replay"; }
+  };
+
+  struct RawSignal {
+    int   tube;
+    float time;
+    float charge;
+    bool operator<(const RawSignal & other) const {
+      return tube < other.tube || (tube == other.tube && time < other.time);
+    }
+  };
+}
+
+void Usage(const char * name) {
+  std::cout << "Usage: " << name << " [options] library" << std::endl
+	    << "  -p npmt      : number of PMTs, for the dark noise (default: the largest tube ID of the library)" << std::endl
+	    << "  -r darkrate  : dark rate (kHz, default 0: no dark noise)" << std::endl
+	    << "  -c conv      : dark rate conversion factor (default 1)" << std::endl
+	    << "  -m darkmode  : 0: dark noise in [darklow,darkhigh], 1: in windows of darkwindow around the signals (default 1)" << std::endl
+	    << "  -l darklow   : (ns, default 0)" << std::endl
+	    << "  -u darkhigh  : (ns, default 100000)" << std::endl
+	    << "  -d darkwindow: (ns, default 5000)" << std::endl
+	    << "  -w window    : digitizer integration window (ns, default 200)" << std::endl
+	    << "  -t deadtime  : digitizer dead time (ns, default 0)" << std::endl
+	    << "  -T threshold : NDigits trigger threshold (default 25)" << std::endl
+	    << "  -W window    : NDigits trigger window (ns, default 200)" << std::endl
+	    << "  -s seed      : random seed (default 1)" << std::endl
+	    << "  -e nentries  : number of entries to replay (default all)" << std::endl
+	    << "  -o file      : write the triggers & their digits to file" << std::endl;
+}
+
+int main(int argc, char ** argv)
+{
+  int npmt = 0, darkmode = 1, window = 200, deadtime = 0, threshold = 25, ndigitswindow = 200;
+  double darkrate = 0, conversion = 1, darklow = 0, darkhigh = 100000, darkwindow = 5000;
+  unsigned int seed = 1;
+  long nentries = -1;
+  const char * libname = 0, * outname = 0;
+  for(int i = 1; i < argc; i++) {
+    if(!strcmp(argv[i], "-h")) { Usage(argv[0]); return 0; }
+    else if(!strcmp(argv[i], "-p") && i + 1 < argc) npmt          = atoi(argv[++i]);
+    else if(!strcmp(argv[i], "-r") && i + 1 < argc) darkrate      = atof(argv[++i]);
+    else if(!strcmp(argv[i], "-c") && i + 1 < argc) conversion    = atof(argv[++i]);
+    else if(!strcmp(argv[i], "-m") && i + 1 < argc) darkmode      = atoi(argv[++i]);
+    else if(!strcmp(argv[i], "-l") && i + 1 < argc) darklow       = atof(argv[++i]);
+    else if(!strcmp(argv[i], "-u") && i + 1 < argc) darkhigh      = atof(argv[++i]);
+    else if(!strcmp(argv[i], "-d") && i + 1 < argc) darkwindow    = atof(argv[++i]);
+    else if(!strcmp(argv[i], "-w") && i + 1 < argc) window        = atoi(argv[++i]);
+    else if(!strcmp(argv[i], "-t") && i + 1 < argc) deadtime      = atoi(argv[++i]);
+    else if(!strcmp(argv[i], "-T") && i + 1 < argc) threshold     = atoi(argv[++i]);
+    else if(!strcmp(argv[i], "-W") && i + 1 < argc) ndigitswindow = atoi(argv[++i]);
+    else if(!strcmp(argv[i], "-s") && i + 1 < argc) seed          = atoi(argv[++i]);
+    else if(!strcmp(argv[i], "-e") && i + 1 < argc) nentries      = atol(argv[++i]);
+    else if(!strcmp(argv[i], "-o") && i + 1 < argc) outname       = argv[++i];
+    else if(argv[i][0] != '-' && !libname) libname = argv[i];
+    else { Usage(argv[0]); return 1; }
+  }
+  if(!libname) { Usage(argv[0]); return 1; }
+
+  WCSimHitLibrary library;
+  if(!library.Open(libname))
+    return 1;
+  if(library.GetLevel() != WCSimHitLibrary::kRawSignal) {
+    std::cerr << libname << " is not a raw signal library (/WCSimIO/SaveRawSignalLibrary)" << std::endl;
+    return 1;
+  }
+  if(nentries < 0 || (uint64_t)nentries > library.GetNumEntries())
+    nentries = library.GetNumEntries();
+  if(npmt <= 0) {
+    const WCSimHitLibraryHit * hits = library.GetEntry(0);
+    for(uint64_t ih = 0; ih < library.GetNumHits(); ih++)
+      npmt = std::max(npmt, (int)hits[ih].tube);
+  }
+  std::ofstream out;
+  if(outname) {
+    out.open(outname);
+    if(!out) {
+      std::cerr << "Could not open " << outname << std::endl;
+      return 1;
+    }
+  }
+
+  // The WCSim defaults of the SKI digitizer & NDigits trigger
+  WCSimDAQDigitizerSKI digitizer;
+  digitizer.SetIntegrationWindow(window);
+  digitizer.SetDeadTime(deadtime);
+  digitizer.SetTimingPrecision(0.4);
+  digitizer.SetPEPrecision(0);
+  const int pretrigger = -400, posttrigger = 950;
+  const double offset = 950;
+
+  ReplayRandom random(seed);
+  ReplayPMTResponse response;
+
+  std::cout << "Replaying " << nentries << " entries of " << libname << " (" << npmt << " PMTs)" << std::endl;
+  long totalsignals = 0, totaldigits = 0, totaltriggers = 0;
+  std::vector<RawSignal> signals;
+  std::vector<float> times;
+  std::vector<std::pair<float, float> > ranges;
+  std::vector<WCSimDAQDarkNoise::NoiseHit> noise;
+  WCSimDAQHits hits;
+  std::vector<WCSimDAQDigit> digits;
+  std::vector<WCSimDAQSortedDigit> sorted;
+  std::vector<unsigned int> masks;
+  std::vector<float> triggerTimes;
+  std::vector< std::vector<float> > triggerInfos;
+  std::vector<WCSimDAQTrigger::TriggeredDigit> selected;
+  for(long entry = 0; entry < nentries; entry++) {
+    // The raw signals, plus dark noise
+    const WCSimHitLibraryHit * entryhits = library.GetEntry(entry);
+    const uint64_t nsignals = library.GetEntrySize(entry);
+    signals.clear();
+    times.clear();
+    for(uint64_t ih = 0; ih < nsignals; ih++) {
+      RawSignal s = { entryhits[ih].tube, entryhits[ih].time, entryhits[ih].charge };
+      signals.push_back(s);
+      times.push_back(s.time);
+    }
+    if(darkrate > 0) {
+      ranges.clear();
+      if(darkmode == 1)
+	WCSimDAQDarkNoise::FindRanges(times, darkwindow, ranges);
+      else
+	ranges.push_back(std::pair<float, float>(darklow, darkhigh));
+      noise.clear();
+      for(size_t ir = 0; ir < ranges.size(); ir++)
+	WCSimDAQDarkNoise::Generate(npmt, darkrate, conversion, ranges[ir].first, ranges[ir].second,
+				    random, response, noise);
+      for(size_t in = 0; in < noise.size(); in++) {
+	RawSignal s = { noise[in].tube, noise[in].time, noise[in].charge };
+	signals.push_back(s);
+      }
+    }
+
+    // Digitize the signals of each PMT, sorted by time
+    std::sort(signals.begin(), signals.end());
+    hits.Clear();
+    for(size_t is = 0; is < signals.size(); is++) {
+      if(is == 0 || signals[is].tube != signals[is - 1].tube)
+	hits.AddPMT(signals[is].tube);
+      hits.AddHit(signals[is].time, signals[is].charge);
+    }
+    digits.clear();
+    digitizer.Digitize(hits, random, response, digits);
+
+    // Trigger
+    sorted.clear();
+    for(size_t id = 0; id < digits.size(); id++) {
+      WCSimDAQSortedDigit sd;
+      sd.time  = digits[id].time;
+      sd.pmt   = digits[id].pmt;
+      sd.tube  = hits.tube[digits[id].pmt];
+      sd.digit = id;
+      sorted.push_back(sd);
+    }
+    WCSimDAQTrigger::SortByTime(sorted);
+    masks.assign(sorted.size(), 0);
+    triggerTimes.clear();
+    triggerInfos.clear();
+    const int ntrig = WCSimDAQTrigger::NDigits(sorted, masks, 0, threshold, ndigitswindow, posttrigger,
+					       triggerTimes, triggerInfos);
+    selected.clear();
+    std::vector<int> pre(ntrig, pretrigger), post(ntrig, posttrigger);
+    WCSimDAQTrigger::SelectTriggeredDigits(sorted, triggerTimes, pre, post, false, offset, selected);
+
+    std::cout << "Entry " << entry << ": " << nsignals << " raw signals, " << noise.size()
+	      << " dark noise hits, " << digits.size() << " digits, " << ntrig << " triggers" << std::endl;
+    totalsignals += nsignals;
+    totaldigits += digits.size();
+    totaltriggers += ntrig;
+
+    if(outname) {
+      out << "entry " << entry << " " << ntrig << "\n";
+      size_t is = 0;
+      for(int it = 0; it < ntrig; it++) {
+	size_t ie = is;
+	while(ie < selected.size() && selected[ie].trigger == it)
+	  ie++;
+	out << "trigger " << triggerTimes[it] << " " << (triggerInfos[it].empty() ? 0 : triggerInfos[it][0])
+	    << " " << ie - is << "\n";
+	for(; is < ie; is++) {
+	  const WCSimDAQSortedDigit & sd = sorted[selected[is].digit];
+	  out << sd.tube << " " << selected[is].time << " " << digits[sd.digit].charge << "\n";
+	}
+      }
+    }
+  }
+  std::cout << "Total: " << totalsignals << " raw signals, " << totaldigits << " digits, "
+	    << totaltriggers << " triggers" << std::endl;
+  return 0;
+}
@@ -0,0 +1,242 @@
+#include "WCSimCoatedSurfaceTable.hh"
+
+#include "G4PhysicalConstants.hh"
+
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+WCSimCoatedSurfaceTable::WCSimCoatedSurfaceTable(const Model & model, G4double emin, G4double emax,
+						 G4int nenergy, G4int ncos, G4double tolerance)
+  : fEnergyMin(emin), fEnergyMax(emax),
+    fNEnergy(std::max(2, nenergy)), fNCos(std::max(2, ncos)),
+    fModelFraction(0), fMaxError(0)
+{
+  fEnergyStep = (fEnergyMax - fEnergyMin) / (fNEnergy - 1);
+  fCosStep    = 1. / (fNCos - 1);
+
+  fNodes.resize(fNEnergy * fNCos);
+  for(G4int ie = 0; ie < fNEnergy; ie++)
+    for(G4int ic = 0; ic < fNCos; ic++)
+      model(fEnergyMin + ie * fEnergyStep, ic * fCosStep, fNodes[ie * fNCos + ic]);
+
+  //check each cell on a 9 x 9 grid of points over it, less the corners (the nodes). Its edges are checked
+  // as well as its inside, as that is where the error is largest when the curvatures in energy & angle
+  // have opposite signs. The model has kinks (at the energies of the material property nodes) where the
+  // error can be up to 8/7 of that at the nearest point of the grid: so the points are checked against
+  // 3/4 of the tolerance
+  const G4int ngrid = 9;
+  const G4double checktolerance = 0.75 * tolerance;
+  std::vector<std::pair<G4double, G4double> > checks;
+  for(G4int jx = 0; jx < ngrid; jx++)
+    for(G4int jy = 0; jy < ngrid; jy++)
+      if((jx % (ngrid - 1)) || (jy % (ngrid - 1)))
+	checks.push_back(std::make_pair((G4double)jx / (ngrid - 1), (G4double)jy / (ngrid - 1)));
+
+  fTabulated.assign((fNEnergy - 1) * (fNCos - 1), 0);
+  G4int nmodel = 0;
+  for(G4int ie = 0; ie < fNEnergy - 1; ie++) {
+    for(G4int ic = 0; ic < fNCos - 1; ic++) {
+      //where the model is not a number at all the nodes (e.g. beyond the critical angle in Model1),
+      // the table gives the same
+      G4bool nan = true;
+      for(G4int je = ie; je <= ie + 1; je++)
+	for(G4int jc = ic; jc <= ic + 1; jc++)
+	  nan = nan && !Finite(fNodes[je * fNCos + jc]);
+
+      G4bool good = true;
+      G4double cellerror = 0;
+      for(size_t ip = 0; ip < checks.size() && good; ip++) {
+	WCSimCoatedCoefficients exact, table;
+	model(fEnergyMin + (ie + checks[ip].first) * fEnergyStep, (ic + checks[ip].second) * fCosStep, exact);
+	Bilinear(ie, ic, checks[ip].first, checks[ip].second, table);
+	if(nan) {
+	  good = !Finite(exact);
+	  continue;
+	}
+	const G4double error = std::max(std::max(std::fabs(table.Rs - exact.Rs), std::fabs(table.Rp - exact.Rp)),
+					std::max(std::fabs(table.Ts - exact.Ts), std::fabs(table.Tp - exact.Tp)));
+	const G4bool samesigns = (table.rs < 0) == (exact.rs < 0) && (table.rp < 0) == (exact.rp < 0)
+	  && (table.ts < 0) == (exact.ts < 0) && (table.tp < 0) == (exact.tp < 0);
+	good = Finite(exact) && Finite(table) && error <= checktolerance && samesigns;
+	cellerror = std::max(cellerror, error);
+      }
+      if(good) {
+	fTabulated[ie * (fNCos - 1) + ic] = 1;
+	fMaxError = std::max(fMaxError, cellerror);
+      }
+      else
+	nmodel++;
+    }
+  }
+  fModelFraction = (G4double)nmodel / fTabulated.size();
+}
+
+G4bool WCSimCoatedSurfaceTable::Finite(const WCSimCoatedCoefficients & c)
+{
+  return std::isfinite(c.Rs) && std::isfinite(c.Rp) && std::isfinite(c.Ts) && std::isfinite(c.Tp)
+    && std::isfinite(c.rs) && std::isfinite(c.rp) && std::isfinite(c.ts) && std::isfinite(c.tp);
+}
+
+void WCSimCoatedSurfaceTable::Bilinear(G4int ie, G4int ic, G4double fx, G4double fy, WCSimCoatedCoefficients & c) const
+{
+  const WCSimCoatedCoefficients & c00 = fNodes[ie * fNCos + ic];
+  const WCSimCoatedCoefficients & c01 = fNodes[ie * fNCos + ic + 1];
+  const WCSimCoatedCoefficients & c10 = fNodes[(ie + 1) * fNCos + ic];
+  const WCSimCoatedCoefficients & c11 = fNodes[(ie + 1) * fNCos + ic + 1];
+  const G4double w00 = (1 - fx) * (1 - fy), w01 = (1 - fx) * fy, w10 = fx * (1 - fy), w11 = fx * fy;
+  c.Rs = w00 * c00.Rs + w01 * c01.Rs + w10 * c10.Rs + w11 * c11.Rs;
+  c.Rp = w00 * c00.Rp + w01 * c01.Rp + w10 * c10.Rp + w11 * c11.Rp;
+  c.Ts = w00 * c00.Ts + w01 * c01.Ts + w10 * c10.Ts + w11 * c11.Ts;
+  c.Tp = w00 * c00.Tp + w01 * c01.Tp + w10 * c10.Tp + w11 * c11.Tp;
+  c.rs = w00 * c00.rs + w01 * c01.rs + w10 * c10.rs + w11 * c11.rs;
+  c.rp = w00 * c00.rp + w01 * c01.rp + w10 * c10.rp + w11 * c11.rp;
+  c.ts = w00 * c00.ts + w01 * c01.ts + w10 * c10.ts + w11 * c11.ts;
+  c.tp = w00 * c00.tp + w01 * c01.tp + w10 * c10.tp + w11 * c11.tp;
+}
+
+void WCSimCoatedSurfaceTable::Model1(G4double Rindex1, G4double Rindex2, G4double CoatedRindex, G4double CoatedThickness,
+				     G4bool FrustratedTransmission, G4double wavelength,
+				     G4double sint1, G4double sinTL, G4double costh1, G4double costh2,
+				     WCSimCoatedCoefficients & c)
+{
+  G4double gammaTL, costTL;
+
+  G4complex i(0, 1);
+  G4complex rTM, rTE;
+  G4complex r1toTL, rTLto2;
+  G4double k0 = 2 * pi / wavelength;
+
+  //only the reflection is used, the rest goes on to the absorption
+  c.Ts = c.Tp = 0;
+  c.rs = c.rp = c.ts = c.tp = 0;
+
+  // Angle > Angle limit
+  if (sinTL >= 1.0) {
+    if (FrustratedTransmission) { //Frustrated transmission
+
+      if (costh1 > 0.0)
+      {
+        gammaTL = std::sqrt(Rindex1 * Rindex1 * sint1 * sint1 -
+                   CoatedRindex * CoatedRindex);
+      }
+      else
+      {
+        gammaTL = -std::sqrt(Rindex1 * Rindex1 * sint1 * sint1 -
+                   CoatedRindex * CoatedRindex);
+      }
+
+      // TE
+      r1toTL = (Rindex1 * costh1 - i * gammaTL) / (Rindex1 * costh1 + i * gammaTL);
+      rTLto2 = (i * gammaTL - Rindex2 * costh2) / (i * gammaTL + Rindex2 * costh2);
+      if (costh1 != 0.0)
+      {
+        rTE = (r1toTL + rTLto2 * std::exp(-2 * k0 * CoatedThickness * gammaTL)) /
+                 (1.0 + r1toTL * rTLto2 * std::exp(-2 * k0 * CoatedThickness * gammaTL));
+      }
+      // TM
+      r1toTL = (Rindex1 * i * gammaTL - CoatedRindex * CoatedRindex * costh1) /
+                  (Rindex1 * i * gammaTL + CoatedRindex * CoatedRindex * costh1);
+      rTLto2 = (CoatedRindex * CoatedRindex * costh2 - Rindex2 * i * gammaTL) /
+                  (CoatedRindex * CoatedRindex * costh2 + Rindex2 * i * gammaTL);
+      if (costh1 != 0.0)
+      {
+        rTM = (r1toTL + rTLto2 * std::exp(-2 * k0 * CoatedThickness * gammaTL)) /
+                 (1.0 + r1toTL * rTLto2 * std::exp(-2 * k0 * CoatedThickness * gammaTL));
+      }
+    }
+    else
+    { //Total reflection
+      c.Rs = c.Rp = 1.;
+      return;
+    }
+  }
+
+  // Angle <= Angle limit
+  else //if (sinTL < 1.0)
+  {
+    if (costh1 > 0.0)
+    {
+      costTL = std::sqrt(1. - sinTL * sinTL);
+    }
+    else
+    {
+      costTL = -std::sqrt(1. - sinTL * sinTL);
+    }
+    // TE
+    r1toTL = (Rindex1 * costh1 - CoatedRindex * costTL) / (Rindex1 * costh1 + CoatedRindex * costTL);
+    rTLto2 = (CoatedRindex * costTL - Rindex2 * costh2) / (CoatedRindex * costTL + Rindex2 * costh2);
+    if (costh1 != 0.0)
+    {
+      rTE = (r1toTL + rTLto2 * std::exp(2.0 * i * k0 * CoatedRindex * CoatedThickness * costTL)) /
+            (1.0 + r1toTL * rTLto2 * std::exp(2.0 * i * k0 * CoatedRindex * CoatedThickness * costTL));
+    }
+    // TM
+    r1toTL = (Rindex1 * costTL - CoatedRindex * costh1) / (Rindex1 * costTL + CoatedRindex * costh1);
+    rTLto2 = (CoatedRindex * costh2 - Rindex2 * costTL) / (CoatedRindex * costh2 + Rindex2 * costTL);
+    if (costh1 != 0.0)
+    {
+      rTM = (r1toTL + rTLto2 * std::exp(2.0 * i * k0 * CoatedRindex * CoatedThickness * costTL)) /
+            (1.0 + r1toTL * rTLto2 * std::exp(2.0 * i * k0 * CoatedRindex * CoatedThickness * costTL));
+    }
+  }
+
+  c.Rs = real(rTE * conj(rTE));
+  c.Rp = real(rTM * conj(rTM));
+}
+
+void WCSimCoatedSurfaceTable::Model2(G4double Rindex1, G4double Rindex2, G4double CoatedRindex, G4double CoatedRindexIm,
+				     G4double CoatedThickness, G4double wavelength, G4double cost1, G4double sint1,
+				     WCSimCoatedCoefficients & c)
+{
+  // Calculate reflection and transmission probability from Eq. 2 of https://arxiv.org/abs/physics/0408075v1
+  // Rename the variables to match those in paper
+  G4complex i(0, 1);
+  G4complex r23p, r34p, t23p, t32p, t34p;
+  G4complex r23s, r34s, t23s, t32s, t34s;
+  G4complex rp, tp, rs, ts;
+  G4complex delta, costh2, costh3, costh4, sinth3, sinth4, n2, n3, n4;
+  n2 = Rindex1;
+  n3 = CoatedRindex-i*CoatedRindexIm;
+  n4 = Rindex2;
+
+  costh2 = cost1;
+  sinth3 = Rindex1*sint1/n3;
+  sinth4 = Rindex1*sint1/Rindex2;
+  costh3 = sqrt(1.-sinth3*sinth3);
+  if (cost1<0) costh3 *= -1;
+  costh4 = sqrt(1.-sinth4*sinth4);
+  if (cost1<0) costh4 *= -1;
+
+  // reflection and transmission coefficients
+  // TM =  p wave
+  r23p = (n2*costh3-n3*costh2)/(n2*costh3+n3*costh2);
+  t23p = 2.*n2*costh2/(n2*costh3+n3*costh2);
+  t32p = 2.*n3*costh3/(n2*costh3+n3*costh2);
+  r34p = (n3*costh4-n4*costh3)/(n3*costh4+n4*costh3);
+  t34p = 2.*n3*costh3/(n4*costh3+n3*costh4);
+
+  // TE = s wave
+  r23s = (n2*costh2-n3*costh3)/(n2*costh2+n3*costh3);
+  t23s = 2.*n2*costh2/(n2*costh2+n3*costh3);
+  t32s = 2.*n3*costh3/(n2*costh2+n3*costh3);
+  r34s = (n3*costh3-n4*costh4)/(n3*costh3+n4*costh4);
+  t34s = 2.*n3*costh3/(n3*costh3+n4*costh4);
+
+  delta = -2.*pi*CoatedThickness*n3/wavelength*costh3;
+
+  rp = r23p+(t23p*t32p*r34p*exp(2.*i*delta))/(1.+r23p*r34p*exp(2.*i*delta));
+  tp = t23p*t34p*exp(i*delta)/(1.+r23p*r34p*exp(2.*i*delta));
+  c.Rp = real(rp*conj(rp));
+  c.Tp = real(n4*costh4/n2/costh2*tp*conj(tp));
+
+  rs = r23s+(t23s*t32s*r34s*exp(2.*i*delta))/(1.+r23s*r34s*exp(2.*i*delta));
+  ts = t23s*t34s*exp(i*delta)/(1.+r23s*r34s*exp(2.*i*delta));
+  c.Rs = real(rs*conj(rs));
+  c.Ts = real(n4*costh4/n2/costh2*ts*conj(ts));
+
+  c.rp = real(rp);
+  c.rs = real(rs);
+  c.tp = real(tp);
+  c.ts = real(ts);
+}
@@ -1,5 +1,6 @@
 #include "WCSimDetectorConstruction.hh"
 #include "WCSimPmtInfo.hh"
+#include "WCSimGeometryTable.hh"
 
 #include "G4Material.hh"
 #include "G4Element.hh"
@@ -171,16 +172,10 @@ void WCSimDetectorConstruction::DescribeAndRegisterPMT(G4VPhysicalVolume* aPV ,i
 
 // Utilities to do stuff with the info we have found.
 
-// Output to WC geometry text file
+// Output to WC geometry binary file (see WCSimGeometryTable.hh for the layout)
 void WCSimDetectorConstruction::DumpGeometryTableToFile()
 {
-  // Open a file
-  std::string filename = "geofile_" + WCDetectorName + ".txt";
-  //geoFile.open("geofile.txt", std::ios::out);
-  geoFile.open(filename.c_str(), std::ios::out);
-
-  geoFile.precision(2);
-  geoFile.setf(std::ios::fixed);
+  geoTableFileName = "geofile_" + WCDetectorName + ".bin";
 
   // (JF) Get first tube transform for filling in detector radius
   // the height is still done with WCCylInfo above
@@ -188,18 +183,13 @@ void WCSimDetectorConstruction::DumpGeometryTableToFile()
   innerradius = sqrt(pow(firstTransform.getTranslation().getX()/cm,2)
                             + pow(firstTransform.getTranslation().getY()/cm,2));
 
+  // geo_type 0 is cylinder, 1 is the defunct mailbox, 2 is egg-shaped HyperK
+  WCSimGeometryTable table;
   if (isEggShapedHyperK){
-    geoFile << setw(8)<< 0;
-    geoFile << setw(8)<< 0;
+    table.SetDetector(2, 0, 0, WCPMTSize, 0, WCOffset(0), WCOffset(1), WCOffset(2));
   }else{
-    geoFile << setw(8)<< innerradius;
-    geoFile << setw(8)<<WCCylInfo[2];
+    table.SetDetector(0, innerradius, WCCylInfo[2], WCPMTSize, 0, WCOffset(0), WCOffset(1), WCOffset(2));
   }
-  geoFile << setw(10)<<totalNumPMTs;
-  geoFile << setw(8)<<WCPMTSize << setw(4)  <<G4endl;
-
-  geoFile << setw(8)<< WCOffset(0)<< setw(8)<<WCOffset(1)<<
-    setw(8) << WCOffset(2)<<G4endl;
 
   //G4double maxZ=0.0;// used to tell if pmt is on the top/bottom cap
   //G4double minZ=0.0;// or the barrel
@@ -231,19 +221,17 @@ void WCSimDetectorConstruction::DumpGeometryTableToFile()
     {cylLocation=0;}
     else // barrel
     {cylLocation=1;}
-    
-    geoFile.precision(9);
-     geoFile << setw(4) << tubeID
-	     << " " << setw(4) << mPMTIDMap[tubeID].first
-	     << " " << setw(4) << mPMTIDMap[tubeID].second 
- 	    << " " << setw(8) << newTransform.getTranslation().getX()/cm
- 	    << " " << setw(8) << newTransform.getTranslation().getY()/cm
- 	    << " " << setw(8) << newTransform.getTranslation().getZ()/cm
-	    << " " << setw(7) << pmtOrientation.x()
-	    << " " << setw(7) << pmtOrientation.y()
-	    << " " << setw(7) << pmtOrientation.z()
- 	    << " " << setw(3) << cylLocation
- 	    << G4endl;
+
+     table.AddPMT(tubeID,
+		  mPMTIDMap[tubeID].first,
+		  mPMTIDMap[tubeID].second,
+		  cylLocation,
+		  newTransform.getTranslation().getX()/cm,
+		  newTransform.getTranslation().getY()/cm,
+		  newTransform.getTranslation().getZ()/cm,
+		  pmtOrientation.x(),
+		  pmtOrientation.y(),
+		  pmtOrientation.z());
      
      WCSimPmtInfo *new_pmt = new WCSimPmtInfo(cylLocation,
 					      newTransform.getTranslation().getX()/cm,
@@ -259,9 +247,13 @@ void WCSimDetectorConstruction::DumpGeometryTableToFile()
      fpmts.push_back(new_pmt);
 
   }
-  geoFile.close();
 
-  std::cout << "Geofile written" << std::endl;
+  if(!table.Write(geoTableFileName)) {
+    G4cerr << "Could not write the geometry table " << geoTableFileName << ". Exiting..." << G4endl;
+    exit(-1);
+  }
+
+  G4cout << "Geofile " << geoTableFileName << " written" << G4endl;
 } 
 
 
@@ -0,0 +1,74 @@
+#include "WCSimDAQDarkNoise.hh"
+
+#include <algorithm>
+
+void WCSimDAQDarkNoise::FindRanges(const std::vector<float> & times, float width,
+				   std::vector<std::pair<float, float> > & result)
+{
+  //Assign a time window around each hit
+  //store these in the ranges vector as pairs
+  std::vector<std::pair<float, float> > ranges;
+  ranges.reserve(times.size());
+  for(size_t i = 0; i < times.size(); i++) {
+    //centre the window on the hit time
+    //t1 is the lower limit of the window.
+    float t1 = times[i] - width/2.;
+    float t2 = times[i] + width/2.;
+    ranges.push_back(std::pair<float, float>(t1, t2));
+  }
+
+  //we need to ensure that the ranges found above are sorted first
+  //for the algorithm below to work
+  std::sort(ranges.begin(), ranges.end());
+
+  //If there are no hits, set the result to have one element from 0 to 0 (so no noise digits will be added)
+  if(ranges.size() == 0) {
+    result.push_back(std::make_pair(0.,0.));
+    return;
+  }
+
+  //the ranges vector contains overlapping ranges
+  //this loop removes overlaps
+  //output are pairs stored in the result vector
+  std::vector<std::pair<float, float> >::iterator it = ranges.begin();
+  std::pair<float, float> current = *(it)++;
+  for( ; it != ranges.end(); it++) {
+    if (current.second >= it->first){
+      current.second = std::max(current.second, it->second);
+    }
+    else {
+      result.push_back(current);
+      current = *(it);
+    }
+  }
+  result.push_back(current);
+}
+
+void WCSimDAQDarkNoise::Generate(int npmt, double rate, double conversion, float low, float high,
+				 WCSimDAQRandom & random, WCSimDAQPMTResponse & response,
+				 std::vector<NoiseHit> & hits)
+{
+  //Calculate the time window size
+  double windowsize = high - low;
+
+  //average number of PMTs with noise
+  double ave = npmt * rate * conversion * windowsize * 1E-6;
+
+  //poisson distributed noise, number of noise hits to add
+  int nnoispmt = random.Poisson(ave);
+  hits.reserve(hits.size() + nnoispmt);
+
+  NoiseHit hit;
+  for(int i = 0; i < nnoispmt; i++) {
+    //time of noise hit to be generated
+    //A time from t=low to high
+    double current_time = low + random.Flat()*windowsize;
+
+    //now a random PMT.  Assuming noise levels are the same for
+    //each PMT.
+    hit.tube   = static_cast<int>( random.Flat() * npmt ) + 1; //so that pmt numbers runs from 1 to Npmt
+    hit.time   = current_time;
+    hit.charge = response.SinglePE(random);
+    hits.push_back(hit);
+  }
+}
@@ -0,0 +1,302 @@
+#include "WCSimDAQDigitizer.hh"
+#include "WCSimDAQParallel.hh"
+
+#include <algorithm>
+#include <iostream>
+#include <iterator>
+
+#ifndef WCSIMDAQDIGITIZER_VERBOSE
+//#define WCSIMDAQDIGITIZER_VERBOSE
+#endif
+
+#ifndef NPMTS_VERBOSE
+#define NPMTS_VERBOSE 10
+#endif
+
+WCSimDAQDigitizerSKI::WCSimDAQDigitizerSKI()
+  : DeadTime(0), IntegrationWindow(200), TimingPrecision(0.4), PEPrecision(0)
+{
+}
+
+void WCSimDAQDigitizerSKI::Threshold(double& pe, int& iflag, WCSimDAQRandom & random)
+{
+  double x = pe+0.1; iflag=0;
+  double thr; double RDUMMY,err;
+  if ( x<1.1) {
+    thr = std::min(1.0,
+		   -0.06374+x*(3.748+x*(-63.23+x*(452.0+x*(-1449.0+x*(2513.0
+								      +x*(-2529.+x*(1472.0+x*(-452.2+x*(51.34+x*2.370))))))))));
+  } else {
+    thr = 1.0;
+  }
+  RDUMMY = random.Flat();
+  if (thr < RDUMMY) {
+    pe = 0.0;
+    iflag = 1;
+  }
+  else {
+    err = random.Gauss(0.0,0.03);
+    /////      call rngaus(0.0, 0.03, err);
+    pe = pe+err;
+  }
+}
+
+bool WCSimDAQDigitizerSKI::AddDigit(int pmt, float digihittime, float peSmeared, std::vector<int> & composition,
+				    std::vector<WCSimDAQDigit> & digits) const
+{
+  //use un-truncated peSmeared here, so that truncation does not affect the test
+  if(peSmeared <= 0.0) {
+#ifdef WCSIMDAQDIGITIZER_VERBOSE
+    std::cout << "DIGIT REJECTED with charge " << peSmeared << " time " << digihittime << std::endl;
+#endif
+    return false;
+  }
+  //digitised hit information does not have infinite precision
+  //so need to round the charge and time information
+  digits.push_back(WCSimDAQDigit());
+  WCSimDAQDigit & digit = digits.back();
+  digit.pmt    = pmt;
+  digit.time   = Truncate(digihittime, TimingPrecision);
+  digit.charge = Truncate(peSmeared,   PEPrecision);
+  digit.composition.swap(composition);
+  return true;
+}
+
+
+void WCSimDAQDigitizerSKI::MakeDigit(int pmt, float intgr_start, double peSmeared, std::vector<int> & composition,
+				     WCSimDAQRandom & random, WCSimDAQPMTResponse & response,
+				     std::vector<WCSimDAQDigit> & digits) const
+{
+  const double efficiency = 0.985; // with skrn1pe (AP tuning) & 30% QE increase in stacking action
+
+  int iflag;
+  Threshold(peSmeared,iflag,random);
+
+  //Check if previous hit passed the threshold.  If so we will digitize the hit
+  if(iflag == 0) {
+    //apply time smearing
+    float Q = (peSmeared > 0.5) ? peSmeared : 0.5;
+    //digitize hit
+    peSmeared *= efficiency;
+    AddDigit(pmt, intgr_start + response.HitTimeSmearing(Q, random), peSmeared, composition, digits);
+  }
+  composition.clear();
+}
+
+namespace {
+  // Index of the first of times[first, n) that is later than value; times must be sorted.
+  // Gallops from first before the binary search, as the answer is usually close to first
+  size_t FirstAfter(const float * times, size_t first, size_t n, float value)
+  {
+    size_t lo = first, hi = first, step = 1;
+    while(hi < n && times[hi] <= value) {
+      lo = hi + 1;
+      hi = lo + step;
+      step *= 2;
+    }
+    if(hi > n) hi = n;
+    return std::upper_bound(times + lo, times + hi, value) - times;
+  }
+}
+
+void WCSimDAQDigitizerSKI::Digitize(const WCSimDAQHits & hits, WCSimDAQRandom & random, WCSimDAQPMTResponse & response,
+				    std::vector<WCSimDAQDigit> & digits) const
+{
+  // The photon ids (index within the PMT) that make up a digit
+  std::vector<int> digi_comp;
+
+  //loop over the PMTs, skipping those without hits
+  for(size_t ipmt = 0; ipmt < hits.GetNumPMT(); ipmt++)
+    if(hits.start[ipmt + 1] != hits.start[ipmt])
+      DigitizePMT(hits, ipmt, random, response, digits, digi_comp);
+}
+
+void WCSimDAQDigitizerSKI::Digitize(const WCSimDAQHits & hits, uint64_t seed, unsigned int nthreads,
+				    WCSimDAQPMTResponse & response, std::vector<WCSimDAQDigit> & digits) const
+{
+  //The digits of each chunk of PMTs are made on one thread, then appended in PMT order
+  const size_t chunk = 16;
+  const size_t npmt = hits.GetNumPMT();
+  std::vector< std::vector<WCSimDAQDigit> > chunkdigits((npmt + chunk - 1) / chunk);
+  WCSimDAQParallel::For(npmt, chunk, nthreads, [&](size_t firstpmt, size_t lastpmt) {
+      std::vector<WCSimDAQDigit> & out = chunkdigits[firstpmt / chunk];
+      std::vector<int> digi_comp;
+      for(size_t ipmt = firstpmt; ipmt < lastpmt; ipmt++) {
+	if(hits.start[ipmt + 1] == hits.start[ipmt])
+	  continue;
+	WCSimDAQRandomStream random(seed, hits.tube[ipmt]);
+	DigitizePMT(hits, ipmt, random, response, out, digi_comp);
+      }
+    });
+
+  size_t ndigits = digits.size();
+  for(size_t ic = 0; ic < chunkdigits.size(); ic++)
+    ndigits += chunkdigits[ic].size();
+  digits.reserve(ndigits);
+  for(size_t ic = 0; ic < chunkdigits.size(); ic++)
+    std::move(chunkdigits[ic].begin(), chunkdigits[ic].end(), std::back_inserter(digits));
+}
+
+void WCSimDAQDigitizerSKI::DigitizePMT(const WCSimDAQHits & hits, size_t ipmt,
+				       WCSimDAQRandom & random, WCSimDAQPMTResponse & response,
+				       std::vector<WCSimDAQDigit> & digits, std::vector<int> & digi_comp) const
+{
+  //the window search below assumes the window & dead time don't go backwards in time
+  if(IntegrationWindow < 0 || DeadTime < 0) {
+    DigitizePMTReference(hits, ipmt, random, response, digits);
+    return;
+  }
+
+  const size_t first = hits.start[ipmt];
+  const size_t nhits = hits.start[ipmt + 1] - first;
+  const float * times   = nhits ? &hits.time[first]   : 0;
+  const float * charges = nhits ? &hits.charge[first] : 0;
+#ifdef WCSIMDAQDIGITIZER_VERBOSE
+  const int tube = hits.tube[ipmt];
+  if(tube < NPMTS_VERBOSE) {
+    std::cout << "tube " << tube << " totalpe = " << nhits << " times";
+    for(size_t ip = 0; ip < nhits; ip++)
+      std::cout << " " << times[ip];
+    std::cout << std::endl;
+  }
+#endif
+
+  //Fast path for the PMTs with one or two hits (most of them at low occupancy, e.g. with dark noise only):
+  // the same windows as the general loop below, without its searches
+  if(nhits <= 2) {
+    if(!nhits)
+      return;
+    const float upperlimit = times[0] + IntegrationWindow;
+    if(nhits == 2 && times[1] <= upperlimit) {
+      digi_comp.resize(2);
+      digi_comp[0] = 0;
+      digi_comp[1] = 1;
+      MakeDigit(ipmt, times[0], (double)charges[0] + charges[1], digi_comp, random, response, digits);
+      return;
+    }
+    digi_comp.assign(1, 0);
+    MakeDigit(ipmt, times[0], charges[0], digi_comp, random, response, digits);
+    if(nhits == 2 && times[1] > upperlimit + DeadTime) {
+      digi_comp.assign(1, 1);
+      MakeDigit(ipmt, times[1], charges[1], digi_comp, random, response, digits);
+    }
+    return;
+  }
+
+  //Each integration window [intgr_start,upperlimit] starts at a hit, the first one on the PMT
+  // or the first one after the dead time that follows the previous window.
+  // Its hits are the contiguous range [ip, iend) of the time-sorted hits
+  size_t ip = 0;
+  while(ip < nhits) {
+    const float intgr_start = times[ip];
+    const float upperlimit  = intgr_start + IntegrationWindow;
+    const size_t iend = FirstAfter(times, ip + 1, nhits, upperlimit);
+
+    //integrate the charge. Summed in hit order, as in DigitizeReference(), so that the
+    // rounding (and so the digits) are the same
+    double peSmeared = 0;
+    for(size_t ih = ip; ih < iend; ih++)
+      peSmeared += charges[ih];
+
+    digi_comp.resize(iend - ip);
+    for(size_t ih = ip; ih < iend; ih++)
+      digi_comp[ih - ip] = ih;
+
+    MakeDigit(ipmt, intgr_start, peSmeared, digi_comp, random, response, digits);
+
+    //skip the hits in the dead time (upperlimit, upperlimit + DeadTime]
+    if(iend == nhits)
+      break;
+    ip = FirstAfter(times, iend, nhits, upperlimit + DeadTime);
+  }//windows on the PMT
+}
+
+void WCSimDAQDigitizerSKI::DigitizeReference(const WCSimDAQHits & hits, WCSimDAQRandom & random, WCSimDAQPMTResponse & response,
+					     std::vector<WCSimDAQDigit> & digits) const
+{
+  //loop over the PMTs
+  for(size_t ipmt = 0; ipmt < hits.GetNumPMT(); ipmt++)
+    DigitizePMTReference(hits, ipmt, random, response, digits);
+}
+
+void WCSimDAQDigitizerSKI::DigitizePMTReference(const WCSimDAQHits & hits, size_t ipmt,
+						WCSimDAQRandom & random, WCSimDAQPMTResponse & response,
+						std::vector<WCSimDAQDigit> & digits) const
+{
+  const size_t first = hits.start[ipmt];
+  const int    nhits = hits.start[ipmt + 1] - first;
+  const float * times   = nhits ? &hits.time[first]   : 0;
+  const float * charges = nhits ? &hits.charge[first] : 0;
+
+  //Now we integrate the charge on each PMT.
+  // Integration occurs for IntegrationWindow ns
+  // Digitizer is then dead for DeadTime ns
+
+  //look over all hits on the PMT
+  //integrate charge and start digitizing
+  float intgr_start=0;
+  float upperlimit=0;
+  double peSmeared = 0;
+
+  // The photon ids (index within the PMT) that make up a digit
+  std::vector<int> digi_comp;
+
+  //loop over the hits on this PMT
+  for(int ip = 0; ip < nhits; ip++) {
+    float time = times[ip];
+    float pe   = charges[ip];
+
+    //start the integration time as the time of the first hit
+    //Hits must be sorted in time
+    if(ip==0) {
+      intgr_start=time;
+      peSmeared = 0;
+      //Set the limits of the integration window [intgr_start,upperlimit]
+      upperlimit = intgr_start + IntegrationWindow;
+    }
+
+    bool MakeNewDigit = false;
+    if(time >= intgr_start && time <= upperlimit) {
+      peSmeared += pe;
+      digi_comp.push_back(ip);
+
+      //if this is the last digit, make sure to make the digit
+      if(ip + 1 == nhits){
+	MakeNewDigit = true;
+      }
+    }
+    //if ensures we don't append the same digit multiple times while in the integration window
+    else if(digi_comp.size()) {
+      //this hit is outside the integration time window.
+      //Charge integration is over.  The is now a DeadTime ns dead
+      //time period where no hits can be recorded
+      MakeNewDigit = true;
+    }
+
+    //Make digit here
+    if(MakeNewDigit)
+      MakeDigit(ipmt, intgr_start, peSmeared, digi_comp, random, response, digits);
+
+    //Now try and deal with the next hit
+    if(time > upperlimit && time <= upperlimit + DeadTime) {
+      //Now we need to reject hits that are after the integration
+      //period to the end of the veto signal
+      continue;
+    }
+    else if(time > upperlimit + DeadTime){
+      //we now need to start integrating from the hit
+      intgr_start=time;
+      peSmeared = pe;
+      //Set the limits of the integration window [intgr_start,upperlimit]
+      upperlimit = intgr_start + IntegrationWindow;
+
+      //store the digi composition information
+      digi_comp.push_back(ip);
+
+      //if this is the last hit we must handle the creation of the digit
+      //as the loop will not evaluate again
+      if(ip+1 == nhits)
+	MakeDigit(ipmt, intgr_start, peSmeared, digi_comp, random, response, digits);
+    }
+  }//ip (hits on the PMT)
+}
@@ -0,0 +1,86 @@
+#include "WCSimDAQParallel.hh"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <random>
+#include <thread>
+#include <vector>
+
+namespace {
+  // The SplitMix64 output function
+  uint64_t Mix(uint64_t z)
+  {
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
+  }
+}
+
+WCSimDAQRandomStream::WCSimDAQRandomStream(uint64_t seed, uint64_t stream)
+  : state(Mix(seed) ^ Mix(stream + 0x9e3779b97f4a7c15ULL)), hasSpareGauss(false), spareGauss(0)
+{
+}
+
+WCSimDAQRandomStream::result_type WCSimDAQRandomStream::operator()()
+{
+  state += 0x9e3779b97f4a7c15ULL;
+  return Mix(state);
+}
+
+double WCSimDAQRandomStream::Flat()
+{
+  //53 random bits, centred in their bin so that 0 & 1 never come out
+  return ((operator()() >> 11) + 0.5) * (1.0 / 9007199254740992.0);
+}
+
+double WCSimDAQRandomStream::Gauss(double mean, double sigma)
+{
+  if(hasSpareGauss) {
+    hasSpareGauss = false;
+    return mean + sigma * spareGauss;
+  }
+  double u, v, s;
+  do {
+    u = 2 * Flat() - 1;
+    v = 2 * Flat() - 1;
+    s = u*u + v*v;
+  } while(s >= 1);
+  const double f = std::sqrt(-2 * std::log(s) / s);
+  spareGauss = v * f;
+  hasSpareGauss = true;
+  return mean + sigma * u * f;
+}
+
+long WCSimDAQRandomStream::Poisson(double mean)
+{
+  if(mean <= 0)
+    return 0;
+  return std::poisson_distribution<long>(mean)(*this);
+}
+
+void WCSimDAQParallel::For(size_t n, size_t chunk, unsigned int nthreads,
+			   const std::function<void(size_t first, size_t last)> & task)
+{
+  if(!n)
+    return;
+  if(!chunk)
+    chunk = 1;
+  const size_t nchunks = (n + chunk - 1) / chunk;
+  if(!nthreads)
+    nthreads = std::max(1u, std::thread::hardware_concurrency());
+  nthreads = std::min<size_t>(nthreads, nchunks);
+
+  std::atomic<size_t> next(0);
+  auto work = [&]() {
+    for(size_t ic = next++; ic < nchunks; ic = next++)
+      task(ic * chunk, std::min(n, (ic + 1) * chunk));
+  };
+  // The calling thread is one of the workers
+  std::vector<std::thread> workers;
+  for(unsigned int t = 1; t < nthreads; t++)
+    workers.push_back(std::thread(work));
+  work();
+  for(size_t t = 0; t < workers.size(); t++)
+    workers[t].join();
+}
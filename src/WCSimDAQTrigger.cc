@@ -0,0 +1,172 @@
+#include "WCSimDAQTrigger.hh"
+
+#include <algorithm>
+#include <iostream>
+
+#ifndef WCSIMDAQTRIGGER_VERBOSE
+//#define WCSIMDAQTRIGGER_VERBOSE
+#endif
+
+namespace {
+  //orders indices into the sorted view by (PMT, digit), i.e. the order of the input collection
+  struct SortedDigitPMTOrder {
+    const std::vector<WCSimDAQSortedDigit> & digits;
+    SortedDigitPMTOrder(const std::vector<WCSimDAQSortedDigit> & d) : digits(d) {}
+    bool operator()(size_t a, size_t b) const {
+      if(digits[a].pmt != digits[b].pmt)
+	return digits[a].pmt < digits[b].pmt;
+      return digits[a].digit < digits[b].digit;
+    }
+  };
+}
+
+void WCSimDAQTrigger::SortByTime(std::vector<WCSimDAQSortedDigit> & digits)
+{
+  std::stable_sort(digits.begin(), digits.end(), CompareTime);
+}
+
+int WCSimDAQTrigger::NDigits(const std::vector<WCSimDAQSortedDigit> & digits, const std::vector<unsigned int> & masks,
+			     unsigned int ignore_mask, int threshold, int window, int postTriggerWindow,
+			     std::vector<float> & triggerTimes, std::vector< std::vector<float> > & triggerInfos)
+{
+  //slide a window along the time-sorted digits.  If ndigits > Threshhold in a time window, then we have a trigger
+
+  const size_t ndigits = digits.size();
+  int ntrig = 0;
+  int window_start_time = 0;
+  int window_step_size  = 5; //step the search window along this amount if no trigger is found
+
+  //get the time of the last hit: the upper time limit is set to the final possible full trigger window,
+  // so the search is not limited to a fixed event length
+  float lasthit = 0;
+  for (size_t id = ndigits; id > 0; id--) {
+    if(!(masks[id-1] & ignore_mask)) {
+      lasthit = digits[id-1].time;
+      break;
+    }
+  }
+  const int window_end_time = lasthit - (window - 10);
+
+  //the digits in the window are [window_first, window_last)
+  // as both edges only ever move forward, each digit is added to & removed from the count at most once
+  size_t window_first = 0, window_last = 0;
+  int n_digits = 0;
+
+  // the first window is always searched
+  do {
+    float triggertime = 0; //save each digit time, because the trigger time is the time of the first hit above threshold
+    bool triggerfound = false;
+
+    //hit in trigger window?
+    while(window_last < ndigits && digits[window_last].time <= (window_start_time + window)) {
+      if(!(masks[window_last] & ignore_mask))
+	n_digits++;
+      window_last++;
+    }
+    while(window_first < window_last && digits[window_first].time < window_start_time) {
+      if(!(masks[window_first] & ignore_mask))
+	n_digits--;
+      window_first++;
+    }
+
+    //if over threshold, issue trigger
+    if(n_digits > threshold) {
+      ntrig++;
+      //The trigger time is the time of the first hit above threshold
+      int nseen = 0;
+      for(size_t id = window_first; id < window_last; id++) {
+	if(masks[id] & ignore_mask)
+	  continue;
+	if(nseen++ == threshold) {
+	  triggertime = digits[id].time;
+	  break;
+	}
+      }
+      triggertime -= (int)triggertime % 5;
+      triggerTimes.push_back(triggertime);
+      triggerInfos.push_back(std::vector<float>(1, n_digits));
+      triggerfound = true;
+    }
+
+#ifdef WCSIMDAQTRIGGER_VERBOSE
+    if(n_digits)
+      std::cout << n_digits << " digits found in " << window << "nsec trigger window ["
+		<< window_start_time << ", " << window_start_time + window
+		<< "]. Threshold is: " << threshold << std::endl;
+#endif
+
+    //move onto the next go through the timing loop
+    if(triggerfound) {
+      window_start_time = triggertime + postTriggerWindow;
+    }//triggerfound
+    else {
+      window_start_time += window_step_size;
+    }
+  } while(window_start_time <= window_end_time);
+  return ntrig;
+}
+
+void WCSimDAQTrigger::SelectTriggeredDigits(const std::vector<WCSimDAQSortedDigit> & digits,
+					    const std::vector<float> & triggerTimes,
+					    const std::vector<int> & preTriggerWindows,
+					    const std::vector<int> & postTriggerWindows,
+					    bool multiDigitsPerTrigger, double offset,
+					    std::vector<TriggeredDigit> & selected)
+{
+  //the digits in the current trigger window, as indices into digits
+  std::vector<size_t> window_digits;
+
+  //Loop over trigger times
+  for(unsigned int itrigger = 0; itrigger < triggerTimes.size(); itrigger++) {
+    float triggertime = triggerTimes[itrigger];
+
+    //these are the boundary of the trigger gate: we want to save all digits within these bounds
+    float lowerbound = triggertime + preTriggerWindows[itrigger];
+    float upperbound = triggertime + postTriggerWindows[itrigger];
+    //need to check for double-counting - check if the previous upperbound is above the lowerbound
+    bool exclusive_lowerbound = false;
+    if(itrigger) {
+      float upperbound_previous = triggerTimes[itrigger - 1] + postTriggerWindows[itrigger - 1];
+      if(upperbound_previous > lowerbound) {
+	//also need to check whether the previous upperbound is above the lowerbound
+	//(different trigger windows for different trigger types can mean this trigger is completely contained within another)
+	// if it is, we skip it
+	if(upperbound_previous >= upperbound)
+	  continue;
+	lowerbound = upperbound_previous;
+	//digits exactly on the boundary were saved in the previous trigger
+	exclusive_lowerbound = true;
+      }
+    }
+
+    //find the digits in the trigger window with a binary search of the sorted view,
+    // then put them back into PMT order, so the output is ordered as the input collection
+    WCSimDAQSortedDigit lower;
+    lower.time = lowerbound;
+    std::vector<WCSimDAQSortedDigit>::const_iterator it =
+      exclusive_lowerbound ?
+      std::upper_bound(digits.begin(), digits.end(), lower, CompareTime) :
+      std::lower_bound(digits.begin(), digits.end(), lower, CompareTime);
+    window_digits.clear();
+    for(; it != digits.end() && it->time <= upperbound; ++it)
+      window_digits.push_back(it - digits.begin());
+    std::sort(window_digits.begin(), window_digits.end(), SortedDigitPMTOrder(digits));
+
+    int last_pmt = -1;
+    TriggeredDigit td;
+    td.trigger = itrigger;
+    for(size_t iw = 0; iw < window_digits.size(); iw++) {
+      const WCSimDAQSortedDigit & sd = digits[window_digits[iw]];
+      //we've already found a digit on this PMT. If we're restricting to just 1 digit per trigger window (e.g. SKI)
+      // then ignore later digits
+      if(!multiDigitsPerTrigger && sd.pmt == last_pmt)
+	continue;
+      last_pmt = sd.pmt;
+
+      //apply time offsets
+      td.digit = window_digits[iw];
+      td.time  = -triggertime + offset + sd.time;
+      selected.push_back(td);
+    }//loop over digits in window
+  }//loop over triggers
+}
@@ -0,0 +1,300 @@
+#include "WCSimDAQWaveform.hh"
+#include "WCSimDAQDigitizer.hh"
+#include "WCSimDAQParallel.hh"
+
+#include <algorithm>
+#include <cmath>
+#include <iterator>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <sstream>
+
+WCSimDAQPulseTemplate::WCSimDAQPulseTemplate(WCSimDAQPMTResponse & response, double samplewidth, int nphases)
+  : SampleWidth(samplewidth), NPhases(std::max(1, nphases)), Length(0), Area(0)
+{
+  //find where the pulse ends: after its peak, when it has fallen below 1e-3 of the peak height.
+  // Search in steps of a phase, up to 1 us
+  const double step = SampleWidth / NPhases;
+  double peak = 0, end = 0;
+  for(double t = 0; t < 1000; t += step) {
+    const double v = std::fabs(response.PulseShape(t));
+    peak = std::max(peak, v);
+    if(v > 1E-3 * peak)
+      end = t;
+    else if(peak > 0)
+      break;
+  }
+  //the samples up to the end of the pulse, plus the one in which the photoelectron arrives
+  Length = (size_t)std::ceil(end / SampleWidth) + 2;
+  Length = (Length + 7) / 8 * 8;
+
+  //row iphase is for a photoelectron in the middle of phase iphase.
+  // Sample k of the row is then (k - (iphase + 0.5) / NPhases) samples after it
+  Samples.assign(NPhases * Length, 0);
+  for(int iphase = 0; iphase < NPhases; iphase++) {
+    float * row = &Samples[iphase * Length];
+    for(size_t k = 0; k < Length; k++) {
+      const double t = (k - (iphase + 0.5) / NPhases) * SampleWidth;
+      row[k] = t > 0 ? response.PulseShape(t) : 0;
+      Area += row[k];
+    }
+  }
+  Area /= NPhases;
+
+  //the transit time spreads, from a fixed substream so that the table is the same in every job
+  TransitTimes.resize(1 << 16);
+  WCSimDAQRandomStream random(0, 1);
+  for(size_t i = 0; i < TransitTimes.size(); i++)
+    TransitTimes[i] = response.HitTimeSmearing(1, random);
+}
+
+const WCSimDAQPulseTemplate & WCSimDAQPulseTemplate::Get(WCSimDAQPMTResponse & response, double samplewidth, int nphases)
+{
+  static std::mutex cachemutex;
+  static std::map<std::string, std::unique_ptr<WCSimDAQPulseTemplate> > cache;
+
+  std::ostringstream key;
+  key << response.PulseName() << "/" << samplewidth << "/" << nphases;
+  std::lock_guard<std::mutex> lock(cachemutex);
+  std::unique_ptr<WCSimDAQPulseTemplate> & pulse = cache[key.str()];
+  if(!pulse)
+    pulse.reset(new WCSimDAQPulseTemplate(response, samplewidth, nphases));
+  return *pulse;
+}
+
+double WCSimDAQPulseTemplate::GetThresholdDelay(double threshold) const
+{
+  //The rows interleaved make the pulse in steps of a phase: step j is (j - 0.5) phases after the photoelectron,
+  // sample (j + NPhases - 1) / NPhases of row (sample * NPhases - j)
+  double tlast = 0, vlast = 0;
+  for(size_t j = 1; j <= Length * NPhases; j++) {
+    const size_t k = (j + NPhases - 1) / NPhases;
+    if(k >= Length)
+      break;
+    const double v = Samples[(k * NPhases - j) * Length + k];
+    const double t = (j - 0.5) * SampleWidth / NPhases;
+    if(v >= threshold)
+      return v > vlast ? tlast + (t - tlast) * (threshold - vlast) / (v - vlast) : t;
+    tlast = t;
+    vlast = v;
+  }
+  return -1;
+}
+
+namespace {
+  // A table of unit Gaussian noise (its size a power of 2), shared by all PMTs. Each stretch of
+  // waveform takes its noise from a random offset in the table, rather than a Gaussian for every sample
+  const std::vector<float> & NoiseTable()
+  {
+    static const std::vector<float> table = []() {
+      std::vector<float> t(1 << 16);
+      WCSimDAQRandomStream random(0, 0);
+      for(size_t i = 0; i < t.size(); i++)
+	t[i] = random.Gauss(0, 1);
+      return t;
+    }();
+    return table;
+  }
+
+  // Add q * pulse to wave. The arrays can't overlap, so the compiler can vectorise the loop
+  void Accumulate(float * __restrict__ wave, const float * __restrict__ pulse, float q, size_t n)
+  {
+    for(size_t k = 0; k < n; k++)
+      wave[k] += q * pulse[k];
+  }
+}
+
+WCSimDAQDigitizerWaveform::WCSimDAQDigitizerWaveform()
+  : DeadTime(0), IntegrationWindow(128), TimingPrecision(0), PEPrecision(0),
+    SampleWidth(8), NPhases(16), Threshold(0.25), Noise(0.03)
+{
+}
+
+void WCSimDAQDigitizerWaveform::Digitize(const WCSimDAQHits & hits, WCSimDAQRandom & random, WCSimDAQPMTResponse & response,
+					 std::vector<WCSimDAQDigit> & digits) const
+{
+  const WCSimDAQPulseTemplate & pulse = WCSimDAQPulseTemplate::Get(response, SampleWidth, NPhases);
+  const double delay = std::max(0., pulse.GetThresholdDelay(Threshold));
+
+  Workspace work;
+  for(size_t ipmt = 0; ipmt < hits.GetNumPMT(); ipmt++)
+    DigitizePMT(hits, ipmt, pulse, delay, random, digits, work);
+}
+
+void WCSimDAQDigitizerWaveform::Digitize(const WCSimDAQHits & hits, uint64_t seed, unsigned int nthreads,
+					 WCSimDAQPMTResponse & response, std::vector<WCSimDAQDigit> & digits) const
+{
+  const WCSimDAQPulseTemplate & pulse = WCSimDAQPulseTemplate::Get(response, SampleWidth, NPhases);
+  const double delay = std::max(0., pulse.GetThresholdDelay(Threshold));
+
+  //The digits of each chunk of PMTs are made on one thread, then appended in PMT order
+  const size_t chunk = 16;
+  const size_t npmt = hits.GetNumPMT();
+  std::vector< std::vector<WCSimDAQDigit> > chunkdigits((npmt + chunk - 1) / chunk);
+  WCSimDAQParallel::For(npmt, chunk, nthreads, [&](size_t firstpmt, size_t lastpmt) {
+      std::vector<WCSimDAQDigit> & out = chunkdigits[firstpmt / chunk];
+      Workspace work;
+      for(size_t ipmt = firstpmt; ipmt < lastpmt; ipmt++) {
+	WCSimDAQRandomStream random(seed, hits.tube[ipmt]);
+	DigitizePMT(hits, ipmt, pulse, delay, random, out, work);
+      }
+    });
+
+  size_t ndigits = digits.size();
+  for(size_t ic = 0; ic < chunkdigits.size(); ic++)
+    ndigits += chunkdigits[ic].size();
+  digits.reserve(ndigits);
+  for(size_t ic = 0; ic < chunkdigits.size(); ic++)
+    std::move(chunkdigits[ic].begin(), chunkdigits[ic].end(), std::back_inserter(digits));
+}
+
+void WCSimDAQDigitizerWaveform::DigitizePMT(const WCSimDAQHits & hits, size_t ipmt, const WCSimDAQPulseTemplate & pulse, double delay,
+					    WCSimDAQRandom & random, std::vector<WCSimDAQDigit> & digits, Workspace & work) const
+{
+  const size_t first = hits.start[ipmt];
+  const size_t nhits = hits.start[ipmt + 1] - first;
+  if(!nhits)
+    return;
+  const float * times   = &hits.time[first];
+  const float * charges = &hits.charge[first];
+
+  //smear each photoelectron by the single p.e. transit time spread, from the table at a random offset
+  const std::vector<float> & transit = pulse.GetTransitTimes();
+  const size_t transitoffset = (size_t)(random.Flat() * transit.size());
+  std::vector<float> & time = work.time;
+  time.resize(nhits);
+  for(size_t ih = 0; ih < nhits; ih++)
+    time[ih] = times[ih] + transit[(transitoffset + ih) & (transit.size() - 1)];
+
+  const double dt = SampleWidth;
+  const size_t length = pulse.GetLength();
+  const size_t nintegrate = std::max(1, (int)std::ceil(IntegrationWindow / dt));
+  const size_t ndead      = std::max(0, (int)std::ceil(DeadTime / dt));
+  //photoelectrons further apart than this can't affect each others' digits, so the waveform is
+  // rendered in separate stretches. These are found from the (sorted) unsmeared times,
+  // as the smearing is much smaller than the gap
+  const double gap = pulse.GetDuration() + (nintegrate + ndead) * dt;
+  const std::vector<float> & noise = NoiseTable();
+
+  size_t istretch = 0;
+  while(istretch < nhits) {
+    size_t iend = istretch + 1;
+    while(iend < nhits && times[iend] - times[iend - 1] <= gap)
+      iend++;
+    float tmin = time[istretch], tmax = time[istretch];
+    for(size_t ih = istretch + 1; ih < iend; ih++) {
+      tmin = std::min(tmin, time[ih]);
+      tmax = std::max(tmax, time[ih]);
+    }
+
+    //the stretch starts on a sample boundary (of a clock common to all PMTs), a sample before the first photoelectron
+    const double t0 = dt * (std::floor(tmin / dt) - 1);
+    const size_t nsamples = (size_t)((tmax - t0) / dt) + std::max(length, nintegrate + 1) + 1;
+    std::vector<float> & wave = work.wave;
+    wave.resize(nsamples);
+    if(Noise > 0) {
+      const size_t offset = (size_t)(random.Flat() * noise.size());
+      for(size_t s = 0; s < nsamples; s++)
+	wave[s] = Noise * noise[(offset + s) & (noise.size() - 1)];
+    }
+    else
+      std::fill(wave.begin(), wave.end(), 0.f);
+
+    //render the photoelectrons. When there are more of them than samples, their charges are first
+    // summed in bins of (sample, phase), so that each bin rather than each photoelectron adds a template
+    if(iend - istretch > nsamples) {
+      //bin b is phase b % nphases of sample b / nphases
+      const int nphases = pulse.GetNumPhases();
+      const float binsperns = nphases / dt;
+      std::vector<float> & binned = work.binned;
+      binned.assign(nsamples * nphases, 0.f);
+      for(size_t ih = istretch; ih < iend; ih++)
+	binned[(size_t)((time[ih] - (float)t0) * binsperns)] += charges[ih];
+      for(size_t s = 0; s < nsamples; s++)
+	for(int iphase = 0; iphase < nphases; iphase++)
+	  if(binned[s * nphases + iphase] != 0)
+	    Accumulate(&wave[s], pulse.GetRow(iphase), binned[s * nphases + iphase], length);
+    }
+    else {
+      for(size_t ih = istretch; ih < iend; ih++) {
+	const double x = (time[ih] - t0) / dt;
+	const size_t s = (size_t)x;
+	Accumulate(&wave[s], pulse.GetPhase(x - s), charges[ih], length);
+      }
+    }
+
+    //discriminate & integrate. windowend & windowdigit hold the end time & the index in digits (-1 if the
+    // charge was not positive) of each integration window
+    std::vector<double> & windowend   = work.windowend;
+    std::vector<long>   & windowdigit = work.windowdigit;
+    windowend.clear();
+    windowdigit.clear();
+    bool armed = true;
+    size_t s = 1;
+    while(s < nsamples) {
+      if(wave[s] < Threshold) {
+	armed = true;
+	s++;
+	continue;
+      }
+      if(!armed) {
+	s++;
+	continue;
+      }
+      //interpolate the crossing between samples s-1 & s
+      double fraction = 0;
+      if(wave[s - 1] < Threshold)
+	fraction = (Threshold - wave[s - 1]) / (wave[s] - wave[s - 1]);
+      const double tcross = t0 + dt * (s - 1 + fraction);
+      const size_t last = std::min(nsamples, s - 1 + nintegrate);
+      double q = 0;
+      for(size_t k = s - 1; k < last; k++)
+	q += wave[k];
+      q /= pulse.GetArea();
+
+      windowend.push_back(t0 + dt * last);
+      windowdigit.push_back(-1);
+      if(q > 0) {
+	windowdigit.back() = digits.size();
+	digits.push_back(WCSimDAQDigit());
+	WCSimDAQDigit & digit = digits.back();
+	digit.pmt    = ipmt;
+	digit.time   = WCSimDAQDigitizerSKI::Truncate(tcross - delay, TimingPrecision);
+	digit.charge = WCSimDAQDigitizerSKI::Truncate(q, PEPrecision);
+      }
+
+      //dead until the end of the dead time, then rearm when below threshold
+      s = last + ndead;
+      armed = false;
+    }
+
+    //each photoelectron is in the composition of the first integration window that ends after it.
+    // They are visited in index order, so the compositions come out sorted. The smeared times are
+    // nearly sorted, so the window is found by moving on from that of the previous photoelectron
+    if(windowend.size() == 1) {
+      //the usual case: a single window, which has all the photoelectrons before its end
+      if(windowdigit[0] >= 0) {
+	std::vector<int> & composition = digits[windowdigit[0]].composition;
+	composition.reserve(iend - istretch);
+	const double end = windowend[0];
+	for(size_t ih = istretch; ih < iend; ih++)
+	  if(time[ih] < end)
+	    composition.push_back(ih);
+      }
+    }
+    else if(!windowend.empty()) {
+      size_t iwindow = 0;
+      for(size_t ih = istretch; ih < iend; ih++) {
+	while(iwindow < windowend.size() && windowend[iwindow] <= time[ih])
+	  iwindow++;
+	while(iwindow > 0 && windowend[iwindow - 1] > time[ih])
+	  iwindow--;
+	if(iwindow < windowend.size() && windowdigit[iwindow] >= 0)
+	  digits[windowdigit[iwindow]].composition.push_back(ih);
+      }
+    }
+
+    istretch = iend;
+  }
+}
@@ -140,12 +140,17 @@ WCSimDetectorConstruction::WCSimDetectorConstruction(G4int DetConfig,WCSimTuning
 #include "G4LogicalBorderSurface.hh"
 #include "G4LogicalSkinSurface.hh"
 
+#include <set>
+
 void WCSimDetectorConstruction::UpdateGeometry()
 {
  
   
   G4bool geomChanged = true;
   G4RunManager::GetRunManager()->DefineWorldVolume(Construct(), geomChanged);
+  // the processes hold pointers into the old geometry (e.g. the surface
+  // caches of WCSimOpBoundaryProcess), so have them rebuilt at the next run
+  G4RunManager::GetRunManager()->PhysicsHasBeenModified();
   // ToDo: need some error catching here for NULL Construct() cases
  
 }
@@ -191,6 +196,53 @@ WCSimDetectorConstruction::~WCSimDetectorConstruction(){
 //
 //}
 
+// Is the logical volume, or one of its daughters, sensitive (i.e. a PMT)?
+static G4bool ContainsSensitiveVolume(const G4LogicalVolume* lv,
+				      std::set<const G4LogicalVolume*> & checked)
+{
+  if(!checked.insert(lv).second)
+    return false;
+  if(lv->GetSensitiveDetector())
+    return true;
+  for(G4int i = 0; i < (G4int)lv->GetNoDaughters(); i++)
+    if(ContainsSensitiveVolume(lv->GetDaughter(i)->GetLogicalVolume(), checked))
+      return true;
+  return false;
+}
+
+void WCSimDetectorConstruction::ResolveOpticalKillVolumes()
+{
+  opticalKillVolumes.clear();
+  if(opticalKillVolumeNames.empty())
+    return;
+
+  G4LogicalVolumeStore* store = G4LogicalVolumeStore::GetInstance();
+  std::set<const G4LogicalVolume*> checked;
+  for(size_t i = 0; i < opticalKillVolumeNames.size(); i++){
+    G4int nfound = 0;
+    for(size_t j = 0; j < store->size(); j++){
+      const G4LogicalVolume* lv = (*store)[j];
+      if(lv->GetName() != opticalKillVolumeNames[i])
+	continue;
+      checked.clear();
+      if(ContainsSensitiveVolume(lv, checked)){
+	G4cerr << "Optical kill volume " << opticalKillVolumeNames[i]
+	       << " is or contains a PMT: photons in it can make hits. Exiting..." << G4endl;
+	exit(-1);
+      }
+      opticalKillVolumes.insert(lv);
+      nfound++;
+    }
+    if(!nfound){
+      G4cerr << "Optical kill volume " << opticalKillVolumeNames[i]
+	     << " is not a logical volume of the " << WCDetectorName << " geometry. Exiting..." << G4endl;
+      exit(-1);
+    }
+  }
+  G4cout << "Killing the optical photons entering " << opticalKillVolumes.size()
+	 << " logical volumes" << G4endl;
+}
+
 G4VPhysicalVolume* WCSimDetectorConstruction::Construct()
 {  
   G4GeometryManager::GetInstance()->OpenGeometry();
@@ -201,6 +253,7 @@ G4VPhysicalVolume* WCSimDetectorConstruction::Construct()
   G4LogicalBorderSurface::CleanSurfaceTable();
   G4LogicalSkinSurface::CleanSurfaceTable();
   WCSimDetectorConstruction::PMTLogicalVolumes.clear();
+  opticalKillVolumes.clear();
   //TF: for new mPMT (or make this into a function?)
   vNiC.clear();
   vAlpha.clear();
@@ -320,6 +373,7 @@ G4VPhysicalVolume* WCSimDetectorConstruction::Construct()
   
   DumpGeometryTableToFile();
 
+  ResolveOpticalKillVolumes();
   
 
   
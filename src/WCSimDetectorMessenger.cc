@@ -4,6 +4,7 @@
 #include "G4UIdirectory.hh"
 #include "G4UIcommand.hh"
 #include "G4UIparameter.hh"
+#include "G4StateManager.hh"
 
 WCSimDetectorMessenger::WCSimDetectorMessenger(WCSimDetectorConstruction* WCSimDet)
 :WCSimDetector(WCSimDet)
@@ -389,6 +390,20 @@ WCSimDetectorMessenger::WCSimDetectorMessenger(WCSimDetectorConstruction* WCSimD
   SetPMTPositionInput = new G4UIcmdWithAString("/WCSim/PMT/PositionFile",this);
   SetPMTPositionInput->SetGuidance("Set filename for PMT position file");
   SetPMTPositionInput->SetParameterName("PMTPositionInput", true);
+
+  // Volumes where optical photons are killed
+  OpticalKillDir = new G4UIdirectory("/WCSim/OpticalKill/");
+  OpticalKillDir->SetGuidance("Commands to stop tracking the optical photons in volumes with no path to a PMT");
+
+  OpticalKillVolume = new G4UIcmdWithAString("/WCSim/OpticalKill/AddVolume",this);
+  OpticalKillVolume->SetGuidance("Kill the optical photons entering the logical volume of this name (e.g. WCBarrelCellBlackSheet)");
+  OpticalKillVolume->SetGuidance("The volume must not contain PMTs, and photons must not be able to reach a PMT from it");
+  OpticalKillVolume->SetParameterName("OpticalKillVolume", false);
+  OpticalKillVolume->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+  OpticalKillClear = new G4UIcmdWithoutParameter("/WCSim/OpticalKill/Clear",this);
+  OpticalKillClear->SetGuidance("Do not kill the optical photons in any volume (the default)");
+  OpticalKillClear->AvailableForStates(G4State_PreInit, G4State_Idle);
 }
 
 WCSimDetectorMessenger::~WCSimDetectorMessenger()
@@ -419,6 +434,10 @@ WCSimDetectorMessenger::~WCSimDetectorMessenger()
   delete PMTPosVar;
   delete TankRadiusChange;
   delete SetPMTPositionInput;
+
+  delete OpticalKillVolume;
+  delete OpticalKillClear;
+  delete OpticalKillDir;
 }
 
 void WCSimDetectorMessenger::SetNewValue(G4UIcommand* command,G4String newValue)
@@ -700,6 +719,19 @@ void WCSimDetectorMessenger::SetNewValue(G4UIcommand* command,G4String newValue)
 	  WCSimDetector->SetPMTPositionInput(newValue);
 	}
 	
+	if(command == OpticalKillVolume){
+	  G4cout << "Killing the optical photons entering " << newValue << G4endl;
+	  WCSimDetector->AddOpticalKillVolume(newValue);
+	  // after /run/initialize the geometry exists already
+	  if(G4StateManager::GetStateManager()->GetCurrentState() == G4State_Idle)
+	    WCSimDetector->ResolveOpticalKillVolumes();
+	}
+
+	if(command == OpticalKillClear){
+	  G4cout << "Not killing the optical photons in any volume" << G4endl;
+	  WCSimDetector->ClearOpticalKillVolumes();
+	}
+
 	if(command == WCConstruct) {
 	  WCSimDetector->UpdateGeometry();
 	}
@@ -9,6 +9,9 @@ std::string WCSimEnumerations::EnumAsString(DigitizerType_t d)
   case (kDigitizerSKI) :
     return "SKI";
     break;
+  case (kDigitizerWaveform) :
+    return "Waveform";
+    break;
   default:
     return "";
     break;
@@ -25,6 +28,12 @@ std::string WCSimEnumerations::EnumAsString(TriggerType_t t)
   case (kTriggerNDigitsTest) :
     return "NDigits_TEST";
     break;
+  case (kTriggerLocalNHits) :
+    return "LocalNHits";
+    break;
+  case (kTriggerTOFScan) :
+    return "TOFScan";
+    break;
   case (kTriggerFailure) :
     return "No_trigger_passed";
     break;
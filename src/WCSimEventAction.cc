@@ -7,6 +7,7 @@
 #include "WCSimWCDigitizer.hh"
 #include "WCSimWCTrigger.hh"
 #include "WCSimWCAddDarkNoise.hh"
+#include "WCSimWCOverlay.hh"
 #include "WCSimWCPMT.hh"
 #include "WCSimDetectorConstruction.hh"
 
@@ -33,6 +34,9 @@
 #include <iomanip>
 #include <string>
 #include <vector>
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
 
 #include "jhfNtuple.h"
 #include "TTree.h"
@@ -62,6 +66,7 @@ WCSimEventAction::WCSimEventAction(WCSimRunAction* myRun,
 				   WCSimPrimaryGeneratorAction* myGenerator)
   :runAction(myRun), generatorAction(myGenerator), 
    detectorConstructor(myDetector),
+   DAQNThreads(0),
    ConstructedDAQClasses(false),
    SavedOptions(false)
 {
@@ -78,6 +83,10 @@ WCSimEventAction::WCSimEventAction(WCSimRunAction* myRun,
   //create dark noise module
   WCSimWCAddDarkNoise* WCDNM = new WCSimWCAddDarkNoise("WCDarkNoise", detectorConstructor);
   DMman->AddNewModule(WCDNM);
+
+  //create pile-up overlay module
+  WCSimWCOverlay* WCOM = new WCSimWCOverlay("WCOverlay", detectorConstructor);
+  DMman->AddNewModule(WCOM);
 }
 
 WCSimEventAction::~WCSimEventAction()
@@ -101,18 +110,19 @@ void WCSimEventAction::CreateDAQInstances()
     WCSimWCDigitizerSKI* WCDM = new WCSimWCDigitizerSKI("WCReadoutDigits", detectorConstructor, DAQMessenger);
     DMman->AddNewModule(WCDM);
   }
+  else if(DigitizerChoice == "Waveform") {
+    WCSimWCDigitizerWaveform* WCDM = new WCSimWCDigitizerWaveform("WCReadoutDigits", detectorConstructor, DAQMessenger);
+    DMman->AddNewModule(WCDM);
+  }
   else {
     G4cerr << "Unknown DigitizerChoice " << DigitizerChoice << G4endl;
     exit(-1);
   }
 
   //create your choice of trigger module
-  if(TriggerChoice == "NDigits") {
-    WCSimWCTriggerNDigits* WCTM = new WCSimWCTriggerNDigits("WCReadout", detectorConstructor, DAQMessenger);
-    DMman->AddNewModule(WCTM);
-  }
-  else if(TriggerChoice == "NDigits2") {
-    WCSimWCTriggerNDigits2* WCTM = new WCSimWCTriggerNDigits2("WCReadout", detectorConstructor, DAQMessenger);
+  // (trigger classes are registered with WCSIM_REGISTER_TRIGGER)
+  WCSimWCTriggerBase* WCTM = WCSimWCTriggerRegistry::Instance().Create(TriggerChoice, "WCReadout", detectorConstructor, DAQMessenger);
+  if(WCTM) {
     DMman->AddNewModule(WCTM);
   }
   else {
@@ -162,6 +172,11 @@ void WCSimEventAction::EndOfEventAction(const G4Event* evt)
       exit(0);
   }
 
+  // The replayed library ran out of entries, or the photon table is full: nothing to save for this event
+  if((generatorAction->IsUsingReplayEvtGenerator() || generatorAction->IsUsingPhotonReplayEvtGenerator() ||
+      generatorAction->IsUsingPhotonTableEvtGenerator()) && evt->IsAborted())
+    return;
+
   // ----------------------------------------------------------------------
   //  Get Event Information
   // ----------------------------------------------------------------------
@@ -193,6 +208,10 @@ void WCSimEventAction::EndOfEventAction(const G4Event* evt)
   // If this option is chosen
   // pe's will be generated on the pmts.
   if( generatorAction->IsUsingPoissonPMT() ){
+    // The photon truth is only recorded when saved (/WCSimIO/SavePhoton*)
+    const bool savePhotonStartTime = GetRunAction()->GetSavePhotonStartTime();
+    const bool savePhotonStartPos  = GetRunAction()->GetSavePhotonStartPos();
+    const bool savePhotonEndPos    = GetRunAction()->GetSavePhotonEndPos();
 
     // Loop through PMTs in detector
     for (
@@ -244,15 +263,50 @@ void WCSimEventAction::EndOfEventAction(const G4Event* evt)
 	G4float time = G4RandGauss::shoot(0.0,10.);
 	(*WCHC)[hitIndex]->AddPe(time);
 	(*WCHC)[hitIndex]->AddParentID(0); // Make parent a geantino (whatever that is)
-	(*WCHC)[hitIndex]->AddPhotonStartPos(pos);
-	(*WCHC)[hitIndex]->AddPhotonEndPos(pos);
-	(*WCHC)[hitIndex]->AddPhotonStartTime(time);
+	if(savePhotonStartPos)
+	  (*WCHC)[hitIndex]->AddPhotonStartPos(pos);
+	if(savePhotonEndPos)
+	  (*WCHC)[hitIndex]->AddPhotonEndPos(pos);
+	if(savePhotonStartTime)
+	  (*WCHC)[hitIndex]->AddPhotonStartTime(time);
       }
     }
   }
   
 
 
+  // Fast optical simulation: add the p.e. sampled from the photon table.
+  // Or, when building the table, add the p.e. of this event's photons to it
+  WCSimFastOptics* fastOptics = GetRunAction()->GetFastOptics();
+  if(fastOptics->IsFast())
+    fastOptics->FillHits(WCHC);
+  if(generatorAction->IsUsingPhotonTableEvtGenerator())
+    fastOptics->EndCell(WCHC);
+
+  // Save this event's photon hits to the hit library, before anything is overlaid
+  WCSimHitLibrary* hitLibrary = GetRunAction()->GetHitLibrary();
+  if(hitLibrary) {
+    if(WCHC)
+      for (G4int i = 0; i < WCHC->entries(); i++)
+	for (G4int ip = 0; ip < (*WCHC)[i]->GetTotalPe(); ip++)
+	  hitLibrary->AddHit((*WCHC)[i]->GetTubeID(), (*WCHC)[i]->GetTime(ip), 0, (*WCHC)[i]->GetParentID(ip));
+    hitLibrary->EndEntry();
+  }
+  // The photons were added as they were stacked
+  WCSimPhotonLibrary* photonLibrary = GetRunAction()->GetPhotonLibrary();
+  if(photonLibrary)
+    photonLibrary->EndEntry();
+
+  // ----------------------------------------------------------------------
+  //  Overlay pre-simulated events (pile-up) on the hits
+  // ----------------------------------------------------------------------
+
+  G4DigiManager* DMman = G4DigiManager::GetDMpointer();
+
+  WCSimWCOverlay* WCOM =
+    (WCSimWCOverlay*)DMman->FindDigitizerModule("WCOverlay");
+  WCOM->Overlay(WCHC);
+
   // To use Do like This:
   // --------------------
   //   if (WCHC)
@@ -264,65 +318,73 @@ void WCSimEventAction::EndOfEventAction(const G4Event* evt)
   //  Get Digitized Hit Collection
   // ----------------------------------------------------------------------
 
-  // Get a pointer to the Digitizing Module Manager
-  G4DigiManager* DMman = G4DigiManager::GetDMpointer();
-
-  // Get a pointer to the WC PMT module
-  WCSimWCPMT* WCDMPMT =
-    (WCSimWCPMT*)DMman->FindDigitizerModule("WCReadoutPMT");
+  //Get pointers to the WC Dark Noise, Digitizer & Trigger Modules
+  WCSimWCAddDarkNoise* WCDNM =
+    (WCSimWCAddDarkNoise*)DMman->FindDigitizerModule("WCDarkNoise");
+  WCSimWCDigitizerBase* WCDM =
+    (WCSimWCDigitizerBase*)DMman->FindDigitizerModule("WCReadoutDigits");
+  WCSimWCTriggerBase* WCTM =
+    (WCSimWCTriggerBase*)DMman->FindDigitizerModule("WCReadout");
 
- 
-  // new MFechner, aug 2006
-  // need to clear up the old info inside PMT
-  WCDMPMT->ReInitialize();
-  
-  
 #ifdef TIME_DAQ_STEPS
   TStopwatch* ms = new TStopwatch();
   ms->Start();
 #endif
 
-  //Convert the hits to PMT pulse
-  WCDMPMT->Digitize();
-
-  //
-  // Do the Dark Noise, then Digitization, then Trigger
-  //
+  WCSimHitLibrary* rawSignalLibrary = GetRunAction()->GetRawSignalLibrary();
 
-  //
-  // First, add Dark noise hits before digitizing
-    
-  //Get a pointer to the WC Dark Noise Module
-  WCSimWCAddDarkNoise* WCDNM =
-    (WCSimWCAddDarkNoise*)DMman->FindDigitizerModule("WCDarkNoise");
-  
-  //Add the dark noise
-  WCDNM->AddDarkNoise();
-
-  //
-  // Next, do the digitization
-  
-  //Get a pointer to the WC Digitizer Module
-  WCSimWCDigitizerBase* WCDM =
-    (WCSimWCDigitizerBase*)DMman->FindDigitizerModule("WCReadoutDigits");
-
-  //Digitize the hits
-  WCDM->Digitize();
+  if(WCTM->GetTriggerClassName() != "Continuous") {
+    //Convert the hits to PMT pulses, add dark noise, digitize & trigger, all in one go
+    RunDAQ(-DBL_MAX, DBL_MAX, 0);
+  }
+  else {
+    //Continuous readout: digitize in chunks of /DAQ/TriggerContinuous/SlicesPerChunk time slices, deleting the
+    // PMT pulses & digits of each chunk before the next, so that their memory does not grow with the length of the event.
+    // The pulses & dark noise within the digitizer integration window + deadtime either side of a chunk are also made,
+    // so that the digits at its edges see the same p.e. as in one go
+    const double length = (double)WCTM->GetTimeSliceLength() * WCTM->GetTimeSlicesPerChunk();
+    if(length <= 0) {
+      G4cerr << "WCSimEventAction::EndOfEventAction() Continuous readout time slice length & slices per chunk must be positive. Exiting..." << G4endl;
+      exit(-1);
+    }
+    const double margin = WCDM->GetDigitizerIntegrationWindow() + WCDM->GetDigitizerDeadTime();
+
+    //The time range of the event: its hits (put in time order, so the PMT module can find those of each chunk),
+    // the replayed PMT pulses & the fixed dark noise window
+    double tmin = DBL_MAX, tmax = -DBL_MAX;
+    if(WCHC)
+      for (G4int i = 0; i < WCHC->entries(); i++) {
+	WCSimWCHit* hit = (*WCHC)[i];
+	hit->SortPeByTime();
+	if(hit->GetTotalPe()) {
+	  tmin = std::min(tmin, (double)hit->GetTime(0));
+	  tmax = std::max(tmax, (double)hit->GetTime(hit->GetTotalPe() - 1));
+	}
+      }
+    if(generatorAction->IsUsingReplayEvtGenerator())
+      for (uint64_t ih = 0; ih < generatorAction->GetReplayNumHits(); ih++) {
+	tmin = std::min(tmin, (double)generatorAction->GetReplayHits()[ih].time);
+	tmax = std::max(tmax, (double)generatorAction->GetReplayHits()[ih].time);
+      }
+    if(WCDNM->GetDarkMode() == 0) {
+      tmin = std::min(tmin, WCDNM->GetDarkLow());
+      tmax = std::max(tmax, WCDNM->GetDarkHigh());
+    }
 
-  //
-  // Finally, apply the trigger
-  
-  //Get a pointer to the WC Trigger Module
-  WCSimWCTriggerBase* WCTM =
-    (WCSimWCTriggerBase*)DMman->FindDigitizerModule("WCReadout");
-  
-  //tell it the dark noise rate (for calculating the average dark occupancy -> can adjust the NDigits threshold)
-  WCTM->SetDarkRate(WCDNM->GetDarkRate());
-  
-  //Apply the trigger
-  // This takes the digits, and places them into trigger gates
-  // Also throws away digits not contained in an trigger gate
-  WCTM->Digitize();
+    WCTM->BeginTimeSlices();
+    int nchunks = 0;
+    if(tmin <= tmax)
+      for(long ichunk = (long)std::floor(tmin / length); ichunk * length <= tmax; ichunk++) {
+	RunDAQ(ichunk * length, (ichunk + 1) * length, margin);
+	DeleteDigiCollection("WCRawPMTSignalCollection");
+	DeleteDigiCollection("WCDigitizedStoreCollection");
+	DeleteDigiCollection("WCDigitizedCollection");
+	nchunks++;
+      }
+    G4cout << "Digitized the continuous readout in " << nchunks << " chunks of " << length << " ns" << G4endl;
+  }
+  if(rawSignalLibrary)
+    rawSignalLibrary->EndEntry();
 
 #ifdef TIME_DAQ_STEPS
   ms->Stop();
@@ -331,6 +393,7 @@ void WCSimEventAction::EndOfEventAction(const G4Event* evt)
 #endif
 
    // Get the post-noise hit collection for the WC
+   // (the continuous readout deletes it chunk by chunk, so it is then not saved)
    G4int WCDChitsID = DMman->GetDigiCollectionID("WCRawPMTSignalCollection");
    WCSimWCDigitsCollection * WCDC_hits = (WCSimWCDigitsCollection*) DMman->GetDigiCollection(WCDChitsID);
   
@@ -491,6 +554,8 @@ void WCSimEventAction::EndOfEventAction(const G4Event* evt)
     WCSimRootOptions * wcsimopt = runAction->GetRootOptions();
     //Dark noise
     WCDNM->SaveOptionsToOutput(wcsimopt);
+    //Overlay
+    WCOM->SaveOptionsToOutput(wcsimopt);
     //Digitizer
     WCDM->SaveOptionsToOutput(wcsimopt);
     //Trigger
@@ -500,6 +565,10 @@ void WCSimEventAction::EndOfEventAction(const G4Event* evt)
     
     SavedOptions = true;
   }
+
+  //roll over to the next output chunk if this one is full
+  if(runAction->GetUseChunks())
+    runAction->EndOfEventChunkCheck(event_id);
 }
 
 G4int WCSimEventAction::WCSimEventFindStartingVolume(G4ThreeVector vtx)
@@ -598,6 +667,96 @@ G4int WCSimEventAction::WCSimEventFindStoppingVolume(G4String stopVolumeName)
   return stopvol;
 }
 
+void WCSimEventAction::RunDAQ(double low, double high, double margin)
+{
+  G4DigiManager* DMman = G4DigiManager::GetDMpointer();
+
+  // Get a pointer to the WC PMT module
+  WCSimWCPMT* WCDMPMT =
+    (WCSimWCPMT*)DMman->FindDigitizerModule("WCReadoutPMT");
+
+  // new MFechner, aug 2006
+  // need to clear up the old info inside PMT
+  WCDMPMT->ReInitialize();
+
+  //Convert the hits to PMT pulse
+  WCDMPMT->SetNThreads(DAQNThreads);
+  WCDMPMT->SetTimeRange(low - margin, high + margin);
+  WCDMPMT->Digitize();
+
+  //In replay mode, add the saved PMT pulses of this entry
+  if(generatorAction->IsUsingReplayEvtGenerator())
+    WCDMPMT->AddRawSignal(generatorAction->GetReplayHits(), generatorAction->GetReplayNumHits());
+
+  //Save the PMT pulses to the raw signal library, before dark noise is added
+  // (only those in [low, high), as the margins are also converted by the next/previous chunk)
+  WCSimHitLibrary* rawSignalLibrary = GetRunAction()->GetRawSignalLibrary();
+  if(rawSignalLibrary) {
+    WCSimWCDigitsCollection* WCDC_raw =
+      (WCSimWCDigitsCollection*)DMman->GetDigiCollection(DMman->GetDigiCollectionID("WCRawPMTSignalCollection"));
+    G4int nraw = WCDC_raw ? WCDC_raw->entries() : 0;
+    for (G4int i = 0; i < nraw; i++)
+      for (G4int ip = 0; ip < (*WCDC_raw)[i]->GetTotalPe(); ip++)
+	if((*WCDC_raw)[i]->GetTime(ip) >= low && (*WCDC_raw)[i]->GetTime(ip) < high)
+	  rawSignalLibrary->AddHit((*WCDC_raw)[i]->GetTubeID(), (*WCDC_raw)[i]->GetTime(ip),
+				   (*WCDC_raw)[i]->GetPe(ip), (*WCDC_raw)[i]->GetParentID(ip));
+  }
+
+  //
+  // Do the Dark Noise, then Digitization, then Trigger
+  //
+
+  //
+  // First, add Dark noise hits before digitizing
+    
+  //Get a pointer to the WC Dark Noise Module
+  WCSimWCAddDarkNoise* WCDNM =
+    (WCSimWCAddDarkNoise*)DMman->FindDigitizerModule("WCDarkNoise");
+  
+  //Add the dark noise
+  WCDNM->SetTimeRange(low - margin, high + margin);
+  WCDNM->AddDarkNoise();
+
+  //
+  // Next, do the digitization
+  
+  //Get a pointer to the WC Digitizer Module
+  WCSimWCDigitizerBase* WCDM =
+    (WCSimWCDigitizerBase*)DMman->FindDigitizerModule("WCReadoutDigits");
+
+  //Digitize the hits
+  WCDM->SetNThreads(DAQNThreads);
+  WCDM->Digitize();
+
+  //
+  // Finally, apply the trigger
+  
+  //Get a pointer to the WC Trigger Module
+  WCSimWCTriggerBase* WCTM =
+    (WCSimWCTriggerBase*)DMman->FindDigitizerModule("WCReadout");
+  
+  //tell it the dark noise rate (for calculating the average dark occupancy -> can adjust the NDigits threshold)
+  WCTM->SetDarkRate(WCDNM->GetDarkRate());
+  
+  //Apply the trigger
+  // This takes the digits, and places them into trigger gates
+  // Also throws away digits not contained in an trigger gate
+  WCTM->SetTimeSliceRange(low, high);
+  WCTM->Digitize();
+}
+
+void WCSimEventAction::DeleteDigiCollection(const G4String & name)
+{
+  //G4DCofThisEvent does not delete a collection when it is replaced, so forget it first
+  G4DigiManager* DMman = G4DigiManager::GetDMpointer();
+  G4int id = DMman->GetDigiCollectionID(name);
+  G4VDigiCollection* collection = (G4VDigiCollection*)DMman->GetDigiCollection(id);
+  if(!collection)
+    return;
+  DMman->SetDigiCollection(id, 0);
+  delete collection;
+}
+
 void WCSimEventAction::FillRootEvent(G4int event_id, 
 				     const struct ntupleStruct& jhfNtuple,
 				     G4TrajectoryContainer* TC,
@@ -792,9 +951,10 @@ void WCSimEventAction::FillRootEvent(G4int event_id,
       }
 
       // Add the track to the TClonesArray, watching out for times
-      if ( trj->GetCreatorProcessName()=="nCapture" ?
-           detectorConstructor->SaveCaptureInfo() :
-           ! ( (ipnu==22)&&(parentType==999)) ) {
+      if ( runAction->GetSaveTracks() &&
+           (trj->GetCreatorProcessName()=="nCapture" ?
+            detectorConstructor->SaveCaptureInfo() :
+            ! ( (ipnu==22)&&(parentType==999))) ) {
           int choose_event = 0;
 
           if (ngates) {
@@ -878,6 +1038,10 @@ void WCSimEventAction::FillRootEvent(G4int event_id,
     G4cout<<"RAW HITS"<<G4endl;
 #endif
     wcsimrootevent->SetNumTubesHit(WCDC_hits->entries());
+    const bool saveHitTimes        = runAction->GetSaveHitTimes();
+    const bool savePhotonStartTime = runAction->GetSavePhotonStartTime();
+    const bool savePhotonStartPos  = runAction->GetSavePhotonStartPos();
+    const bool savePhotonEndPos    = runAction->GetSavePhotonEndPos();
     std::vector<float> truetime, smeartime;
     std::vector<int>   primaryParentID;
     std::vector<float> photonStartTime;
@@ -893,23 +1057,33 @@ void WCSimEventAction::FillRootEvent(G4int event_id,
       int digi_tubeid = (*WCDC_hits)[idigi]->GetTubeID();
       WCSimPmtInfo *pmt = ((WCSimPmtInfo*)fpmts->at(digi_tubeid -1));
 
+      if(!saveHitTimes) {
+	wcsimrootevent->AddCherenkovHit(digi_tubeid,
+					pmt->Get_mPMTid(),
+					pmt->Get_mPMT_pmtid(),
+					(*WCDC_hits)[idigi]->GetTotalPe());
+	continue;
+      }
+
       for(G4int id = 0; id < (*WCDC_hits)[idigi]->GetTotalPe(); id++){
 	hit_time_true  = (*WCDC_hits)[idigi]->GetPreSmearTime(id);
 	hit_parentid = (*WCDC_hits)[idigi]->GetParentID(id);
-	hit_photon_starttime = (*WCDC_hits)[idigi]->GetPhotonStartTime(id);
-	hit_photon_startpos = TVector3(
-	        (*WCDC_hits)[idigi]->GetPhotonStartPos(id)[0], 
-	        (*WCDC_hits)[idigi]->GetPhotonStartPos(id)[1], 
-	        (*WCDC_hits)[idigi]->GetPhotonStartPos(id)[2]);
-	hit_photon_endpos = TVector3(
-	        (*WCDC_hits)[idigi]->GetPhotonEndPos(id)[0],
-	        (*WCDC_hits)[idigi]->GetPhotonEndPos(id)[1],
-	        (*WCDC_hits)[idigi]->GetPhotonEndPos(id)[2]);
 	truetime.push_back(hit_time_true);
 	primaryParentID.push_back(hit_parentid);
-	photonStartTime.push_back(hit_photon_starttime);
-	photonStartPos.push_back(hit_photon_startpos);
-	photonEndPos.push_back(hit_photon_endpos);
+	if(savePhotonStartTime) {
+	  hit_photon_starttime = (*WCDC_hits)[idigi]->GetPhotonStartTime(id);
+	  photonStartTime.push_back(hit_photon_starttime);
+	}
+	if(savePhotonStartPos) {
+	  const G4ThreeVector & startpos = (*WCDC_hits)[idigi]->GetPhotonStartPos(id);
+	  hit_photon_startpos = TVector3(startpos[0], startpos[1], startpos[2]);
+	  photonStartPos.push_back(hit_photon_startpos);
+	}
+	if(savePhotonEndPos) {
+	  const G4ThreeVector & endpos = (*WCDC_hits)[idigi]->GetPhotonEndPos(id);
+	  hit_photon_endpos = TVector3(endpos[0], endpos[1], endpos[2]);
+	  photonEndPos.push_back(hit_photon_endpos);
+	}
 #ifdef _SAVE_RAW_HITS_VERBOSE
 	hit_time_smear = (*WCDC_hits)[idigi]->GetTime(id);
 	smeartime.push_back(hit_time_smear);
@@ -0,0 +1,332 @@
+#include "WCSimFastOptics.hh"
+#include "WCSimFastOpticsMessenger.hh"
+#include "WCSimDetectorConstruction.hh"
+#include "WCSimRunAction.hh"
+
+#include "G4Event.hh"
+#include "G4EventManager.hh"
+#include "G4PrimaryVertex.hh"
+#include "G4PrimaryParticle.hh"
+#include "G4OpticalPhoton.hh"
+#include "G4Step.hh"
+#include "G4Track.hh"
+#include "G4Material.hh"
+#include "G4MaterialPropertiesTable.hh"
+#include "G4Navigator.hh"
+#include "G4TransportationManager.hh"
+#include "G4RunManager.hh"
+#include "G4Poisson.hh"
+#include "G4ios.hh"
+#include "Randomize.hh"
+
+#include "G4PhysicalConstants.hh"
+#include "G4SystemOfUnits.hh"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+
+namespace {
+  // Cherenkov photons per unit energy & length for unit charge (as G4Cerenkov)
+  const G4double kCherenkovFactor = 369.81 / (eV * cm);
+
+  /// A photon energy from the Cherenkov spectrum of a beta = 1 particle (flat in energy, times 1 - 1/n^2).
+  /// 0 if the material does not make Cherenkov light
+  G4double SampleCherenkovEnergy(G4MaterialPropertyVector* rindex)
+  {
+    const size_t n = rindex->GetVectorLength();
+    G4double maxWeight = 0;
+    for(size_t i = 0; i < n; i++)
+      maxWeight = std::max(maxWeight, 1 - 1 / ((*rindex)[i] * (*rindex)[i]));
+    if(maxWeight <= 0)
+      return 0;
+    const G4double emin = rindex->Energy(0), emax = rindex->Energy(n - 1);
+    for(;;) {
+      const G4double energy = emin + G4UniformRand() * (emax - emin);
+      const G4double index = rindex->Value(energy);
+      if(G4UniformRand() * maxWeight <= 1 - 1 / (index * index))
+	return energy;
+    }
+  }
+}
+
+WCSimFastOptics::WCSimFastOptics(WCSimDetectorConstruction* myDC)
+  : myDetector(myDC),
+    voxelSize(50 * cm), nCosTheta(8), nPhi(16), photonsPerCell(10000), minProbability(0),
+    nextCell(0), cellPhotons(0),
+    coneSamples(12), currentTrackID(-1), currentTrackFirst(0), currentEventID(-1)
+{
+  messenger = new WCSimFastOpticsMessenger(this);
+}
+
+WCSimFastOptics::~WCSimFastOptics()
+{
+  delete messenger;
+}
+
+void WCSimFastOptics::UseTable(G4String fname)
+{
+  if(!table.Open(fname)) {
+    G4cerr << "Could not open the photon table " << fname << ". Exiting..." << G4endl;
+    exit(-1);
+  }
+  tableFileName = fname;
+}
+
+void WCSimFastOptics::BeginOfRun()
+{
+  nextCell = 0;
+  pending.clear();
+  currentTrackID = -1;
+  currentEventID = -1;
+
+  const G4int ntubes = myDetector->GetTotalNumPmts();
+  if(!buildFileName.empty()) {
+    if(IsFast()) {
+      G4cerr << "A photon table can not be built (/WCSim/FastOptics/BuildTable) while one is used (/WCSim/FastOptics/UseTable). Exiting..." << G4endl;
+      exit(-1);
+    }
+    // The voxel box covers all the PMTs
+    G4ThreeVector low(DBL_MAX, DBL_MAX, DBL_MAX), high(-DBL_MAX, -DBL_MAX, -DBL_MAX);
+    for(G4int tube = 1; tube <= ntubes; tube++) {
+      const G4ThreeVector pos = myDetector->GetTubeTransform(tube).getTranslation();
+      for(int i = 0; i < 3; i++) {
+	low[i]  = std::min(low[i], pos[i]);
+	high[i] = std::max(high[i], pos[i]);
+      }
+    }
+    const G4double margin = myDetector->GetPMTSize();
+    double origin[3];
+    int nBins[5];
+    for(int i = 0; i < 3; i++) {
+      nBins[i]  = std::max(1, (int)std::ceil((high[i] - low[i] + 2 * margin) / voxelSize));
+      origin[i] = (0.5 * (low[i] + high[i]) - 0.5 * nBins[i] * voxelSize) / cm;
+    }
+    nBins[3] = nCosTheta;
+    nBins[4] = nPhi;
+    if(!table.Create(buildFileName, myDetector->GetDetectorName(), ntubes, origin, voxelSize / cm, nBins, photonsPerCell)) {
+      G4cerr << "Could not create the photon table " << buildFileName << ". Exiting..." << G4endl;
+      exit(-1);
+    }
+    G4cout << "Building the photon table " << buildFileName << ": " << nBins[0] << " x " << nBins[1] << " x " << nBins[2]
+	   << " voxels of " << voxelSize / cm << " cm, " << nCosTheta << " x " << nPhi << " directions. Run "
+	   << table.GetNumCells() << " events of /mygen/generator photontable to fill it" << G4endl;
+  }
+  else if(IsFast()) {
+    const WCSimPhotonTableHeader & header = table.GetHeader();
+    if((G4int)header.numTubes != ntubes || myDetector->GetDetectorName() != header.detectorName) {
+      G4cerr << "The photon table " << tableFileName << " was built for " << header.detectorName << " (" << header.numTubes
+	     << " PMTs), not " << myDetector->GetDetectorName() << " (" << ntubes << " PMTs). Exiting..." << G4endl;
+      exit(-1);
+    }
+    G4cout << "Fast optical simulation: the Cherenkov light of charged particles is sampled from the photon table "
+	   << tableFileName << G4endl;
+  }
+}
+
+void WCSimFastOptics::EndOfRun()
+{
+  if(IsBuilding() && !table.Finish())
+    G4cerr << "Error finishing the photon table " << buildFileName << G4endl;
+}
+
+void WCSimFastOptics::SaveOptionsToOutput(WCSimRootOptions * wcopt)
+{
+  wcopt->SetFastOpticsTable(IsFast() ? tableFileName : G4String(""));
+  wcopt->SetFastOpticsConeSamples(coneSamples);
+}
+
+G4bool WCSimFastOptics::GenerateCellPhotons(G4Event* anEvent)
+{
+  if(buildFileName.empty()) {
+    G4cerr << "Set the photon table to build with /WCSim/FastOptics/BuildTable before /run/beamOn. Exiting..." << G4endl;
+    exit(-1);
+  }
+  // The table is finished as soon as its last cell is filled
+  if(!IsBuilding() || nextCell >= table.GetNumCells())
+    return false;
+  const uint64_t cell = nextCell++;
+  double low[3], high[3], costLow, costHigh, phiLow, phiHigh;
+  table.GetCellBounds(cell, low, high, costLow, costHigh, phiLow, phiHigh);
+
+  G4Navigator* navigator = G4TransportationManager::GetTransportationManager()->GetNavigatorForTracking();
+  G4ParticleDefinition* opticalPhoton = G4OpticalPhoton::OpticalPhotonDefinition();
+  cellPhotons = 0;
+  for(G4int i = 0; i < photonsPerCell; i++) {
+    const G4ThreeVector pos((low[0] + G4UniformRand() * (high[0] - low[0])) * cm,
+			    (low[1] + G4UniformRand() * (high[1] - low[1])) * cm,
+			    (low[2] + G4UniformRand() * (high[2] - low[2])) * cm);
+    // Only transparent materials make Cherenkov light: photons elsewhere are neither emitted nor counted
+    G4VPhysicalVolume* volume = navigator->LocateGlobalPointAndSetup(pos, 0, false, true);
+    G4MaterialPropertiesTable* MPT = volume ? volume->GetLogicalVolume()->GetMaterial()->GetMaterialPropertiesTable() : 0;
+    G4MaterialPropertyVector* rindex = MPT ? MPT->GetProperty("RINDEX") : 0;
+    const G4double energy = rindex ? SampleCherenkovEnergy(rindex) : 0;
+    if(energy <= 0)
+      continue;
+    cellPhotons++;
+
+    const G4double cost = costLow + G4UniformRand() * (costHigh - costLow);
+    const G4double sint = std::sqrt(1 - cost * cost);
+    const G4double phi  = phiLow + G4UniformRand() * (phiHigh - phiLow);
+    const G4ThreeVector dir(sint * std::cos(phi), sint * std::sin(phi), cost);
+    G4ThreeVector polarization = dir.orthogonal().unit();
+    polarization.rotate(twopi * G4UniformRand(), dir);
+
+    G4PrimaryParticle* photon = new G4PrimaryParticle(opticalPhoton);
+    photon->SetMomentumDirection(dir);
+    photon->SetKineticEnergy(energy);
+    photon->SetPolarization(polarization.x(), polarization.y(), polarization.z());
+    G4PrimaryVertex* vertex = new G4PrimaryVertex(pos, 0.);
+    vertex->SetPrimary(photon);
+    anEvent->AddPrimaryVertex(vertex);
+  }
+  return true;
+}
+
+void WCSimFastOptics::EndCell(WCSimWCHitsCollection* WCHC)
+{
+  if(!IsBuilding())
+    return;
+  if(WCHC)
+    for(G4int i = 0; i < WCHC->entries(); i++)
+      for(G4int ip = 0; ip < (*WCHC)[i]->GetTotalPe(); ip++)
+	table.AddHit((*WCHC)[i]->GetTubeID(), (*WCHC)[i]->GetTime(ip));
+  table.EndCell(cellPhotons, minProbability);
+  if(nextCell == table.GetNumCells()) {
+    G4cout << "All the cells of the photon table " << buildFileName << " are filled" << G4endl;
+    EndOfRun();
+  }
+}
+
+void WCSimFastOptics::ProcessStep(const G4Step* aStep)
+{
+  const G4Track* track = aStep->GetTrack();
+  const G4double charge = track->GetDefinition()->GetPDGCharge();
+  const G4double length = aStep->GetStepLength();
+  if(charge == 0 || length <= 0)
+    return;
+  G4MaterialPropertiesTable* MPT = track->GetMaterial()->GetMaterialPropertiesTable();
+  G4MaterialPropertyVector* rindex = MPT ? MPT->GetProperty("RINDEX") : 0;
+  if(!rindex)
+    return;
+
+  const G4StepPoint* pre  = aStep->GetPreStepPoint();
+  const G4StepPoint* post = aStep->GetPostStepPoint();
+  const G4double beta = 0.5 * (pre->GetBeta() + post->GetBeta());
+  if(beta <= 0)
+    return;
+
+  // Mean number of photons (the integral of 1 - 1/(beta n)^2 over the photon energies above threshold),
+  // and the mean refractive index of the light, which sets the cone angle
+  G4double integral = 0, indexIntegral = 0;
+  for(size_t i = 0; i + 1 < rindex->GetVectorLength(); i++) {
+    const G4double n0 = (*rindex)[i], n1 = (*rindex)[i + 1];
+    const G4double f0 = std::max(0., 1 - 1 / (beta * beta * n0 * n0));
+    const G4double f1 = std::max(0., 1 - 1 / (beta * beta * n1 * n1));
+    const G4double de = rindex->Energy(i + 1) - rindex->Energy(i);
+    integral      += 0.5 * (f0 + f1) * de;
+    indexIntegral += 0.5 * (f0 * n0 + f1 * n1) * de;
+  }
+  if(integral <= 0)
+    return;
+  const G4double cost = 1 / (beta * indexIntegral / integral);
+  if(cost >= 1)
+    return;
+  const G4double sint = std::sqrt(1 - cost * cost);
+  const G4double meanPhotons = kCherenkovFactor * (charge / eplus) * (charge / eplus) * integral * length;
+  const G4double photonsPerSample = meanPhotons / coneSamples;
+
+  // The p.e. are kept per track, to be given the track's primary parent ID at its end
+  const G4int eventID = G4EventManager::GetEventManager()->GetConstCurrentEvent()->GetEventID();
+  if(eventID != currentEventID) {
+    pending.clear();
+    currentEventID = eventID;
+    currentTrackID = -1;
+  }
+  if(track->GetTrackID() != currentTrackID) {
+    currentTrackID = track->GetTrackID();
+    currentTrackFirst = pending.size();
+  }
+
+  const G4ThreeVector step = post->GetPosition() - pre->GetPosition();
+  const G4ThreeVector axis = step.unit();
+  const G4ThreeVector u = axis.orthogonal().unit();
+  const G4ThreeVector v = axis.cross(u);
+  const G4double phase = twopi * G4UniformRand();
+  const G4double duration = post->GetGlobalTime() - pre->GetGlobalTime();
+  for(G4int k = 0; k < coneSamples; k++) {
+    const G4double f = (k + G4UniformRand()) / coneSamples;
+    const G4ThreeVector pos = pre->GetPosition() + f * step;
+    const G4double phi = phase + twopi * k / coneSamples;
+    const G4ThreeVector dir = cost * axis + sint * (std::cos(phi) * u + std::sin(phi) * v);
+    const int64_t cell = table.GetCellIndex(pos.x() / cm, pos.y() / cm, pos.z() / cm, dir.x(), dir.y(), dir.z());
+    if(cell < 0)
+      continue;
+    const G4double time = pre->GetGlobalTime() + f * duration;
+    const WCSimPhotonTableEntry* entries = table.GetCell(cell);
+    const uint64_t nentries = table.GetCellSize(cell);
+    for(uint64_t ie = 0; ie < nentries; ie++) {
+      const G4long npe = G4Poisson(photonsPerSample * entries[ie].probability);
+      for(G4long ipe = 0; ipe < npe; ipe++) {
+	PendingPe pe;
+	pe.tube      = entries[ie].tube;
+	pe.time      = time / ns + WCSimPhotonTable::SampleTime(entries[ie], G4UniformRand());
+	pe.parentID  = currentTrackID;
+	pe.startTime = time / ns;
+	pe.startPos  = pos;
+	pending.push_back(pe);
+      }
+    }
+  }
+}
+
+void WCSimFastOptics::EndOfTrack(G4int trackID, G4int primaryParentID)
+{
+  if(trackID != currentTrackID)
+    return;
+  for(size_t i = currentTrackFirst; i < pending.size(); i++)
+    pending[i].parentID = primaryParentID;
+}
+
+void WCSimFastOptics::FillHits(WCSimWCHitsCollection* WCHC)
+{
+  if(!WCHC) {
+    pending.clear();
+    return;
+  }
+  //Only fill the optional photon truth that WCSimWCPMT will copy
+  WCSimRunAction* runAction = (WCSimRunAction*)G4RunManager::GetRunManager()->GetUserRunAction();
+  const bool savePhotonStartTime = runAction->GetSavePhotonStartTime();
+  const bool savePhotonStartPos  = runAction->GetSavePhotonStartPos();
+  const bool savePhotonEndPos    = runAction->GetSavePhotonEndPos();
+
+  //Find the hit of each tube that already has one
+  HitIndex.assign(myDetector->GetTotalNumPmts() + 1, -1);
+  for(G4int i = 0; i < WCHC->entries(); i++)
+    HitIndex[(*WCHC)[i]->GetTubeID()] = i;
+
+  for(size_t ipe = 0; ipe < pending.size(); ipe++) {
+    const PendingPe & pe = pending[ipe];
+    if(HitIndex[pe.tube] < 0) {
+      WCSimWCHit* hit = new WCSimWCHit();
+      const G4Transform3D & transform = myDetector->GetTubeTransform(pe.tube);
+      hit->SetTubeID(pe.tube);
+      hit->SetTrackID(0);
+      hit->SetEdep(0.);
+      hit->SetPos(transform.getTranslation());
+      hit->SetRot(transform.getRotation());
+      HitIndex[pe.tube] = WCHC->insert(hit) - 1;
+    }
+    WCSimWCHit* hit = (*WCHC)[HitIndex[pe.tube]];
+    hit->AddPe(pe.time);
+    hit->AddParentID(pe.parentID);
+    if(savePhotonStartTime)
+      hit->AddPhotonStartTime(pe.startTime);
+    if(savePhotonStartPos)
+      hit->AddPhotonStartPos(pe.startPos);
+    if(savePhotonEndPos)
+      hit->AddPhotonEndPos(hit->GetPos());
+  }
+  pending.clear();
+  currentTrackID = -1;
+}
@@ -0,0 +1,115 @@
+#include "WCSimFastOpticsMessenger.hh"
+#include "WCSimFastOptics.hh"
+
+#include "G4UIdirectory.hh"
+#include "G4UIcommand.hh"
+#include "G4UIcmdWithAString.hh"
+#include "G4UIcmdWithAnInteger.hh"
+#include "G4UIcmdWithADouble.hh"
+#include "G4UIcmdWithADoubleAndUnit.hh"
+
+WCSimFastOpticsMessenger::WCSimFastOpticsMessenger(WCSimFastOptics* fastoptics)
+  : WCSimFastOpt(fastoptics)
+{
+  WCSimDir = new G4UIdirectory("/WCSim/FastOptics/");
+  WCSimDir->SetGuidance("Commands to build & use tables of photon detection probabilities, instead of tracking optical photons");
+
+  BuildTable = new G4UIcmdWithAString("/WCSim/FastOptics/BuildTable",this);
+  BuildTable->SetGuidance("Build a photon table in this file, with the events of /mygen/generator photontable (one per cell)");
+  BuildTable->SetGuidance("The table is written at the end of the run");
+  BuildTable->SetParameterName("BuildTable",false);
+  BuildTable->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+  VoxelSize = new G4UIcmdWithADoubleAndUnit("/WCSim/FastOptics/VoxelSize",this);
+  VoxelSize->SetGuidance("Set the size of the cubic position bins of the table built");
+  VoxelSize->SetParameterName("VoxelSize",false);
+  VoxelSize->SetDefaultValue(50.);
+  VoxelSize->SetUnitCategory("Length");
+  VoxelSize->SetDefaultUnit("cm");
+  VoxelSize->SetRange("VoxelSize>0");
+
+  NCosTheta = new G4UIcmdWithAnInteger("/WCSim/FastOptics/NCosTheta",this);
+  NCosTheta->SetGuidance("Set the number of cos(theta) bins of the photon directions of the table built");
+  NCosTheta->SetParameterName("NCosTheta",false);
+  NCosTheta->SetDefaultValue(8);
+  NCosTheta->SetRange("NCosTheta>0");
+
+  NPhi = new G4UIcmdWithAnInteger("/WCSim/FastOptics/NPhi",this);
+  NPhi->SetGuidance("Set the number of phi bins of the photon directions of the table built");
+  NPhi->SetParameterName("NPhi",false);
+  NPhi->SetDefaultValue(16);
+  NPhi->SetRange("NPhi>0");
+
+  PhotonsPerCell = new G4UIcmdWithAnInteger("/WCSim/FastOptics/PhotonsPerCell",this);
+  PhotonsPerCell->SetGuidance("Set the number of photons tracked from each cell of the table built");
+  PhotonsPerCell->SetParameterName("PhotonsPerCell",false);
+  PhotonsPerCell->SetDefaultValue(10000);
+  PhotonsPerCell->SetRange("PhotonsPerCell>0");
+
+  MinProbability = new G4UIcmdWithADouble("/WCSim/FastOptics/MinProbability",this);
+  MinProbability->SetGuidance("Drop the PMTs seen from a cell with a lower detection probability than this from the table built");
+  MinProbability->SetParameterName("MinProbability",false);
+  MinProbability->SetDefaultValue(0.);
+  MinProbability->SetRange("MinProbability>=0");
+
+  UseTable = new G4UIcmdWithAString("/WCSim/FastOptics/UseTable",this);
+  UseTable->SetGuidance("Do not track the Cherenkov photons: sample their p.e. from this photon table");
+  UseTable->SetGuidance("The table must have been built with the same geometry");
+  UseTable->SetParameterName("UseTable",false);
+  UseTable->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+  ConeSamples = new G4UIcmdWithAnInteger("/WCSim/FastOptics/ConeSamples",this);
+  ConeSamples->SetGuidance("Set the number of directions on the Cherenkov cone of each step looked up in the photon table");
+  ConeSamples->SetParameterName("ConeSamples",false);
+  ConeSamples->SetDefaultValue(12);
+  ConeSamples->SetRange("ConeSamples>0");
+}
+
+WCSimFastOpticsMessenger::~WCSimFastOpticsMessenger()
+{
+  delete BuildTable;
+  delete VoxelSize;
+  delete NCosTheta;
+  delete NPhi;
+  delete PhotonsPerCell;
+  delete MinProbability;
+  delete UseTable;
+  delete ConeSamples;
+  delete WCSimDir;
+}
+
+void WCSimFastOpticsMessenger::SetNewValue(G4UIcommand* command,G4String newValue)
+{
+  if(command == BuildTable){
+    WCSimFastOpt->SetBuildFileName(newValue);
+    G4cout << "Building the photon table " << newValue << G4endl;
+  }
+  else if(command == VoxelSize){
+    WCSimFastOpt->SetVoxelSize(VoxelSize->GetNewDoubleValue(newValue));
+    G4cout << "Setting photon table VoxelSize " << newValue << G4endl;
+  }
+  else if(command == NCosTheta){
+    WCSimFastOpt->SetNCosTheta(NCosTheta->GetNewIntValue(newValue));
+    G4cout << "Setting photon table NCosTheta " << newValue << G4endl;
+  }
+  else if(command == NPhi){
+    WCSimFastOpt->SetNPhi(NPhi->GetNewIntValue(newValue));
+    G4cout << "Setting photon table NPhi " << newValue << G4endl;
+  }
+  else if(command == PhotonsPerCell){
+    WCSimFastOpt->SetPhotonsPerCell(PhotonsPerCell->GetNewIntValue(newValue));
+    G4cout << "Setting photon table PhotonsPerCell " << newValue << G4endl;
+  }
+  else if(command == MinProbability){
+    WCSimFastOpt->SetMinProbability(MinProbability->GetNewDoubleValue(newValue));
+    G4cout << "Setting photon table MinProbability " << newValue << G4endl;
+  }
+  else if(command == UseTable){
+    WCSimFastOpt->UseTable(newValue);
+    G4cout << "Using the photon table " << newValue << G4endl;
+  }
+  else if(command == ConeSamples){
+    WCSimFastOpt->SetConeSamples(ConeSamples->GetNewIntValue(newValue));
+    G4cout << "Setting photon table ConeSamples " << newValue << G4endl;
+  }
+}
@@ -0,0 +1,172 @@
+#include "WCSimGeometryTable.hh"
+
+#include <cstring>
+#include <cstdio>
+#include <iostream>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+namespace {
+  const char kMagic[8] = {'W','C','S','I','M','G','E','O'};
+  const uint64_t kAlignment = 64;
+
+  uint64_t Align(uint64_t n) { return (n + kAlignment - 1) / kAlignment * kAlignment; }
+}
+
+WCSimGeometryTable::WCSimGeometryTable()
+  : fMap(0), fMapSize(0), fHeader(0)
+{
+  memset(&fNewHeader, 0, sizeof(fNewHeader));
+}
+
+WCSimGeometryTable::~WCSimGeometryTable()
+{
+  Close();
+}
+
+void WCSimGeometryTable::SetDetector(int geoType, double cylRadius, double cylLength, double pmtRadius,
+				     int orientation, double offsetx, double offsety, double offsetz)
+{
+  fNewHeader.geoType     = geoType;
+  fNewHeader.cylRadius   = cylRadius;
+  fNewHeader.cylLength   = cylLength;
+  fNewHeader.pmtRadius   = pmtRadius;
+  fNewHeader.orientation = orientation;
+  fNewHeader.offset[0]   = offsetx;
+  fNewHeader.offset[1]   = offsety;
+  fNewHeader.offset[2]   = offsetz;
+}
+
+void WCSimGeometryTable::AddPMT(int tubeID, int mPMTID, int mPMT_PMTID, int cylLocation,
+				double x, double y, double z, double dirx, double diry, double dirz)
+{
+  fIntColumns[kTubeID].push_back(tubeID);
+  fIntColumns[kmPMTID].push_back(mPMTID);
+  fIntColumns[kmPMT_PMTID].push_back(mPMT_PMTID);
+  fIntColumns[kCylLocation].push_back(cylLocation);
+  fDoubleColumns[kPositionX  - kPositionX].push_back(x);
+  fDoubleColumns[kPositionY  - kPositionX].push_back(y);
+  fDoubleColumns[kPositionZ  - kPositionX].push_back(z);
+  fDoubleColumns[kDirectionX - kPositionX].push_back(dirx);
+  fDoubleColumns[kDirectionY - kPositionX].push_back(diry);
+  fDoubleColumns[kDirectionZ - kPositionX].push_back(dirz);
+}
+
+bool WCSimGeometryTable::Write(const std::string & filename) const
+{
+  WCSimGeometryTableHeader header = fNewHeader;
+  memcpy(header.magic, kMagic, sizeof(kMagic));
+  header.version    = kVersion;
+  header.headerSize = sizeof(WCSimGeometryTableHeader);
+  header.numPMT     = fIntColumns[kTubeID].size();
+
+  // Lay out the columns one after the other
+  uint64_t offset = Align(sizeof(WCSimGeometryTableHeader));
+  for(int c = 0; c < kNColumns; c++) {
+    header.columnOffset[c] = offset;
+    const size_t width = c < kPositionX ? sizeof(int32_t) : sizeof(double);
+    offset = Align(offset + width * header.numPMT);
+  }
+  header.fileSize = offset;
+
+  // Written to a file of this process, then renamed: jobs which have mapped an older table
+  // (e.g. other jobs in the same directory) keep reading it, and never see a partial one
+  char suffix[32];
+  snprintf(suffix, sizeof(suffix), ".tmp%d", (int)getpid());
+  const std::string tmpname = filename + suffix;
+  FILE * f = fopen(tmpname.c_str(), "wb");
+  if(!f) {
+    std::cerr << "WCSimGeometryTable: could not open " << tmpname << " for writing" << std::endl;
+    return false;
+  }
+  bool ok = fwrite(&header, sizeof(header), 1, f) == 1;
+  const char zeros[kAlignment] = {0};
+  uint64_t written = sizeof(header);
+  for(int c = 0; c < kNColumns && ok; c++) {
+    ok = fwrite(zeros, 1, header.columnOffset[c] - written, f) == header.columnOffset[c] - written;
+    written = header.columnOffset[c];
+    if(!ok || !header.numPMT) continue;
+    if(c < kPositionX) {
+      ok = fwrite(&fIntColumns[c][0], sizeof(int32_t), header.numPMT, f) == header.numPMT;
+      written += sizeof(int32_t) * header.numPMT;
+    }
+    else {
+      ok = fwrite(&fDoubleColumns[c - kPositionX][0], sizeof(double), header.numPMT, f) == header.numPMT;
+      written += sizeof(double) * header.numPMT;
+    }
+  }
+  if(ok)
+    ok = fwrite(zeros, 1, header.fileSize - written, f) == header.fileSize - written;
+  if(fclose(f) != 0)
+    ok = false;
+  if(ok && rename(tmpname.c_str(), filename.c_str()) != 0)
+    ok = false;
+  if(!ok) {
+    std::cerr << "WCSimGeometryTable: error writing " << filename << std::endl;
+    unlink(tmpname.c_str());
+  }
+  return ok;
+}
+
+bool WCSimGeometryTable::Open(const std::string & filename)
+{
+  Close();
+  int fd = open(filename.c_str(), O_RDONLY);
+  if(fd < 0) {
+    std::cerr << "WCSimGeometryTable: could not open " << filename << std::endl;
+    return false;
+  }
+  struct stat st;
+  if(fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(WCSimGeometryTableHeader)) {
+    std::cerr << "WCSimGeometryTable: " << filename << " is too small to be a geometry table" << std::endl;
+    close(fd);
+    return false;
+  }
+  void * map = mmap(0, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+  close(fd); //the mapping stays valid
+  if(map == MAP_FAILED) {
+    std::cerr << "WCSimGeometryTable: could not mmap " << filename << std::endl;
+    return false;
+  }
+  fMap = static_cast<const char*>(map);
+  fMapSize = st.st_size;
+  fHeader = reinterpret_cast<const WCSimGeometryTableHeader*>(fMap);
+
+  // Validate before any column is handed out
+  const char * problem = 0;
+  if(memcmp(fHeader->magic, kMagic, sizeof(kMagic)) != 0)
+    problem = "is not a WCSim geometry table";
+  else if(fHeader->version != kVersion)
+    problem = "has an unsupported version";
+  else if(fHeader->headerSize != sizeof(WCSimGeometryTableHeader))
+    problem = "has an unexpected header size";
+  else if(fHeader->fileSize != fMapSize)
+    problem = "is truncated";
+  else {
+    for(int c = 0; c < kNColumns; c++) {
+      const size_t width = c < kPositionX ? sizeof(int32_t) : sizeof(double);
+      if(fHeader->columnOffset[c] % kAlignment ||
+	 fHeader->columnOffset[c] + width * fHeader->numPMT > fMapSize) {
+	problem = "has a corrupt column layout";
+	break;
+      }
+    }
+  }
+  if(problem) {
+    std::cerr << "WCSimGeometryTable: " << filename << " " << problem << std::endl;
+    Close();
+    return false;
+  }
+  return true;
+}
+
+void WCSimGeometryTable::Close()
+{
+  if(fMap)
+    munmap(const_cast<char*>(fMap), fMapSize);
+  fMap = 0;
+  fMapSize = 0;
+  fHeader = 0;
+}
@@ -0,0 +1,180 @@
+#include "WCSimHitLibrary.hh"
+
+#include <cstring>
+#include <iostream>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+namespace {
+  const char kMagic[8] = {'W','C','S','I','M','H','I','T'};
+  const uint64_t kAlignment = 64;
+
+  uint64_t Align(uint64_t n) { return (n + kAlignment - 1) / kAlignment * kAlignment; }
+
+  bool WritePadding(FILE * f, uint64_t n)
+  {
+    const char zeros[kAlignment] = {0};
+    return fwrite(zeros, 1, n, f) == n;
+  }
+}
+
+WCSimHitLibrary::WCSimHitLibrary()
+  : fMap(0), fMapSize(0), fHeader(0), fHits(0), fEntries(0),
+    fFile(0), fNewLevel(kPhotonHits)
+{
+}
+
+WCSimHitLibrary::~WCSimHitLibrary()
+{
+  if(fFile)
+    Finish();
+  Close();
+}
+
+bool WCSimHitLibrary::Create(const std::string & filename, EHitLevel level)
+{
+  if(fFile)
+    Finish();
+  fFile = fopen(filename.c_str(), "wb");
+  if(!fFile) {
+    std::cerr << "WCSimHitLibrary: could not open " << filename << " for writing" << std::endl;
+    return false;
+  }
+  fFileName = filename;
+  fNewLevel = level;
+  fNewEntry.clear();
+  fNewEntries.assign(1, 0);
+
+  // Reserve the header; it is filled by Finish()
+  if(!WritePadding(fFile, Align(sizeof(WCSimHitLibraryHeader)))) {
+    std::cerr << "WCSimHitLibrary: error writing " << filename << std::endl;
+    fclose(fFile);
+    fFile = 0;
+    return false;
+  }
+  return true;
+}
+
+void WCSimHitLibrary::AddHit(int tube, float time, float charge, int parentID)
+{
+  WCSimHitLibraryHit hit;
+  hit.tube     = tube;
+  hit.time     = time;
+  hit.charge   = charge;
+  hit.parentID = parentID;
+  fNewEntry.push_back(hit);
+}
+
+bool WCSimHitLibrary::EndEntry()
+{
+  if(!fFile)
+    return false;
+  bool ok = true;
+  if(!fNewEntry.empty())
+    ok = fwrite(&fNewEntry[0], sizeof(WCSimHitLibraryHit), fNewEntry.size(), fFile) == fNewEntry.size();
+  if(!ok)
+    std::cerr << "WCSimHitLibrary: error writing " << fFileName << std::endl;
+  fNewEntries.push_back(fNewEntries.back() + fNewEntry.size());
+  fNewEntry.clear();
+  return ok;
+}
+
+bool WCSimHitLibrary::Finish()
+{
+  if(!fFile)
+    return false;
+  if(!fNewEntry.empty())
+    EndEntry();
+
+  WCSimHitLibraryHeader header;
+  memset(&header, 0, sizeof(header));
+  memcpy(header.magic, kMagic, sizeof(kMagic));
+  header.version     = kVersion;
+  header.headerSize  = sizeof(WCSimHitLibraryHeader);
+  header.level       = fNewLevel;
+  header.numEntries  = fNewEntries.size() - 1;
+  header.numHits     = fNewEntries.back();
+  header.hitOffset   = Align(sizeof(WCSimHitLibraryHeader));
+  const uint64_t hitEnd = header.hitOffset + header.numHits * sizeof(WCSimHitLibraryHit);
+  header.entryOffset = Align(hitEnd);
+  header.fileSize    = Align(header.entryOffset + fNewEntries.size() * sizeof(uint64_t));
+
+  // The hits are already on disk: append the entry boundaries, then go back for the header
+  bool ok = WritePadding(fFile, header.entryOffset - hitEnd);
+  ok = ok && fwrite(&fNewEntries[0], sizeof(uint64_t), fNewEntries.size(), fFile) == fNewEntries.size();
+  ok = ok && WritePadding(fFile, header.fileSize - header.entryOffset - fNewEntries.size() * sizeof(uint64_t));
+  ok = ok && fseek(fFile, 0, SEEK_SET) == 0;
+  ok = ok && fwrite(&header, sizeof(header), 1, fFile) == 1;
+  if(fclose(fFile) != 0)
+    ok = false;
+  fFile = 0;
+  if(!ok)
+    std::cerr << "WCSimHitLibrary: error writing " << fFileName << std::endl;
+  fNewEntries.clear();
+  return ok;
+}
+
+bool WCSimHitLibrary::Open(const std::string & filename)
+{
+  Close();
+  int fd = open(filename.c_str(), O_RDONLY);
+  if(fd < 0) {
+    std::cerr << "WCSimHitLibrary: could not open " << filename << std::endl;
+    return false;
+  }
+  struct stat st;
+  if(fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(WCSimHitLibraryHeader)) {
+    std::cerr << "WCSimHitLibrary: " << filename << " is too small to be a hit library" << std::endl;
+    close(fd);
+    return false;
+  }
+  void * map = mmap(0, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+  close(fd); //the mapping stays valid
+  if(map == MAP_FAILED) {
+    std::cerr << "WCSimHitLibrary: could not mmap " << filename << std::endl;
+    return false;
+  }
+  fMap = static_cast<const char*>(map);
+  fMapSize = st.st_size;
+  fHeader = reinterpret_cast<const WCSimHitLibraryHeader*>(fMap);
+
+  // Validate before any hit is handed out
+  const char * problem = 0;
+  if(memcmp(fHeader->magic, kMagic, sizeof(kMagic)) != 0)
+    problem = "is not a WCSim hit library (or was not finished)";
+  else if(fHeader->version != kVersion)
+    problem = "has an unsupported version";
+  else if(fHeader->headerSize != sizeof(WCSimHitLibraryHeader))
+    problem = "has an unexpected header size";
+  else if(fHeader->fileSize != fMapSize)
+    problem = "is truncated";
+  else if(fHeader->hitOffset % kAlignment || fHeader->entryOffset % kAlignment ||
+	  fHeader->hitOffset + fHeader->numHits * sizeof(WCSimHitLibraryHit) > fHeader->entryOffset ||
+	  fHeader->entryOffset + (fHeader->numEntries + 1) * sizeof(uint64_t) > fMapSize)
+    problem = "has a corrupt layout";
+  else {
+    fHits    = reinterpret_cast<const WCSimHitLibraryHit*>(fMap + fHeader->hitOffset);
+    fEntries = reinterpret_cast<const uint64_t*>(fMap + fHeader->entryOffset);
+    if(fEntries[0] != 0 || fEntries[fHeader->numEntries] != fHeader->numHits)
+      problem = "has a corrupt entry index";
+  }
+  if(problem) {
+    std::cerr << "WCSimHitLibrary: " << filename << " " << problem << std::endl;
+    Close();
+    return false;
+  }
+  return true;
+}
+
+void WCSimHitLibrary::Close()
+{
+  if(fMap)
+    munmap(const_cast<char*>(fMap), fMapSize);
+  fMap = 0;
+  fMapSize = 0;
+  fHeader = 0;
+  fHits = 0;
+  fEntries = 0;
+}
@@ -97,6 +97,16 @@
 
 #include "G4SystemOfUnits.hh"
 
+#include "WCSimFresnel.hh"
+
+#include <algorithm>
+
+namespace {
+  // The grid of the coated surface tables: photon energies & cos(incidence angle)
+  const G4int kCoatedTableEnergies = 64;
+  const G4int kCoatedTableAngles   = 256;
+}
+
 /////////////////////////
 // Class Implementation
 /////////////////////////
@@ -145,6 +155,9 @@ WCSimOpBoundaryProcess::WCSimOpBoundaryProcess(const G4String& processName,
 
         OpticalSurface = NULL;
 
+        fMaterial1Cache = fMaterial2Cache = NULL;
+        fOpticalSurfaceCache = NULL;
+
         kCarTolerance = G4GeometryTolerance::GetInstance()
                         ->GetSurfaceTolerance();
 
@@ -162,6 +175,9 @@ WCSimOpBoundaryProcess::WCSimOpBoundaryProcess(const G4String& processName,
         DichroicVector = NULL;
 
         fInvokeSD = true;
+
+        fUseCoatedTable = false;
+        fCoatedTableTolerance = 1.e-3;
 }
 
 // WCSimOpBoundaryProcess::WCSimOpBoundaryProcess(const WCSimOpBoundaryProcess &right)
@@ -178,6 +194,217 @@ WCSimOpBoundaryProcess::~WCSimOpBoundaryProcess(){}
         // Methods
         ////////////
 
+// BuildPhysicsTable
+// -----------------
+//
+
+void WCSimOpBoundaryProcess::BuildPhysicsTable(const G4ParticleDefinition& )
+{
+        fMaterialCache.clear();
+        fSurfaceCache.clear();
+        fLogicalSurfaceCache.clear();
+        fCoatedTables.clear();
+        fMaterial1Cache = fMaterial2Cache = NULL;
+        fOpticalSurfaceCache = NULL;
+}
+
+// Property caches
+// ---------------
+//
+
+const WCSimOpBoundaryProcess::MaterialCache&
+WCSimOpBoundaryProcess::GetMaterialCache(const G4Material* material)
+{
+        // sized for the whole material table, so that the reference to
+        // the cache of one material stays valid when another is looked up
+        const size_t index = material->GetIndex();
+        if (index >= fMaterialCache.size())
+           fMaterialCache.resize(std::max(index + 1,
+                                 (size_t)G4Material::GetNumberOfMaterials()));
+
+        MaterialCache& cache = fMaterialCache[index];
+        if (!cache.built) {
+           cache.built = true;
+           cache.Table = material->GetMaterialPropertiesTable();
+           if (cache.Table) {
+              cache.Rindex          = cache.Table->GetProperty("RINDEX");
+              cache.RealRindex      = cache.Table->GetProperty("REALRINDEX");
+              cache.ImaginaryRindex = cache.Table->GetProperty("IMAGINARYRINDEX");
+              if (cache.Rindex)
+                 cache.GroupVel     = cache.Table->GetProperty("GROUPVEL");
+           }
+        }
+        return cache;
+}
+
+const WCSimOpBoundaryProcess::SurfaceCache&
+WCSimOpBoundaryProcess::GetSurfaceCache(const G4OpticalSurface* surface)
+{
+        std::unordered_map<const G4OpticalSurface*, SurfaceCache>::iterator
+           it = fSurfaceCache.find(surface);
+        if (it != fSurfaceCache.end()) return it->second;
+
+        SurfaceCache& cache = fSurfaceCache[surface];
+        cache.SigmaAlpha = surface->GetSigmaAlpha();
+        cache.FacetMax   = std::min(1.0,4.*cache.SigmaAlpha);
+        cache.Polish     = surface->GetPolish();
+        cache.Table = surface->GetMaterialPropertiesTable();
+        G4MaterialPropertiesTable* MPT = cache.Table;
+        if (MPT) {
+           cache.Rindex          = MPT->GetProperty("RINDEX");
+           cache.Reflectivity    = MPT->GetProperty("REFLECTIVITY");
+           cache.RealRindex      = MPT->GetProperty("REALRINDEX");
+           cache.ImaginaryRindex = MPT->GetProperty("IMAGINARYRINDEX");
+           cache.Efficiency      = MPT->GetProperty("EFFICIENCY");
+           cache.Transmittance   = MPT->GetProperty("TRANSMITTANCE");
+
+           if ((cache.hasSurfaceRoughness =
+                MPT->ConstPropertyExists("SURFACEROUGHNESS")))
+              cache.SurfaceRoughness = MPT->GetConstProperty("SURFACEROUGHNESS");
+
+           // as in PostStepDoIt() & the coated models, only look for the
+           // properties of the model & type of the surface
+           if (surface->GetModel() == unified) {
+              cache.SpecularLobe  = MPT->GetProperty("SPECULARLOBECONSTANT");
+              cache.SpecularSpike = MPT->GetProperty("SPECULARSPIKECONSTANT");
+              cache.BackScatter   = MPT->GetProperty("BACKSCATTERCONSTANT");
+           }
+
+           const G4SurfaceType type = surface->GetType();
+           if (type == 101 || type == 102) {
+              cache.CoatedRindex = MPT->GetProperty("COATEDRINDEX");
+              if (type == 102)
+                 cache.CoatedRindexIm = MPT->GetProperty("COATEDRINDEXIM");
+              if ((cache.hasCoatedThickness =
+                   MPT->ConstPropertyExists("COATEDTHICKNESS")))
+                 cache.CoatedThickness = MPT->GetConstProperty("COATEDTHICKNESS");
+              if (type == 101 &&
+                  (cache.hasCoatedFrustratedTransmission =
+                   MPT->ConstPropertyExists("COATEDFRUSTRATEDTRANSMISSION")))
+                 cache.CoatedFrustratedTransmission =
+                    (G4bool)MPT->GetConstProperty("COATEDFRUSTRATEDTRANSMISSION");
+           }
+        }
+        return cache;
+}
+
+const WCSimCoatedSurfaceTable*
+WCSimOpBoundaryProcess::GetCoatedTable(G4int model)
+{
+        if (!fUseCoatedTable) return NULL;
+
+        const std::tuple<const G4OpticalSurface*, const G4Material*, const G4Material*>
+           key(OpticalSurface, Material1, Material2);
+        std::map<std::tuple<const G4OpticalSurface*, const G4Material*, const G4Material*>,
+                 std::unique_ptr<WCSimCoatedSurfaceTable> >::iterator
+           it = fCoatedTables.find(key);
+        if (it != fCoatedTables.end()) return it->second.get();
+
+        std::unique_ptr<WCSimCoatedSurfaceTable>& table = fCoatedTables[key];
+
+        // the properties the models need (else they use those of an earlier
+        // photon, which can't be tabulated)
+        const SurfaceCache& surface = *fOpticalSurfaceCache;
+        G4MaterialPropertyVector* rindex1  = GetMaterialCache(Material1).Rindex;
+        G4MaterialPropertyVector* rindex2  = GetMaterialCache(Material2).Rindex;
+        G4MaterialPropertyVector* coated   = surface.CoatedRindex;
+        G4MaterialPropertyVector* coatedim = surface.CoatedRindexIm;
+        if (!rindex1 || !rindex2 || !coated || !surface.hasCoatedThickness ||
+            (model == 102 && !coatedim))
+           return NULL;
+
+        // the energies at which all the properties are tabulated
+        std::vector<G4MaterialPropertyVector*> properties;
+        properties.push_back(rindex1);
+        properties.push_back(rindex2);
+        properties.push_back(coated);
+        if (model == 102) properties.push_back(coatedim);
+        G4double emin = 0., emax = DBL_MAX;
+        for (size_t ip = 0; ip < properties.size(); ip++) {
+           emin = std::max(emin, properties[ip]->Energy(0));
+           emax = std::min(emax, properties[ip]->Energy(properties[ip]->GetVectorLength() - 1));
+        }
+        if (emin >= emax) return NULL;
+
+        // evaluate the models as CoatedDielectricDielectric_Model1() & _Model2() do
+        const G4double thickness = surface.CoatedThickness;
+        const G4bool frustrated = surface.hasCoatedFrustratedTransmission ?
+                                  surface.CoatedFrustratedTransmission : true;
+        const G4double tolerance = kCarTolerance;
+        WCSimCoatedSurfaceTable::Model evaluate =
+           [=](G4double energy, G4double cost, WCSimCoatedCoefficients& c) {
+              const G4double n1 = rindex1->Value(energy);
+              const G4double n2 = rindex2->Value(energy);
+              const G4double nTL = coated->Value(energy);
+              const G4double wavelength = h_Planck * c_light / energy;
+              G4double sint = 0., sint2 = 0., sintTL = 0.;
+              if (std::abs(cost) < 1.0 - tolerance) {
+                 sint = std::sqrt(1. - cost * cost);
+                 sint2 = sint * n1 / n2;
+                 sintTL = sint * n1 / nTL;
+              }
+              if (model == 101) {
+                 const G4double cost2 = (cost > 0.0 ? 1. : -1.) * std::sqrt(1. - sint2 * sint2);
+                 WCSimCoatedSurfaceTable::Model1(n1, n2, nTL, thickness, frustrated, wavelength,
+                                                 sint, sintTL, cost, cost2, c);
+              }
+              else
+                 WCSimCoatedSurfaceTable::Model2(n1, n2, nTL, coatedim->Value(energy), thickness,
+                                                 wavelength, cost, sint, c);
+           };
+
+        table.reset(new WCSimCoatedSurfaceTable(evaluate, emin, emax,
+                                                kCoatedTableEnergies, kCoatedTableAngles,
+                                                fCoatedTableTolerance));
+
+        if ( verboseLevel > 0 ) {
+           G4cout << " Coated surface " << OpticalSurface->GetName()
+                  << " from " << Material1->GetName() << " to " << Material2->GetName()
+                  << ": tabulated from " << emin / eV << " to " << emax / eV << " eV, "
+                  << 100. * table->GetModelFraction() << "% of the table left to the model,"
+                  << " largest error " << table->GetMaxError() << G4endl;
+        }
+        return table.get();
+}
+
+G4LogicalSurface*
+WCSimOpBoundaryProcess::GetLogicalSurface(G4VPhysicalVolume* thePrePV,
+                                          G4VPhysicalVolume* thePostPV)
+{
+        const std::pair<const G4VPhysicalVolume*, const G4VPhysicalVolume*>
+           key(thePrePV, thePostPV);
+        std::unordered_map<std::pair<const G4VPhysicalVolume*, const G4VPhysicalVolume*>,
+                           G4LogicalSurface*, VolumePairHash>::iterator
+           it = fLogicalSurfaceCache.find(key);
+        if (it != fLogicalSurfaceCache.end()) return it->second;
+
+        G4LogicalSurface* Surface = NULL;
+
+        Surface = G4LogicalBorderSurface::GetSurface(thePrePV, thePostPV);
+
+        if (Surface == NULL){
+          G4bool enteredDaughter= (thePostPV->GetMotherLogical() ==
+                                   thePrePV ->GetLogicalVolume());
+            if(enteredDaughter){
+                Surface = 
+                    G4LogicalSkinSurface::GetSurface(thePostPV->GetLogicalVolume());
+                if(Surface == NULL)
+                Surface =
+                        G4LogicalSkinSurface::GetSurface(thePrePV->GetLogicalVolume());
+            }
+            else {
+                Surface =
+                    G4LogicalSkinSurface::GetSurface(thePrePV->GetLogicalVolume());
+                if(Surface == NULL)
+                Surface =
+                        G4LogicalSkinSurface::GetSurface(thePostPV->GetLogicalVolume());
+            }
+        }
+
+        fLogicalSurfaceCache[key] = Surface;
+        return Surface;
+}
+
 // PostStepDoIt
 // ------------
 //
@@ -291,12 +518,14 @@ WCSimOpBoundaryProcess::PostStepDoIt(const G4Track& aTrack, const G4Step& aStep)
 #endif
         }
 
-        G4MaterialPropertiesTable* aMaterialPropertiesTable;
-            G4MaterialPropertyVector* Rindex;
+        G4MaterialPropertyVector* Rindex;
+
+        fMaterial1Cache = &GetMaterialCache(Material1);
+        fMaterial2Cache = &GetMaterialCache(Material2);
+        fOpticalSurfaceCache = NULL;
 
-        aMaterialPropertiesTable = Material1->GetMaterialPropertiesTable();
-        if (aMaterialPropertiesTable) {
-		    Rindex = aMaterialPropertiesTable->GetProperty("RINDEX");
+        if (fMaterial1Cache->Table) {
+		    Rindex = fMaterial1Cache->Rindex;
         }
         else {
                     theStatus = NoRINDEX;
@@ -331,28 +560,7 @@ WCSimOpBoundaryProcess::PostStepDoIt(const G4Track& aTrack, const G4Step& aStep)
         Rindex = NULL;
         OpticalSurface = NULL;
 
-        G4LogicalSurface* Surface = NULL;
-
-        Surface = G4LogicalBorderSurface::GetSurface(thePrePV, thePostPV);
-
-        if (Surface == NULL){
-          G4bool enteredDaughter= (thePostPV->GetMotherLogical() ==
-                                   thePrePV ->GetLogicalVolume());
-            if(enteredDaughter){
-                Surface = 
-                    G4LogicalSkinSurface::GetSurface(thePostPV->GetLogicalVolume());
-                if(Surface == NULL)
-                Surface =
-                        G4LogicalSkinSurface::GetSurface(thePrePV->GetLogicalVolume());
-            }
-            else {
-                Surface =
-                    G4LogicalSkinSurface::GetSurface(thePrePV->GetLogicalVolume());
-                if(Surface == NULL)
-                Surface =
-                        G4LogicalSkinSurface::GetSurface(thePostPV->GetLogicalVolume());
-            }
-        }
+        G4LogicalSurface* Surface = GetLogicalSurface(thePrePV, thePostPV);
 
         if (Surface) OpticalSurface = 
            dynamic_cast <G4OpticalSurface*> (Surface->GetSurfaceProperty());
@@ -363,14 +571,14 @@ WCSimOpBoundaryProcess::PostStepDoIt(const G4Track& aTrack, const G4Step& aStep)
            theModel  = OpticalSurface->GetModel();
            theFinish = OpticalSurface->GetFinish();
 
-           aMaterialPropertiesTable = OpticalSurface->
-                                        GetMaterialPropertiesTable();
+           fOpticalSurfaceCache = &GetSurfaceCache(OpticalSurface);
+           const SurfaceCache& surface = *fOpticalSurfaceCache;
 
-           if (aMaterialPropertiesTable) {
+           if (surface.Table) {
 
               if (theFinish == polishedbackpainted ||
                   theFinish == groundbackpainted ) {
-                  Rindex = aMaterialPropertiesTable->GetProperty("RINDEX");
+                  Rindex = surface.Rindex;
 	          if (Rindex) {
                      Rindex2 = Rindex->Value(thePhotonMomentum);
                   }
@@ -383,12 +591,9 @@ WCSimOpBoundaryProcess::PostStepDoIt(const G4Track& aTrack, const G4Step& aStep)
                   }
               }
 
-              PropertyPointer =
-                      aMaterialPropertiesTable->GetProperty("REFLECTIVITY");
-              PropertyPointer1 =
-                      aMaterialPropertiesTable->GetProperty("REALRINDEX");
-              PropertyPointer2 =
-                      aMaterialPropertiesTable->GetProperty("IMAGINARYRINDEX");
+              PropertyPointer  = surface.Reflectivity;
+              PropertyPointer1 = surface.RealRindex;
+              PropertyPointer2 = surface.ImaginaryRindex;
 
               iTE = 1;
               iTM = 1;
@@ -404,28 +609,23 @@ WCSimOpBoundaryProcess::PostStepDoIt(const G4Track& aTrack, const G4Step& aStep)
 
               }
 
-              PropertyPointer =
-              aMaterialPropertiesTable->GetProperty("EFFICIENCY");
+              PropertyPointer = surface.Efficiency;
               if (PropertyPointer) {
                       theEfficiency =
                       PropertyPointer->Value(thePhotonMomentum);
               }
 
-              PropertyPointer =
-              aMaterialPropertiesTable->GetProperty("TRANSMITTANCE");
+              PropertyPointer = surface.Transmittance;
               if (PropertyPointer) {
                       theTransmittance =
                       PropertyPointer->Value(thePhotonMomentum);
               }
 
-              if (aMaterialPropertiesTable->
-                                     ConstPropertyExists("SURFACEROUGHNESS"))
-                 theSurfaceRoughness = aMaterialPropertiesTable->
-                                         GetConstProperty("SURFACEROUGHNESS");
+              if (surface.hasSurfaceRoughness)
+                 theSurfaceRoughness = surface.SurfaceRoughness;
 
 	      if ( theModel == unified ) {
-                 PropertyPointer =
-                 aMaterialPropertiesTable->GetProperty("SPECULARLOBECONSTANT");
+                 PropertyPointer = surface.SpecularLobe;
                  if (PropertyPointer) {
                          prob_sl =
                          PropertyPointer->Value(thePhotonMomentum);
@@ -433,8 +633,7 @@ WCSimOpBoundaryProcess::PostStepDoIt(const G4Track& aTrack, const G4Step& aStep)
                          prob_sl = 0.0;
                  }
 
-                 PropertyPointer =
-                 aMaterialPropertiesTable->GetProperty("SPECULARSPIKECONSTANT");
+                 PropertyPointer = surface.SpecularSpike;
 	         if (PropertyPointer) {
                          prob_ss =
                          PropertyPointer->Value(thePhotonMomentum);
@@ -442,8 +641,7 @@ WCSimOpBoundaryProcess::PostStepDoIt(const G4Track& aTrack, const G4Step& aStep)
                          prob_ss = 0.0;
                  }
 
-                 PropertyPointer =
-                 aMaterialPropertiesTable->GetProperty("BACKSCATTERCONSTANT");
+                 PropertyPointer = surface.BackScatter;
                  if (PropertyPointer) {
                          prob_bs =
                          PropertyPointer->Value(thePhotonMomentum);
@@ -468,10 +666,7 @@ WCSimOpBoundaryProcess::PostStepDoIt(const G4Track& aTrack, const G4Step& aStep)
                  if ( verboseLevel > 0) BoundaryProcessVerbose();
 		 return G4VDiscreteProcess::PostStepDoIt(aTrack, aStep);
 	      }
-              aMaterialPropertiesTable =
-                     Material2->GetMaterialPropertiesTable();
-              if (aMaterialPropertiesTable)
-                 Rindex = aMaterialPropertiesTable->GetProperty("RINDEX");
+              Rindex = fMaterial2Cache->Rindex;
               if (Rindex) {
                  Rindex2 = Rindex->Value(thePhotonMomentum);
               }
@@ -566,8 +761,7 @@ WCSimOpBoundaryProcess::PostStepDoIt(const G4Track& aTrack, const G4Step& aStep)
         aParticleChange.ProposePolarization(NewPolarization);
 
         if ( theStatus == FresnelRefraction || theStatus == Transmission ) {
-           G4MaterialPropertyVector* groupvel =
-           Material2->GetMaterialPropertiesTable()->GetProperty("GROUPVEL");
+           G4MaterialPropertyVector* groupvel = fMaterial2Cache->GroupVel;
            G4double finalVelocity = groupvel->Value(thePhotonMomentum);
            aParticleChange.ProposeVelocity(finalVelocity);
         }
@@ -686,12 +880,13 @@ WCSimOpBoundaryProcess::GetFacetNormal(const G4ThreeVector& Momentum,
 
            G4double alpha;
 
+           // sigma_alpha & f_max are constants of the surface
            G4double sigma_alpha = 0.0;
-           if (OpticalSurface) sigma_alpha = OpticalSurface->GetSigmaAlpha();
+           if (fOpticalSurfaceCache) sigma_alpha = fOpticalSurfaceCache->SigmaAlpha;
 
            if (sigma_alpha == 0.0) return FacetNormal = Normal;
 
-           G4double f_max = std::min(1.0,4.*sigma_alpha);
+           const G4double f_max = fOpticalSurfaceCache->FacetMax;
 
            G4double phi, SinAlpha, CosAlpha, SinPhi, CosPhi, unit_x, unit_y, unit_z;
            G4ThreeVector tmpNormal;
@@ -699,12 +894,12 @@ WCSimOpBoundaryProcess::GetFacetNormal(const G4ThreeVector& Momentum,
            do {
               do {
                  alpha = G4RandGauss::shoot(0.0,sigma_alpha);
+                 SinAlpha = std::sin(alpha);
                  // Loop checking, 13-Aug-2015, Peter Gumplinger
-              } while (G4UniformRand()*f_max > std::sin(alpha) || alpha >= halfpi );
+              } while (G4UniformRand()*f_max > SinAlpha || alpha >= halfpi );
 
               phi = G4UniformRand()*twopi;
 
-              SinAlpha = std::sin(alpha);
               CosAlpha = std::cos(alpha);
               SinPhi = std::sin(phi);
               CosPhi = std::cos(phi);
@@ -726,7 +921,7 @@ WCSimOpBoundaryProcess::GetFacetNormal(const G4ThreeVector& Momentum,
         else {
 
            G4double  polish = 1.0;
-           if (OpticalSurface) polish = OpticalSurface->GetPolish();
+           if (fOpticalSurfaceCache) polish = fOpticalSurfaceCache->Polish;
 
            if (polish < 1.0) {
               do {
@@ -1096,8 +1291,8 @@ void WCSimOpBoundaryProcess::DielectricDielectric()
 
         G4ThreeVector A_trans, A_paral, E1pp, E1pl;
         G4double E1_perp, E1_parl;
-        G4double s1, s2, E2_perp, E2_parl, E2_total, TransCoeff;
-        G4double E2_abs, C_parl, C_perp;
+        G4double E2_perp, E2_parl, E2_total, TransCoeff;
+        G4double C_parl, C_perp;
         G4double alpha;
 
         do {
@@ -1119,19 +1314,11 @@ void WCSimOpBoundaryProcess::DielectricDielectric()
            }
 
            PdotN = OldMomentum * theFacetNormal;
-           EdotN = OldPolarization * theFacetNormal;
 
            cost1 = - PdotN;
-           if (std::abs(cost1) < 1.0-kCarTolerance){
-              sint1 = std::sqrt(1.-cost1*cost1);
-              sint2 = sint1*Rindex1/Rindex2;     // *** Snell's Law ***
-           }
-           else {
-              sint1 = 0.0;
-              sint2 = 0.0;
-           }
-
-           if (sint2 >= 1.0) {
+           // *** Snell's Law ***
+           if (!WCSimFresnel::Refract(cost1, Rindex1/Rindex2, kCarTolerance,
+                                      sint1, sint2, cost2)) {
 
               // Simulate total internal reflection
 
@@ -1161,17 +1348,10 @@ void WCSimOpBoundaryProcess::DielectricDielectric()
 
               }
            }
-           else if (sint2 < 1.0) {
+           else {
 
               // Calculate amplitude for transmission (Q = P x N)
 
-              if (cost1 > 0.0) {
-                 cost2 =  std::sqrt(1.-sint2*sint2);
-              }
-              else {
-                 cost2 = -std::sqrt(1.-sint2*sint2);
-              }
-
               if (sint1 > 0.0) {
                  A_trans = OldMomentum.cross(theFacetNormal);
                  A_trans = A_trans.unit();
@@ -1189,15 +1369,10 @@ void WCSimOpBoundaryProcess::DielectricDielectric()
                  E1_parl  = 1.0;
               }
 
-              s1 = Rindex1*cost1;
-              E2_perp = 2.*s1*E1_perp/(Rindex1*cost1+Rindex2*cost2);
-              E2_parl = 2.*s1*E1_parl/(Rindex2*cost1+Rindex1*cost2);
-              E2_total = E2_perp*E2_perp + E2_parl*E2_parl;
-              s2 = Rindex2*cost2*E2_total;
-
+              TransCoeff = WCSimFresnel::Transmission(Rindex1, Rindex2, cost1, cost2,
+                                                      E1_perp, E1_parl,
+                                                      E2_perp, E2_parl, E2_total);
               if (theTransmittance > 0) TransCoeff = theTransmittance;
-              else if (cost1 != 0.0) TransCoeff = s2/s1;
-              else TransCoeff = 0.0;
 
               if ( !G4BooleanRand(TransCoeff) ) {
 
@@ -1227,14 +1402,12 @@ void WCSimOpBoundaryProcess::DielectricDielectric()
 
                     if (sint1 > 0.0) {   // incident ray oblique
 
-                       E2_parl   = Rindex2*E2_parl/Rindex1 - E1_parl;
-                       E2_perp   = E2_perp - E1_perp;
-                       E2_total  = E2_perp*E2_perp + E2_parl*E2_parl;
+                       WCSimFresnel::Reflection(Rindex1, Rindex2, E1_perp, E1_parl,
+                                                E2_perp, E2_parl, E2_total);
                        A_paral   = NewMomentum.cross(A_trans);
                        A_paral   = A_paral.unit();
-                       E2_abs    = std::sqrt(E2_total);
-                       C_parl    = E2_parl/E2_abs;
-                       C_perp    = E2_perp/E2_abs;
+                       WCSimFresnel::Direction(E2_perp, E2_parl, E2_total,
+                                               C_perp, C_parl);
 
                        NewPolarization = C_parl*A_paral + C_perp*A_trans;
 
@@ -1268,9 +1441,8 @@ void WCSimOpBoundaryProcess::DielectricDielectric()
 //                   PdotN = -cost2;
                    A_paral = NewMomentum.cross(A_trans);
                    A_paral = A_paral.unit();
-                   E2_abs     = std::sqrt(E2_total);
-                   C_parl     = E2_parl/E2_abs;
-                   C_perp     = E2_perp/E2_abs;
+                   WCSimFresnel::Direction(E2_perp, E2_parl, E2_total,
+                                           C_perp, C_parl);
 
                    NewPolarization = C_parl*A_paral + C_perp*A_trans;
 
@@ -1373,12 +1545,8 @@ G4double WCSimOpBoundaryProcess::GetReflectivity(G4double E1_perp,
   G4complex denominatorTE, denominatorTM;
   G4complex rTM, rTE;
 
-  G4MaterialPropertiesTable* aMaterialPropertiesTable =
-                                    Material1->GetMaterialPropertiesTable();
-  G4MaterialPropertyVector* aPropertyPointerR =
-                      aMaterialPropertiesTable->GetProperty("REALRINDEX");
-  G4MaterialPropertyVector* aPropertyPointerI =
-                      aMaterialPropertiesTable->GetProperty("IMAGINARYRINDEX");
+  G4MaterialPropertyVector* aPropertyPointerR = fMaterial1Cache->RealRindex;
+  G4MaterialPropertyVector* aPropertyPointerI = fMaterial1Cache->ImaginaryRindex;
   if (aPropertyPointerR && aPropertyPointerI) {
      G4double RRindex = aPropertyPointerR->Value(thePhotonMomentum);
      G4double IRindex = aPropertyPointerI->Value(thePhotonMomentum);
@@ -1491,27 +1659,25 @@ void WCSimOpBoundaryProcess::CoatedDielectricDielectric_Model1()
 {
   G4MaterialPropertyVector* pp = nullptr;
 
-  G4MaterialPropertiesTable* MPT = Material2->GetMaterialPropertiesTable();
-  if((pp = MPT->GetProperty("RINDEX")))
+  if((pp = fMaterial2Cache->Rindex))
   {
     Rindex2 = pp->Value(thePhotonMomentum);
   }
 
-  MPT = OpticalSurface->GetMaterialPropertiesTable();
+  const SurfaceCache& surface = *fOpticalSurfaceCache;
   // thin film properties to be defined in WCSimConstructMaterials.cc
-  if((pp = MPT->GetProperty("COATEDRINDEX")))
+  if((pp = surface.CoatedRindex))
   {
     fCoatedRindex = pp->Value(thePhotonMomentum);
   }
-  if(MPT->ConstPropertyExists("COATEDTHICKNESS"))
+  if(surface.hasCoatedThickness)
   {
-    fCoatedThickness = MPT->GetConstProperty("COATEDTHICKNESS");
+    fCoatedThickness = surface.CoatedThickness;
   }
   // allows frustrated transmission through the film or not
-  if(MPT->ConstPropertyExists("COATEDFRUSTRATEDTRANSMISSION"))
+  if(surface.hasCoatedFrustratedTransmission)
   {
-    fCoatedFrustratedTransmission =
-      (G4bool)MPT->GetConstProperty("COATEDFRUSTRATEDTRANSMISSION");
+    fCoatedFrustratedTransmission = surface.CoatedFrustratedTransmission;
   }
 
   G4double sintTL;
@@ -1537,6 +1703,9 @@ void WCSimOpBoundaryProcess::CoatedDielectricDielectric_Model1()
       G4SwapObj(&Rindex1, &Rindex2);
     }
 
+    // the film coefficients are tabulated for each side of the surface
+    const WCSimCoatedSurfaceTable* table = GetCoatedTable(101);
+
     if(theFinish == polished)
     {
       theFacetNormal = theGlobalNormal;
@@ -1600,8 +1769,12 @@ void WCSimOpBoundaryProcess::CoatedDielectricDielectric_Model1()
     E2_total = E2_perp * E2_perp + E2_parl * E2_parl;
 
     // Equations in Table 1 of https://ieeexplore.ieee.org/document/9875513
-    transCoeff = 1. - GetReflectivityThroughThinLayer(
-                        sintTL, E1_perp, E1_parl, wavelength, cost1, cost2);
+    WCSimCoatedCoefficients coefficients;
+    if (!(table && table->Interpolate(thePhotonMomentum, cost1, coefficients)))
+      WCSimCoatedSurfaceTable::Model1(Rindex1, Rindex2, fCoatedRindex, fCoatedThickness,
+                                      fCoatedFrustratedTransmission, wavelength,
+                                      sint1, sintTL, cost1, cost2, coefficients);
+    transCoeff = 1. - coefficients.Reflectivity(E1_perp, E1_parl);
     if (!G4BooleanRand(transCoeff))
     {
       if(verboseLevel > 2)
@@ -1713,95 +1886,6 @@ void WCSimOpBoundaryProcess::CoatedDielectricDielectric_Model1()
   } while (!done);
 }
 
-//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
-G4double WCSimOpBoundaryProcess::GetReflectivityThroughThinLayer(G4double sinTL,
-                   G4double E1_perp,
-                   G4double E1_parl,
-                   G4double wavelength, G4double costh1, G4double costh2) {
-  G4complex Reflectivity, Reflectivity_TE, Reflectivity_TM;
-  G4double gammaTL, costTL;
-
-  G4complex i(0, 1);
-  G4complex rTM, rTE;
-  G4complex r1toTL, rTLto2;
-  G4double k0 = 2 * pi / wavelength;
-
-  // Angle > Angle limit
-  if (sinTL >= 1.0) {
-    if (fCoatedFrustratedTransmission) { //Frustrated transmission
-
-      if (costh1 > 0.0)
-      {
-        gammaTL = std::sqrt(Rindex1 * Rindex1 * sint1 * sint1 -
-                   fCoatedRindex * fCoatedRindex);
-      }
-      else
-      {
-        gammaTL = -std::sqrt(Rindex1 * Rindex1 * sint1 * sint1 -
-                   fCoatedRindex * fCoatedRindex);
-      }
-
-      // TE
-      r1toTL = (Rindex1 * costh1 - i * gammaTL) / (Rindex1 * costh1 + i * gammaTL);
-      rTLto2 = (i * gammaTL - Rindex2 * costh2) / (i * gammaTL + Rindex2 * costh2);
-      if (costh1 != 0.0)
-      {
-        rTE = (r1toTL + rTLto2 * std::exp(-2 * k0 * fCoatedThickness * gammaTL)) /
-                 (1.0 + r1toTL * rTLto2 * std::exp(-2 * k0 * fCoatedThickness * gammaTL));
-      }
-      // TM
-      r1toTL = (Rindex1 * i * gammaTL - fCoatedRindex * fCoatedRindex * costh1) /
-                  (Rindex1 * i * gammaTL + fCoatedRindex * fCoatedRindex * costh1);
-      rTLto2 = (fCoatedRindex * fCoatedRindex * costh2 - Rindex2 * i * gammaTL) /
-                  (fCoatedRindex * fCoatedRindex * costh2 + Rindex2 * i * gammaTL);
-      if (costh1 != 0.0)
-      {
-        rTM = (r1toTL + rTLto2 * std::exp(-2 * k0 * fCoatedThickness * gammaTL)) /
-                 (1.0 + r1toTL * rTLto2 * std::exp(-2 * k0 * fCoatedThickness * gammaTL));
-      }
-    }
-    else
-    { //Total reflection
-      return(1.);
-    }
-  }
-
-  // Angle <= Angle limit
-  else //if (sinTL < 1.0)
-  {
-    if (costh1 > 0.0)
-    {
-      costTL = std::sqrt(1. - sinTL * sinTL);
-    }
-    else
-    {
-      costTL = -std::sqrt(1. - sinTL * sinTL);
-    }
-    // TE
-    r1toTL = (Rindex1 * costh1 - fCoatedRindex * costTL) / (Rindex1 * costh1 + fCoatedRindex * costTL);
-    rTLto2 = (fCoatedRindex * costTL - Rindex2 * costh2) / (fCoatedRindex * costTL + Rindex2 * costh2);
-    if (costh1 != 0.0)
-    {
-      rTE = (r1toTL + rTLto2 * std::exp(2.0 * i * k0 * fCoatedRindex * fCoatedThickness * costTL)) /
-            (1.0 + r1toTL * rTLto2 * std::exp(2.0 * i * k0 * fCoatedRindex * fCoatedThickness * costTL));
-    }
-    // TM
-    r1toTL = (Rindex1 * costTL - fCoatedRindex * costh1) / (Rindex1 * costTL + fCoatedRindex * costh1);
-    rTLto2 = (fCoatedRindex * costh2 - Rindex2 * costTL) / (fCoatedRindex * costh2 + Rindex2 * costTL);
-    if (costh1 != 0.0)
-    {
-      rTM = (r1toTL + rTLto2 * std::exp(2.0 * i * k0 * fCoatedRindex * fCoatedThickness * costTL)) /
-            (1.0 + r1toTL * rTLto2 * std::exp(2.0 * i * k0 * fCoatedRindex * fCoatedThickness * costTL));
-    }
-  }
-
-  Reflectivity_TE = (rTE * conj(rTE)) * (E1_perp * E1_perp) / (E1_perp * E1_perp + E1_parl * E1_parl);
-  Reflectivity_TM = (rTM * conj(rTM)) * (E1_parl * E1_parl) / (E1_perp * E1_perp + E1_parl * E1_parl);
-  Reflectivity = Reflectivity_TE + Reflectivity_TM;
-
-  return real(Reflectivity);
-}
-
 void WCSimOpBoundaryProcess::CoatedDielectricDielectric_Model2()
 {
   // Model taken from https://arxiv.org/abs/physics/0408075v1
@@ -1809,26 +1893,25 @@ void WCSimOpBoundaryProcess::CoatedDielectricDielectric_Model2()
 
   G4MaterialPropertyVector* pp = nullptr;
 
-  G4MaterialPropertiesTable* MPT = Material2->GetMaterialPropertiesTable();
-  if((pp = MPT->GetProperty("RINDEX")))
+  if((pp = fMaterial2Cache->Rindex))
   {
     Rindex2 = pp->Value(thePhotonMomentum);
   }
 
-  MPT = OpticalSurface->GetMaterialPropertiesTable();
+  const SurfaceCache& surface = *fOpticalSurfaceCache;
   // thin film properties to be defined in WCSimConstructMaterials.cc
   // need both real and imaginary refractive indices
-  if((pp = MPT->GetProperty("COATEDRINDEX")))
+  if((pp = surface.CoatedRindex))
   {
     fCoatedRindex = pp->Value(thePhotonMomentum);
   }
-  if((pp = MPT->GetProperty("COATEDRINDEXIM")))
+  if((pp = surface.CoatedRindexIm))
   {
     fCoatedRindexIm = pp->Value(thePhotonMomentum);
   }
-  if(MPT->ConstPropertyExists("COATEDTHICKNESS"))
+  if(surface.hasCoatedThickness)
   {
-    fCoatedThickness = MPT->GetConstProperty("COATEDTHICKNESS");
+    fCoatedThickness = surface.CoatedThickness;
   }
 
   G4double sintTL;
@@ -1844,15 +1927,8 @@ void WCSimOpBoundaryProcess::CoatedDielectricDielectric_Model2()
   G4bool through = false;
   G4bool done    = false;
 
-  G4complex i(0, 1);
-  G4complex r23p, r34p, t23p, t32p, t34p;
-  G4complex r23s, r34s, t23s, t32s, t34s;
-  G4complex rp, tp, rs, ts;
-  G4complex delta, costh2, costh3, costh4, sinth3, sinth4, n2, n3, n4;
-  n2 = Rindex1;
-  n3 = fCoatedRindex-i*fCoatedRindexIm;
-  n4 = Rindex2;
-  G4double Rp, Tp, Rs, Ts, Rtot, Ttot;
+  WCSimCoatedCoefficients coefficients;
+  G4double Rtot, Ttot;
 
   do {
     if (through)
@@ -1864,6 +1940,9 @@ void WCSimOpBoundaryProcess::CoatedDielectricDielectric_Model2()
       G4SwapObj(&Rindex1, &Rindex2);
     }
 
+    // the film coefficients are tabulated for each side of the surface
+    const WCSimCoatedSurfaceTable* table = GetCoatedTable(102);
+
     if(theFinish == polished)
     {
       theFacetNormal = theGlobalNormal;
@@ -1906,44 +1985,12 @@ void WCSimOpBoundaryProcess::CoatedDielectricDielectric_Model2()
     }
 
     // Calculate reflection and transmission probability from Eq. 2 of https://arxiv.org/abs/physics/0408075v1
-    // Rename the variables to match those in paper
-    costh2 = cost1;
-    sinth3 = Rindex1*sint1/n3;
-    sinth4 = Rindex1*sint1/Rindex2;
-    costh3 = sqrt(1.-sinth3*sinth3);
-    if (cost1<0) costh3 *= -1;
-    costh4 = sqrt(1.-sinth4*sinth4);
-    if (cost1<0) costh4 *= -1;
-
-    // reflection and transmission coefficients
-    // TM =  p wave
-    r23p = (n2*costh3-n3*costh2)/(n2*costh3+n3*costh2);
-    t23p = 2.*n2*costh2/(n2*costh3+n3*costh2);
-    t32p = 2.*n3*costh3/(n2*costh3+n3*costh2);
-    r34p = (n3*costh4-n4*costh3)/(n3*costh4+n4*costh3);
-    t34p = 2.*n3*costh3/(n4*costh3+n3*costh4);
-
-    // TE = s wave
-    r23s = (n2*costh2-n3*costh3)/(n2*costh2+n3*costh3);
-    t23s = 2.*n2*costh2/(n2*costh2+n3*costh3);
-    t32s = 2.*n3*costh3/(n2*costh2+n3*costh3);
-    r34s = (n3*costh3-n4*costh4)/(n3*costh3+n4*costh4);
-    t34s = 2.*n3*costh3/(n3*costh3+n4*costh4);
-
-    delta = -2.*pi*fCoatedThickness*n3/wavelength*costh3;
-
-    rp = r23p+(t23p*t32p*r34p*exp(2.*i*delta))/(1.+r23p*r34p*exp(2.*i*delta));
-    tp = t23p*t34p*exp(i*delta)/(1.+r23p*r34p*exp(2.*i*delta));
-    Rp = real(rp*conj(rp));
-    Tp = real(n4*costh4/n2/costh2*tp*conj(tp));
-
-    rs = r23s+(t23s*t32s*r34s*exp(2.*i*delta))/(1.+r23s*r34s*exp(2.*i*delta));
-    ts = t23s*t34s*exp(i*delta)/(1.+r23s*r34s*exp(2.*i*delta));
-    Rs = real(rs*conj(rs));
-    Ts = real(n4*costh4/n2/costh2*ts*conj(ts));
-
-    Rtot = (Rs * E1_perp * E1_perp + Rp * E1_parl * E1_parl)  / (E1_perp * E1_perp + E1_parl * E1_parl);
-    Ttot = (Ts * E1_perp * E1_perp + Tp * E1_parl * E1_parl)  / (E1_perp * E1_perp + E1_parl * E1_parl);
+    if (!(table && table->Interpolate(thePhotonMomentum, cost1, coefficients)))
+      WCSimCoatedSurfaceTable::Model2(Rindex1, Rindex2, fCoatedRindex, fCoatedRindexIm,
+                                      fCoatedThickness, wavelength, cost1, sint1, coefficients);
+
+    Rtot = coefficients.Reflectivity(E1_perp, E1_parl);
+    Ttot = coefficients.Transmittance(E1_perp, E1_parl);
 
     G4double rdm = G4UniformRand();
 
@@ -1970,10 +2017,10 @@ void WCSimOpBoundaryProcess::CoatedDielectricDielectric_Model2()
       if (sint1 > 0.0) {   // incident ray oblique
 
         // not sure about +/- sign, also ignore the phase change
-        E2_parl = -sqrt(Rp)*E1_parl;
-        if (std::arg(rp)<-pi/2 || std::arg(rp)>pi/2) E2_parl *= -1;
-        E2_perp = sqrt(Rs)*E1_perp;
-        if (std::arg(rs)<-pi/2 || std::arg(rs)>pi/2) E2_perp *= -1;
+        E2_parl = -sqrt(coefficients.Rp)*E1_parl;
+        if (coefficients.rp < 0) E2_parl *= -1;
+        E2_perp = sqrt(coefficients.Rs)*E1_perp;
+        if (coefficients.rs < 0) E2_perp *= -1;
 
         E2_total = E2_perp * E2_perp + E2_parl * E2_parl;
         A_paral = NewMomentum.cross(A_trans);
@@ -2025,10 +2072,10 @@ void WCSimOpBoundaryProcess::CoatedDielectricDielectric_Model2()
          A_paral = NewMomentum.cross(A_trans);
          A_paral = A_paral.unit();
          // again the sign may be wrong
-         E2_parl = sqrt(Tp)*E1_parl;
-         E2_perp = sqrt(Ts)*E1_perp;
-         if (std::arg(tp)<-pi/2 || std::arg(tp)>pi/2) E2_parl *= -1;
-         if (std::arg(ts)<-pi/2 || std::arg(ts)>pi/2) E2_perp *= -1;
+         E2_parl = sqrt(coefficients.Tp)*E1_parl;
+         E2_perp = sqrt(coefficients.Ts)*E1_perp;
+         if (coefficients.tp < 0) E2_parl *= -1;
+         if (coefficients.ts < 0) E2_perp *= -1;
          E2_total = E2_perp * E2_perp + E2_parl * E2_parl;
          E2_abs = std::sqrt(E2_total);
          C_parl = E2_parl / E2_abs;
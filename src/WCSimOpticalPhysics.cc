@@ -68,6 +68,9 @@ G4ThreadLocal G4OpRayleigh*        WCSimOpticalPhysics::fRayleighProcess = nullp
 G4ThreadLocal G4OpMieHG*           WCSimOpticalPhysics::fMieProcess = nullptr;
 G4ThreadLocal WCSimOpBoundaryProcess* WCSimOpticalPhysics::fBoundaryProcess = nullptr; // custom boundary process
 
+G4double WCSimOpticalPhysics::fPhotonWeight = 1.;
+G4int WCSimOpticalPhysics::fPhotonBudget = 0;
+
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
 WCSimOpticalPhysics::WCSimOpticalPhysics(G4int verbose, const G4String& name)
@@ -90,7 +93,9 @@ WCSimOpticalPhysics::WCSimOpticalPhysics(G4int verbose, const G4String& name)
     fRayleighVerbosity(0),
     fMieVerbosity(0),
     fInvokeSD(true),
-    fBoundaryVerbosity(0)
+    fBoundaryVerbosity(0),
+    fCoatedTable(false),
+    fCoatedTableTolerance(1.e-3)
 
 {
   verboseLevel = verbose;
@@ -185,6 +190,8 @@ void WCSimOpticalPhysics::ConstructProcess()
   // custom boundary process
   fBoundaryProcess = new WCSimOpBoundaryProcess();
   fBoundaryProcess->SetInvokeSD(fInvokeSD);
+  fBoundaryProcess->SetCoatedTable(fCoatedTable);
+  fBoundaryProcess->SetCoatedTableTolerance(fCoatedTableTolerance);
   OpProcesses[kBoundary] = fBoundaryProcess;
 
   fWLSProcess = new G4OpWLS();
@@ -431,6 +438,16 @@ void WCSimOpticalPhysics::SetTrackSecondariesFirst(G4OpticalProcessIndex index,
   fProcessTrackSecondariesFirst[index] = trackSecondariesFirst;
 }
 
+void WCSimOpticalPhysics::SetPhotonWeight(G4double weight)
+{
+  fPhotonWeight = weight;
+}
+
+void WCSimOpticalPhysics::SetPhotonBudget(G4int budget)
+{
+  fPhotonBudget = budget;
+}
+
 void WCSimOpticalPhysics::SetFiniteRiseTime(G4bool b)
 {
   fFiniteRiseTime = b;
@@ -447,6 +464,22 @@ void WCSimOpticalPhysics::SetInvokeSD(G4bool b)
   }
 }
 
+void WCSimOpticalPhysics::SetCoatedTable(G4bool b)
+{
+  fCoatedTable = b;
+  if (fBoundaryProcess) {
+    fBoundaryProcess->SetCoatedTable(fCoatedTable);
+  }
+}
+
+void WCSimOpticalPhysics::SetCoatedTableTolerance(G4double tolerance)
+{
+  fCoatedTableTolerance = tolerance;
+  if (fBoundaryProcess) {
+    fBoundaryProcess->SetCoatedTableTolerance(fCoatedTableTolerance);
+  }
+}
+
 void WCSimOpticalPhysics::SetScintillationStackPhotons(G4bool stackingFlag)
 {
   fScintillationStackPhotons = stackingFlag;
@@ -68,6 +68,8 @@ WCSimOpticalPhysicsMessenger::WCSimOpticalPhysicsMessenger(
     fActivateProcessCmd(nullptr),
     fVerboseCmd(nullptr),
     fTrackSecondariesFirstCmd(nullptr),
+    fPhotonWeightCmd(nullptr),
+    fPhotonBudgetCmd(nullptr),
 
     fCerenkovMaxPhotonsCmd(nullptr),
     fCerenkovMaxPhotons1Cmd(nullptr),
@@ -98,6 +100,8 @@ WCSimOpticalPhysicsMessenger::WCSimOpticalPhysicsMessenger(
     fBoundaryInvokeSDCmd(nullptr),
     fBoundaryInvokeSD1Cmd(nullptr),
     fBoundaryVerbosityCmd(nullptr),
+    fBoundaryCoatedTableCmd(nullptr),
+    fBoundaryCoatedTableToleranceCmd(nullptr),
 
     fAbsorptionVerbosityCmd(nullptr),
     fRayleighVerbosityCmd(nullptr),
@@ -158,6 +162,24 @@ WCSimOpticalPhysicsMessenger::WCSimOpticalPhysicsMessenger(
     fVerboseCmd->SetRange("ver>=0");
     fVerboseCmd->AvailableForStates(G4State_PreInit);
 
+    fPhotonWeightCmd = new G4UIcmdWithADouble("/process/optical/photonWeight", this);
+    fPhotonWeightCmd->SetGuidance("Track only 1 in photonWeight of the optical photons, each with this weight.");
+    fPhotonWeightCmd->SetGuidance("Each photon detected adds a weight to its PMT; at the end of the event the number");
+    fPhotonWeightCmd->SetGuidance("of p.e. of each PMT is drawn from a Poisson of its total weight.");
+    fPhotonWeightCmd->SetGuidance("For events with large PMT occupancies. Default 1 (no weighting)");
+    fPhotonWeightCmd->SetParameterName("photonWeight", false);
+    fPhotonWeightCmd->SetRange("photonWeight >= 1");
+    fPhotonWeightCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+    fPhotonBudgetCmd = new G4UIcmdWithAnInteger("/process/optical/photonBudget", this);
+    fPhotonBudgetCmd->SetGuidance("Cap the number of optical photons waiting in the stack: when there are photonBudget of them,");
+    fPhotonBudgetCmd->SetGuidance("only 1 in 2 is kept, with twice the weight, as are the next photons of the event (see");
+    fPhotonBudgetCmd->SetGuidance("/process/optical/photonWeight). With /event/verbose 1 the events reaching it are printed.");
+    fPhotonBudgetCmd->SetGuidance("For very energetic events (e.g. muon bundles). Default 0 (no cap)");
+    fPhotonBudgetCmd->SetParameterName("photonBudget", false);
+    fPhotonBudgetCmd->SetRange("photonBudget >= 0");
+    fPhotonBudgetCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
     //// Cerenkov ////////////////////
     fCerenkovMaxPhotons1Cmd = new G4UIcmdWithAnInteger("/process/optical/defaults/cerenkov/setMaxPhotons", this);
     fCerenkovMaxPhotons1Cmd->SetGuidance("Set default maximum number of photons per step");
@@ -351,6 +373,20 @@ WCSimOpticalPhysicsMessenger::WCSimOpticalPhysicsMessenger(
     fBoundaryVerbosityCmd->SetRange("verbosity >= 0 && verbosity <= 2");
     fBoundaryVerbosityCmd->AvailableForStates(G4State_Idle);
 
+    fBoundaryCoatedTableCmd = new G4UIcmdWithABool("/process/optical/boundary/setCoatedTable", this);
+    fBoundaryCoatedTableCmd->SetGuidance("Tabulate the reflection & transmission of the coated (photocathode) surfaces");
+    fBoundaryCoatedTableCmd->SetGuidance("against photon energy & incidence angle, rather than evaluate the thin film");
+    fBoundaryCoatedTableCmd->SetGuidance("model (/WCSim/tuning/pmtsurftype 1 or 2) for each photon");
+    fBoundaryCoatedTableCmd->SetParameterName("CoatedTable", false);
+    fBoundaryCoatedTableCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+    fBoundaryCoatedTableToleranceCmd = new G4UIcmdWithADouble("/process/optical/boundary/setCoatedTableTolerance", this);
+    fBoundaryCoatedTableToleranceCmd->SetGuidance("Largest error allowed in the tabulated reflection & transmission probabilities.");
+    fBoundaryCoatedTableToleranceCmd->SetGuidance("Parts of the table that are less accurate use the model. Default 0.001");
+    fBoundaryCoatedTableToleranceCmd->SetParameterName("tolerance", false);
+    fBoundaryCoatedTableToleranceCmd->SetRange("tolerance > 0");
+    fBoundaryCoatedTableToleranceCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
     // the others  ////////////////////////////////////
     fAbsorptionVerbosityCmd = new G4UIcmdWithAnInteger("/process/optical/absorption/verbose", this);
     fAbsorptionVerbosityCmd->SetGuidance("Verbosity for absorption process.");
@@ -377,6 +413,8 @@ WCSimOpticalPhysicsMessenger::~WCSimOpticalPhysicsMessenger()
   delete fDir2;
   delete fActivateProcessCmd;
   delete fVerboseCmd;
+  delete fPhotonWeightCmd;
+  delete fPhotonBudgetCmd;
   delete fCerenkovMaxPhotonsCmd;
   delete fCerenkovMaxPhotons1Cmd;
   delete fCerenkovMaxBetaChangeCmd;
@@ -408,6 +446,8 @@ WCSimOpticalPhysicsMessenger::~WCSimOpticalPhysicsMessenger()
   delete fTrackSecondariesFirstCmd;
   delete fBoundaryInvokeSDCmd;
   delete fBoundaryInvokeSD1Cmd;
+  delete fBoundaryCoatedTableCmd;
+  delete fBoundaryCoatedTableToleranceCmd;
 }
 
 void WCSimOpticalPhysicsMessenger::SetNewValue(G4UIcommand* command,
@@ -472,6 +512,12 @@ void WCSimOpticalPhysicsMessenger::SetNewValue(G4UIcommand* command,
   else if (command == fVerboseCmd) {
         fOpticalPhysics->SetVerboseLevel(fVerboseCmd->GetNewIntValue(newValue));
   }
+  else if (command == fPhotonWeightCmd) {
+    fOpticalPhysics->SetPhotonWeight(fPhotonWeightCmd->GetNewDoubleValue(newValue));
+  }
+  else if (command == fPhotonBudgetCmd) {
+    fOpticalPhysics->SetPhotonBudget(fPhotonBudgetCmd->GetNewIntValue(newValue));
+  }
   else if (command == fCerenkovMaxPhotons1Cmd) {
     fOpticalPhysics->SetMaxNumPhotonsPerStep(
           fCerenkovMaxPhotons1Cmd->GetNewIntValue(newValue));
@@ -594,6 +640,12 @@ void WCSimOpticalPhysicsMessenger::SetNewValue(G4UIcommand* command,
     fOpticalPhysics
       ->SetInvokeSD(fBoundaryInvokeSDCmd->GetNewBoolValue(newValue));
   }
+  else if (command == fBoundaryCoatedTableCmd) {
+    fOpticalPhysics->SetCoatedTable(fBoundaryCoatedTableCmd->GetNewBoolValue(newValue));
+  }
+  else if (command == fBoundaryCoatedTableToleranceCmd) {
+    fOpticalPhysics->SetCoatedTableTolerance(fBoundaryCoatedTableToleranceCmd->GetNewDoubleValue(newValue));
+  }
 }
 
 void WCSimOpticalPhysicsMessenger::Deprecated()
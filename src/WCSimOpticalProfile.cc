@@ -0,0 +1,200 @@
+#include "WCSimOpticalProfile.hh"
+#include "WCSimOpBoundaryProcess.hh"
+
+#include "G4Step.hh"
+#include "G4Track.hh"
+#include "G4LogicalVolume.hh"
+#include "G4VPhysicalVolume.hh"
+#include "G4Material.hh"
+#include "G4ios.hh"
+
+#include "TDirectory.h"
+#include "TTree.h"
+#include "TString.h"
+
+#include <string>
+#include <algorithm>
+#include <iomanip>
+
+namespace {
+  // In the order of WCSimOpBoundaryProcessStatus
+  const char* kStatusNames[] = {
+    "Undefined",
+    "Transmission", "FresnelRefraction",
+    "FresnelReflection", "TotalInternalReflection",
+    "LambertianReflection", "LobeReflection",
+    "SpikeReflection", "BackScattering",
+    "Absorption", "Detection", "NotAtBoundary",
+    "SameMaterial", "StepTooSmall", "NoRINDEX",
+    "PolishedLumirrorAirReflection",
+    "PolishedLumirrorGlueReflection",
+    "PolishedAirReflection",
+    "PolishedTeflonAirReflection",
+    "PolishedTiOAirReflection",
+    "PolishedTyvekAirReflection",
+    "PolishedVM2000AirReflection",
+    "PolishedVM2000GlueReflection",
+    "EtchedLumirrorAirReflection",
+    "EtchedLumirrorGlueReflection",
+    "EtchedAirReflection",
+    "EtchedTeflonAirReflection",
+    "EtchedTiOAirReflection",
+    "EtchedTyvekAirReflection",
+    "EtchedVM2000AirReflection",
+    "EtchedVM2000GlueReflection",
+    "GroundLumirrorAirReflection",
+    "GroundLumirrorGlueReflection",
+    "GroundAirReflection",
+    "GroundTeflonAirReflection",
+    "GroundTiOAirReflection",
+    "GroundTyvekAirReflection",
+    "GroundVM2000AirReflection",
+    "GroundVM2000GlueReflection",
+    "Dichroic",
+    "CoatedDielectricReflection",
+    "CoatedDielectricRefraction",
+    "CoatedDielectricFrustratedTransmission"
+  };
+  const G4int kNStatus = CoatedDielectricFrustratedTransmission + 1;
+  static_assert(sizeof(kStatusNames) / sizeof(kStatusNames[0]) == CoatedDielectricFrustratedTransmission + 1,
+		"kStatusNames must list all the WCSimOpBoundaryProcessStatus values");
+}
+
+WCSimOpticalProfile::WCSimOpticalProfile()
+  : enabled(false), lastVolume(NULL), lastIndex(-1)
+{
+}
+
+WCSimOpticalProfile::~WCSimOpticalProfile()
+{
+}
+
+const char* WCSimOpticalProfile::GetStatusName(G4int status)
+{
+  return (status >= 0 && status < kNStatus) ? kStatusNames[status] : "Unknown";
+}
+
+void WCSimOpticalProfile::BeginOfRun()
+{
+  volumes.clear();
+  counters.clear();
+  volumeIndex.clear();
+  lastVolume = NULL;
+  lastIndex = -1;
+  if(enabled)
+    G4cout << "Optical profiling: counting the optical photon steps & their time by logical volume" << G4endl;
+}
+
+G4int WCSimOpticalProfile::Index(const G4LogicalVolume* lv)
+{
+  if(lv == lastVolume)
+    return lastIndex;
+  std::unordered_map<const G4LogicalVolume*, G4int>::iterator it = volumeIndex.find(lv);
+  G4int index;
+  if(it != volumeIndex.end())
+    index = it->second;
+  else {
+    index = volumes.size();
+    volumeIndex[lv] = index;
+    volumes.push_back(lv);
+    VolumeCounters zero;
+    zero.steps = 0;
+    zero.kills = 0;
+    zero.time = 0;
+    std::fill(zero.timeHist, zero.timeHist + kNTimeBins, 0);
+    zero.boundary.assign(kNStatus, 0);
+    counters.push_back(zero);
+  }
+  lastVolume = lv;
+  lastIndex = index;
+  return index;
+}
+
+void WCSimOpticalProfile::Step(const G4Step* aStep, G4int boundaryStatus)
+{
+  std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+  const G4long ns = std::chrono::duration_cast<std::chrono::nanoseconds>(now - lastTime).count();
+  lastTime = now;
+
+  const G4VPhysicalVolume* prePV = aStep->GetPreStepPoint()->GetPhysicalVolume();
+  const G4VPhysicalVolume* postPV = aStep->GetPostStepPoint()->GetPhysicalVolume();
+  if(!prePV)
+    return;
+
+  // The step & its time go to the volume it is in
+  VolumeCounters & pre = counters[Index(prePV->GetLogicalVolume())];
+  pre.steps++;
+  pre.time += ns * 1E-9;
+  G4int bin = 0;
+  for(G4long t = ns >> 1; t && bin < kNTimeBins - 1; t >>= 1)
+    bin++;
+  pre.timeHist[bin]++;
+
+  // The boundary status & the end of the photon to the volume on the other side (when leaving the world, to the last one)
+  const G4int post = postPV ? Index(postPV->GetLogicalVolume()) : Index(prePV->GetLogicalVolume());
+  VolumeCounters & end = counters[post];
+  if(boundaryStatus >= 0 && boundaryStatus < kNStatus)
+    end.boundary[boundaryStatus]++;
+  if(aStep->GetTrack()->GetTrackStatus() == fStopAndKill)
+    end.kills++;
+}
+
+void WCSimOpticalProfile::EndOfRun(TDirectory* dir)
+{
+  if(!enabled)
+    return;
+
+  TDirectory* previous = gDirectory;
+  dir->cd();
+  TTree* tree = new TTree("wcsimOpticalProfileT", "WCSim optical photon steps & their wall time by logical volume");
+  std::string volume, material;
+  Long64_t steps, kills;
+  Double_t time;
+  Long64_t timeHist[kNTimeBins];
+  std::vector<Long64_t> boundary(kNStatus);
+  tree->Branch("Volume", &volume);
+  tree->Branch("Material", &material);
+  tree->Branch("Steps", &steps, "Steps/L");
+  tree->Branch("Time", &time, "Time/D");
+  tree->Branch("StepTimeHist", timeHist, Form("StepTimeHist[%d]/L", kNTimeBins));
+  tree->Branch("Kills", &kills, "Kills/L");
+  for(G4int s = 0; s < kNStatus; s++)
+    tree->Branch(kStatusNames[s], &boundary[s], Form("%s/L", kStatusNames[s]));
+
+  G4double totalTime = 0;
+  G4long totalSteps = 0;
+  for(size_t i = 0; i < volumes.size(); i++) {
+    const VolumeCounters & c = counters[i];
+    volume = volumes[i]->GetName();
+    material = volumes[i]->GetMaterial() ? volumes[i]->GetMaterial()->GetName() : "";
+    steps = c.steps;
+    kills = c.kills;
+    time = c.time;
+    std::copy(c.timeHist, c.timeHist + kNTimeBins, timeHist);
+    std::copy(c.boundary.begin(), c.boundary.end(), boundary.begin());
+    tree->Fill();
+    totalTime += c.time;
+    totalSteps += c.steps;
+  }
+  tree->Write();
+  delete tree;
+  previous->cd();
+
+  // The volumes with the most time
+  std::vector<size_t> order(volumes.size());
+  for(size_t i = 0; i < order.size(); i++)
+    order[i] = i;
+  std::sort(order.begin(), order.end(),
+	    [this](size_t a, size_t b) { return counters[a].time > counters[b].time; });
+  G4cout << "Optical profiling: " << totalSteps << " optical photon steps in " << totalTime << " s, "
+	 << volumes.size() << " logical volumes. The most time was spent in:" << G4endl;
+  for(size_t i = 0; i < order.size() && i < 10; i++) {
+    const VolumeCounters & c = counters[order[i]];
+    G4cout << "  " << std::setw(30) << std::left << volumes[order[i]]->GetName() << std::right
+	   << std::setw(12) << c.steps << " steps " << std::setw(10) << c.time << " s ("
+	   << std::setw(5) << std::setprecision(3) << (totalTime > 0 ? 100 * c.time / totalTime : 0) << "%) "
+	   << std::setw(8) << (c.steps ? 1E9 * c.time / c.steps : 0) << " ns/step "
+	   << std::setw(10) << c.kills << " photons ended"
+	   << std::setprecision(6) << G4endl;
+  }
+}
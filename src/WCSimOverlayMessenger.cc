@@ -0,0 +1,100 @@
+#include "WCSimOverlayMessenger.hh"
+#include "WCSimWCOverlay.hh"
+
+#include "G4UIdirectory.hh"
+#include "G4UIcommand.hh"
+#include "G4UIparameter.hh"
+#include "G4UIcmdWithADoubleAndUnit.hh"
+#include "G4UIcmdWithoutParameter.hh"
+
+#include <sstream>
+
+WCSimOverlayMessenger::WCSimOverlayMessenger(WCSimWCOverlay* overlaypoint)
+  : WCSimOverlay(overlaypoint)
+{
+  WCSimDir = new G4UIdirectory("/DAQ/Overlay/");
+  WCSimDir->SetGuidance("Commands to overlay pre-simulated events (hit libraries written with /WCSimIO/SaveHitLibrary) on each event");
+
+  AddRateSource = new G4UIcommand("/DAQ/Overlay/AddRateSource",this);
+  AddRateSource->SetGuidance("Overlay entries of a hit library at random times in the overlay window, at the given rate");
+  AddRateSource->SetGuidance("The number of entries per event is Poisson distributed, with mean rate x window width");
+  G4UIparameter* par = new G4UIparameter("file",'s',false);
+  par->SetGuidance("hit library file");
+  AddRateSource->SetParameter(par);
+  par = new G4UIparameter("rate",'d',false);
+  par->SetGuidance("rate of library entries (kHz)");
+  par->SetParameterRange("rate>=0");
+  AddRateSource->SetParameter(par);
+
+  AddFixedSource = new G4UIcommand("/DAQ/Overlay/AddFixedSource",this);
+  AddFixedSource->SetGuidance("Overlay one entry of a hit library per event, at a fixed time offset");
+  AddFixedSource->SetGuidance("Entries are taken in order, going back to the first after the last");
+  par = new G4UIparameter("file",'s',false);
+  par->SetGuidance("hit library file");
+  AddFixedSource->SetParameter(par);
+  par = new G4UIparameter("offset",'d',true);
+  par->SetGuidance("time offset (ns)");
+  par->SetDefaultValue(0.);
+  AddFixedSource->SetParameter(par);
+
+  ClearSources = new G4UIcmdWithoutParameter("/DAQ/Overlay/ClearSources",this);
+  ClearSources->SetGuidance("Remove all overlay sources");
+
+  double defaultWindowLow = -1000;
+  SetWindowLow = new G4UIcmdWithADoubleAndUnit("/DAQ/Overlay/WindowLow",this);
+  SetWindowLow->SetGuidance("Set the lower GEANT time limit of the window in which rate sources are overlaid");
+  SetWindowLow->SetParameterName("WindowLow",false);
+  SetWindowLow->SetDefaultValue(defaultWindowLow);
+  SetWindowLow->SetUnitCategory("Time");
+  SetWindowLow->SetDefaultUnit("ns");
+
+  double defaultWindowHigh = 2000;
+  SetWindowHigh = new G4UIcmdWithADoubleAndUnit("/DAQ/Overlay/WindowHigh",this);
+  SetWindowHigh->SetGuidance("Set the upper GEANT time limit of the window in which rate sources are overlaid");
+  SetWindowHigh->SetParameterName("WindowHigh",false);
+  SetWindowHigh->SetDefaultValue(defaultWindowHigh);
+  SetWindowHigh->SetUnitCategory("Time");
+  SetWindowHigh->SetDefaultUnit("ns");
+}
+
+WCSimOverlayMessenger::~WCSimOverlayMessenger()
+{
+  delete AddRateSource;
+  delete AddFixedSource;
+  delete ClearSources;
+  delete SetWindowLow;
+  delete SetWindowHigh;
+  delete WCSimDir;
+}
+
+void WCSimOverlayMessenger::SetNewValue(G4UIcommand* command,G4String newValue)
+{
+  if(command == AddRateSource){
+    std::istringstream is(newValue);
+    G4String file;
+    double rate;
+    is >> file >> rate;
+    WCSimOverlay->AddRateSource(file, rate);
+    G4cout << "Overlaying entries of " << file << " at " << rate << " kHz" << G4endl;
+  }
+  else if(command == AddFixedSource){
+    std::istringstream is(newValue);
+    G4String file;
+    double offset;
+    is >> file >> offset;
+    WCSimOverlay->AddFixedSource(file, offset);
+    G4cout << "Overlaying one entry of " << file << " per event at " << offset << " ns" << G4endl;
+  }
+  else if(command == ClearSources){
+    WCSimOverlay->ClearSources();
+    G4cout << "Removed all overlay sources" << G4endl;
+  }
+  else if(command == SetWindowLow){
+    WCSimOverlay->SetWindowLow(SetWindowLow->GetNewDoubleValue(newValue));
+    G4cout << "Setting overlay WindowLow value " << SetWindowLow->GetNewDoubleValue(newValue) << G4endl;
+  }
+  else if(command == SetWindowHigh){
+    WCSimOverlay->SetWindowHigh(SetWindowHigh->GetNewDoubleValue(newValue));
+    G4cout << "Setting overlay WindowHigh value " << SetWindowHigh->GetNewDoubleValue(newValue) << G4endl;
+  }
+}
@@ -20,6 +20,7 @@
 #include <vector>
 // for memset
 #include <cstring>
+#include <cmath>
 
 //ToDo: Clean this up, many of these hard coded things can be read in from (ROOT) files.
 
@@ -68,6 +69,17 @@ G4float* WCSimPMTObject::GetCollectionEfficiencyArray(){
   return CE;
 }
 
+// By default, the single p.e. pulse is that of a CR-(RC)^2 shaper with an 8 ns time constant,
+// which peaks 16 ns after the photoelectron.
+// This can be overridden in the derived class, e.g. with a measured pulse shape
+G4double WCSimPMTObject::PulseShape(G4double t){
+  const G4double tau = 8.; // ns
+  if(t <= 0)
+    return 0;
+  const G4double x = t / tau;
+  return x * x * std::exp(2. - x) / 4.;
+}
+
 
 
 ////////////////////////////////////////////////////////////////////////////////////////////////
@@ -81,12 +93,12 @@ G4String PMT20inch::GetPMTName() {G4String PMTName = "20inch"; return PMTName;}
 G4double PMT20inch::GetExposeHeight() {return .18*m;}
 G4double PMT20inch::GetRadius() {return .254*m;}
 G4double PMT20inch::GetPMTGlassThickness() {return 0.4*cm;}
-float PMT20inch::HitTimeSmearing(float Q) {
+float PMT20inch::HitTimeSmearing(float Q, WCSimDAQRandom & random) {
   float timingConstant = 10.0; 
   float timingResolution = 0.33 + sqrt(timingConstant/Q); 
   // looking at SK's jitter function for 20" tubes
   if (timingResolution < 0.58) timingResolution=0.58;
-  float Smearing_factor = G4RandGauss::shoot(0.0,timingResolution);
+  float Smearing_factor = random.Gauss(0.0,timingResolution);
   return Smearing_factor;
 }
 
@@ -255,12 +267,12 @@ G4String PMT8inch::GetPMTName() {G4String PMTName = "8inch"; return PMTName;}
 G4double PMT8inch::GetExposeHeight() {return 91.6*mm;}
 G4double PMT8inch::GetRadius() {return 101.6*mm;}
 G4double PMT8inch::GetPMTGlassThickness() {return 0.55*cm;} //currently the same as 10inch
-G4float PMT8inch::HitTimeSmearing(float Q) { 
+G4float PMT8inch::HitTimeSmearing(float Q, WCSimDAQRandom & random) { 
   float timingConstant = 1.890; 
   float timingResolution = 0.33 + sqrt(timingConstant/Q); 
   // looking at SK's jitter function for 20" tubes
   if (timingResolution < 0.58) timingResolution=0.58;
-  float Smearing_factor = G4RandGauss::shoot(0.0,timingResolution);
+  float Smearing_factor = random.Gauss(0.0,timingResolution);
   return Smearing_factor;
 }
 
@@ -416,12 +428,12 @@ G4String PMT5inch::GetPMTName() {G4String PMTName = "5inch"; return PMTName;}
 G4double PMT5inch::GetExposeHeight() {return 57.*mm;} //rough estimation
 G4double PMT5inch::GetRadius() {return 63.5*mm;}
 G4double PMT5inch::GetPMTGlassThickness() {return 0.55*cm;} //currently the same as 10inch
-G4float PMT5inch::HitTimeSmearing(float Q) { 
+G4float PMT5inch::HitTimeSmearing(float Q, WCSimDAQRandom & random) { 
   float timingConstant = 1.890;  //currently the same as 8inch
   float timingResolution = 0.33 + sqrt(timingConstant/Q); 
   // looking at SK's jitter function for 20" tubes
   if (timingResolution < 0.58) timingResolution=0.58;
-  float Smearing_factor = G4RandGauss::shoot(0.0,timingResolution);
+  float Smearing_factor = random.Gauss(0.0,timingResolution);
   return Smearing_factor;
 }
 
@@ -576,12 +588,12 @@ G4String PMT3inch::GetPMTName() {G4String PMTName = "3inch"; return PMTName;}
 G4double PMT3inch::GetExposeHeight() {return 20.*mm;}
 G4double PMT3inch::GetRadius() {return 40.*mm;}
 G4double PMT3inch::GetPMTGlassThickness() {return 0.10*cm;}
-G4float PMT3inch::HitTimeSmearing(float Q) { 
+G4float PMT3inch::HitTimeSmearing(float Q, WCSimDAQRandom & random) { 
   float timingConstant = 1.890; // 4ns FWHM when Q=1.0 
   float timingResolution = 0.33 + sqrt(timingConstant/Q); 
   // looking at SK's jitter function for 20" tubes
   if (timingResolution < 0.58) timingResolution=0.58;
-  float Smearing_factor = G4RandGauss::shoot(0.0,timingResolution);
+  float Smearing_factor = random.Gauss(0.0,timingResolution);
   return Smearing_factor;
 }
 
@@ -738,12 +750,12 @@ G4String PMT3inchGT::GetPMTName() {G4String PMTName = "3inchGT"; return PMTName;
 G4double PMT3inchGT::GetExposeHeight() {return 20.*mm;}
 G4double PMT3inchGT::GetRadius() {return 40.*mm;}
 G4double PMT3inchGT::GetPMTGlassThickness() {return 0.10*cm;}
-G4float PMT3inchGT::HitTimeSmearing(float Q) { 
+G4float PMT3inchGT::HitTimeSmearing(float Q, WCSimDAQRandom & random) { 
   float timingConstant = 0.535; // 2.5ns FWHM when Q=1.0
   float timingResolution = 0.33 + sqrt(timingConstant/Q); 
   // looking at SK's jitter function for 20" tubes
   if (timingResolution < 0.58) timingResolution=0.58;
-  float Smearing_factor = G4RandGauss::shoot(0.0,timingResolution);
+  float Smearing_factor = random.Gauss(0.0,timingResolution);
   return Smearing_factor;
 }
 
@@ -899,12 +911,12 @@ G4String PMT10inch::GetPMTName() {G4String PMTName = "10inch"; return PMTName;}
 G4double PMT10inch::GetExposeHeight() {return 117.*mm;}
 G4double PMT10inch::GetRadius() {return 127.*mm;}
 G4double PMT10inch::GetPMTGlassThickness() {return 0.55*cm;}
-float PMT10inch::HitTimeSmearing(float Q) { 
+float PMT10inch::HitTimeSmearing(float Q, WCSimDAQRandom & random) { 
   float timingConstant = 2.0; 
   float timingResolution = 0.33 + sqrt(timingConstant/Q); 
   // looking at SK's jitter function for 20" tubes
   if (timingResolution < 0.58) timingResolution=0.58;
-  float Smearing_factor = G4RandGauss::shoot(0.0,timingResolution);
+  float Smearing_factor = random.Gauss(0.0,timingResolution);
   return Smearing_factor;
 }
 
@@ -1061,12 +1073,12 @@ G4String PMT10inchHQE::GetPMTName() {G4String PMTName = "10inch"; return PMTName
 G4double PMT10inchHQE::GetExposeHeight() {return 117.*mm;}
 G4double PMT10inchHQE::GetRadius() {return 127.*mm;}
 G4double PMT10inchHQE::GetPMTGlassThickness() {return 0.55*cm;}
-G4float PMT10inchHQE::HitTimeSmearing(float Q) {
+G4float PMT10inchHQE::HitTimeSmearing(float Q, WCSimDAQRandom & random) {
   float timingConstant = 2.0; 
   float timingResolution = 0.33 + sqrt(timingConstant/Q); 
   // looking at SK's jitter function for 20" tubes
   if (timingResolution < 0.58) timingResolution=0.58;
-  float Smearing_factor = G4RandGauss::shoot(0.0,timingResolution);
+  float Smearing_factor = random.Gauss(0.0,timingResolution);
   return Smearing_factor;
 }
 
@@ -1223,12 +1235,12 @@ G4String PMT12inchHQE::GetPMTName() {G4String PMTName = "12inch"; return PMTName
 G4double PMT12inchHQE::GetExposeHeight() {return 118.*mm;}
 G4double PMT12inchHQE::GetRadius() {return 152.4*mm;}
 G4double PMT12inchHQE::GetPMTGlassThickness() {return 0.55*cm;}
-G4float PMT12inchHQE::HitTimeSmearing(float Q) {
+G4float PMT12inchHQE::HitTimeSmearing(float Q, WCSimDAQRandom & random) {
   float timingConstant = 2.0; 
   float timingResolution = 0.33 + sqrt(timingConstant/Q); 
   // looking at SK's jitter function for 20" tubes
   if (timingResolution < 0.58) timingResolution=0.58;
-  float Smearing_factor = G4RandGauss::shoot(0.0,timingResolution);
+  float Smearing_factor = random.Gauss(0.0,timingResolution);
   return Smearing_factor;
 }
 
@@ -1398,7 +1410,7 @@ G4String HPD20inchHQE::GetPMTName() {G4String PMTName = "HPD20inchHQE"; return P
 G4double HPD20inchHQE::GetExposeHeight() {return .192*m;}
 G4double HPD20inchHQE::GetRadius() {return .254*m;}
 G4double HPD20inchHQE::GetPMTGlassThickness() {return 0.3*cm;}
-float HPD20inchHQE::HitTimeSmearing(float Q) {
+float HPD20inchHQE::HitTimeSmearing(float Q, WCSimDAQRandom & random) {
   G4float sig_param[4]={0.6718,0.1264,0.4450,11.87};
   G4float lambda_param[2]={0.3255,0.1142};
 
@@ -1411,7 +1423,7 @@ float HPD20inchHQE::HitTimeSmearing(float Q) {
 
   G4float sigma = sigma_lowcharge*(Q<sig_param[3])+sigma_highcharge*(Q>sig_param[3]);
   G4float lambda = lambda_param[0]+lambda_param[1]*Q;
-  G4float Smearing_factor = G4RandGauss::shoot(-0.2,sigma)-1/lambda*log(1-G4UniformRand());
+  G4float Smearing_factor = random.Gauss(-0.2,sigma)-1/lambda*log(1-random.Flat());
   return Smearing_factor;
 }
 
@@ -1577,7 +1589,7 @@ G4String HPD12inchHQE::GetPMTName() {G4String PMTName = "HPD12inchHQE"; return P
 G4double HPD12inchHQE::GetExposeHeight() {return 118.*mm;} //Assumed to be the same as the PMT12inchHQE.
 G4double HPD12inchHQE::GetRadius() {return 152.4*mm;} //12 inches
 G4double HPD12inchHQE::GetPMTGlassThickness() {return 0.3*cm;} 
-float HPD12inchHQE::HitTimeSmearing(float Q) {
+float HPD12inchHQE::HitTimeSmearing(float Q, WCSimDAQRandom & random) {
   G4float sig_param[4]={0.6718,0.1264,0.4450,11.87};
   G4float lambda_param[2]={0.3255,0.1142};
 
@@ -1590,7 +1602,7 @@ float HPD12inchHQE::HitTimeSmearing(float Q) {
 
   G4float sigma = sigma_lowcharge*(Q<sig_param[3])+sigma_highcharge*(Q>sig_param[3]);
   G4float lambda = lambda_param[0]+lambda_param[1]*Q;
-  G4float Smearing_factor = G4RandGauss::shoot(-0.2,sigma)-1/lambda*log(1-G4UniformRand());
+  G4float Smearing_factor = random.Gauss(-0.2,sigma)-1/lambda*log(1-random.Flat());
   return Smearing_factor;
 }
 
@@ -1765,7 +1777,7 @@ G4double BoxandLine20inchHQE::GetExposeHeight() {return .18*m;}
 G4double BoxandLine20inchHQE::GetRadius() {return .254*m;}
 G4double BoxandLine20inchHQE::GetPMTGlassThickness() {return 0.4*cm;}
 
-float BoxandLine20inchHQE::HitTimeSmearing(float Q) {
+float BoxandLine20inchHQE::HitTimeSmearing(float Q, WCSimDAQRandom & random) {
   G4float sig_param[4]={0.6314,0.06260,0.5711,23.96};
   G4float lambda_param[2]={0.4113,0.07827};
   G4float sigma_lowcharge = sig_param[0]*(exp(-sig_param[1]*Q)+sig_param[2]);
@@ -1777,7 +1789,7 @@ float BoxandLine20inchHQE::HitTimeSmearing(float Q) {
 
   G4float sigma = sigma_lowcharge*(Q<sig_param[3])+sigma_highcharge*(Q>sig_param[3]);
   G4float lambda = lambda_param[0]+lambda_param[1]*Q;
-  G4float Smearing_factor = G4RandGauss::shoot(-0.2,sigma)-1/lambda*log(1-G4UniformRand());
+  G4float Smearing_factor = random.Gauss(-0.2,sigma)-1/lambda*log(1-random.Flat());
   return Smearing_factor;
 }
 
@@ -1951,7 +1963,7 @@ G4double BoxandLine12inchHQE::GetExposeHeight() {return 118.*mm;}
 G4double BoxandLine12inchHQE::GetRadius() {return 152.4*mm;}
 G4double BoxandLine12inchHQE::GetPMTGlassThickness() {return 0.4*cm;}
 
-float BoxandLine12inchHQE::HitTimeSmearing(float Q) {
+float BoxandLine12inchHQE::HitTimeSmearing(float Q, WCSimDAQRandom & random) {
   G4float sig_param[4]={0.6314,0.06260,0.5711,23.96};
   G4float lambda_param[2]={0.4113,0.07827};
 
@@ -1964,7 +1976,7 @@ float BoxandLine12inchHQE::HitTimeSmearing(float Q) {
 
   G4float sigma = sigma_lowcharge*(Q<sig_param[3])+sigma_highcharge*(Q>sig_param[3]);
   G4float lambda = lambda_param[0]+lambda_param[1]*Q;
-  G4float Smearing_factor = G4RandGauss::shoot(-0.2,sigma)-1/lambda*log(1-G4UniformRand());
+  G4float Smearing_factor = random.Gauss(-0.2,sigma)-1/lambda*log(1-random.Flat());
   return Smearing_factor;
 }
 
@@ -2144,13 +2156,13 @@ G4double PMT3inchR12199_02::GetPMTGlassThickness() {return 0.1*cm;}     // TF: f
 
 // Currently based on 8" (instead of 20")
 // But shifted to requirements (2ns TTS FWHM) for 1 pe
-float PMT3inchR12199_02::HitTimeSmearing(float Q) {
+float PMT3inchR12199_02::HitTimeSmearing(float Q, WCSimDAQRandom & random) {
 
   float timingConstant = 1.890; 
   float timingResolution = 0.5*(0.33 + sqrt(timingConstant/Q));  //factor 0.5 for expected improvement and required TTS
   // looking at SK's jitter function for 20" tubes
   if (timingResolution < 0.58) timingResolution=0.58;
-  float Smearing_factor = G4RandGauss::shoot(0.0,timingResolution);
+  float Smearing_factor = random.Gauss(0.0,timingResolution);
   return Smearing_factor;
 }
 
@@ -2346,7 +2358,7 @@ G4double PMT4inchR12199_02::GetExposeHeight() {return .0276*m;}  //or 0.021 for
 G4double PMT4inchR12199_02::GetRadius() {return .054*m;}        //radius at z = exposeheight of photocathode. In ConstructPMT, we use sphereRadius for the radius of curvature
 G4double PMT4inchR12199_02::GetPMTGlassThickness() {return 0.1*cm;}
 
-float PMT4inchR12199_02::HitTimeSmearing(float Q) {
+float PMT4inchR12199_02::HitTimeSmearing(float Q, WCSimDAQRandom & random) {
   G4float sig_param[4]={0.6314,0.06260,0.5711,23.96};
   G4float lambda_param[2]={0.4113,0.07827};
   G4float sigma_lowcharge = sig_param[0]*(exp(-sig_param[1]*Q)+sig_param[2]);
@@ -2358,7 +2370,7 @@ float PMT4inchR12199_02::HitTimeSmearing(float Q) {
 
   G4float sigma = sigma_lowcharge*(Q<sig_param[3])+sigma_highcharge*(Q>sig_param[3]);
   G4float lambda = lambda_param[0]+lambda_param[1]*Q;
-  G4float Smearing_factor = G4RandGauss::shoot(-0.2,sigma)-1/lambda*log(1-G4UniformRand());
+  G4float Smearing_factor = random.Gauss(-0.2,sigma)-1/lambda*log(1-random.Flat());
   return Smearing_factor;
 }
 
@@ -2528,7 +2540,7 @@ G4double PMT5inchR12199_02::GetExposeHeight() {return .0338*m;}  //or 0.0259 for
 G4double PMT5inchR12199_02::GetRadius() {return .0675*m;}        //radius at z = exposeheight of photocathode. In ConstructPMT, we use sphereRadius for the radius of curvature
 G4double PMT5inchR12199_02::GetPMTGlassThickness() {return 0.1*cm;}
 
-float PMT5inchR12199_02::HitTimeSmearing(float Q) {
+float PMT5inchR12199_02::HitTimeSmearing(float Q, WCSimDAQRandom & random) {
   G4float sig_param[4]={0.6314,0.06260,0.5711,23.96};
   G4float lambda_param[2]={0.4113,0.07827};
   G4float sigma_lowcharge = sig_param[0]*(exp(-sig_param[1]*Q)+sig_param[2]);
@@ -2540,7 +2552,7 @@ float PMT5inchR12199_02::HitTimeSmearing(float Q) {
 
   G4float sigma = sigma_lowcharge*(Q<sig_param[3])+sigma_highcharge*(Q>sig_param[3]);
   G4float lambda = lambda_param[0]+lambda_param[1]*Q;
-  G4float Smearing_factor = G4RandGauss::shoot(-0.2,sigma)-1/lambda*log(1-G4UniformRand());
+  G4float Smearing_factor = random.Gauss(-0.2,sigma)-1/lambda*log(1-random.Flat());
   return Smearing_factor;
 }
 
@@ -0,0 +1,168 @@
+#include "WCSimPhotonLibrary.hh"
+
+#include <cstring>
+#include <iostream>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+namespace {
+  const char kMagic[8] = {'W','C','S','I','M','O','P','H'};
+  const uint64_t kAlignment = 64;
+
+  uint64_t Align(uint64_t n) { return (n + kAlignment - 1) / kAlignment * kAlignment; }
+
+  bool WritePadding(FILE * f, uint64_t n)
+  {
+    const char zeros[kAlignment] = {0};
+    return fwrite(zeros, 1, n, f) == n;
+  }
+}
+
+WCSimPhotonLibrary::WCSimPhotonLibrary()
+  : fMap(0), fMapSize(0), fHeader(0), fPhotons(0), fEntries(0),
+    fFile(0)
+{
+}
+
+WCSimPhotonLibrary::~WCSimPhotonLibrary()
+{
+  if(fFile)
+    Finish();
+  Close();
+}
+
+bool WCSimPhotonLibrary::Create(const std::string & filename)
+{
+  if(fFile)
+    Finish();
+  fFile = fopen(filename.c_str(), "wb");
+  if(!fFile) {
+    std::cerr << "WCSimPhotonLibrary: could not open " << filename << " for writing" << std::endl;
+    return false;
+  }
+  fFileName = filename;
+  fNewEntry.clear();
+  fNewEntries.assign(1, 0);
+
+  // Reserve the header; it is filled by Finish()
+  if(!WritePadding(fFile, Align(sizeof(WCSimPhotonLibraryHeader)))) {
+    std::cerr << "WCSimPhotonLibrary: error writing " << filename << std::endl;
+    fclose(fFile);
+    fFile = 0;
+    return false;
+  }
+  return true;
+}
+
+bool WCSimPhotonLibrary::EndEntry()
+{
+  if(!fFile)
+    return false;
+  bool ok = true;
+  if(!fNewEntry.empty())
+    ok = fwrite(&fNewEntry[0], sizeof(WCSimPhotonLibraryPhoton), fNewEntry.size(), fFile) == fNewEntry.size();
+  if(!ok)
+    std::cerr << "WCSimPhotonLibrary: error writing " << fFileName << std::endl;
+  fNewEntries.push_back(fNewEntries.back() + fNewEntry.size());
+  fNewEntry.clear();
+  return ok;
+}
+
+bool WCSimPhotonLibrary::Finish()
+{
+  if(!fFile)
+    return false;
+  if(!fNewEntry.empty())
+    EndEntry();
+
+  WCSimPhotonLibraryHeader header;
+  memset(&header, 0, sizeof(header));
+  memcpy(header.magic, kMagic, sizeof(kMagic));
+  header.version     = kVersion;
+  header.headerSize  = sizeof(WCSimPhotonLibraryHeader);
+  header.numEntries  = fNewEntries.size() - 1;
+  header.numPhotons  = fNewEntries.back();
+  header.photonOffset = Align(sizeof(WCSimPhotonLibraryHeader));
+  const uint64_t photonEnd = header.photonOffset + header.numPhotons * sizeof(WCSimPhotonLibraryPhoton);
+  header.entryOffset = Align(photonEnd);
+  header.fileSize    = Align(header.entryOffset + fNewEntries.size() * sizeof(uint64_t));
+
+  // The photons are already on disk: append the entry boundaries, then go back for the header
+  bool ok = WritePadding(fFile, header.entryOffset - photonEnd);
+  ok = ok && fwrite(&fNewEntries[0], sizeof(uint64_t), fNewEntries.size(), fFile) == fNewEntries.size();
+  ok = ok && WritePadding(fFile, header.fileSize - header.entryOffset - fNewEntries.size() * sizeof(uint64_t));
+  ok = ok && fseek(fFile, 0, SEEK_SET) == 0;
+  ok = ok && fwrite(&header, sizeof(header), 1, fFile) == 1;
+  if(fclose(fFile) != 0)
+    ok = false;
+  fFile = 0;
+  if(!ok)
+    std::cerr << "WCSimPhotonLibrary: error writing " << fFileName << std::endl;
+  fNewEntries.clear();
+  return ok;
+}
+
+bool WCSimPhotonLibrary::Open(const std::string & filename)
+{
+  Close();
+  int fd = open(filename.c_str(), O_RDONLY);
+  if(fd < 0) {
+    std::cerr << "WCSimPhotonLibrary: could not open " << filename << std::endl;
+    return false;
+  }
+  struct stat st;
+  if(fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(WCSimPhotonLibraryHeader)) {
+    std::cerr << "WCSimPhotonLibrary: " << filename << " is too small to be a photon library" << std::endl;
+    close(fd);
+    return false;
+  }
+  void * map = mmap(0, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+  close(fd); //the mapping stays valid
+  if(map == MAP_FAILED) {
+    std::cerr << "WCSimPhotonLibrary: could not mmap " << filename << std::endl;
+    return false;
+  }
+  fMap = static_cast<const char*>(map);
+  fMapSize = st.st_size;
+  fHeader = reinterpret_cast<const WCSimPhotonLibraryHeader*>(fMap);
+
+  // Validate before any photon is handed out
+  const char * problem = 0;
+  if(memcmp(fHeader->magic, kMagic, sizeof(kMagic)) != 0)
+    problem = "is not a WCSim photon library (or was not finished)";
+  else if(fHeader->version != kVersion)
+    problem = "has an unsupported version";
+  else if(fHeader->headerSize != sizeof(WCSimPhotonLibraryHeader))
+    problem = "has an unexpected header size";
+  else if(fHeader->fileSize != fMapSize)
+    problem = "is truncated";
+  else if(fHeader->photonOffset % kAlignment || fHeader->entryOffset % kAlignment ||
+	  fHeader->photonOffset + fHeader->numPhotons * sizeof(WCSimPhotonLibraryPhoton) > fHeader->entryOffset ||
+	  fHeader->entryOffset + (fHeader->numEntries + 1) * sizeof(uint64_t) > fMapSize)
+    problem = "has a corrupt layout";
+  else {
+    fPhotons = reinterpret_cast<const WCSimPhotonLibraryPhoton*>(fMap + fHeader->photonOffset);
+    fEntries = reinterpret_cast<const uint64_t*>(fMap + fHeader->entryOffset);
+    if(fEntries[0] != 0 || fEntries[fHeader->numEntries] != fHeader->numPhotons)
+      problem = "has a corrupt entry index";
+  }
+  if(problem) {
+    std::cerr << "WCSimPhotonLibrary: " << filename << " " << problem << std::endl;
+    Close();
+    return false;
+  }
+  return true;
+}
+
+void WCSimPhotonLibrary::Close()
+{
+  if(fMap)
+    munmap(const_cast<char*>(fMap), fMapSize);
+  fMap = 0;
+  fMapSize = 0;
+  fHeader = 0;
+  fPhotons = 0;
+  fEntries = 0;
+}
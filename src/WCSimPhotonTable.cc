@@ -0,0 +1,276 @@
+#include "WCSimPhotonTable.hh"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+namespace {
+  const char kMagic[8] = {'W','C','S','I','M','P','D','T'};
+  const uint64_t kAlignment = 64;
+  const double kPi = 3.14159265358979323846;
+
+  uint64_t Align(uint64_t n) { return (n + kAlignment - 1) / kAlignment * kAlignment; }
+
+  bool WritePadding(FILE * f, uint64_t n)
+  {
+    const char zeros[kAlignment] = {0};
+    return fwrite(zeros, 1, n, f) == n;
+  }
+
+  /// The bin of x in [0, n), or -1
+  int Bin(double x, int n)
+  {
+    if(!(x >= 0) || x >= n)
+      return -1;
+    return (int)x;
+  }
+}
+
+WCSimPhotonTable::WCSimPhotonTable()
+  : fMap(0), fMapSize(0), fHeader(0), fEntries(0), fCells(0),
+    fFile(0)
+{
+  memset(&fNewHeader, 0, sizeof(fNewHeader));
+}
+
+WCSimPhotonTable::~WCSimPhotonTable()
+{
+  if(fFile)
+    Finish();
+  Close();
+}
+
+bool WCSimPhotonTable::Create(const std::string & filename, const std::string & detectorName, int numTubes,
+			      const double origin[3], double voxelSize, const int nBins[5], uint64_t photonsPerCell)
+{
+  if(fFile)
+    Finish();
+  Close();
+  fFile = fopen(filename.c_str(), "wb");
+  if(!fFile) {
+    std::cerr << "WCSimPhotonTable: could not open " << filename << " for writing" << std::endl;
+    return false;
+  }
+  fFileName = filename;
+
+  memset(&fNewHeader, 0, sizeof(fNewHeader));
+  memcpy(fNewHeader.magic, kMagic, sizeof(kMagic));
+  fNewHeader.version        = kVersion;
+  fNewHeader.headerSize     = sizeof(WCSimPhotonTableHeader);
+  fNewHeader.numTubes       = numTubes;
+  fNewHeader.numQuantiles   = kNTimeQuantiles;
+  fNewHeader.numCells       = 1;
+  for(int i = 0; i < 5; i++) {
+    fNewHeader.nBins[i] = nBins[i];
+    fNewHeader.numCells *= nBins[i];
+  }
+  for(int i = 0; i < 3; i++)
+    fNewHeader.origin[i] = origin[i];
+  fNewHeader.voxelSize      = voxelSize;
+  fNewHeader.photonsPerCell = photonsPerCell;
+  strncpy(fNewHeader.detectorName, detectorName.c_str(), sizeof(fNewHeader.detectorName) - 1);
+  fNewHits.clear();
+  fNewCells.assign(1, 0);
+
+  // Reserve the header; it is filled by Finish()
+  if(!WritePadding(fFile, Align(sizeof(WCSimPhotonTableHeader)))) {
+    std::cerr << "WCSimPhotonTable: error writing " << filename << std::endl;
+    fclose(fFile);
+    fFile = 0;
+    return false;
+  }
+  return true;
+}
+
+void WCSimPhotonTable::AddHit(int tube, float time)
+{
+  fNewHits.push_back(std::make_pair((int32_t)tube, time));
+}
+
+bool WCSimPhotonTable::EndCell(uint64_t numPhotons, double minProbability)
+{
+  if(!fFile)
+    return false;
+  if(GetNumCellsWritten() >= fNewHeader.numCells) {
+    std::cerr << "WCSimPhotonTable: all " << fNewHeader.numCells << " cells of " << fFileName
+	      << " are already filled" << std::endl;
+    fNewHits.clear();
+    return false;
+  }
+
+  // One entry per tube: its share of the photons & the quantiles of its sorted hit times
+  std::sort(fNewHits.begin(), fNewHits.end());
+  fNewCell.clear();
+  for(size_t first = 0; numPhotons && first < fNewHits.size(); ) {
+    size_t last = first;
+    while(last < fNewHits.size() && fNewHits[last].first == fNewHits[first].first)
+      last++;
+    const size_t n = last - first;
+    WCSimPhotonTableEntry entry;
+    entry.tube        = fNewHits[first].first;
+    entry.probability = (float)((double)n / numPhotons);
+    for(int k = 0; k < kNTimeQuantiles; k++) {
+      const double x = (double)k * (n - 1) / (kNTimeQuantiles - 1);
+      const size_t i = std::min((size_t)x, n - 1);
+      const size_t j = std::min(i + 1, n - 1);
+      entry.time[k] = fNewHits[first + i].second + (x - i) * (fNewHits[first + j].second - fNewHits[first + i].second);
+    }
+    if(entry.probability >= minProbability)
+      fNewCell.push_back(entry);
+    first = last;
+  }
+  fNewHits.clear();
+  return WriteCell();
+}
+
+bool WCSimPhotonTable::WriteCell()
+{
+  bool ok = true;
+  if(!fNewCell.empty())
+    ok = fwrite(&fNewCell[0], sizeof(WCSimPhotonTableEntry), fNewCell.size(), fFile) == fNewCell.size();
+  if(!ok)
+    std::cerr << "WCSimPhotonTable: error writing " << fFileName << std::endl;
+  fNewCells.push_back(fNewCells.back() + fNewCell.size());
+  fNewCell.clear();
+  return ok;
+}
+
+bool WCSimPhotonTable::Finish()
+{
+  if(!fFile)
+    return false;
+  if(GetNumCellsWritten() < fNewHeader.numCells) {
+    std::cerr << "WCSimPhotonTable: only " << GetNumCellsWritten() << " of the " << fNewHeader.numCells
+	      << " cells of " << fFileName << " were filled. The others are left empty" << std::endl;
+    fNewCells.resize(fNewHeader.numCells + 1, fNewCells.back());
+  }
+
+  WCSimPhotonTableHeader header = fNewHeader;
+  header.numEntries  = fNewCells.back();
+  header.entryOffset = Align(sizeof(WCSimPhotonTableHeader));
+  const uint64_t entryEnd = header.entryOffset + header.numEntries * sizeof(WCSimPhotonTableEntry);
+  header.cellOffset  = Align(entryEnd);
+  header.fileSize    = Align(header.cellOffset + fNewCells.size() * sizeof(uint64_t));
+
+  // The entries are already on disk: append the cell boundaries, then go back for the header
+  bool ok = WritePadding(fFile, header.cellOffset - entryEnd);
+  ok = ok && fwrite(&fNewCells[0], sizeof(uint64_t), fNewCells.size(), fFile) == fNewCells.size();
+  ok = ok && WritePadding(fFile, header.fileSize - header.cellOffset - fNewCells.size() * sizeof(uint64_t));
+  ok = ok && fseek(fFile, 0, SEEK_SET) == 0;
+  ok = ok && fwrite(&header, sizeof(header), 1, fFile) == 1;
+  if(fclose(fFile) != 0)
+    ok = false;
+  fFile = 0;
+  if(!ok)
+    std::cerr << "WCSimPhotonTable: error writing " << fFileName << std::endl;
+  fNewCells.clear();
+  return ok;
+}
+
+bool WCSimPhotonTable::Open(const std::string & filename)
+{
+  Close();
+  int fd = open(filename.c_str(), O_RDONLY);
+  if(fd < 0) {
+    std::cerr << "WCSimPhotonTable: could not open " << filename << std::endl;
+    return false;
+  }
+  struct stat st;
+  if(fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(WCSimPhotonTableHeader)) {
+    std::cerr << "WCSimPhotonTable: " << filename << " is too small to be a photon table" << std::endl;
+    close(fd);
+    return false;
+  }
+  void * map = mmap(0, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+  close(fd); //the mapping stays valid
+  if(map == MAP_FAILED) {
+    std::cerr << "WCSimPhotonTable: could not mmap " << filename << std::endl;
+    return false;
+  }
+  fMap = static_cast<const char*>(map);
+  fMapSize = st.st_size;
+  fHeader = reinterpret_cast<const WCSimPhotonTableHeader*>(fMap);
+
+  // Validate before any entry is handed out
+  const char * problem = 0;
+  uint64_t numCells = 1;
+  for(int i = 0; i < 5; i++)
+    numCells *= fHeader->nBins[i];
+  if(memcmp(fHeader->magic, kMagic, sizeof(kMagic)) != 0)
+    problem = "is not a WCSim photon table (or was not finished)";
+  else if(fHeader->version != kVersion)
+    problem = "has an unsupported version";
+  else if(fHeader->headerSize != sizeof(WCSimPhotonTableHeader) || fHeader->numQuantiles != (uint32_t)kNTimeQuantiles)
+    problem = "has an unexpected header size";
+  else if(fHeader->fileSize != fMapSize)
+    problem = "is truncated";
+  else if(numCells != fHeader->numCells || !(fHeader->voxelSize > 0))
+    problem = "has a corrupt grid";
+  else if(fHeader->entryOffset % kAlignment || fHeader->cellOffset % kAlignment ||
+	  fHeader->entryOffset + fHeader->numEntries * sizeof(WCSimPhotonTableEntry) > fHeader->cellOffset ||
+	  fHeader->cellOffset + (fHeader->numCells + 1) * sizeof(uint64_t) > fMapSize)
+    problem = "has a corrupt layout";
+  else {
+    fEntries = reinterpret_cast<const WCSimPhotonTableEntry*>(fMap + fHeader->entryOffset);
+    fCells   = reinterpret_cast<const uint64_t*>(fMap + fHeader->cellOffset);
+    if(fCells[0] != 0 || fCells[fHeader->numCells] != fHeader->numEntries)
+      problem = "has a corrupt cell index";
+  }
+  if(problem) {
+    std::cerr << "WCSimPhotonTable: " << filename << " " << problem << std::endl;
+    Close();
+    return false;
+  }
+  return true;
+}
+
+void WCSimPhotonTable::Close()
+{
+  if(fMap)
+    munmap(const_cast<char*>(fMap), fMapSize);
+  fMap = 0;
+  fMapSize = 0;
+  fHeader = 0;
+  fEntries = 0;
+  fCells = 0;
+}
+
+int64_t WCSimPhotonTable::GetCellIndex(double x, double y, double z, double dx, double dy, double dz) const
+{
+  const WCSimPhotonTableHeader & h = GetHeader();
+  const int ix = Bin((x - h.origin[0]) / h.voxelSize, h.nBins[0]);
+  const int iy = Bin((y - h.origin[1]) / h.voxelSize, h.nBins[1]);
+  const int iz = Bin((z - h.origin[2]) / h.voxelSize, h.nBins[2]);
+  if(ix < 0 || iy < 0 || iz < 0)
+    return -1;
+  // Directions on the edges (cos(theta) = 1, phi = pi) go in the last bins
+  const int ncost = h.nBins[3], nphi = h.nBins[4];
+  const int icost = std::min(std::max((int)((dz + 1) * 0.5 * ncost), 0), ncost - 1);
+  const int iphi  = std::min(std::max((int)((std::atan2(dy, dx) + kPi) / (2 * kPi) * nphi), 0), nphi - 1);
+  return ((((int64_t)ix * h.nBins[1] + iy) * h.nBins[2] + iz) * ncost + icost) * nphi + iphi;
+}
+
+void WCSimPhotonTable::GetCellBounds(uint64_t cell, double low[3], double high[3],
+				     double & costLow, double & costHigh, double & phiLow, double & phiHigh) const
+{
+  const WCSimPhotonTableHeader & h = GetHeader();
+  const int iphi  = cell % h.nBins[4]; cell /= h.nBins[4];
+  const int icost = cell % h.nBins[3]; cell /= h.nBins[3];
+  int index[3];
+  index[2] = cell % h.nBins[2]; cell /= h.nBins[2];
+  index[1] = cell % h.nBins[1]; cell /= h.nBins[1];
+  index[0] = cell;
+  for(int i = 0; i < 3; i++) {
+    low[i]  = h.origin[i] + index[i] * h.voxelSize;
+    high[i] = low[i] + h.voxelSize;
+  }
+  costLow  = -1 + 2. * icost / h.nBins[3];
+  costHigh = -1 + 2. * (icost + 1) / h.nBins[3];
+  phiLow   = -kPi + 2 * kPi * iphi / h.nBins[4];
+  phiHigh  = -kPi + 2 * kPi * (iphi + 1) / h.nBins[4];
+}
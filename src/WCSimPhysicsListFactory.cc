@@ -39,6 +39,8 @@ WCSimPhysicsListFactory::WCSimPhysicsListFactory() :  G4VModularPhysicsList()
  }
  //G4cout << "ValidListsString=" << ValidListsString << G4endl;
 
+ tableCache = new WCSimPhysicsTableCache(this);
+
  PhysicsMessenger = new WCSimPhysicsListFactoryMessenger(this, ValidListsString);
 
 }
@@ -47,6 +49,7 @@ WCSimPhysicsListFactory::~WCSimPhysicsListFactory()
 {
   delete PhysicsMessenger;
   PhysicsMessenger = NULL;
+  delete tableCache;
 
 }
 
@@ -133,6 +136,11 @@ void WCSimPhysicsListFactory::SetnCaptModel(G4String newvalue){
     nCaptModelChoice = newvalue;
 }
 
+void WCSimPhysicsListFactory::SetTableCacheDir(G4String dir){
+    G4cout << "Caching the physics tables in " << dir << G4endl;
+    tableCache->SetDirectory(dir);
+}
+
 void WCSimPhysicsListFactory::InitializeList(){
   G4cout << "Initializing physics list " << PhysicsListName << G4endl;
 
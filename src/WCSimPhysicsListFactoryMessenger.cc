@@ -30,12 +30,20 @@ WCSimPhysicsListFactoryMessenger::WCSimPhysicsListFactoryMessenger(WCSimPhysicsL
   nCaptureModelCmd->SetGuidance(captureModelGuidance);
   nCaptureModelCmd->SetDefaultValue("Default");
   nCaptureModelCmd->SetCandidates(captureModelsString);
+
+  tableCacheCmd = new G4UIcmdWithAString("/WCSim/physics/TableCache",this);
+  tableCacheCmd->SetGuidance("Directory where the physics tables are stored, and retrieved from by the next jobs");
+  tableCacheCmd->SetGuidance("with the same Geant4 version, physics list, geometry materials & production cuts.");
+  tableCacheCmd->SetGuidance("The optical tables are not cached: they are always built from the /WCSim/tuning/ parameters");
+  tableCacheCmd->SetParameterName("TableCache",false);
+  tableCacheCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
 }
 
 WCSimPhysicsListFactoryMessenger::~WCSimPhysicsListFactoryMessenger()
 {
   delete physListCmd;
   delete nCaptureModelCmd;
+  delete tableCacheCmd;
   //delete WCSimDir;
 }
 
@@ -46,4 +54,6 @@ void WCSimPhysicsListFactoryMessenger::SetNewValue(G4UIcommand* command, G4Strin
   else if (command == nCaptureModelCmd){
     thisWCSimPhysicsListFactory->SetnCaptModel(newValue);
   }
+  else if (command == tableCacheCmd)
+    thisWCSimPhysicsListFactory->SetTableCacheDir(newValue);
 }
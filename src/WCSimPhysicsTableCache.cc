@@ -0,0 +1,163 @@
+#include "WCSimPhysicsTableCache.hh"
+#include "WCSimPhysicsListFactory.hh"
+
+#include "G4StateManager.hh"
+#include "G4LogicalVolumeStore.hh"
+#include "G4LogicalVolume.hh"
+#include "G4Material.hh"
+#include "G4Element.hh"
+#include "G4RegionStore.hh"
+#include "G4Region.hh"
+#include "G4ProductionCuts.hh"
+#include "G4Version.hh"
+#include "G4SystemOfUnits.hh"
+
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <dirent.h>
+#include <unistd.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <fstream>
+#include <sstream>
+#include <vector>
+#include <algorithm>
+
+// Remove a directory of (table) files
+static void RemoveTableDirectory(const G4String & dir)
+{
+  DIR* d = opendir(dir.c_str());
+  if(d) {
+    struct dirent* entry;
+    while((entry = readdir(d))) {
+      G4String name = entry->d_name;
+      if(name != "." && name != "..")
+	unlink((dir + "/" + name).c_str());
+    }
+    closedir(d);
+  }
+  rmdir(dir.c_str());
+}
+
+WCSimPhysicsTableCache::WCSimPhysicsTableCache(WCSimPhysicsListFactory* physList)
+  : G4VStateDependent(), physicsList(physList), storeTables(false)
+{
+}
+
+WCSimPhysicsTableCache::~WCSimPhysicsTableCache()
+{
+}
+
+G4String WCSimPhysicsTableCache::MakeKey()
+{
+  std::ostringstream key;
+  key.precision(15);
+  key << "Geant4 " << G4VERSION_NUMBER << "\n"
+      << "Physics list " << physicsList->GetPhysicsListName()
+      << " nCapture " << physicsList->GetnCaptModel() << "\n";
+
+  // The materials of the geometry, in the order of the logical volumes, with their
+  // composition: some are remade with the same name (e.g. "Doped Water", by
+  // /WCSim/DopingConcentration)
+  std::vector<const G4Material*> materials;
+  G4LogicalVolumeStore* lvStore = G4LogicalVolumeStore::GetInstance();
+  for(size_t i = 0; i < lvStore->size(); i++) {
+    const G4Material* material = (*lvStore)[i]->GetMaterial();
+    if(material && std::find(materials.begin(), materials.end(), material) == materials.end()) {
+      materials.push_back(material);
+      key << "Material " << material->GetName() << " density " << material->GetDensity()/(g/cm3);
+      const G4double* fractions = material->GetFractionVector();
+      for(size_t j = 0; j < material->GetNumberOfElements(); j++) {
+	const G4Element* element = material->GetElement(j);
+	key << " " << element->GetName() << " Z " << element->GetZ()
+	    << " A " << element->GetA()/(g/mole) << " fraction " << fractions[j];
+      }
+      key << "\n";
+    }
+  }
+
+  // The production cuts of each region (gamma, e-, e+, proton)
+  G4RegionStore* regionStore = G4RegionStore::GetInstance();
+  for(size_t i = 0; i < regionStore->size(); i++) {
+    const G4Region* region = (*regionStore)[i];
+    key << "Region " << region->GetName() << " cuts";
+    G4ProductionCuts* cuts = region->GetProductionCuts();
+    if(cuts)
+      for(G4int j = 0; j < 4; j++)
+	key << " " << cuts->GetProductionCut(j)/mm;
+    key << "\n";
+  }
+  return key.str();
+}
+
+G4bool WCSimPhysicsTableCache::Notify(G4ApplicationState requestedState)
+{
+  if(cacheDir.empty())
+    return true;
+  G4ApplicationState previousState = G4StateManager::GetStateManager()->GetPreviousState();
+
+  // Start of a run: the physics tables are about to be built
+  if(previousState == G4State_Idle && requestedState == G4State_Init) {
+    G4String key = MakeKey();
+    if(key == currentKey)
+      return true;
+    currentKey = key;
+
+    // FNV-1a hash of the key
+    uint64_t hash = 14695981039346656037ULL;
+    for(size_t i = 0; i < key.size(); i++) {
+      hash ^= (unsigned char)key[i];
+      hash *= 1099511628211ULL;
+    }
+    char name[17];
+    snprintf(name, sizeof(name), "%016llx", (unsigned long long)hash);
+    tableDir = cacheDir + "/" + name;
+
+    struct stat st;
+    if(stat(tableDir.c_str(), &st) == 0 && S_ISDIR(st.st_mode)) {
+      G4cout << "Retrieving the physics tables from " << tableDir << G4endl;
+      physicsList->SetPhysicsTableRetrieved(tableDir);
+      storeTables = false;
+    }
+    else {
+      G4cout << "Building the physics tables, to be stored in " << tableDir << G4endl;
+      physicsList->ResetPhysicsTableRetrieved();
+      storeTables = true;
+    }
+  }
+  // End of the run initialisation: the physics tables have been built
+  else if(previousState == G4State_Idle && requestedState == G4State_GeomClosed) {
+    if(storeTables)
+      Store();
+    storeTables = false;
+  }
+  return true;
+}
+
+void WCSimPhysicsTableCache::Store()
+{
+  mkdir(cacheDir.c_str(), 0755);
+  std::ostringstream tmp;
+  tmp << tableDir << ".tmp" << getpid();
+  G4String tmpDir = tmp.str();
+  if(mkdir(tmpDir.c_str(), 0755) != 0) {
+    G4cerr << "WCSimPhysicsTableCache: could not create " << tmpDir
+	   << ". Not caching the physics tables" << G4endl;
+    return;
+  }
+
+  if(!physicsList->StorePhysicsTable(tmpDir)) {
+    G4cerr << "WCSimPhysicsTableCache: could not store the physics tables in " << tmpDir << G4endl;
+    RemoveTableDirectory(tmpDir);
+    return;
+  }
+  std::ofstream keyFile((tmpDir + "/key.txt").c_str());
+  keyFile << currentKey;
+  keyFile.close();
+
+  // Another job may have stored the same tables in the meantime
+  if(rename(tmpDir.c_str(), tableDir.c_str()) != 0)
+    RemoveTableDirectory(tmpDir);
+  else
+    G4cout << "Stored the physics tables in " << tableDir << G4endl;
+}
@@ -1,6 +1,7 @@
 #include "WCSimPrimaryGeneratorAction.hh"
 #include "WCSimDetectorConstruction.hh"
 #include "WCSimPrimaryGeneratorMessenger.hh"
+#include "WCSimRunAction.hh"
 
 #include "G4Event.hh"
 #include "G4ParticleGun.hh"
@@ -9,6 +10,7 @@
 #include "G4ParticleDefinition.hh"
 #include "G4ThreeVector.hh"
 #include "G4EventManager.hh"
+#include "G4RunManager.hh"
 #include "globals.hh"
 #include "Randomize.hh"
 #include <fstream>
@@ -76,8 +78,15 @@ WCSimPrimaryGeneratorAction::WCSimPrimaryGeneratorAction(
   useLaserEvt  = false;
   useGPSEvt    = false;
   useRootrackerEvt = false;
+  useReplayEvt = false;
+  usePhotonTableEvt = false;
+  usePhotonReplayEvt = false;
   
   fEvNum = 0;
+  fReplayEntry = 0;
+  fReplayNext = 0;
+  fPhotonEntry = 0;
+  fPhotonNext = 0;
   fInputRootrackerFile = NULL;
   fNEntries = 1;
 	  
@@ -374,6 +383,103 @@ void WCSimPrimaryGeneratorAction::GeneratePrimaries(G4Event* anEvent)
         }
     }
 
+  else if (useReplayEvt)
+  {
+    // No particles: WCSimEventAction replays the PMT signals of the next library entry
+    if ( !fReplayLibrary.IsOpen() )
+    {
+      G4cout << "Set a raw signal library to replay using the command /mygen/vecfile name"
+	     << G4endl;
+      exit(-1);
+    }
+    fReplayEntry = fReplayNext++;
+    if ( fReplayEntry >= fReplayLibrary.GetNumEntries() )
+    {
+      G4cout << "End of the replayed library reached after " << fReplayLibrary.GetNumEntries()
+	     << " entries. Ending the run" << G4endl;
+      anEvent->SetEventAborted();
+      G4RunManager::GetRunManager()->AbortRun(true);
+      return;
+    }
+
+    mode = UNKNOWN;
+    vecRecNumber = (G4int)fReplayEntry;
+    SetVtx(G4ThreeVector(0.,0.,0.));
+    SetBeamEnergy(0.);
+    SetBeamDir(G4ThreeVector(0.,0.,1.));
+    SetBeamPDG(0);
+    targetpdg = 0;
+    targetenergy = 0.;
+    targetdir = G4ThreeVector(0.,0.,1.);
+  }
+  else if (usePhotonReplayEvt)
+  {
+    // The saved optical photons of the next library entry. Their primary track IDs (1, 2, ...) follow
+    // the order of the entry, so WCSimTrackingAction can give them their saved parents
+    if ( !fPhotonLibrary.IsOpen() )
+    {
+      G4cout << "Set a photon library to replay using the command /mygen/vecfile name"
+	     << G4endl;
+      exit(-1);
+    }
+    fPhotonEntry = fPhotonNext++;
+    if ( fPhotonEntry >= fPhotonLibrary.GetNumEntries() )
+    {
+      G4cout << "End of the replayed photon library reached after " << fPhotonLibrary.GetNumEntries()
+	     << " entries. Ending the run" << G4endl;
+      anEvent->SetEventAborted();
+      G4RunManager::GetRunManager()->AbortRun(true);
+      return;
+    }
+
+    G4ParticleDefinition* opticalPhoton = particleTable->FindParticle("opticalphoton");
+    const WCSimPhotonLibraryPhoton * photons = fPhotonLibrary.GetEntry(fPhotonEntry);
+    const uint64_t nphotons = fPhotonLibrary.GetEntrySize(fPhotonEntry);
+    for (uint64_t i = 0; i < nphotons; i++)
+    {
+      const WCSimPhotonLibraryPhoton & saved = photons[i];
+      G4PrimaryParticle* photon = new G4PrimaryParticle(opticalPhoton);
+      photon->SetMomentumDirection(G4ThreeVector(saved.dir[0], saved.dir[1], saved.dir[2]));
+      photon->SetKineticEnergy(saved.energy*eV);
+      photon->SetPolarization(saved.pol[0], saved.pol[1], saved.pol[2]);
+      photon->SetWeight(saved.weight);
+      G4PrimaryVertex* vertex = new G4PrimaryVertex(G4ThreeVector(saved.pos[0], saved.pos[1], saved.pos[2])*cm, saved.time*ns);
+      vertex->SetPrimary(photon);
+      anEvent->AddPrimaryVertex(vertex);
+    }
+
+    mode = UNKNOWN;
+    vecRecNumber = (G4int)fPhotonEntry;
+    SetVtx(nphotons ? G4ThreeVector(photons[0].pos[0], photons[0].pos[1], photons[0].pos[2])*cm : G4ThreeVector(0.,0.,0.));
+    SetBeamEnergy(0.);
+    SetBeamDir(G4ThreeVector(0.,0.,1.));
+    SetBeamPDG(0);
+    targetpdg = 0;
+    targetenergy = 0.;
+    targetdir = G4ThreeVector(0.,0.,1.);
+  }
+  else if (usePhotonTableEvt)
+  {
+    // The optical photons of the next cell of the photon table, added to the table by WCSimEventAction
+    WCSimFastOptics* fastOptics = ((WCSimRunAction*)G4RunManager::GetRunManager()->GetUserRunAction())->GetFastOptics();
+    if ( !fastOptics->GenerateCellPhotons(anEvent) )
+    {
+      G4cout << "All the cells of the photon table are filled. Ending the run" << G4endl;
+      anEvent->SetEventAborted();
+      G4RunManager::GetRunManager()->AbortRun(true);
+      return;
+    }
+
+    mode = UNKNOWN;
+    vecRecNumber = anEvent->GetEventID();
+    SetVtx(anEvent->GetNumberOfPrimaryVertex() ? anEvent->GetPrimaryVertex()->GetPosition() : G4ThreeVector(0.,0.,0.));
+    SetBeamEnergy(0.);
+    SetBeamDir(G4ThreeVector(0.,0.,1.));
+    SetBeamPDG(0);
+    targetpdg = 0;
+    targetenergy = 0.;
+    targetdir = G4ThreeVector(0.,0.,1.);
+  }
   else if (useGunEvt)
   {      // manual gun operation
     particleGun->GeneratePrimaryVertex(anEvent);
@@ -473,7 +579,7 @@ void WCSimPrimaryGeneratorAction::GeneratePrimaries(G4Event* anEvent)
 
 void WCSimPrimaryGeneratorAction::SaveOptionsToOutput(WCSimRootOptions * wcopt)
 {
-  if(useMulineEvt)
+  if(useMulineEvt || useReplayEvt || usePhotonReplayEvt)
     wcopt->SetVectorFileName(vectorFileName);
   else
     wcopt->SetVectorFileName("");
@@ -492,6 +598,12 @@ G4String WCSimPrimaryGeneratorAction::GetGeneratorTypeString()
     return "laser";
   else if(useRootrackerEvt)
     return "rooTrackerEvt";
+  else if(useReplayEvt)
+    return "replay";
+  else if(usePhotonTableEvt)
+    return "photontable";
+  else if(usePhotonReplayEvt)
+    return "photonreplay";
   return "";
 }
 
@@ -530,6 +642,34 @@ vector<string> tokenize( string separators, string input )
     return tokens;
 }
 
+void WCSimPrimaryGeneratorAction::OpenReplayLibrary(G4String fileName)
+{
+    if (!fReplayLibrary.Open(fileName)) {
+        G4cout << "Cannot open: " << fileName << G4endl;
+        exit(1);
+    }
+    if (fReplayLibrary.GetLevel() != WCSimHitLibrary::kRawSignal) {
+        G4cout << fileName << " is not a raw signal library (see /WCSimIO/SaveRawSignalLibrary)" << G4endl;
+        exit(1);
+    }
+    vectorFileName = fileName;
+    fReplayEntry = 0;
+    fReplayNext = 0;
+    G4cout << "Replaying the " << fReplayLibrary.GetNumEntries() << " entries of " << fileName << G4endl;
+}
+
+void WCSimPrimaryGeneratorAction::OpenPhotonLibrary(G4String fileName)
+{
+    if (!fPhotonLibrary.Open(fileName)) {
+        G4cout << "Cannot open: " << fileName << G4endl;
+        exit(1);
+    }
+    vectorFileName = fileName;
+    fPhotonEntry = 0;
+    fPhotonNext = 0;
+    G4cout << "Replaying the optical photons of the " << fPhotonLibrary.GetNumEntries() << " entries of " << fileName << G4endl;
+}
+
 void WCSimPrimaryGeneratorAction::OpenRootrackerFile(G4String fileName)
 {
     if (fInputRootrackerFile) fInputRootrackerFile->Delete();
@@ -15,10 +15,13 @@ WCSimPrimaryGeneratorMessenger::WCSimPrimaryGeneratorMessenger(WCSimPrimaryGener
   genCmd = new G4UIcmdWithAString("/mygen/generator",this);
   genCmd->SetGuidance("Select primary generator.");
 
-  genCmd->SetGuidance(" Available generators : muline, gun, laser, gps, rootracker, gamma-conversion");
+  genCmd->SetGuidance(" Available generators : muline, gun, laser, gps, rootracker, gamma-conversion, replay, photontable, photonreplay");
+  genCmd->SetGuidance(" replay: generate no particles, and replay the PMT signals saved with /WCSimIO/SaveRawSignalLibrary (set with /mygen/vecfile)");
+  genCmd->SetGuidance(" photontable: emit the optical photons of one cell of the photon table built with /WCSim/FastOptics/BuildTable per event");
+  genCmd->SetGuidance(" photonreplay: only track the optical photons saved with /WCSimIO/SavePhotons (set with /mygen/vecfile)");
   genCmd->SetParameterName("generator",true);
   genCmd->SetDefaultValue("muline");
-  genCmd->SetCandidates("muline gun laser gps rootracker, gamma-conversion");
+  genCmd->SetCandidates("muline gun laser gps rootracker, gamma-conversion replay photontable photonreplay");
 
   fileNameCmd = new G4UIcmdWithAString("/mygen/vecfile",this);
   fileNameCmd->SetGuidance("Select the file of vectors.");
@@ -59,6 +62,9 @@ void WCSimPrimaryGeneratorMessenger::SetNewValue(G4UIcommand * command,G4String
       myAction->SetRootrackerEvtGenerator(false);
       myAction->SetLaserEvtGenerator(false);
       myAction->SetGPSEvtGenerator(false);
+      myAction->SetReplayEvtGenerator(false);
+      myAction->SetPhotonTableEvtGenerator(false);
+      myAction->SetPhotonReplayEvtGenerator(false);
     }
     else if ( newValue == "gun")
     {
@@ -67,6 +73,9 @@ void WCSimPrimaryGeneratorMessenger::SetNewValue(G4UIcommand * command,G4String
       myAction->SetRootrackerEvtGenerator(false);
       myAction->SetLaserEvtGenerator(false);
       myAction->SetGPSEvtGenerator(false);
+      myAction->SetReplayEvtGenerator(false);
+      myAction->SetPhotonTableEvtGenerator(false);
+      myAction->SetPhotonReplayEvtGenerator(false);
     }
     else if ( newValue == "laser")   //T. Akiri: Addition of laser
     {
@@ -75,6 +84,9 @@ void WCSimPrimaryGeneratorMessenger::SetNewValue(G4UIcommand * command,G4String
       myAction->SetRootrackerEvtGenerator(false);
       myAction->SetLaserEvtGenerator(true);
       myAction->SetGPSEvtGenerator(false);
+      myAction->SetReplayEvtGenerator(false);
+      myAction->SetPhotonTableEvtGenerator(false);
+      myAction->SetPhotonReplayEvtGenerator(false);
     }
     else if ( newValue == "gps")
     {
@@ -83,6 +95,9 @@ void WCSimPrimaryGeneratorMessenger::SetNewValue(G4UIcommand * command,G4String
       myAction->SetRootrackerEvtGenerator(false);
       myAction->SetLaserEvtGenerator(false);
       myAction->SetGPSEvtGenerator(true);
+      myAction->SetReplayEvtGenerator(false);
+      myAction->SetPhotonTableEvtGenerator(false);
+      myAction->SetPhotonReplayEvtGenerator(false);
       myAction->SetNeedConversion(false);	    
     }
     else if ( newValue == "rootracker")   //M. Scott: Addition of Rootracker events
@@ -92,6 +107,9 @@ void WCSimPrimaryGeneratorMessenger::SetNewValue(G4UIcommand * command,G4String
       myAction->SetGunEvtGenerator(false);
       myAction->SetLaserEvtGenerator(false);
       myAction->SetGPSEvtGenerator(false);
+      myAction->SetReplayEvtGenerator(false);
+      myAction->SetPhotonTableEvtGenerator(false);
+      myAction->SetPhotonReplayEvtGenerator(false);
     }
     else if ( newValue == "gamma-conversion")
     {
@@ -100,8 +118,44 @@ void WCSimPrimaryGeneratorMessenger::SetNewValue(G4UIcommand * command,G4String
       myAction->SetGunEvtGenerator(false);
       myAction->SetLaserEvtGenerator(false);
       myAction->SetGPSEvtGenerator(true);
+      myAction->SetReplayEvtGenerator(false);
+      myAction->SetPhotonTableEvtGenerator(false);
+      myAction->SetPhotonReplayEvtGenerator(false);
       myAction->SetNeedConversion(true);
-    }	  
+    }
+    else if ( newValue == "replay")
+    {
+      myAction->SetMulineEvtGenerator(false);
+      myAction->SetRootrackerEvtGenerator(false);
+      myAction->SetGunEvtGenerator(false);
+      myAction->SetLaserEvtGenerator(false);
+      myAction->SetGPSEvtGenerator(false);
+      myAction->SetReplayEvtGenerator(true);
+      myAction->SetPhotonTableEvtGenerator(false);
+      myAction->SetPhotonReplayEvtGenerator(false);
+    }
+    else if ( newValue == "photontable")
+    {
+      myAction->SetMulineEvtGenerator(false);
+      myAction->SetRootrackerEvtGenerator(false);
+      myAction->SetGunEvtGenerator(false);
+      myAction->SetLaserEvtGenerator(false);
+      myAction->SetGPSEvtGenerator(false);
+      myAction->SetReplayEvtGenerator(false);
+      myAction->SetPhotonTableEvtGenerator(true);
+      myAction->SetPhotonReplayEvtGenerator(false);
+    }
+    else if ( newValue == "photonreplay")
+    {
+      myAction->SetMulineEvtGenerator(false);
+      myAction->SetRootrackerEvtGenerator(false);
+      myAction->SetGunEvtGenerator(false);
+      myAction->SetLaserEvtGenerator(false);
+      myAction->SetGPSEvtGenerator(false);
+      myAction->SetReplayEvtGenerator(false);
+      myAction->SetPhotonTableEvtGenerator(false);
+      myAction->SetPhotonReplayEvtGenerator(true);
+    }
   }
 
   if( command == fileNameCmd )
@@ -110,6 +164,12 @@ void WCSimPrimaryGeneratorMessenger::SetNewValue(G4UIcommand * command,G4String
         if(myAction->IsUsingRootrackerEvtGenerator()){
             myAction->OpenRootrackerFile(newValue);
         }
+        else if(myAction->IsUsingReplayEvtGenerator()){
+            myAction->OpenReplayLibrary(newValue);
+        }
+        else if(myAction->IsUsingPhotonReplayEvtGenerator()){
+            myAction->OpenPhotonLibrary(newValue);
+        }
         else{
             myAction->OpenVectorFile(newValue);
         }
@@ -153,6 +213,12 @@ G4String WCSimPrimaryGeneratorMessenger::GetCurrentValue(G4UIcommand* command)
        { cv = myAction->NeedsConversion() ? "gamma-conversion" : "gps"; }
     else if(myAction->IsUsingRootrackerEvtGenerator())
       { cv = "rootracker"; }   //M. Scott: Addition of Rootracker events
+    else if(myAction->IsUsingReplayEvtGenerator())
+      { cv = "replay"; }
+    else if(myAction->IsUsingPhotonTableEvtGenerator())
+      { cv = "photontable"; }
+    else if(myAction->IsUsingPhotonReplayEvtGenerator())
+      { cv = "photonreplay"; }
   }
   
   return cv;
@@ -414,19 +414,24 @@ WCSimRootCherenkovHit *WCSimRootTrigger::AddCherenkovHit(Int_t tubeID, Int_t mPM
         std::vector<Int_t> primParID, std::vector<Float_t> photonStartTime, std::vector<TVector3> photonStartPos, std::vector<TVector3> photonEndPos)
 {
   // Add a new Cherenkov hit to the list of Cherenkov hits
+  // The photon start time/position and end position vectors are optional
+  // (see /WCSimIO/). If they are empty, the values are saved as 0
   TClonesArray &cherenkovhittimes = *fCherenkovHitTimes;
 
+  const bool hasStartTime = !photonStartTime.empty();
+  const bool hasStartPos  = !photonStartPos.empty();
+  const bool hasEndPos    = !photonEndPos.empty();
   for (unsigned int i =0;i<truetime.size();i++)
   {
     fCherenkovHitCounter++;
     Float_t startPos[3];
     Float_t endPos[3];
     for(int j=0; j<3; j++){
-      startPos[j] = photonStartPos[i][j];
-      endPos[j] = photonEndPos[i][j];
+      startPos[j] = hasStartPos ? photonStartPos[i][j] : 0;
+      endPos[j] = hasEndPos ? photonEndPos[i][j] : 0;
     }
     WCSimRootCherenkovHitTime *cherenkovhittime = 
-      new(cherenkovhittimes[fNcherenkovhittimes++]) WCSimRootCherenkovHitTime(truetime[i],primParID[i], photonStartTime[i], startPos, endPos);
+      new(cherenkovhittimes[fNcherenkovhittimes++]) WCSimRootCherenkovHitTime(truetime[i],primParID[i], hasStartTime ? photonStartTime[i] : 0, startPos, endPos);
   }
 
   Int_t WC_Index[2];
@@ -443,6 +448,24 @@ WCSimRootCherenkovHit *WCSimRootTrigger::AddCherenkovHit(Int_t tubeID, Int_t mPM
 
   return cherenkovhit;
 }
+
+WCSimRootCherenkovHit *WCSimRootTrigger::AddCherenkovHit(Int_t tubeID, Int_t mPMTID, Int_t mPMT_PMTID, Int_t npe)
+{
+  // Add a new Cherenkov hit to the list of Cherenkov hits, without the true hit times
+  Int_t WC_Index[2];
+  WC_Index[0] = -1;
+  WC_Index[1] = npe;
+
+  TClonesArray &cherenkovhits = *fCherenkovHits;
+
+  WCSimRootCherenkovHit *cherenkovhit
+    = new(cherenkovhits[fNcherenkovhits++]) WCSimRootCherenkovHit(tubeID,
+								  mPMTID,
+								  mPMT_PMTID,
+								  WC_Index);
+
+  return cherenkovhit;
+}
 //_____________________________________________________________________________
 
 WCSimRootCherenkovHit::WCSimRootCherenkovHit(Int_t tubeID,
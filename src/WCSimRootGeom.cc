@@ -6,8 +6,24 @@
 #include "TDirectory.h"
 #include "TProcessID.h"
 #include "TClonesArray.h"
+#include "TMath.h"
 
 #include "WCSimRootGeom.hh"
+#include "WCSimGeometryTable.hh"
+
+#include <atomic>
+#include <mutex>
+
+// SoA view & ID lookup tables of the PMTs of a WCSimRootGeom
+struct WCSimRootPMTCache {
+  std::mutex           mutex;
+  std::atomic<bool>    valid;
+  std::vector<Float_t> x, y, z, dx, dy, dz;
+  std::vector<Int_t>   indexByTube; // tube ID -> PMT index
+  std::vector<Int_t>   indexBymPMT; // mPMT * mPMT_PMTStride + mPMT_PMT -> PMT index
+  Int_t                mPMT_PMTStride;
+  WCSimRootPMTCache() : valid(false), mPMT_PMTStride(0) {}
+};
 
 #ifndef REFLEX_DICTIONARY
 ClassImp(WCSimRootGeom)
@@ -21,6 +37,7 @@ WCSimRootGeom::WCSimRootGeom()
   fWCNumPMT = 0;
   fPMTArray = 0;
   fPMTArray = new TClonesArray("WCSimRootPMT", 500);
+  fPMTCache = new WCSimRootPMTCache();
 
 }
 
@@ -29,6 +46,7 @@ WCSimRootGeom::~WCSimRootGeom()
 {
   fPMTArray->Delete();
   delete fPMTArray;
+  delete fPMTCache;
 }
 
 //______________________________________________________________________________
@@ -76,6 +94,7 @@ void WCSimRootGeom::SetPMT(Int_t i, Int_t tubeno, Int_t cyl_loc,
 			    Float_t rot[3], Float_t pos[3], bool expand)
 {
   if(expand) (*(fPMTArray)).ExpandCreate(i+2);
+  InvalidatePMTCache();
   
   // Set PMT values
   TClonesArray &pmtArray = *fPMTArray;
@@ -96,6 +115,7 @@ void WCSimRootGeom::SetPMT(Int_t i, Int_t tubeno, Int_t mPMTNo, Int_t mPMT_PMTNo
 			    Float_t rot[3], Float_t pos[3], bool expand)
 {
   if(expand) (*(fPMTArray)).ExpandCreate(i+2);
+  InvalidatePMTCache();
   
   // Set PMT values
   TClonesArray &pmtArray = *fPMTArray;
@@ -111,6 +131,134 @@ void WCSimRootGeom::SetPMT(Int_t i, Int_t tubeno, Int_t mPMTNo, Int_t mPMT_PMTNo
 
 }
 
+//______________________________________________________________________________
+Bool_t WCSimRootGeom::ReadGeometryTable(const char * filename)
+{
+  WCSimGeometryTable table;
+  if(!table.Open(filename))
+    return false;
+
+  fgeo_type    = table.GetGeoType();
+  fWCCylRadius = table.GetCylRadius();
+  fWCCylLength = table.GetCylLength();
+  fWCPMTRadius = table.GetPMTRadius();
+  fOrientation = table.GetOrientation();
+  SetWCOffset(table.GetOffset(0), table.GetOffset(1), table.GetOffset(2));
+
+  const Int_t npmt = table.GetNumPMT();
+  const int32_t * tube   = table.GetTubeID();
+  const int32_t * mpmt   = table.GetmPMTID();
+  const int32_t * mpmt_pmt = table.GetmPMT_PMTID();
+  const int32_t * cylloc = table.GetCylLocation();
+  const double * x  = table.GetPositionX();
+  const double * y  = table.GetPositionY();
+  const double * z  = table.GetPositionZ();
+  const double * dx = table.GetDirectionX();
+  const double * dy = table.GetDirectionY();
+  const double * dz = table.GetDirectionZ();
+
+  // Size the array once, rather than per PMT
+  fPMTArray->Clear();
+  fPMTArray->ExpandCreate(npmt);
+  Float_t pos[3], rot[3];
+  for(Int_t i = 0; i < npmt; i++) {
+    pos[0] = x[i];  pos[1] = y[i];  pos[2] = z[i];
+    rot[0] = dx[i]; rot[1] = dy[i]; rot[2] = dz[i];
+    SetPMT(i, tube[i], mpmt[i], mpmt_pmt[i], cylloc[i], rot, pos, false);
+  }
+  fWCNumPMT = npmt;
+  InvalidatePMTCache();
+  return true;
+}
+
+//______________________________________________________________________________
+void WCSimRootGeom::InvalidatePMTCache()
+{
+  fPMTCache->valid.store(false, std::memory_order_release);
+}
+
+//______________________________________________________________________________
+const WCSimRootPMTCache & WCSimRootGeom::GetPMTCache() const
+{
+  WCSimRootPMTCache & cache = *fPMTCache;
+  if(cache.valid.load(std::memory_order_acquire))
+    return cache;
+  std::lock_guard<std::mutex> lock(cache.mutex);
+  if(cache.valid.load(std::memory_order_relaxed))
+    return cache; // built by another thread in the meantime
+
+  // Copy the PMT positions & directions into contiguous arrays,
+  // and index the PMTs by tube ID and by (mPMT, mPMT_PMT)
+  const Int_t npmt = TMath::Min(fWCNumPMT, fPMTArray->GetEntriesFast());
+  cache.x.resize(npmt);  cache.y.resize(npmt);  cache.z.resize(npmt);
+  cache.dx.resize(npmt); cache.dy.resize(npmt); cache.dz.resize(npmt);
+
+  Int_t maxtube = 0, maxmpmt = 0, maxmpmt_pmt = 0;
+  for(Int_t i = 0; i < npmt; i++) {
+    const WCSimRootPMT & pmt = GetPMTRef(i);
+    cache.x[i]  = pmt.GetPosition(0);
+    cache.y[i]  = pmt.GetPosition(1);
+    cache.z[i]  = pmt.GetPosition(2);
+    cache.dx[i] = pmt.GetOrientation(0);
+    cache.dy[i] = pmt.GetOrientation(1);
+    cache.dz[i] = pmt.GetOrientation(2);
+    maxtube     = TMath::Max(maxtube,     pmt.GetTubeNo());
+    maxmpmt     = TMath::Max(maxmpmt,     pmt.GetmPMTNo());
+    maxmpmt_pmt = TMath::Max(maxmpmt_pmt, pmt.GetmPMT_PMTNo());
+  }
+
+  // IDs are dense (tubes from 1, mPMTs from 1, PMTs in an mPMT from 1 or 0 for single PMTs),
+  // so flat tables are both smaller and faster than maps
+  cache.mPMT_PMTStride = maxmpmt_pmt + 1;
+  cache.indexByTube.assign(maxtube + 1, -1);
+  cache.indexBymPMT.assign((maxmpmt + 1) * cache.mPMT_PMTStride, -1);
+  for(Int_t i = 0; i < npmt; i++) {
+    const WCSimRootPMT & pmt = GetPMTRef(i);
+    if(pmt.GetTubeNo() >= 0)
+      cache.indexByTube[pmt.GetTubeNo()] = i;
+    if(pmt.GetmPMTNo() >= 0 && pmt.GetmPMT_PMTNo() >= 0)
+      cache.indexBymPMT[pmt.GetmPMTNo() * cache.mPMT_PMTStride + pmt.GetmPMT_PMTNo()] = i;
+  }
+  cache.valid.store(true, std::memory_order_release);
+  return cache;
+}
+
+//______________________________________________________________________________
+const std::vector<Float_t> & WCSimRootGeom::GetPMTx()  const { return GetPMTCache().x; }
+const std::vector<Float_t> & WCSimRootGeom::GetPMTy()  const { return GetPMTCache().y; }
+const std::vector<Float_t> & WCSimRootGeom::GetPMTz()  const { return GetPMTCache().z; }
+const std::vector<Float_t> & WCSimRootGeom::GetPMTdx() const { return GetPMTCache().dx; }
+const std::vector<Float_t> & WCSimRootGeom::GetPMTdy() const { return GetPMTCache().dy; }
+const std::vector<Float_t> & WCSimRootGeom::GetPMTdz() const { return GetPMTCache().dz; }
+
+//______________________________________________________________________________
+Int_t WCSimRootGeom::GetPMTIndexFromTubeNo(Int_t tubeNo) const
+{
+  const WCSimRootPMTCache & cache = GetPMTCache();
+  if(tubeNo < 0 || tubeNo >= (Int_t)cache.indexByTube.size())
+    return -1;
+  return cache.indexByTube[tubeNo];
+}
+
+//______________________________________________________________________________
+Int_t WCSimRootGeom::GetPMTIndexFrommPMT(Int_t mPMTNo, Int_t mPMT_PMTNo) const
+{
+  const WCSimRootPMTCache & cache = GetPMTCache();
+  if(mPMTNo < 0 || mPMT_PMTNo < 0 || mPMT_PMTNo >= cache.mPMT_PMTStride)
+    return -1;
+  const size_t index = (size_t)mPMTNo * cache.mPMT_PMTStride + mPMT_PMTNo;
+  if(index >= cache.indexBymPMT.size())
+    return -1;
+  return cache.indexBymPMT[index];
+}
+
+//______________________________________________________________________________
+Int_t WCSimRootGeom::GetTubeNo(Int_t mPMTNo, Int_t mPMT_PMTNo) const
+{
+  const Int_t i = GetPMTIndexFrommPMT(mPMTNo, mPMT_PMTNo);
+  return (i < 0) ? -1 : GetPMTRef(i).GetTubeNo();
+}
+
 //______________________________________________________________________________
 WCSimRootPMT::~WCSimRootPMT()
 {
@@ -16,7 +16,39 @@ using std::cout;
 WCSimRootOptions::WCSimRootOptions()
 {
   // Create a WCSimRootOptions object.
+  // The options added to the class are not in the files written before:
+  // they are read with these defaults, i.e. the behaviour before they existed
 
+  // no pile-up overlay
+  OverlayWindowLow = 0;
+  OverlayWindowHigh = 0;
+  // no waveform digitizer
+  WaveformSampleWidth = 0;
+  WaveformNPhases = 0;
+  WaveformThreshold = 0;
+  WaveformNoise = 0;
+  // none of the localnhits, tofscan & continuous triggers
+  LocalNHitsThreshold = 0;
+  LocalNHitsWindow = 0;
+  LocalNHitsNeighbourRadius = 0;
+  LocalNHitsPreTriggerWindow = 0;
+  LocalNHitsPostTriggerWindow = 0;
+  TOFScanThreshold = 0;
+  TOFScanWindow = 0;
+  TOFScanGridSpacing = 0;
+  TOFScanPreTriggerWindow = 0;
+  TOFScanPostTriggerWindow = 0;
+  TimeSliceLength = 0;
+  // unweighted photons, all tracked
+  PhotonWeight = 1;
+  PhotonBudget = 0;
+  FastOpticsConeSamples = 0;
+  // all the photon truth & tracks saved
+  SaveHitTimes = true;
+  SavePhotonStartTime = true;
+  SavePhotonStartPos = true;
+  SavePhotonEndPos = true;
+  SaveTracks = true;
 }
 
 //______________________________________________________________________________
@@ -40,12 +72,30 @@ void WCSimRootOptions::Print(Option_t *) const
     << "\tDarkLow: " << DarkLow << " ns" << endl
     << "\tDarkWindow: " << DarkWindow << " ns" << endl
     << "\tDarkMode: " << DarkMode << endl
+    << "Overlay options:" << endl;
+  for(size_t i = 0; i < OverlayFiles.size(); i++) {
+    cout << "\tOverlay source " << i << ": " << OverlayFiles[i];
+    if(OverlayRates[i] > 0)
+      cout << " at " << OverlayRates[i] << " kHz" << endl;
+    else
+      cout << " at " << OverlayOffsets[i] << " ns" << endl;
+  }
+  cout
+    << "\tOverlayWindowLow: " << OverlayWindowLow << " ns" << endl
+    << "\tOverlayWindowHigh: " << OverlayWindowHigh << " ns" << endl
     << "Digitizer options:" << endl
     << "\tDigitizerClassName: " << DigitizerClassName << endl
     << "\tDigitizerDeadTime: " << DigitizerDeadTime << " ns" << endl
     << "\tDigitizerIntegrationWindow: " << DigitizerIntegrationWindow << " ns" << endl
     << "\tDigitizerTimingPrecision: " << DigitizerTimingPrecision << " ns" << endl
-    << "\tDigitizerPEPrecision: " << DigitizerPEPrecision << " ns" << endl
+    << "\tDigitizerPEPrecision: " << DigitizerPEPrecision << " ns" << endl;
+  if(DigitizerClassName == "Waveform")
+    cout
+      << "\tWaveformSampleWidth: " << WaveformSampleWidth << " ns" << endl
+      << "\tWaveformNPhases: " << WaveformNPhases << endl
+      << "\tWaveformThreshold: " << WaveformThreshold << " single p.e. pulse heights" << endl
+      << "\tWaveformNoise: " << WaveformNoise << " single p.e. pulse heights" << endl;
+  cout
     << "Trigger options:" << endl
     << "\tTriggerClassName: " << TriggerClassName << endl
     << "\tMultiDigitsPerTrigger: " << MultiDigitsPerTrigger << endl
@@ -56,6 +106,20 @@ void WCSimRootOptions::Print(Option_t *) const
     << "\tNDigitsAdjustForNoise: " << NDigitsAdjustForNoise << endl
     << "\tNDigitsPreTriggerWindow: " << NDigitsPreTriggerWindow << " ns" << endl
     << "\tNDigitsPostTriggerWindow: " << NDigitsPostTriggerWindow << " ns" << endl
+    << "LocalNHits trigger options:" << endl
+    << "\tLocalNHitsThreshold: " << LocalNHitsThreshold << " hit PMTs" << endl
+    << "\tLocalNHitsWindow: " << LocalNHitsWindow << " ns" << endl
+    << "\tLocalNHitsNeighbourRadius: " << LocalNHitsNeighbourRadius << " cm" << endl
+    << "\tLocalNHitsPreTriggerWindow: " << LocalNHitsPreTriggerWindow << " ns" << endl
+    << "\tLocalNHitsPostTriggerWindow: " << LocalNHitsPostTriggerWindow << " ns" << endl
+    << "TOFScan trigger options:" << endl
+    << "\tTOFScanThreshold: " << TOFScanThreshold << " digitized hits" << endl
+    << "\tTOFScanWindow: " << TOFScanWindow << " ns" << endl
+    << "\tTOFScanGridSpacing: " << TOFScanGridSpacing << " cm" << endl
+    << "\tTOFScanPreTriggerWindow: " << TOFScanPreTriggerWindow << " ns" << endl
+    << "\tTOFScanPostTriggerWindow: " << TOFScanPostTriggerWindow << " ns" << endl
+    << "Continuous readout options:" << endl
+    << "\tTimeSliceLength: " << TimeSliceLength << " ns" << endl
     << "Save failures trigger options:" << endl
     << "\tSaveFailuresMode: " << SaveFailuresMode << endl
     << "\tSaveFailuresTime: " << SaveFailuresTime << " ns" << endl
@@ -71,11 +135,23 @@ void WCSimRootOptions::Print(Option_t *) const
     << "\tTopveto: " << Topveto << endl
     << "Physics List Factory:" << endl
     << "\tPhysicsListName: " << PhysicsListName << endl
+    << "WCSimOpticalPhysics" << endl
+    << "\tPhotonWeight: " << PhotonWeight << endl
+    << "\tPhotonBudget: " << PhotonBudget << endl
+    << "WCSimFastOptics" << endl
+    << "\tFastOpticsTable: " << FastOpticsTable << endl
+    << "\tFastOpticsConeSamples: " << FastOpticsConeSamples << endl
     << "WCSimPrimaryGeneratorAction" << endl
     << "\tVectorFileName: " << VectorFileName << endl
     << "\tGeneratorType: " << GeneratorType << endl
     << "WCSimRandomParameters" << endl
     << "\tRandomSeed: " << RandomSeed << endl
     << "\tRandomGenerator: " << WCSimEnumerations::EnumAsString(RandomGenerator) << endl
+    << "WCSimRunAction" << endl
+    << "\tSaveHitTimes: " << SaveHitTimes << endl
+    << "\tSavePhotonStartTime: " << SavePhotonStartTime << endl
+    << "\tSavePhotonStartPos: " << SavePhotonStartPos << endl
+    << "\tSavePhotonEndPos: " << SavePhotonEndPos << endl
+    << "\tSaveTracks: " << SaveTracks << endl
     << endl;
 }
@@ -1,10 +1,15 @@
 #include "WCSimRunAction.hh"
 #include "WCSimRunActionMessenger.hh"
+#include "WCSimOpticalPhysics.hh"
 
 #include "G4Run.hh"
 #include "G4UImanager.hh"
 #include "G4VVisManager.hh"
 #include "G4ios.hh"
+#include "G4RunManager.hh"
+#include "G4EventManager.hh"
+#include "G4Event.hh"
+#include "Randomize.hh"
 
 #include "jhfNtuple.h"
 
@@ -21,6 +26,9 @@
 #include "WCSimPmtInfo.hh"
 
 #include <vector>
+#include <sstream>
+#include <fstream>
+#include <cstdio>
 
 int pawc_[500000];                // Declare the PAWC common
 struct ntupleStruct jhfNtuple;    // global, ToDo: why not use and set the class member?
@@ -33,6 +41,8 @@ WCSimRunAction::WCSimRunAction(WCSimDetectorConstruction* test, WCSimRandomParam
   // Messenger to allow IO options
   wcsimdetector = test;
   messenger = new WCSimRunActionMessenger(this);
+  fastOptics = new WCSimFastOptics(test);
+  opticalProfile = new WCSimOpticalProfile();
 
   useDefaultROOTout = true;  //false;  TF: ToDo, make this false WHEN flat ROOT has RooTracker trees and when FiTQun can read that in.
   wcsimrootoptions = new WCSimRootOptions();
@@ -40,11 +50,26 @@ WCSimRunAction::WCSimRunAction(WCSimDetectorConstruction* test, WCSimRandomParam
   // By default do not try and save Rootracker interaction information
   SetSaveRooTracker(0);
 
+  // By default save all the truth information
+  saveHitTimes = true;
+  savePhotonStartTime = true;
+  savePhotonStartPos = true;
+  savePhotonEndPos = true;
+  saveTracks = true;
+
+  // Photons saved to a photon library are also tracked
+  trackSavedPhotons = true;
+
+  // By default write a single pair of output files
+  chunkEvents = 0;
+  chunkMaxMB = 0;
+
 }
 
 WCSimRunAction::~WCSimRunAction()
 {
-
+  delete fastOptics;
+  delete opticalProfile;
 }
 
 void WCSimRunAction::BeginOfRunAction(const G4Run* /*aRun*/)
@@ -52,6 +77,30 @@ void WCSimRunAction::BeginOfRunAction(const G4Run* /*aRun*/)
 
   fSettingsOutputTree = NULL;
   fSettingsInputTree = NULL;
+  sliceTree = NULL;
+  if(!hitLibraryFileName.empty()) {
+    if(!hitLibrary.Create(hitLibraryFileName, WCSimHitLibrary::kPhotonHits)) {
+      G4cerr << "Could not create the hit library " << hitLibraryFileName << ". Exiting..." << G4endl;
+      exit(-1);
+    }
+    G4cout << "Saving the photon hits of every event to the hit library " << hitLibraryFileName << G4endl;
+  }
+  if(!rawSignalLibraryFileName.empty()) {
+    if(!rawSignalLibrary.Create(rawSignalLibraryFileName, WCSimHitLibrary::kRawSignal)) {
+      G4cerr << "Could not create the raw signal library " << rawSignalLibraryFileName << ". Exiting..." << G4endl;
+      exit(-1);
+    }
+    G4cout << "Saving the PMT signals of every event to the raw signal library " << rawSignalLibraryFileName << G4endl;
+  }
+  if(!photonLibraryFileName.empty()) {
+    if(!photonLibrary.Create(photonLibraryFileName)) {
+      G4cerr << "Could not create the photon library " << photonLibraryFileName << ". Exiting..." << G4endl;
+      exit(-1);
+    }
+    G4cout << "Saving the optical photons of every event to the photon library " << photonLibraryFileName << G4endl;
+  }
+  fastOptics->BeginOfRun();
+  opticalProfile->BeginOfRun();
   for(int i = 0; i < 3; ++i){
       WCXRotation[i] = 0;
       WCYRotation[i] = 0;
@@ -144,6 +193,7 @@ void WCSimRunAction::BeginOfRunAction(const G4Run* /*aRun*/)
     //set detector & random options
     wcsimdetector->SaveOptionsToOutput(wcsimrootoptions);
     wcsimrandomparameters->SaveOptionsToOutput(wcsimrootoptions);
+    SaveOptionsToOutput(wcsimrootoptions);
      
     //Setup rooTracker tree
     if(SaveRooTracker){
@@ -487,6 +537,14 @@ void WCSimRunAction::BeginOfRunAction(const G4Run* /*aRun*/)
 
   }
   
+
+  if(GetUseChunks()){
+    chunkBaseName = GetRootFileName();
+    if(chunkBaseName.size() > 5 && chunkBaseName.substr(chunkBaseName.size() - 5) == ".root")
+      chunkBaseName.erase(chunkBaseName.size() - 5);
+    chunks.clear();
+    StartChunk();
+  }
 }
 
 void WCSimRunAction::EndOfRunAction(const G4Run*)
@@ -501,25 +559,26 @@ void WCSimRunAction::EndOfRunAction(const G4Run*)
 
   //Write the options tree
   G4cout << "EndOfRunAction" << G4endl;
+
+  // With the time slices: in the default ROOT file if it's written, otherwise in the flat file
+  opticalProfile->EndOfRun(useDefaultROOTout ? WCSimTree->GetCurrentFile() : masterTree->GetCurrentFile());
   
   // Close the Root file at the end of the run
 
   TFile *file = masterTree->GetCurrentFile();
   file->cd();
-  masterTree->AddFriend("Tracks");
+  AddFlatFriends();
   tracksTree->Write();
-  masterTree->AddFriend("CherenkovHits");
   cherenkovHitsTree->Write();
-  masterTree->AddFriend("CherenkovDigiHits");
   cherenkovDigiHitsTree->Write();
-  masterTree->AddFriend("Trigger");
   triggerTree->Write();
-  masterTree->AddFriend("EventInfo");
   eventInfoTree->Write();
   if(SaveRooTracker){
-    masterTree->AddFriend("RooTracker");
     flatRooTrackerTree->Write();
   }
+  if(sliceTree && !useDefaultROOTout){
+    sliceTree->Write(); // not a friend: one entry per time slice
+  }
   //  fSettingsOutputTree->Write(); // not a friend
   //}
 
@@ -546,6 +605,19 @@ void WCSimRunAction::EndOfRunAction(const G4Run*)
   }
 
 
+  if(hitLibrary.IsWriting() && !hitLibrary.Finish())
+    G4cerr << "Error finishing the hit library " << hitLibraryFileName << G4endl;
+  if(rawSignalLibrary.IsWriting() && !rawSignalLibrary.Finish())
+    G4cerr << "Error finishing the raw signal library " << rawSignalLibraryFileName << G4endl;
+  if(photonLibrary.IsWriting() && !photonLibrary.Finish())
+    G4cerr << "Error finishing the photon library " << photonLibraryFileName << G4endl;
+  fastOptics->EndOfRun();
+
+  if(GetUseChunks() && !chunks.empty()){
+    chunks.back().closed = true;
+    WriteManifest();
+  }
+
   if(useTimer) {
     timer.Stop();
     G4cout << "WCSimRunAction ran from BeginOfRunAction() to EndOfRunAction() in:"
@@ -556,55 +628,15 @@ void WCSimRunAction::EndOfRunAction(const G4Run*)
 
 void WCSimRunAction::FillGeoTree(){
 
-  // Fill the geometry tree
-  G4int geo_type;
-  G4double cylinfo[3];
-  G4double pmtradius;
-  G4int numpmt;
-  G4int orientation;
-  Float_t offset[3];
- 
-  Float_t rotation[3];
-
-  Int_t tubeNo;
-  Int_t mPMTNo = -1;
-  Int_t mPMT_pmtNo = -1;
-  Float_t pos[3];
-  Float_t rot[3];
-  Int_t cylLoc;
-
-  if (wcsimdetector->GetIsEggShapedHyperK()) {
-      geo_type = 2;
-  }
-  else {
-      geo_type = 0;
-  }
-  // geo_type 1 is for defunct mailbox design
-
-  wcsimrootgeom-> SetGeo_Type(geo_type);
+  // Fill the geometry tree from the binary table written by the detector construction
+  G4int numpmt = wcsimdetector->GetTotalNumPmts();
+  G4ThreeVector offset1= wcsimdetector->GetWCOffset();
 
-  if (geo_type == 0) {
-      //cylinder
-      cylinfo[1] = wcsimdetector->GetGeo_Dm(3);
-      cylinfo[2] = wcsimdetector->GetGeo_Dm(2);
-      wcsimrootgeom-> SetWCCylRadius(cylinfo[1]);
-      wcsimrootgeom-> SetWCCylLength(cylinfo[2]);
+  if(!wcsimrootgeom->ReadGeometryTable(wcsimdetector->GetGeometryTableFileName().c_str())) {
+    G4cerr << "Could not read the geometry table " << wcsimdetector->GetGeometryTableFileName() << ". Exiting..." << G4endl;
+    exit(-1);
   }
 
-
-  pmtradius = wcsimdetector->GetPMTSize1();
-  numpmt = wcsimdetector->GetTotalNumPmts();
-  orientation = 0;
-  
-  wcsimrootgeom-> SetWCPMTRadius(pmtradius);
-  wcsimrootgeom-> SetOrientation(orientation);
-  
-  G4ThreeVector offset1= wcsimdetector->GetWCOffset();
-  offset[0] = offset1[0];
-  offset[1] = offset1[1];
-  offset[2] = offset1[2];
-  wcsimrootgeom-> SetWCOffset(offset[0],offset[1],offset[2]);
-
   if(wcsimdetector->GetIsNuPrism()){ 
       G4ThreeVector rotation1= wcsimdetector->GetWCXRotation();
       WCXRotation[0] = rotation1[0];
@@ -638,28 +670,10 @@ void WCSimRunAction::FillGeoTree(){
       fSettingsOutputTree->Fill();
   }
 
-  std::vector<WCSimPmtInfo*> *fpmts = wcsimdetector->Get_Pmts();
-  WCSimPmtInfo *pmt;
-  for (unsigned int i=0;i!=fpmts->size();i++){
-    pmt = ((WCSimPmtInfo*)fpmts->at(i));
-    pos[0] = pmt->Get_transx();
-    pos[1] = pmt->Get_transy();
-    pos[2] = pmt->Get_transz();
-    rot[0] = pmt->Get_orienx();
-    rot[1] = pmt->Get_orieny();
-    rot[2] = pmt->Get_orienz();
-    tubeNo = pmt->Get_tubeid();
-    mPMTNo = pmt->Get_mPMTid();
-    mPMT_pmtNo = pmt->Get_mPMT_pmtid();
-    cylLoc = pmt->Get_cylocation();
-    wcsimrootgeom-> SetPMT(i,tubeNo,mPMTNo, mPMT_pmtNo, cylLoc,rot,pos);
+  if (wcsimrootgeom->GetWCNumPMT() != numpmt) {
+    G4cout << "Mismatch between number of pmts and pmt list in " << wcsimdetector->GetGeometryTableFileName() << "!!"<<G4endl;
+    G4cout << wcsimrootgeom->GetWCNumPMT() <<" vs. "<< numpmt <<G4endl;
   }
-  if (fpmts->size() != (unsigned int)numpmt) {
-    G4cout << "Mismatch between number of pmts and pmt list in geofile.txt!!"<<G4endl;
-    G4cout << fpmts->size() <<" vs. "<< numpmt <<G4endl;
-  }
-  
-  wcsimrootgeom-> SetWCNumPMT(numpmt);
   
   geoTree->Fill();
   TFile* hfile = geoTree->GetCurrentFile();
@@ -718,7 +732,7 @@ void WCSimRunAction::FillFlatGeoTree(){
   }
 
   if (fpmts->size() != (unsigned int)numPMT_id) {
-    G4cout << "Mismatch between number of pmts and pmt list in geofile.txt!!"<<G4endl;
+    G4cout << "Mismatch between number of pmts and pmt list in " << wcsimdetector->GetGeometryTableFileName() << "!!"<<G4endl;
     G4cout << fpmts->size() <<" vs. "<< numPMT_id <<G4endl;
   }
 
@@ -759,6 +773,169 @@ void WCSimRunAction::FillFlatGeoTree(){
   flatfile->Write(); 
 }
 
+void WCSimRunAction::AddFlatFriends()
+{
+  // Only once per tree; the friends follow the trees into each new chunk
+  if(masterTree->GetListOfFriends() && masterTree->GetListOfFriends()->GetSize())
+    return;
+  masterTree->AddFriend("Tracks");
+  masterTree->AddFriend("CherenkovHits");
+  masterTree->AddFriend("CherenkovDigiHits");
+  masterTree->AddFriend("Trigger");
+  masterTree->AddFriend("EventInfo");
+  if(SaveRooTracker)
+    masterTree->AddFriend("RooTracker");
+}
+
+void WCSimRunAction::StartChunk()
+{
+  OutputChunk chunk;
+  chunk.file = useDefaultROOTout ? WCSimTree->GetCurrentFile()->GetName() : "";
+  chunk.flatfile = masterTree->GetCurrentFile()->GetName();
+  std::stringstream rndmfile;
+  rndmfile << chunkBaseName << "_chunk" << chunks.size() << ".rndm";
+  chunk.rndmfile = rndmfile.str();
+  chunk.firstEvent = -1;
+  chunk.lastEvent = -1;
+  chunk.nEvents = 0;
+  chunk.closed = false;
+
+  // To redo this chunk: /random/resetEngineFrom <rndmfile>, then /run/beamOn <nEvents>
+  G4Random::saveEngineStatus(chunk.rndmfile.c_str());
+
+  chunks.push_back(chunk);
+  WriteManifest();
+}
+
+void WCSimRunAction::EndOfEventChunkCheck(G4int event_id)
+{
+  if(chunks.empty())
+    return;
+
+  OutputChunk & chunk = chunks.back();
+  if(!chunk.nEvents)
+    chunk.firstEvent = event_id;
+  chunk.lastEvent = event_id;
+  chunk.nEvents++;
+
+  // The last chunk is closed by EndOfRunAction
+  const G4Run * run = G4RunManager::GetRunManager()->GetCurrentRun();
+  if(run && event_id + 1 >= run->GetNumberOfEventToBeProcessed())
+    return;
+
+  bool full = chunkEvents > 0 && chunk.nEvents >= chunkEvents;
+  if(!full && chunkMaxMB > 0) {
+    Long64_t bytes = masterTree->GetCurrentFile()->GetEND();
+    if(useDefaultROOTout)
+      bytes += WCSimTree->GetCurrentFile()->GetEND();
+    full = bytes > chunkMaxMB * 1024 * 1024;
+  }
+  if(full)
+    RollOverChunk();
+}
+
+void WCSimRunAction::RollOverChunk()
+{
+  // TTree::ChangeFile() writes every tree in the current file, closes it,
+  // and moves the (now empty) trees to a new file <name>_<n>.root
+  // Geometry & options are written to every chunk, so that each one can be read on its own
+  if(useDefaultROOTout){
+    TFile* hfile = WCSimTree->GetCurrentFile();
+    hfile->cd();
+    optionsTree->Fill();
+    TFile* newfile = WCSimTree->ChangeFile(hfile);
+    newfile->cd();
+    geoTree->Fill();
+    geoTree->Write();
+  }
+
+  TFile* flatfile = masterTree->GetCurrentFile();
+  flatfile->cd();
+  AddFlatFriends();
+  TFile* newflatfile = cherenkovHitsTree->ChangeFile(flatfile);
+  newflatfile->cd();
+  geomTree->Fill();
+  geomTree->Write();
+
+  chunks.back().closed = true;
+  G4cout << "Closed output chunk " << chunks.size() - 1
+	 << " (events " << chunks.back().firstEvent << "-" << chunks.back().lastEvent << ")" << G4endl;
+  StartChunk();
+}
+
+void WCSimRunAction::WriteManifest()
+{
+  // Written to a temporary file then renamed, so readers never see a partial manifest
+  std::string manifest = chunkBaseName + "_manifest.txt";
+  std::string tmp = manifest + ".tmp";
+  std::ofstream out(tmp.c_str());
+  out << "# WCSim output chunks" << std::endl
+      << "# chunk status first_event last_event n_events file flat_file random_state_file" << std::endl;
+  for(size_t i = 0; i < chunks.size(); i++) {
+    const OutputChunk & chunk = chunks[i];
+    out << i
+	<< " " << (chunk.closed ? "closed" : "open")
+	<< " " << chunk.firstEvent
+	<< " " << chunk.lastEvent
+	<< " " << chunk.nEvents
+	<< " " << (chunk.file.empty() ? "-" : chunk.file)
+	<< " " << chunk.flatfile
+	<< " " << chunk.rndmfile << std::endl;
+  }
+  out.close();
+  if(!out || std::rename(tmp.c_str(), manifest.c_str()) != 0)
+    G4cerr << "Could not write the output chunk manifest " << manifest << G4endl;
+}
+
+void WCSimRunAction::CreateSliceTree()
+{
+  // Put in the default ROOT file if it's written, otherwise in the flat file.
+  // Made in the same directory as the other trees, so that TTree::ChangeFile() moves it too
+  TDirectory* previous = gDirectory;
+  TFile* file = useDefaultROOTout ? WCSimTree->GetCurrentFile() : masterTree->GetCurrentFile();
+  file->cd();
+  sliceTree = new TTree("wcsimSliceT","WCSim continuous readout time slices");
+  sliceTree->Branch("Run",&slice_run,"Run/I");
+  sliceTree->Branch("Event",&slice_event,"Event/I");
+  sliceTree->Branch("Slice",&slice_index,"Slice/I");
+  sliceTree->Branch("StartTime",&slice_start,"StartTime/D");
+  sliceTree->Branch("Length",&slice_length,"Length/D");
+  sliceTree->Branch("T",&slice_t);
+  sliceTree->Branch("Q",&slice_q);
+  sliceTree->Branch("Tube",&slice_tube);
+  previous->cd();
+}
+
+void WCSimRunAction::FillTimeSlice(G4int slice, G4double startTime, G4double length,
+				   const std::vector<float> & times, const std::vector<float> & charges, const std::vector<int> & tubes)
+{
+  if(!sliceTree)
+    CreateSliceTree();
+  slice_run    = G4RunManager::GetRunManager()->GetCurrentRun()->GetRunID();
+  slice_event  = G4EventManager::GetEventManager()->GetConstCurrentEvent()->GetEventID();
+  slice_index  = slice;
+  slice_start  = startTime;
+  slice_length = length;
+  slice_t    = times;
+  slice_q    = charges;
+  slice_tube = tubes;
+  // Baskets are written out as they fill, so only the current slice is held in memory
+  sliceTree->Fill();
+}
+
+void WCSimRunAction::SaveOptionsToOutput(WCSimRootOptions * wcopt)
+{
+  wcopt->SetSaveHitTimes(saveHitTimes);
+  wcopt->SetSavePhotonStartTime(GetSavePhotonStartTime());
+  wcopt->SetSavePhotonStartPos(GetSavePhotonStartPos());
+  wcopt->SetSavePhotonEndPos(GetSavePhotonEndPos());
+  wcopt->SetSaveTracks(saveTracks);
+  //set with /process/optical/, after WCSimPhysicsListFactory saves its options
+  wcopt->SetPhotonWeight(WCSimOpticalPhysics::GetPhotonWeight());
+  wcopt->SetPhotonBudget(WCSimOpticalPhysics::GetPhotonBudget());
+  fastOptics->SaveOptionsToOutput(wcopt);
+}
+
 NRooTrackerVtx* WCSimRunAction::GetRootrackerVertex(){
 
   NRooTrackerVtx* currRootrackerVtx = new((*fVertices)[fNVtx])NRooTrackerVtx();
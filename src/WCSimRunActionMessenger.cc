@@ -6,6 +6,8 @@
 #include "G4UIparameter.hh"
 #include "G4UIcmdWithAString.hh"
 #include "G4UIcmdWithABool.hh"
+#include "G4UIcmdWithAnInteger.hh"
+#include "G4UIcmdWithADouble.hh"
 
 WCSimRunActionMessenger::WCSimRunActionMessenger(WCSimRunAction* WCSimRA)
 :WCSimRun(WCSimRA)
@@ -35,6 +37,82 @@ WCSimRunActionMessenger::WCSimRunActionMessenger(WCSimRunAction* WCSimRA)
   UseTimer->SetGuidance("Use a timer for runtime");
   UseTimer->SetParameterName("UseTimer",true);
   UseTimer->SetDefaultValue(false);
+
+  SaveHitTimes = new G4UIcmdWithABool("/WCSimIO/SaveHitTimes",this);
+  SaveHitTimes->SetGuidance("Save the per-photon true hit information (WCSimRootCherenkovHitTime) in the ROOT file");
+  SaveHitTimes->SetGuidance("If false, only the per-tube Cherenkov hits are saved, and the photon start/end information is not recorded at all");
+  SaveHitTimes->SetParameterName("SaveHitTimes",true);
+  SaveHitTimes->SetDefaultValue(true);
+
+  SavePhotonStartTime = new G4UIcmdWithABool("/WCSimIO/SavePhotonStartTime",this);
+  SavePhotonStartTime->SetGuidance("Record the creation time of each photon that makes a hit");
+  SavePhotonStartTime->SetParameterName("SavePhotonStartTime",true);
+  SavePhotonStartTime->SetDefaultValue(true);
+
+  SavePhotonStartPos = new G4UIcmdWithABool("/WCSimIO/SavePhotonStartPos",this);
+  SavePhotonStartPos->SetGuidance("Record the creation position of each photon that makes a hit");
+  SavePhotonStartPos->SetParameterName("SavePhotonStartPos",true);
+  SavePhotonStartPos->SetDefaultValue(true);
+
+  SavePhotonEndPos = new G4UIcmdWithABool("/WCSimIO/SavePhotonEndPos",this);
+  SavePhotonEndPos->SetGuidance("Record the position on the PMT of each photon that makes a hit");
+  SavePhotonEndPos->SetParameterName("SavePhotonEndPos",true);
+  SavePhotonEndPos->SetDefaultValue(true);
+
+  SaveTracks = new G4UIcmdWithABool("/WCSimIO/SaveTracks",this);
+  SaveTracks->SetGuidance("Save the WCSimRootTrack of each saved trajectory in the ROOT file");
+  SaveTracks->SetGuidance("The beam and target tracks are always saved");
+  SaveTracks->SetParameterName("SaveTracks",true);
+  SaveTracks->SetDefaultValue(true);
+
+  ChunkEvents = new G4UIcmdWithAnInteger("/WCSimIO/ChunkEvents",this);
+  ChunkEvents->SetGuidance("Close the output files and start new ones (<name>_1.root, <name>_2.root, ...) every N events");
+  ChunkEvents->SetGuidance("The chunks are listed, with their event ranges & random engine states, in <name>_manifest.txt");
+  ChunkEvents->SetGuidance("0 (default) writes a single pair of output files");
+  ChunkEvents->SetParameterName("ChunkEvents",false);
+  ChunkEvents->SetRange("ChunkEvents>=0");
+  ChunkEvents->SetDefaultValue(0);
+
+  ChunkMaxSize = new G4UIcmdWithADouble("/WCSimIO/ChunkMaxSize",this);
+  ChunkMaxSize->SetGuidance("Close the output files and start new ones once they are larger than this many MB");
+  ChunkMaxSize->SetGuidance("Can be combined with /WCSimIO/ChunkEvents. 0 (default) disables it");
+  ChunkMaxSize->SetParameterName("ChunkMaxSize",false);
+  ChunkMaxSize->SetRange("ChunkMaxSize>=0");
+  ChunkMaxSize->SetDefaultValue(0);
+
+  SaveHitLibrary = new G4UIcmdWithAString("/WCSimIO/SaveHitLibrary",this);
+  SaveHitLibrary->SetGuidance("Also save the photon hits of every event to this hit library file, one entry per event");
+  SaveHitLibrary->SetGuidance("Libraries can be overlaid on other events with /DAQ/Overlay/");
+  SaveHitLibrary->SetGuidance("An empty name (default) saves no library");
+  SaveHitLibrary->SetParameterName("SaveHitLibrary",true);
+  SaveHitLibrary->SetDefaultValue("");
+
+  SaveRawSignalLibrary = new G4UIcmdWithAString("/WCSimIO/SaveRawSignalLibrary",this);
+  SaveRawSignalLibrary->SetGuidance("Also save the PMT signals of every event (after the PMT response, before dark noise) to this hit library file");
+  SaveRawSignalLibrary->SetGuidance("The library can be replayed through dark noise, digitizer & trigger without tracking any particles, with /mygen/generator replay");
+  SaveRawSignalLibrary->SetGuidance("An empty name (default) saves no library");
+  SaveRawSignalLibrary->SetParameterName("SaveRawSignalLibrary",true);
+  SaveRawSignalLibrary->SetDefaultValue("");
+
+  SavePhotons = new G4UIcmdWithAString("/WCSimIO/SavePhotons",this);
+  SavePhotons->SetGuidance("Also save the optical photons of every event (position, direction, polarisation, energy, time, weight & parent) to this photon library file");
+  SavePhotons->SetGuidance("Photons are saved as they are stacked, after the QE cut. Photons made during the optical transport (e.g. by WLS) are not saved");
+  SavePhotons->SetGuidance("Only the optical transport can then be rerun (e.g. with other /WCSim/tuning/ parameters) with /mygen/generator photonreplay");
+  SavePhotons->SetGuidance("An empty name (default) saves no library");
+  SavePhotons->SetParameterName("SavePhotons",true);
+  SavePhotons->SetDefaultValue("");
+
+  TrackSavedPhotons = new G4UIcmdWithABool("/WCSimIO/TrackSavedPhotons",this);
+  TrackSavedPhotons->SetGuidance("Whether the photons saved with /WCSimIO/SavePhotons are also tracked (default true)");
+  TrackSavedPhotons->SetGuidance("false only runs the charged particle stage, for photon libraries to be replayed later");
+  TrackSavedPhotons->SetParameterName("TrackSavedPhotons",true);
+  TrackSavedPhotons->SetDefaultValue(true);
+
+  OpticalProfile = new G4UIcmdWithABool("/WCSimIO/OpticalProfile",this);
+  OpticalProfile->SetGuidance("Count the optical photon steps, boundary interactions, kills & wall time by logical volume (default false)");
+  OpticalProfile->SetGuidance("They are written to the wcsimOpticalProfileT tree at the end of the run, one entry per logical volume");
+  OpticalProfile->SetParameterName("OpticalProfile",true);
+  OpticalProfile->SetDefaultValue(false);
 }
 
 WCSimRunActionMessenger::~WCSimRunActionMessenger()
@@ -43,6 +121,18 @@ WCSimRunActionMessenger::~WCSimRunActionMessenger()
   delete RootFile;
   delete RooTracker;
   delete UseTimer;
+  delete SaveHitTimes;
+  delete SavePhotonStartTime;
+  delete SavePhotonStartPos;
+  delete SavePhotonEndPos;
+  delete SaveTracks;
+  delete ChunkEvents;
+  delete ChunkMaxSize;
+  delete SaveHitLibrary;
+  delete SaveRawSignalLibrary;
+  delete SavePhotons;
+  delete TrackSavedPhotons;
+  delete OpticalProfile;
   delete WCSimIODir;
 }
 
@@ -72,5 +162,74 @@ void WCSimRunActionMessenger::SetNewValue(G4UIcommand* command,G4String newValue
       WCSimRun->SetUseTimer(use);
       G4cout << "WCSimRunAction timer " << (use ? "ENABLED" : "DISABLED") << G4endl;
     }
+  else if(command == SaveHitTimes)
+    {
+      bool save = SaveHitTimes->GetNewBoolValue(newValue);
+      WCSimRun->SetSaveHitTimes(save);
+      G4cout << "Saving of true hit times " << (save ? "ENABLED" : "DISABLED") << G4endl;
+    }
+  else if(command == SavePhotonStartTime)
+    {
+      bool save = SavePhotonStartTime->GetNewBoolValue(newValue);
+      WCSimRun->SetSavePhotonStartTime(save);
+      G4cout << "Saving of photon start times " << (save ? "ENABLED" : "DISABLED") << G4endl;
+    }
+  else if(command == SavePhotonStartPos)
+    {
+      bool save = SavePhotonStartPos->GetNewBoolValue(newValue);
+      WCSimRun->SetSavePhotonStartPos(save);
+      G4cout << "Saving of photon start positions " << (save ? "ENABLED" : "DISABLED") << G4endl;
+    }
+  else if(command == SavePhotonEndPos)
+    {
+      bool save = SavePhotonEndPos->GetNewBoolValue(newValue);
+      WCSimRun->SetSavePhotonEndPos(save);
+      G4cout << "Saving of photon end positions " << (save ? "ENABLED" : "DISABLED") << G4endl;
+    }
+  else if(command == SaveTracks)
+    {
+      bool save = SaveTracks->GetNewBoolValue(newValue);
+      WCSimRun->SetSaveTracks(save);
+      G4cout << "Saving of tracks " << (save ? "ENABLED" : "DISABLED") << G4endl;
+    }
+  else if(command == ChunkEvents)
+    {
+      int n = ChunkEvents->GetNewIntValue(newValue);
+      WCSimRun->SetChunkEvents(n);
+      G4cout << "Output files will be split every " << n << " events (0 = never)" << G4endl;
+    }
+  else if(command == ChunkMaxSize)
+    {
+      double mb = ChunkMaxSize->GetNewDoubleValue(newValue);
+      WCSimRun->SetChunkMaxMB(mb);
+      G4cout << "Output files will be split every " << mb << " MB (0 = never)" << G4endl;
+    }
+  else if(command == SaveHitLibrary)
+    {
+      WCSimRun->SetHitLibraryFileName(newValue);
+      G4cout << "Hit library file set to " << newValue << G4endl;
+    }
+  else if(command == SaveRawSignalLibrary)
+    {
+      WCSimRun->SetRawSignalLibraryFileName(newValue);
+      G4cout << "Raw signal library file set to " << newValue << G4endl;
+    }
+  else if(command == SavePhotons)
+    {
+      WCSimRun->SetPhotonLibraryFileName(newValue);
+      G4cout << "Photon library file set to " << newValue << G4endl;
+    }
+  else if(command == TrackSavedPhotons)
+    {
+      G4bool track = TrackSavedPhotons->GetNewBoolValue(newValue);
+      WCSimRun->SetTrackSavedPhotons(track);
+      G4cout << "Tracking of the photons saved to the photon library " << (track ? "ENABLED" : "DISABLED") << G4endl;
+    }
+  else if(command == OpticalProfile)
+    {
+      G4bool profile = OpticalProfile->GetNewBoolValue(newValue);
+      WCSimRun->SetOpticalProfile(profile);
+      G4cout << "Optical profiling " << (profile ? "ENABLED" : "DISABLED") << G4endl;
+    }
 }
 
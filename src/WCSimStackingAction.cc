@@ -1,5 +1,9 @@
 #include "WCSimStackingAction.hh"
 #include "WCSimDetectorConstruction.hh"
+#include "WCSimOpticalPhysics.hh"
+#include "WCSimRunAction.hh"
+#include "WCSimPrimaryGeneratorAction.hh"
+#include "WCSimTrackInformation.hh"
 
 #include "G4Track.hh"
 #include "G4TrackStatus.hh"
@@ -10,13 +14,18 @@
 #include "G4TransportationManager.hh"
 #include "G4ParticleDefinition.hh"
 #include "G4ParticleTypes.hh"
+#include "G4RunManager.hh"
+#include "G4EventManager.hh"
+#include "G4StackManager.hh"
 
 #include "G4PhysicalConstants.hh"
 #include "G4SystemOfUnits.hh"
 
+#include <algorithm>
+
 //class WCSimDetectorConstruction;
 
-WCSimStackingAction::WCSimStackingAction(WCSimDetectorConstruction* myDet):DetConstruct(myDet) {;}
+WCSimStackingAction::WCSimStackingAction(WCSimDetectorConstruction* myDet):DetConstruct(myDet),nWaitingPhotons(0),budgetWeight(1),thinning(false) {;}
 WCSimStackingAction::~WCSimStackingAction(){;}
 
 
@@ -27,10 +36,32 @@ G4ClassificationOfNewTrack WCSimStackingAction::ClassifyNewTrack
   G4ClassificationOfNewTrack classification    = fWaiting;
   G4ParticleDefinition*      particleType      = aTrack->GetDefinition();
   
+  // Photon budget: the waiting stack is being thinned (see below). Half of its
+  // optical photons are kept, with twice the weight, the other tracks stay
+  if( thinning ) {
+    if( particleType != G4OpticalPhoton::OpticalPhotonDefinition() )
+      return fWaiting;
+    if( G4UniformRand() < 0.5 )
+      return fKill;
+    const_cast<G4Track*>(aTrack)->SetWeight(aTrack->GetWeight() * 2);
+    nWaitingPhotons++;
+    return fWaiting;
+  }
 
   // Make sure it is an optical photon
   if( particleType == G4OpticalPhoton::OpticalPhotonDefinition() )
     {
+      // Fast optical simulation: the p.e. of the Cherenkov light are sampled from the photon table instead
+      if( aTrack->GetCreatorProcess() != NULL &&
+	  aTrack->GetCreatorProcess()->GetProcessName() == "Cerenkov" &&
+	  ((WCSimRunAction*)G4RunManager::GetRunManager()->GetUserRunAction())->GetFastOptics()->IsFast() )
+	return fKill;
+
+      // Replayed photons (/mygen/generator photonreplay) passed the QE cut, and were weighted, when they were saved
+      if( aTrack->GetParentID() == 0 &&
+	  ((WCSimPrimaryGeneratorAction*)G4RunManager::GetRunManager()->GetUserPrimaryGeneratorAction())->IsUsingPhotonReplayEvtGenerator() )
+	return classification;
+
       // TF: cleaned this up a little: no repetition of code.
       // also don't know why CreatorProcess() == NULL needs to have QE applied.
       // use QE method for ALL.
@@ -57,13 +88,66 @@ G4ClassificationOfNewTrack WCSimStackingAction::ClassifyNewTrack
 	  wavelengthQE = 1.1;
 	}
 	
-	if( G4UniformRand() > wavelengthQE )
+	// In weighted mode only 1 in photonWeight of the photons is tracked,
+	// and it stands for photonWeight photons (see WCSimWCSD::EndOfEvent).
+	// The QE of 1.1 above (keep every photon) is taken as 1, or 1.1 in
+	// photonWeight of the photons would be kept instead of 1 in photonWeight
+	G4double photonWeight = WCSimOpticalPhysics::GetPhotonWeight();
+
+	// Photon budget: the optical photons wait to be tracked until the
+	// charged particles of their stage are done. When photonBudget of them
+	// are waiting, they are thinned to half with twice the weight, as are
+	// the next photons of the event, so the stack never holds more
+	const G4int photonBudget = WCSimOpticalPhysics::GetPhotonBudget();
+	if( photonBudget > 0 && nWaitingPhotons >= photonBudget ) {
+	  if( budgetWeight == 1 && G4EventManager::GetEventManager()->GetVerboseLevel() > 0 )
+	    G4cout << "Photon budget of " << photonBudget << " photons reached: thinning the photons" << G4endl;
+	  budgetWeight *= 2;
+	  nWaitingPhotons = 0;
+	  thinning = true;
+	  stackManager->ReClassify();
+	  thinning = false;
+	}
+	photonWeight *= budgetWeight;
+
+	if( G4UniformRand() * photonWeight > std::min(wavelengthQE, 1.f) )
 	  classification = fKill;
+	else {
+	  if( photonWeight != 1 )
+	    const_cast<G4Track*>(aTrack)->SetWeight(aTrack->GetWeight() * photonWeight);
+
+	  // Save the photon, to replay its optical transport later (/WCSimIO/SavePhotons)
+	  WCSimRunAction* runAction = (WCSimRunAction*)G4RunManager::GetRunManager()->GetUserRunAction();
+	  WCSimPhotonLibrary* photonLibrary = runAction->GetPhotonLibrary();
+	  if( photonLibrary ) {
+	    WCSimTrackInformation* trackinfo = (WCSimTrackInformation*)aTrack->GetUserInformation();
+	    const G4ThreeVector & pos = aTrack->GetPosition();
+	    const G4ThreeVector & dir = aTrack->GetMomentumDirection();
+	    const G4ThreeVector & pol = aTrack->GetPolarization();
+	    WCSimPhotonLibraryPhoton photon;
+	    for(int i = 0; i < 3; i++) {
+	      photon.pos[i] = pos[i]/cm;
+	      photon.dir[i] = dir[i];
+	      photon.pol[i] = pol[i];
+	    }
+	    photon.energy   = aTrack->GetKineticEnergy()/eV;
+	    photon.time     = aTrack->GetGlobalTime()/ns;
+	    photon.weight   = aTrack->GetWeight();
+	    photon.parentID = trackinfo ? trackinfo->GetPrimaryParentID() : aTrack->GetTrackID();
+	    photonLibrary->AddPhoton(photon);
+	    if( !runAction->GetTrackSavedPhotons() )
+	      classification = fKill;
+	  }
+	}
       }
+
+      if( classification == fWaiting )
+	nWaitingPhotons++;
     }
   
   return classification;
 }
 
-void WCSimStackingAction::NewStage() {;}
-void WCSimStackingAction::PrepareNewEvent() {;}
+// The waiting tracks have just been moved to the urgent stack, to be tracked
+void WCSimStackingAction::NewStage() { nWaitingPhotons = 0; }
+void WCSimStackingAction::PrepareNewEvent() { nWaitingPhotons = 0; budgetWeight = 1; }
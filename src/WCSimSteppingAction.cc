@@ -2,6 +2,8 @@
 #include <stdio.h>
 
 #include "WCSimSteppingAction.hh"
+#include "WCSimRunAction.hh"
+#include "WCSimDetectorConstruction.hh"
 
 #include "G4Track.hh"
 #include "G4VProcess.hh"
@@ -12,13 +14,7 @@
 #include "G4PVReplica.hh"
 #include "G4SDManager.hh"
 #include "G4RunManager.hh"
-#include "G4OpBoundaryProcess.hh"
-
-G4int WCSimSteppingAction::n_photons_through_mPMTLV = 0;
-G4int WCSimSteppingAction::n_photons_through_acrylic = 0;
-G4int WCSimSteppingAction::n_photons_through_gel = 0;
-G4int WCSimSteppingAction::n_photons_on_blacksheet = 0;
-G4int WCSimSteppingAction::n_photons_on_smallPMT = 0;
+#include "WCSimOpBoundaryProcess.hh"
 
 
 void WCSimSteppingAction::UserSteppingAction(const G4Step* aStep)
@@ -26,6 +22,12 @@ void WCSimSteppingAction::UserSteppingAction(const G4Step* aStep)
     const G4Event *event = G4EventManager::GetEventManager()->GetConstCurrentEvent();
     if(event->IsAborted() || event->GetEventID() < 0)
       return;
+
+  // Fast optical simulation: the Cherenkov light of charged particles is sampled from the photon table
+  WCSimRunAction* runAction = (WCSimRunAction*)G4RunManager::GetRunManager()->GetUserRunAction();
+  WCSimFastOptics* fastOptics = runAction->GetFastOptics();
+  if(fastOptics->IsFast())
+    fastOptics->ProcessStep(aStep);
   //DISTORTION must be used ONLY if INNERTUBE or INNERTUBEBIG has been defined in BidoneDetectorConstruction.cc
   
   const G4Track* track       = aStep->GetTrack();
@@ -44,20 +46,16 @@ void WCSimSteppingAction::UserSteppingAction(const G4Step* aStep)
   G4StepPoint* thePostPoint = aStep->GetPostStepPoint();
   G4VPhysicalVolume* thePostPV = thePostPoint->GetPhysicalVolume();
 
-  //G4OpBoundaryProcessStatus boundaryStatus=Undefined;
-  //static G4ThreadLocal G4OpBoundaryProcess* boundary=NULL;  //doesn't work and needs #include tls.hh from Geant4.9.6 and beyond
-  G4OpBoundaryProcess* boundary=NULL;
-  
   //find the boundary process only once
   if(!boundary){
     G4ProcessManager* pm
-      = aStep->GetTrack()->GetDefinition()->GetProcessManager();
+      = G4OpticalPhoton::OpticalPhotonDefinition()->GetProcessManager();
     G4int nprocesses = pm->GetProcessListLength();
     G4ProcessVector* pv = pm->GetProcessList();
     G4int i;
     for( i=0;i<nprocesses;i++){
       if((*pv)[i]->GetProcessName()=="OpBoundary"){
-	boundary = (G4OpBoundaryProcess*)(*pv)[i];
+	boundary = dynamic_cast<WCSimOpBoundaryProcess*>((*pv)[i]);
 	break;
       }
     }
@@ -65,26 +63,6 @@ void WCSimSteppingAction::UserSteppingAction(const G4Step* aStep)
 
   G4ParticleDefinition *particleType = track->GetDefinition();
   if(particleType == G4OpticalPhoton::OpticalPhotonDefinition()){
-    if( (thePrePV->GetName().find("MultiPMT") != std::string::npos) &&
-	(thePostPV->GetName().find("vessel") != std::string::npos) )
-      n_photons_through_mPMTLV++;
-    
-    if( (thePostPV->GetName().find("container") != std::string::npos) &&
-	(thePrePV->GetName().find("vessel") != std::string::npos))
-      n_photons_through_acrylic++;
-    
-    if( (thePrePV->GetName().find("container") != std::string::npos) )
-      n_photons_through_gel++;
-
-    if( (thePrePV->GetName().find("container") != std::string::npos) &&
-	(thePostPV->GetName().find("inner") != std::string::npos) )
-      n_photons_on_blacksheet++;
-
-    if( (thePrePV->GetName().find("container") != std::string::npos) &&
-	(thePostPV->GetName().find("pmt") != std::string::npos) )
-      n_photons_on_smallPMT++;
-	
-
     /*
     if( (thePrePV->GetName().find("pmt") != std::string::npos)){
       std::cout << "Photon between " << thePrePV->GetName() <<
@@ -97,7 +75,7 @@ void WCSimSteppingAction::UserSteppingAction(const G4Step* aStep)
 
 
     if(track->GetTrackStatus() == fStopAndKill){
-      if(boundary->GetStatus() == NoRINDEX){
+      if(boundary && boundary->GetStatus() == NoRINDEX){
 	std::cout << "Optical photon is killed because of missing refractive index in either " << thePrePoint->GetMaterial()->GetName() << " or " << thePostPoint->GetMaterial()->GetName() << 
 	  " : could also be caused by Overlaps with volumes with logicalBoundaries." << std::endl;
 	
@@ -117,6 +95,14 @@ void WCSimSteppingAction::UserSteppingAction(const G4Step* aStep)
 	}	*/
       
     }
+    // Stop tracking the photons which can no longer make a hit
+    else if(thePostPV && detector->IsOpticalKillVolume(thePostPV->GetLogicalVolume())){
+      aStep->GetTrack()->SetTrackStatus(fStopAndKill);
+    }
+
+    WCSimOpticalProfile* profile = runAction->GetOpticalProfile();
+    if(profile->IsEnabled())
+      profile->Step(aStep, boundary ? boundary->GetStatus() : Undefined);
   }
 
 
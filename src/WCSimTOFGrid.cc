@@ -0,0 +1,191 @@
+#include "WCSimTOFGrid.hh"
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <thread>
+
+const float WCSimTOFGrid::kDefaultLightSpeed = 21.8; // cm/ns, i.e. c/n with a group index n ~ 1.375
+
+WCSimTOFGrid::WCSimTOFGrid()
+  : fNumPMT(0), fMaxTOF(0)
+{
+}
+
+namespace {
+  // Lattice filling the bounding box of the PMTs, centred in each direction:
+  // n[d] vertices from first[d] in direction d
+  void Lattice(size_t npmt, const double * x, const double * y, const double * z,
+	       double spacing, int n[3], double first[3])
+  {
+    const double * pos[3] = {x, y, z};
+    for(int d = 0; d < 3; d++) {
+      const double lo = *std::min_element(pos[d], pos[d] + npmt);
+      const double hi = *std::max_element(pos[d], pos[d] + npmt);
+      n[d] = (int)((hi - lo) / spacing) + 1;
+      first[d] = 0.5 * (lo + hi) - 0.5 * (n[d] - 1) * spacing;
+    }
+  }
+}
+
+size_t WCSimTOFGrid::GetNumVertices(size_t npmt, const double * x, const double * y, const double * z,
+				    double spacing)
+{
+  if(!npmt || spacing <= 0)
+    return 0;
+  int n[3];
+  double first[3];
+  Lattice(npmt, x, y, z, spacing, n, first);
+  return (size_t)n[0] * n[1] * n[2];
+}
+
+bool WCSimTOFGrid::Build(size_t npmt, const double * x, const double * y, const double * z,
+			 double spacing, double lightSpeed, size_t maxTableSize)
+{
+  fNumPMT = npmt;
+  fMaxTOF = 0;
+  fVertexX.clear();
+  fVertexY.clear();
+  fVertexZ.clear();
+  fTOF.clear();
+  fMinTOF.clear();
+  if(!npmt || spacing <= 0)
+    return true;
+
+  const size_t nvertices = GetNumVertices(npmt, x, y, z, spacing);
+  if(maxTableSize && (double)nvertices * npmt * sizeof(float) > maxTableSize) {
+    fNumPMT = 0;
+    return false;
+  }
+
+  int n[3];
+  double first[3];
+  Lattice(npmt, x, y, z, spacing, n, first);
+  fVertexX.reserve(nvertices);
+  fVertexY.reserve(nvertices);
+  fVertexZ.reserve(nvertices);
+  for(int ix = 0; ix < n[0]; ix++)
+    for(int iy = 0; iy < n[1]; iy++)
+      for(int iz = 0; iz < n[2]; iz++) {
+	fVertexX.push_back(first[0] + ix * spacing);
+	fVertexY.push_back(first[1] + iy * spacing);
+	fVertexZ.push_back(first[2] + iz * spacing);
+      }
+
+  fTOF.resize(nvertices * npmt);
+  fMinTOF.resize(nvertices);
+  const double invspeed = 1. / lightSpeed;
+  for(size_t v = 0; v < nvertices; v++) {
+    float * tof = &fTOF[v * npmt];
+    for(size_t p = 0; p < npmt; p++) {
+      const double dx = x[p] - fVertexX[v];
+      const double dy = y[p] - fVertexY[v];
+      const double dz = z[p] - fVertexZ[v];
+      tof[p] = std::sqrt(dx*dx + dy*dy + dz*dz) * invspeed;
+      fMaxTOF = std::max(fMaxTOF, tof[p]);
+    }
+    fMinTOF[v] = *std::min_element(tof, tof + npmt);
+  }
+  return true;
+}
+
+void WCSimTOFGrid::Scan(const float * times, const int * rows, size_t ndigits,
+			float window, int threshold, unsigned int nthreads,
+			std::vector<Candidate> & candidates) const
+{
+  candidates.clear();
+  const size_t nvertices = GetNumVertices();
+  if(!ndigits || !nvertices || window <= 0)
+    return;
+
+  // Corrected times are in [tmin, tmax]
+  const float tmin = *std::min_element(times, times + ndigits) - fMaxTOF;
+  const float tmax = *std::max_element(times, times + ndigits);
+  const float halfwindow = 0.5 * window;
+  const size_t nwindows = (size_t)((tmax - tmin) / halfwindow) + 2;
+
+  if(!nthreads)
+    nthreads = std::max(1u, std::thread::hardware_concurrency());
+  nthreads = std::min<size_t>(nthreads, nvertices);
+
+  std::vector< std::vector<int> > bestcount(nthreads), bestvertex(nthreads);
+  std::vector<std::thread> workers;
+  for(unsigned int t = 0; t < nthreads; t++) {
+    const size_t vfirst = nvertices * t / nthreads;
+    const size_t vlast  = nvertices * (t + 1) / nthreads;
+    if(t + 1 == nthreads)
+      ScanVertices(times, rows, ndigits, tmin, 1 / halfwindow, nwindows, vfirst, vlast,
+		   bestcount[t], bestvertex[t]);
+    else
+      workers.push_back(std::thread(&WCSimTOFGrid::ScanVertices, this, times, rows, ndigits,
+				    tmin, 1 / halfwindow, nwindows, vfirst, vlast,
+				    std::ref(bestcount[t]), std::ref(bestvertex[t])));
+  }
+  for(size_t t = 0; t < workers.size(); t++)
+    workers[t].join();
+
+  // Merge in vertex order, so ties go to the lowest vertex whatever the number of threads
+  std::vector<int> & count  = bestcount[0];
+  std::vector<int> & vertex = bestvertex[0];
+  for(unsigned int t = 1; t < nthreads; t++)
+    for(size_t k = 0; k < nwindows; k++)
+      if(bestcount[t][k] > count[k]) {
+	count[k]  = bestcount[t][k];
+	vertex[k] = bestvertex[t][k];
+      }
+
+  for(size_t k = 0; k < nwindows; k++) {
+    if(count[k] > threshold) {
+      Candidate c;
+      c.time   = tmin + k * halfwindow;
+      c.count  = count[k];
+      c.vertex = vertex[k];
+      candidates.push_back(c);
+    }
+  }
+}
+
+void WCSimTOFGrid::ScanVertices(const float * times, const int * rows, size_t ndigits,
+				float tmin, float invhalfwindow, size_t nwindows,
+				size_t vfirst, size_t vlast,
+				std::vector<int> & bestcount, std::vector<int> & bestvertex) const
+{
+  bestcount.assign(nwindows, 0);
+  bestvertex.assign(nwindows, -1);
+  // Window k is bins k and k+1
+  std::vector<int> hist(nwindows + 1, 0);
+  std::vector<int> bins(ndigits);
+  int * bin = &bins[0];
+
+  for(size_t v = vfirst; v < vlast; v++) {
+    const float * tof = &fTOF[v * fNumPMT];
+
+    // Branch-free, so the compiler can vectorise it (a gather from the TOF row)
+    for(size_t i = 0; i < ndigits; i++)
+      bin[i] = (int)((times[i] - tof[rows[i]] - tmin) * invhalfwindow);
+
+    for(size_t i = 0; i < ndigits; i++)
+      hist[bin[i]]++;
+
+    // Only the windows containing a digit can have changed
+    for(size_t i = 0; i < ndigits; i++) {
+      const int k = bin[i];
+      int c = hist[k] + hist[k + 1];
+      if(c > bestcount[k]) {
+	bestcount[k]  = c;
+	bestvertex[k] = v;
+      }
+      if(k) {
+	c = hist[k - 1] + hist[k];
+	if(c > bestcount[k - 1]) {
+	  bestcount[k - 1]  = c;
+	  bestvertex[k - 1] = v;
+	}
+      }
+    }
+
+    // Clear only the bins that were used, so the cost doesn't depend on the event length
+    for(size_t i = 0; i < ndigits; i++)
+      hist[bin[i]] = 0;
+  }
+}
@@ -9,6 +9,7 @@
 #include "WCSimTrackInformation.hh"
 #include "WCSimTrackingMessenger.hh"
 #include "WCSimPrimaryGeneratorAction.hh"
+#include "WCSimRunAction.hh"
 
 #include "G4PhysicalConstants.hh"
 #include "G4SystemOfUnits.hh"
@@ -64,6 +65,16 @@ void WCSimTrackingAction::PreUserTrackingAction(const G4Track* aTrack)
     fpTrackingManager->SetStoreTrajectory(false);
 	
     WCSimPrimaryGeneratorAction *primaryGenerator = (WCSimPrimaryGeneratorAction *) (G4RunManager::GetRunManager()->GetUserPrimaryGeneratorAction());
+
+    // Replayed photons: their hits go to the parent saved with them, and start where they were saved
+    if(aTrack->GetParentID() == 0 && primaryGenerator->IsUsingPhotonReplayEvtGenerator() && !aTrack->GetUserInformation()) {
+      const WCSimPhotonLibraryPhoton & saved = primaryGenerator->GetReplayPhoton(aTrack->GetTrackID());
+      WCSimTrackInformation* info = new WCSimTrackInformation();
+      info->SetPrimaryParentID(saved.parentID);
+      info->SetPhotonStartTime(aTrack->GetGlobalTime());
+      info->SetPhotonStartPos(aTrack->GetPosition());
+      ((G4Track*)aTrack)->SetUserInformation(info);
+    }
     if(!primaryGenerator->IsConversionFound()) {
       if(aTrack->GetParentID()==0){
           primaryID = aTrack->GetTrackID();
@@ -76,6 +87,13 @@ void WCSimTrackingAction::PreUserTrackingAction(const G4Track* aTrack)
           G4EventManager::GetEventManager()->GetNonconstCurrentEvent()->SetEventAborted();
       }
   }
+
+    // Optical profiling: the time of the first step starts now
+    if(aTrack->GetDefinition() == G4OpticalPhoton::OpticalPhotonDefinition()) {
+      WCSimOpticalProfile* profile = ((WCSimRunAction*)G4RunManager::GetRunManager()->GetUserRunAction())->GetOpticalProfile();
+      if(profile->IsEnabled())
+	profile->StartTrack();
+    }
 }
 
 void WCSimTrackingAction::PostUserTrackingAction(const G4Track* aTrack)
@@ -160,6 +178,11 @@ void WCSimTrackingAction::PostUserTrackingAction(const G4Track* aTrack)
   G4Track* theTrack = (G4Track*)aTrack;
   theTrack->SetUserInformation(anInfo);
 
+  // The p.e. sampled from the photon table for this track get its primary parent, as its photons would
+  WCSimFastOptics* fastOptics = ((WCSimRunAction*)G4RunManager::GetRunManager()->GetUserRunAction())->GetFastOptics();
+  if(fastOptics->IsFast())
+    fastOptics->EndOfTrack(aTrack->GetTrackID(), anInfo->GetPrimaryParentID());
+
   // pass primary parent ID to children
   G4TrackVector* secondaries = fpTrackingManager->GimmeSecondaries();
   if(secondaries)
@@ -10,13 +10,19 @@
 #include "G4RotationMatrix.hh"
 #include "G4ThreeVector.hh"
 #include "G4LogicalVolumeStore.hh"
+#include "G4RunManager.hh"
 
 #include "WCSimDetectorConstruction.hh"
 #include "WCSimPmtInfo.hh"
 #include "WCSimDarkRateMessenger.hh"
+#include "WCSimRunAction.hh"
+#include "WCSimDAQDarkNoise.hh"
+#include "WCSimDAQGeant4.hh"
 
 #include <vector>
 #include <utility>
+#include <algorithm>
+#include <cfloat>
 // for memset
 #include <cstring>
 
@@ -30,7 +36,7 @@
 
 WCSimWCAddDarkNoise::WCSimWCAddDarkNoise(G4String name,
 					 WCSimDetectorConstruction* inDetector)
-  :G4VDigitizerModule(name), fCalledAddDarkNoise(false), myDetector(inDetector)
+  :G4VDigitizerModule(name), fCalledAddDarkNoise(false), TimeLow(-DBL_MAX), TimeHigh(DBL_MAX), myDetector(inDetector)
 {
   //Set defaults to be unphysical, so that we know if they have been overwritten by the user
   PMTDarkRate = -99;
@@ -91,7 +97,10 @@ void WCSimWCAddDarkNoise::AddDarkNoise(){
     //loop over pairs which represent ranges.
     //Add noise to those ranges
     for(std::vector<std::pair<float, float> >::iterator it2 = result.begin(); it2 != result.end(); it2++) {
-      AddDarkNoiseBeforeDigi(WCHCPMT,it2->first,it2->second);
+      const double low  = std::max((double)it2->first,  TimeLow);
+      const double high = std::min((double)it2->second, TimeHigh);
+      if(low < high)
+	AddDarkNoiseBeforeDigi(WCHCPMT,low,high);
     }
   }
 }
@@ -137,32 +146,32 @@ void WCSimWCAddDarkNoise::AddDarkNoiseBeforeDigi(WCSimWCDigitsCollection* WCHCPM
       list[(*WCHCPMT)[h]->GetTubeID()] = h+1;
     }
    
-    // Add noise to PMT's here, do so in the range num1 to num2
-    double current_time = 0;
-    double pe = 0.0;
-    //Calculate the time window size
-    double windowsize = num2 - num1;
+    //The single p.e. charges are those of the ID PMT type (as WCSimWCPMT::rn1pe())
+    WCSimPMTObject * PMT = myDetector->GetPMTPointer(myDetector->GetIDCollectionName());
 
-    G4DigiManager* DMman = G4DigiManager::GetDMpointer();
-    WCSimWCPMT* WCPMT = (WCSimWCPMT*)DMman->FindDigitizerModule("WCReadoutPMT");
-   
-    //average number of PMTs with noise
-    double ave=number_pmts * this->PMTDarkRate * this->ConvRate * windowsize * 1E-6; 
+    //Only record the optional photon truth that will be saved (see /WCSimIO/)
+    WCSimRunAction* runAction = (WCSimRunAction*)G4RunManager::GetRunManager()->GetUserRunAction();
+    const bool savePhotonStartTime = runAction->GetSavePhotonStartTime();
+    const bool savePhotonStartPos  = runAction->GetSavePhotonStartPos();
+    const bool savePhotonEndPos    = runAction->GetSavePhotonEndPos();
 
-    //poisson distributed noise, number of noise hits to add
-    int nnoispmt = CLHEP::RandPoisson::shoot(ave);
+    // Generate the noise hits in the range num1 to num2 (done by the DAQ library)
+    WCSimDAQG4Random random;
+    WCSimDAQG4PMTResponse response(PMT);
+    std::vector<WCSimDAQDarkNoise::NoiseHit> noise;
+    WCSimDAQDarkNoise::Generate(number_pmts, this->PMTDarkRate, this->ConvRate, num1, num2, random, response, noise);
+    int nnoispmt = noise.size();
 #ifdef WCSIMWCADDDARKNOISE_VERBOSE
     G4cout << "WCSimWCAddDarkNoise::AddDarkNoiseBeforeDigi Going to add " << nnoispmt << " dark noise hits in time window [" << num1 << "," << num2 << "]" << G4endl;
 #endif
+    // Add them to the PMTs
+    double current_time = 0;
+    double pe = 0.0;
     for( int i = 0; i < nnoispmt; i++ )
       {
-	//time of noise hit to be generated
-	//A time from t=num1 to num2
-	current_time = num1 + G4UniformRand()*windowsize;
-
-	//now a random PMT.  Assuming noise levels are the same for
-	//each PMT.
-	int noise_pmt = static_cast<int>( G4UniformRand() * number_pmts ) + 1; //so that pmt numbers runs from 1 to Npmt
+	current_time = noise[i].time;
+	int noise_pmt = noise[i].tube;
+	pe = noise[i].charge;
       
 	if( list[ noise_pmt ] == 0 )
 	{
@@ -175,7 +184,7 @@ void WCSimWCAddDarkNoise::AddDarkNoiseBeforeDigi(WCSimWCDigitsCollection* WCHCPM
 	    //G4cout<<"1 "<<(G4LogicalVolumeStore::GetInstance()->GetVolume("glassFaceWCPMT"))->GetName()<<"\n";
 	    //G4cout<<"2 "<<(*WCHCPMT)[0]->GetLogicalVolume()->GetName()<<"\n";
 	    ahit->SetTrackID(-1);
-	    ahit->SetParentID(PMTindex[noise_pmt], -1);
+	    ahit->SetParentID(PMTindex[noise_pmt], -1); //-1 for dark noise (-2 for overlaid pile-up, see WCSimWCOverlay)
 	    // Set the position and rotation of the pmt
 	    Float_t hit_pos[3];
 	    Float_t hit_rot[3];
@@ -194,11 +203,13 @@ void WCSimWCAddDarkNoise::AddDarkNoiseBeforeDigi(WCSimWCDigitsCollection* WCHCPM
 	    ahit->SetOrientation(pmt_orientation);
 	    ahit->SetPos(pmt_position);
 	    ahit->SetTime(PMTindex[noise_pmt],current_time);
-	    ahit->SetPhotonStartTime(PMTindex[noise_pmt],current_time);
-	    ahit->SetPhotonStartPos(PMTindex[noise_pmt], pmt_position);
-	    ahit->SetPhotonEndPos(PMTindex[noise_pmt], pmt_position);
+	    if(savePhotonStartTime)
+	      ahit->SetPhotonStartTime(PMTindex[noise_pmt],current_time);
+	    if(savePhotonStartPos)
+	      ahit->SetPhotonStartPos(PMTindex[noise_pmt], pmt_position);
+	    if(savePhotonEndPos)
+	      ahit->SetPhotonEndPos(PMTindex[noise_pmt], pmt_position);
 	    ahit->SetPreSmearTime(PMTindex[noise_pmt],current_time); //presmear==postsmear for dark noise
-	    pe = WCPMT->rn1pe();
 	    ahit->SetPe(PMTindex[noise_pmt],pe);
 	    //Added this line to increase the totalPe by 1
 	    ahit->AddPe(current_time);
@@ -213,14 +224,16 @@ void WCSimWCAddDarkNoise::AddDarkNoiseBeforeDigi(WCSimWCDigitsCollection* WCHCPM
 	  }
 	else {
 	  (*WCHCPMT)[ list[noise_pmt]-1 ]->AddPe(current_time);
-	  pe = WCPMT->rn1pe();
 	  (*WCHCPMT)[ list[noise_pmt]-1 ]->SetPe(PMTindex[noise_pmt],pe);
 	  (*WCHCPMT)[ list[noise_pmt]-1 ]->SetTime(PMTindex[noise_pmt],current_time);
 	  (*WCHCPMT)[ list[noise_pmt]-1 ]->SetPreSmearTime(PMTindex[noise_pmt],current_time); //presmear==postsmear for dark noise
 	  (*WCHCPMT)[ list[noise_pmt]-1 ]->SetParentID(PMTindex[noise_pmt],-1);
-	  (*WCHCPMT)[ list[noise_pmt]-1 ]->SetPhotonStartTime(PMTindex[noise_pmt],current_time);
-	  (*WCHCPMT)[ list[noise_pmt]-1 ]->SetPhotonStartPos(PMTindex[noise_pmt],(*WCHCPMT)[ list[noise_pmt]-1 ]->GetPos());
-	  (*WCHCPMT)[ list[noise_pmt]-1 ]->SetPhotonEndPos(PMTindex[noise_pmt],(*WCHCPMT)[ list[noise_pmt]-1 ]->GetPos());
+	  if(savePhotonStartTime)
+	    (*WCHCPMT)[ list[noise_pmt]-1 ]->SetPhotonStartTime(PMTindex[noise_pmt],current_time);
+	  if(savePhotonStartPos)
+	    (*WCHCPMT)[ list[noise_pmt]-1 ]->SetPhotonStartPos(PMTindex[noise_pmt],(*WCHCPMT)[ list[noise_pmt]-1 ]->GetPos());
+	  if(savePhotonEndPos)
+	    (*WCHCPMT)[ list[noise_pmt]-1 ]->SetPhotonEndPos(PMTindex[noise_pmt],(*WCHCPMT)[ list[noise_pmt]-1 ]->GetPos());
 	  PMTindex[noise_pmt]++;
 #ifdef WCSIMWCADDDARKNOISE_VERBOSE
 	  if(noise_pmt < NPMTS_VERBOSE)
@@ -237,51 +250,15 @@ void WCSimWCAddDarkNoise::AddDarkNoiseBeforeDigi(WCSimWCDigitsCollection* WCHCPM
 
 
 void WCSimWCAddDarkNoise::FindDarkNoiseRanges(WCSimWCDigitsCollection* WCHCPMT, float width) {
-  //Loop over all Hits and assign a time window around each hit
-  //store these in the ranges vector as pairs
+  //Assign a time window around each hit, and merge the overlapping ones
+  // (done by the DAQ library, on the hit times)
+  std::vector<float> times;
   for (int g=0; g<WCHCPMT->entries(); g++){
     for (int gp=0; gp<(*WCHCPMT)[g]->GetTotalPe(); gp++){
-      float time = (*WCHCPMT)[g]->GetTime(gp);
-      //lets assume a 5us window.  So we centre this on the hit time.
-      //t1 is the lower limit of the window.
-      float t1=time - width/2.;
-      float t2=time + width/2.;
-      ranges.push_back(std::pair<float, float>(t1, t2));
-    }
-  }
-  
-  //we need to ensure that the ranges found above are sorted first
-  //for the algorithm below to work
-  sort(ranges.begin(),ranges.end());
-
-  //check if the vector range has any entries
-  //If no entries this indicates that no digits were
-  //found in the WCSimWCDigitsCollection, which can cause 
-  //segmentation faults in the next part of the code in this method
-  //which searches for overlapping ranges.
-  //Set range vector to have one element from 0 to 0 (so no noise digits will be added)
-  if(ranges.size() == 0)
-    {
-      //push back a range of 0 and 0 and return                                                                                                                              
-      result.push_back(std::make_pair(0.,0.));
-      return;
-    }
-
-  //the ranges vector contains overlapping ranges
-  //this loop removes overlaps
-  //output are pairs stored in the result vector
-  std::vector<std::pair<float, float> >::iterator it = ranges.begin();
-  std::pair<float, float> current = *(it)++;
-  for( ; it != ranges.end(); it++) {
-    if (current.second >= it->first){
-      current.second = std::max(current.second, it->second); 
-    }
-    else {
-      result.push_back(current);
-      current = *(it);
+      times.push_back((*WCHCPMT)[g]->GetTime(gp));
     }
   }
-  result.push_back(current);
+  WCSimDAQDarkNoise::FindRanges(times, width, result);
 
   //now we should have a vector of non-overlapping range pairs to pass to the
   //dark noise routine
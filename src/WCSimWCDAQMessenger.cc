@@ -25,10 +25,12 @@ WCSimWCDAQMessenger::WCSimWCDAQMessenger(WCSimEventAction* eventaction) :
   DigitizerChoice->SetGuidance("Set the Digitizer type");
   DigitizerChoice->SetGuidance("Available choices are:\n"
 			       "SKI\n"
+			       "Waveform\n"
 			       );
   DigitizerChoice->SetParameterName("Digitizer", false);
   DigitizerChoice->SetCandidates(
 				 "SKI "
+				 "Waveform "
 				 );
   DigitizerChoice->AvailableForStates(G4State_PreInit, G4State_Idle);
   DigitizerChoice->SetDefaultValue(defaultDigitizer);
@@ -38,15 +40,11 @@ WCSimWCDAQMessenger::WCSimWCDAQMessenger(WCSimEventAction* eventaction) :
   G4String defaultTrigger = "NDigits";
   TriggerChoice = new G4UIcmdWithAString("/DAQ/Trigger", this);
   TriggerChoice->SetGuidance("Set the Trigger type");
-  TriggerChoice->SetGuidance("Available choices are:\n"
-			     "NDigits\n"
-			     "NDigits2\n"
-			     );
+  //the choices are the trigger classes registered with WCSIM_REGISTER_TRIGGER
+  G4String triggerChoices = WCSimWCTriggerRegistry::Instance().GetChoices();
+  TriggerChoice->SetGuidance(("Available choices are:\n" + triggerChoices).c_str());
   TriggerChoice->SetParameterName("Trigger", false);
-  TriggerChoice->SetCandidates(
-			       "NDigits "
-			       "NDigits2 "
-			       );
+  TriggerChoice->SetCandidates(triggerChoices.c_str());
   TriggerChoice->AvailableForStates(G4State_PreInit, G4State_Idle);
   TriggerChoice->SetDefaultValue(defaultTrigger);
   StoreTriggerChoice = defaultTrigger;
@@ -61,6 +59,17 @@ WCSimWCDAQMessenger::WCSimWCDAQMessenger(WCSimEventAction* eventaction) :
   MultiDigitsPerTriggerSet = false; //this variable is bool & defaults are class specfic; use this to know if the default is overidden
   //don't SetNewValue -> defaults class-specific and taken from GetDefault*()
 
+  int defaultNThreads = 0;
+  NThreads = new G4UIcmdWithAnInteger("/DAQ/NThreads", this);
+  NThreads->SetGuidance("Number of threads for the per-PMT loops of the PMT response (charge smearing) & the digitizer");
+  NThreads->SetGuidance("0 (default): not threaded, random numbers from the Geant4 engine, as in previous versions");
+  NThreads->SetGuidance(">0: each PMT uses its own random number substream, seeded from the Geant4 engine once per event."
+			" The results do not depend on the number of threads");
+  NThreads->SetParameterName("NThreads",false);
+  NThreads->SetRange("NThreads>=0");
+  NThreads->SetDefaultValue(defaultNThreads);
+  SetNewValue(NThreads, G4UIcommand::ConvertToString(defaultNThreads));
+
 
   //Generic digitizer specific options
   DigitizerDir = new G4UIdirectory("/DAQ/DigitizerOpt/");
@@ -99,6 +108,43 @@ WCSimWCDAQMessenger::WCSimWCDAQMessenger(WCSimEventAction* eventaction) :
   //don't SetNewValue -> defaults class-specific and taken from GetDefault*()
 
 
+  //Waveform digitizer specific options
+  WaveformDigitizerDir = new G4UIdirectory("/DAQ/DigitizerWaveform/");
+  WaveformDigitizerDir->SetGuidance("Commands specific to the Waveform digitizer");
+
+  double defaultWaveformSampleWidth = -99;
+  WaveformSampleWidth = new G4UIcmdWithADouble("/DAQ/DigitizerWaveform/SampleWidth", this);
+  WaveformSampleWidth->SetGuidance("Set the sampling period of the waveforms (in ns)");
+  WaveformSampleWidth->SetParameterName("WaveformSampleWidth",false);
+  WaveformSampleWidth->SetDefaultValue(defaultWaveformSampleWidth);
+  StoreWaveformSampleWidth = defaultWaveformSampleWidth;
+  //don't SetNewValue -> defaults class-specific and taken from GetDefault*()
+
+  int defaultWaveformNPhases = -99;
+  WaveformNPhases = new G4UIcmdWithAnInteger("/DAQ/DigitizerWaveform/NPhases", this);
+  WaveformNPhases->SetGuidance("Set the number of sub-sample phases at which the single p.e. pulse templates are tabulated");
+  WaveformNPhases->SetParameterName("WaveformNPhases",false);
+  WaveformNPhases->SetDefaultValue(defaultWaveformNPhases);
+  StoreWaveformNPhases = defaultWaveformNPhases;
+  //don't SetNewValue -> defaults class-specific and taken from GetDefault*()
+
+  double defaultWaveformThreshold = -99;
+  WaveformThreshold = new G4UIcmdWithADouble("/DAQ/DigitizerWaveform/Threshold", this);
+  WaveformThreshold->SetGuidance("Set the discriminator threshold (as a fraction of the single p.e. pulse height)");
+  WaveformThreshold->SetParameterName("WaveformThreshold",false);
+  WaveformThreshold->SetDefaultValue(defaultWaveformThreshold);
+  StoreWaveformThreshold = defaultWaveformThreshold;
+  //don't SetNewValue -> defaults class-specific and taken from GetDefault*()
+
+  double defaultWaveformNoise = -99;
+  WaveformNoise = new G4UIcmdWithADouble("/DAQ/DigitizerWaveform/Noise", this);
+  WaveformNoise->SetGuidance("Set the RMS of the noise added to each sample (as a fraction of the single p.e. pulse height)");
+  WaveformNoise->SetParameterName("WaveformNoise",false);
+  WaveformNoise->SetDefaultValue(defaultWaveformNoise);
+  StoreWaveformNoise = defaultWaveformNoise;
+  //don't SetNewValue -> defaults class-specific and taken from GetDefault*()
+
+
   //Save failure trigger specific options
   SaveFailuresTriggerDir = new G4UIdirectory("/DAQ/TriggerSaveFailures/");
   SaveFailuresTriggerDir->SetGuidance("Commands specific to the Save Failures trigger");
@@ -188,6 +234,134 @@ WCSimWCDAQMessenger::WCSimWCDAQMessenger(WCSimEventAction* eventaction) :
   StoreNDigitsPostWindow = defaultNDigitsPostTriggerWindow;
   //don't SetNewValue -> defaults class-specific and taken from GetDefault*()
 
+
+  //LocalNHits trigger specifc options
+  LocalNHitsTriggerDir = new G4UIdirectory("/DAQ/TriggerLocalNHits/");
+  LocalNHitsTriggerDir->SetGuidance("Commands specific to the LocalNHits trigger");
+
+  int defaultLocalNHitsTriggerThreshold = -99;
+  LocalNHitsTriggerThreshold = new G4UIcmdWithAnInteger("/DAQ/TriggerLocalNHits/Threshold", this);
+  LocalNHitsTriggerThreshold->SetGuidance("Set the LocalNHits trigger threshold (number of hit PMTs in a neighbourhood)");
+  LocalNHitsTriggerThreshold->SetParameterName("LocalNHitsThreshold",false);
+  LocalNHitsTriggerThreshold->SetDefaultValue(defaultLocalNHitsTriggerThreshold);
+  StoreLocalNHitsThreshold = defaultLocalNHitsTriggerThreshold;
+  //don't SetNewValue -> defaults class-specific and taken from GetDefault*()
+
+  int defaultLocalNHitsTriggerWindow = -99;
+  LocalNHitsTriggerWindow = new G4UIcmdWithAnInteger("/DAQ/TriggerLocalNHits/Window", this);
+  LocalNHitsTriggerWindow->SetGuidance("Set the LocalNHits trigger window (in ns)");
+  LocalNHitsTriggerWindow->SetParameterName("LocalNHitsWindow",false);
+  LocalNHitsTriggerWindow->SetDefaultValue(defaultLocalNHitsTriggerWindow);
+  StoreLocalNHitsWindow = defaultLocalNHitsTriggerWindow;
+  //don't SetNewValue -> defaults class-specific and taken from GetDefault*()
+
+  double defaultLocalNHitsTriggerNeighbourRadius = -99;
+  LocalNHitsTriggerNeighbourRadius = new G4UIcmdWithADouble("/DAQ/TriggerLocalNHits/NeighbourRadius", this);
+  LocalNHitsTriggerNeighbourRadius->SetGuidance("Set the LocalNHits neighbourhood radius (in cm). 0: the neighbourhoods are the mPMTs; >0: the PMTs within this distance of each PMT");
+  LocalNHitsTriggerNeighbourRadius->SetParameterName("LocalNHitsNeighbourRadius",false);
+  LocalNHitsTriggerNeighbourRadius->SetDefaultValue(defaultLocalNHitsTriggerNeighbourRadius);
+  StoreLocalNHitsNeighbourRadius = defaultLocalNHitsTriggerNeighbourRadius;
+  //don't SetNewValue -> defaults class-specific and taken from GetDefault*()
+
+  int defaultLocalNHitsPreTriggerWindow = -99;
+  LocalNHitsPreTriggerWindow = new G4UIcmdWithAnInteger("/DAQ/TriggerLocalNHits/PreTriggerWindow", this);
+  LocalNHitsPreTriggerWindow->SetGuidance("Set the LocalNHits pretrigger window (in ns)");
+  LocalNHitsPreTriggerWindow->SetParameterName("LocalNHitsPreTriggerWindow",false);
+  LocalNHitsPreTriggerWindow->SetDefaultValue(defaultLocalNHitsPreTriggerWindow);
+  StoreLocalNHitsPreWindow = defaultLocalNHitsPreTriggerWindow;
+  //don't SetNewValue -> defaults class-specific and taken from GetDefault*()
+
+  int defaultLocalNHitsPostTriggerWindow = -99;
+  LocalNHitsPostTriggerWindow = new G4UIcmdWithAnInteger("/DAQ/TriggerLocalNHits/PostTriggerWindow", this);
+  LocalNHitsPostTriggerWindow->SetGuidance("Set the LocalNHits posttrigger window (in ns)");
+  LocalNHitsPostTriggerWindow->SetParameterName("LocalNHitsPostTriggerWindow",false);
+  LocalNHitsPostTriggerWindow->SetDefaultValue(defaultLocalNHitsPostTriggerWindow);
+  StoreLocalNHitsPostWindow = defaultLocalNHitsPostTriggerWindow;
+  //don't SetNewValue -> defaults class-specific and taken from GetDefault*()
+
+
+  //TOFScan trigger specifc options
+  TOFScanTriggerDir = new G4UIdirectory("/DAQ/TriggerTOFScan/");
+  TOFScanTriggerDir->SetGuidance("Commands specific to the TOFScan trigger");
+
+  int defaultTOFScanTriggerThreshold = -99;
+  TOFScanTriggerThreshold = new G4UIcmdWithAnInteger("/DAQ/TriggerTOFScan/Threshold", this);
+  TOFScanTriggerThreshold->SetGuidance("Set the TOFScan trigger threshold (number of digits in the TOF-corrected window)");
+  TOFScanTriggerThreshold->SetParameterName("TOFScanThreshold",false);
+  TOFScanTriggerThreshold->SetDefaultValue(defaultTOFScanTriggerThreshold);
+  StoreTOFScanThreshold = defaultTOFScanTriggerThreshold;
+  //don't SetNewValue -> defaults class-specific and taken from GetDefault*()
+
+  int defaultTOFScanTriggerWindow = -99;
+  TOFScanTriggerWindow = new G4UIcmdWithAnInteger("/DAQ/TriggerTOFScan/Window", this);
+  TOFScanTriggerWindow->SetGuidance("Set the TOFScan TOF-corrected trigger window (in ns)");
+  TOFScanTriggerWindow->SetParameterName("TOFScanWindow",false);
+  TOFScanTriggerWindow->SetDefaultValue(defaultTOFScanTriggerWindow);
+  StoreTOFScanWindow = defaultTOFScanTriggerWindow;
+  //don't SetNewValue -> defaults class-specific and taken from GetDefault*()
+
+  double defaultTOFScanTriggerGridSpacing = -99;
+  TOFScanTriggerGridSpacing = new G4UIcmdWithADouble("/DAQ/TriggerTOFScan/GridSpacing", this);
+  TOFScanTriggerGridSpacing->SetGuidance("Set the spacing of the TOFScan grid of candidate vertices (in cm)");
+  TOFScanTriggerGridSpacing->SetParameterName("TOFScanGridSpacing",false);
+  TOFScanTriggerGridSpacing->SetDefaultValue(defaultTOFScanTriggerGridSpacing);
+  StoreTOFScanGridSpacing = defaultTOFScanTriggerGridSpacing;
+
+  double defaultTOFScanTriggerMaxTableSize = -99;
+  TOFScanTriggerMaxTableSize = new G4UIcmdWithADouble("/DAQ/TriggerTOFScan/MaxTableSize", this);
+  TOFScanTriggerMaxTableSize->SetGuidance("Set the largest TOF table (in MB) the TOFScan trigger may allocate (default 1024, 0: no limit)");
+  TOFScanTriggerMaxTableSize->SetGuidance("The table takes 4 bytes x vertices x PMTs, i.e. grows as 1/GridSpacing^3. WCSim exits if it would be larger");
+  TOFScanTriggerMaxTableSize->SetParameterName("TOFScanMaxTableSize",false);
+  TOFScanTriggerMaxTableSize->SetDefaultValue(defaultTOFScanTriggerMaxTableSize);
+  StoreTOFScanMaxTableSize = defaultTOFScanTriggerMaxTableSize;
+  //don't SetNewValue -> defaults class-specific and taken from GetDefault*()
+
+  int defaultTOFScanTriggerNThreads = -99;
+  TOFScanTriggerNThreads = new G4UIcmdWithAnInteger("/DAQ/TriggerTOFScan/NThreads", this);
+  TOFScanTriggerNThreads->SetGuidance("Set the number of threads used by the TOFScan trigger (0: one per core)");
+  TOFScanTriggerNThreads->SetParameterName("TOFScanNThreads",false);
+  TOFScanTriggerNThreads->SetDefaultValue(defaultTOFScanTriggerNThreads);
+  StoreTOFScanNThreads = defaultTOFScanTriggerNThreads;
+  //don't SetNewValue -> defaults class-specific and taken from GetDefault*()
+
+  int defaultTOFScanPreTriggerWindow = -99;
+  TOFScanPreTriggerWindow = new G4UIcmdWithAnInteger("/DAQ/TriggerTOFScan/PreTriggerWindow", this);
+  TOFScanPreTriggerWindow->SetGuidance("Set the TOFScan pretrigger window (in ns)");
+  TOFScanPreTriggerWindow->SetParameterName("TOFScanPreTriggerWindow",false);
+  TOFScanPreTriggerWindow->SetDefaultValue(defaultTOFScanPreTriggerWindow);
+  StoreTOFScanPreWindow = defaultTOFScanPreTriggerWindow;
+  //don't SetNewValue -> defaults class-specific and taken from GetDefault*()
+
+  int defaultTOFScanPostTriggerWindow = -99;
+  TOFScanPostTriggerWindow = new G4UIcmdWithAnInteger("/DAQ/TriggerTOFScan/PostTriggerWindow", this);
+  TOFScanPostTriggerWindow->SetGuidance("Set the TOFScan posttrigger window (in ns)");
+  TOFScanPostTriggerWindow->SetParameterName("TOFScanPostTriggerWindow",false);
+  TOFScanPostTriggerWindow->SetDefaultValue(defaultTOFScanPostTriggerWindow);
+  StoreTOFScanPostWindow = defaultTOFScanPostTriggerWindow;
+  //don't SetNewValue -> defaults class-specific and taken from GetDefault*()
+
+
+  //Continuous readout specific options
+  ContinuousTriggerDir = new G4UIdirectory("/DAQ/TriggerContinuous/");
+  ContinuousTriggerDir->SetGuidance("Commands specific to the Continuous (triggerless) readout");
+
+  int defaultContinuousSliceLength = -99;
+  ContinuousSliceLength = new G4UIcmdWithAnInteger("/DAQ/TriggerContinuous/SliceLength", this);
+  ContinuousSliceLength->SetGuidance("Set the length of the continuous readout time slices (in ns)");
+  ContinuousSliceLength->SetParameterName("ContinuousSliceLength",false);
+  ContinuousSliceLength->SetDefaultValue(defaultContinuousSliceLength);
+  StoreContinuousSliceLength = defaultContinuousSliceLength;
+  //don't SetNewValue -> defaults class-specific and taken from GetDefault*()
+
+  int defaultContinuousSlicesPerChunk = -99;
+  ContinuousSlicesPerChunk = new G4UIcmdWithAnInteger("/DAQ/TriggerContinuous/SlicesPerChunk", this);
+  ContinuousSlicesPerChunk->SetGuidance("Set the number of continuous readout time slices digitized at once");
+  ContinuousSlicesPerChunk->SetGuidance(" Only the PMT signals & digits of one chunk of slices are in memory at a time");
+  ContinuousSlicesPerChunk->SetParameterName("ContinuousSlicesPerChunk",false);
+  ContinuousSlicesPerChunk->SetDefaultValue(defaultContinuousSlicesPerChunk);
+  StoreContinuousSlicesPerChunk = defaultContinuousSlicesPerChunk;
+  //don't SetNewValue -> defaults class-specific and taken from GetDefault*()
+
   initialiseString = "";
   initialised = true;
 }
@@ -206,6 +380,26 @@ WCSimWCDAQMessenger::~WCSimWCDAQMessenger()
   delete NDigitsTriggerAdjustForNoise;
   delete NDigitsPreTriggerWindow;
   delete NDigitsPostTriggerWindow;
+
+  delete LocalNHitsTriggerDir;
+  delete LocalNHitsTriggerThreshold;
+  delete LocalNHitsTriggerWindow;
+  delete LocalNHitsTriggerNeighbourRadius;
+  delete LocalNHitsPreTriggerWindow;
+  delete LocalNHitsPostTriggerWindow;
+
+  delete TOFScanTriggerDir;
+  delete TOFScanTriggerThreshold;
+  delete TOFScanTriggerWindow;
+  delete TOFScanTriggerGridSpacing;
+  delete TOFScanTriggerMaxTableSize;
+  delete TOFScanTriggerNThreads;
+  delete TOFScanPreTriggerWindow;
+  delete TOFScanPostTriggerWindow;
+
+  delete ContinuousTriggerDir;
+  delete ContinuousSliceLength;
+  delete ContinuousSlicesPerChunk;
   
   delete TriggerOffset;
 
@@ -215,9 +409,16 @@ WCSimWCDAQMessenger::~WCSimWCDAQMessenger()
   delete DigitizerTimingPrecision;
   delete DigitizerPEPrecision;
 
+  delete WaveformDigitizerDir;
+  delete WaveformSampleWidth;
+  delete WaveformNPhases;
+  delete WaveformThreshold;
+  delete WaveformNoise;
+
   delete DigitizerChoice;
   delete TriggerChoice;
   delete MultiDigitsPerTrigger;
+  delete NThreads;
   delete WCSimDAQDir;
 }
 
@@ -246,6 +447,12 @@ void WCSimWCDAQMessenger::SetNewValue(G4UIcommand* command,G4String newValue)
     if(initialised)
       MultiDigitsPerTriggerSet = true;
   }
+  else if (command == NThreads) {
+    G4int nthreads = NThreads->GetNewIntValue(newValue);
+    if(nthreads)
+      G4cout << "PMT response & digitizer will run on " << nthreads << " threads, with per-PMT random number substreams" << initialiseString.c_str() << G4endl;
+    WCSimEvent->SetDAQNThreads(nthreads);
+  }
 
   //Generic digitizer options
   else if (command == DigitizerDeadTime) {
@@ -265,6 +472,24 @@ void WCSimWCDAQMessenger::SetNewValue(G4UIcommand* command,G4String newValue)
     StoreDigitizerPEPrecision = DigitizerPEPrecision->GetNewDoubleValue(newValue);
   }
 
+  //Waveform digitizer options
+  else if (command == WaveformSampleWidth) {
+    G4cout << "Waveform digitizer sampling period set to " << newValue << " ns" << initialiseString.c_str() << G4endl;
+    StoreWaveformSampleWidth = WaveformSampleWidth->GetNewDoubleValue(newValue);
+  }
+  else if (command == WaveformNPhases) {
+    G4cout << "Waveform digitizer pulse template phases set to " << newValue << initialiseString.c_str() << G4endl;
+    StoreWaveformNPhases = WaveformNPhases->GetNewIntValue(newValue);
+  }
+  else if (command == WaveformThreshold) {
+    G4cout << "Waveform digitizer threshold set to " << newValue << " single p.e. pulse heights" << initialiseString.c_str() << G4endl;
+    StoreWaveformThreshold = WaveformThreshold->GetNewDoubleValue(newValue);
+  }
+  else if (command == WaveformNoise) {
+    G4cout << "Waveform digitizer noise set to " << newValue << " single p.e. pulse heights" << initialiseString.c_str() << G4endl;
+    StoreWaveformNoise = WaveformNoise->GetNewDoubleValue(newValue);
+  }
+
   //Save failures "trigger"
   else if (command == SaveFailuresTriggerMode) {
     StoreSaveFailuresMode = SaveFailuresTriggerMode->GetNewIntValue(newValue);
@@ -317,6 +542,68 @@ void WCSimWCDAQMessenger::SetNewValue(G4UIcommand* command,G4String newValue)
     StoreNDigitsPostWindow = NDigitsPostTriggerWindow->GetNewIntValue(newValue);
   }
 
+  //LocalNHits trigger
+  else if (command == LocalNHitsTriggerThreshold) {
+    G4cout << "LocalNHits trigger threshold set to " << newValue << initialiseString.c_str() << G4endl;
+    StoreLocalNHitsThreshold = LocalNHitsTriggerThreshold->GetNewIntValue(newValue);
+  }
+  else if (command == LocalNHitsTriggerWindow) {
+    G4cout << "LocalNHits trigger window set to " << newValue << " ns" << initialiseString.c_str() << G4endl;
+    StoreLocalNHitsWindow = LocalNHitsTriggerWindow->GetNewIntValue(newValue);
+  }
+  else if (command == LocalNHitsTriggerNeighbourRadius) {
+    G4cout << "LocalNHits neighbourhood radius set to " << newValue << " cm" << initialiseString.c_str() << G4endl;
+    StoreLocalNHitsNeighbourRadius = LocalNHitsTriggerNeighbourRadius->GetNewDoubleValue(newValue);
+  }
+  else if (command == LocalNHitsPreTriggerWindow) {
+    G4cout << "LocalNHits pretrigger window set to " << newValue << " ns" << initialiseString.c_str() << G4endl;
+    StoreLocalNHitsPreWindow = LocalNHitsPreTriggerWindow->GetNewIntValue(newValue);
+  }
+  else if (command == LocalNHitsPostTriggerWindow) {
+    G4cout << "LocalNHits posttrigger window set to " << newValue << " ns" << initialiseString.c_str() << G4endl;
+    StoreLocalNHitsPostWindow = LocalNHitsPostTriggerWindow->GetNewIntValue(newValue);
+  }
+
+  //TOFScan trigger
+  else if (command == TOFScanTriggerThreshold) {
+    G4cout << "TOFScan trigger threshold set to " << newValue << initialiseString.c_str() << G4endl;
+    StoreTOFScanThreshold = TOFScanTriggerThreshold->GetNewIntValue(newValue);
+  }
+  else if (command == TOFScanTriggerWindow) {
+    G4cout << "TOFScan trigger window set to " << newValue << " ns" << initialiseString.c_str() << G4endl;
+    StoreTOFScanWindow = TOFScanTriggerWindow->GetNewIntValue(newValue);
+  }
+  else if (command == TOFScanTriggerGridSpacing) {
+    G4cout << "TOFScan vertex grid spacing set to " << newValue << " cm" << initialiseString.c_str() << G4endl;
+    StoreTOFScanGridSpacing = TOFScanTriggerGridSpacing->GetNewDoubleValue(newValue);
+  }
+  else if (command == TOFScanTriggerMaxTableSize) {
+    G4cout << "TOFScan TOF table size limit set to " << newValue << " MB" << initialiseString.c_str() << G4endl;
+    StoreTOFScanMaxTableSize = TOFScanTriggerMaxTableSize->GetNewDoubleValue(newValue);
+  }
+  else if (command == TOFScanTriggerNThreads) {
+    G4cout << "TOFScan number of threads set to " << newValue << initialiseString.c_str() << G4endl;
+    StoreTOFScanNThreads = TOFScanTriggerNThreads->GetNewIntValue(newValue);
+  }
+  else if (command == TOFScanPreTriggerWindow) {
+    G4cout << "TOFScan pretrigger window set to " << newValue << " ns" << initialiseString.c_str() << G4endl;
+    StoreTOFScanPreWindow = TOFScanPreTriggerWindow->GetNewIntValue(newValue);
+  }
+  else if (command == TOFScanPostTriggerWindow) {
+    G4cout << "TOFScan posttrigger window set to " << newValue << " ns" << initialiseString.c_str() << G4endl;
+    StoreTOFScanPostWindow = TOFScanPostTriggerWindow->GetNewIntValue(newValue);
+  }
+
+  //Continuous readout
+  else if (command == ContinuousSliceLength) {
+    G4cout << "Continuous readout time slice length set to " << newValue << " ns" << initialiseString.c_str() << G4endl;
+    StoreContinuousSliceLength = ContinuousSliceLength->GetNewIntValue(newValue);
+  }
+  else if (command == ContinuousSlicesPerChunk) {
+    G4cout << "Continuous readout time slices per chunk set to " << newValue << initialiseString.c_str() << G4endl;
+    StoreContinuousSlicesPerChunk = ContinuousSlicesPerChunk->GetNewIntValue(newValue);
+  }
+
   else if (command == TriggerOffset) {
     G4cout << "trigger offset set to " << newValue << initialiseString.c_str() << G4endl;
     StoreTriggerOffset = TriggerOffset->GetNewDoubleValue(newValue);
@@ -374,6 +661,62 @@ void WCSimWCDAQMessenger::SetTriggerOptions()
     WCSimTrigger->SetNDigitsPostTriggerWindow(StoreNDigitsPostWindow);
     G4cout << "\tNDigits posttrigger window set to " << StoreNDigitsPostWindow << " ns" << G4endl;
   }
+  if(StoreLocalNHitsThreshold >= 0) {
+    WCSimTrigger->SetLocalNHitsThreshold(StoreLocalNHitsThreshold);
+    G4cout << "\tLocalNHits trigger threshold set to " << StoreLocalNHitsThreshold << G4endl;
+  }
+  if(StoreLocalNHitsWindow >= 0) {
+    WCSimTrigger->SetLocalNHitsWindow(StoreLocalNHitsWindow);
+    G4cout << "\tLocalNHits trigger window set to " << StoreLocalNHitsWindow << " ns" << G4endl;
+  }
+  if(StoreLocalNHitsNeighbourRadius >= 0) {
+    WCSimTrigger->SetLocalNHitsNeighbourRadius(StoreLocalNHitsNeighbourRadius);
+    G4cout << "\tLocalNHits neighbourhood radius set to " << StoreLocalNHitsNeighbourRadius << " cm" << G4endl;
+  }
+  if(StoreLocalNHitsPreWindow >= 0) {
+    WCSimTrigger->SetLocalNHitsPreTriggerWindow(StoreLocalNHitsPreWindow);
+    G4cout << "\tLocalNHits pretrigger window set to " << StoreLocalNHitsPreWindow << " ns" << G4endl;
+  }
+  if(StoreLocalNHitsPostWindow >= 0) {
+    WCSimTrigger->SetLocalNHitsPostTriggerWindow(StoreLocalNHitsPostWindow);
+    G4cout << "\tLocalNHits posttrigger window set to " << StoreLocalNHitsPostWindow << " ns" << G4endl;
+  }
+  if(StoreTOFScanThreshold >= 0) {
+    WCSimTrigger->SetTOFScanThreshold(StoreTOFScanThreshold);
+    G4cout << "\tTOFScan trigger threshold set to " << StoreTOFScanThreshold << G4endl;
+  }
+  if(StoreTOFScanWindow >= 0) {
+    WCSimTrigger->SetTOFScanWindow(StoreTOFScanWindow);
+    G4cout << "\tTOFScan trigger window set to " << StoreTOFScanWindow << " ns" << G4endl;
+  }
+  if(StoreTOFScanGridSpacing >= 0) {
+    WCSimTrigger->SetTOFScanGridSpacing(StoreTOFScanGridSpacing);
+    G4cout << "\tTOFScan vertex grid spacing set to " << StoreTOFScanGridSpacing << " cm" << G4endl;
+  }
+  if(StoreTOFScanMaxTableSize >= 0) {
+    WCSimTrigger->SetTOFScanMaxTableSize(StoreTOFScanMaxTableSize);
+    G4cout << "\tTOFScan TOF table size limit set to " << StoreTOFScanMaxTableSize << " MB" << G4endl;
+  }
+  if(StoreTOFScanNThreads >= 0) {
+    WCSimTrigger->SetTOFScanNThreads(StoreTOFScanNThreads);
+    G4cout << "\tTOFScan number of threads set to " << StoreTOFScanNThreads << G4endl;
+  }
+  if(StoreTOFScanPreWindow >= 0) {
+    WCSimTrigger->SetTOFScanPreTriggerWindow(StoreTOFScanPreWindow);
+    G4cout << "\tTOFScan pretrigger window set to " << StoreTOFScanPreWindow << " ns" << G4endl;
+  }
+  if(StoreTOFScanPostWindow >= 0) {
+    WCSimTrigger->SetTOFScanPostTriggerWindow(StoreTOFScanPostWindow);
+    G4cout << "\tTOFScan posttrigger window set to " << StoreTOFScanPostWindow << " ns" << G4endl;
+  }
+  if(StoreContinuousSliceLength >= 0) {
+    WCSimTrigger->SetTimeSliceLength(StoreContinuousSliceLength);
+    G4cout << "\tContinuous readout time slice length set to " << StoreContinuousSliceLength << " ns" << G4endl;
+  }
+  if(StoreContinuousSlicesPerChunk > 0) {
+    WCSimTrigger->SetTimeSlicesPerChunk(StoreContinuousSlicesPerChunk);
+    G4cout << "\tContinuous readout time slices per chunk set to " << StoreContinuousSlicesPerChunk << G4endl;
+  }
   WCSimTrigger->SetTriggerOffset(StoreTriggerOffset);
   G4cout << "\tTrigger offset set to " << StoreTriggerOffset << " ns" << G4endl;
 }
@@ -397,4 +740,20 @@ void WCSimWCDAQMessenger::SetDigitizerOptions()
     WCSimDigitize->SetDigitizerPEPrecision(StoreDigitizerPEPrecision);
     G4cout << "\tDigitizer charge resolution set to " << StoreDigitizerPEPrecision << " p.e."  << G4endl;
   }
+  if(StoreWaveformSampleWidth > 0) {
+    WCSimDigitize->SetWaveformSampleWidth(StoreWaveformSampleWidth);
+    G4cout << "\tWaveform digitizer sampling period set to " << StoreWaveformSampleWidth << " ns"  << G4endl;
+  }
+  if(StoreWaveformNPhases > 0) {
+    WCSimDigitize->SetWaveformNPhases(StoreWaveformNPhases);
+    G4cout << "\tWaveform digitizer pulse template phases set to " << StoreWaveformNPhases << G4endl;
+  }
+  if(StoreWaveformThreshold > 0) {
+    WCSimDigitize->SetWaveformThreshold(StoreWaveformThreshold);
+    G4cout << "\tWaveform digitizer threshold set to " << StoreWaveformThreshold << " single p.e. pulse heights"  << G4endl;
+  }
+  if(StoreWaveformNoise >= 0) {
+    WCSimDigitize->SetWaveformNoise(StoreWaveformNoise);
+    G4cout << "\tWaveform digitizer noise set to " << StoreWaveformNoise << " single p.e. pulse heights"  << G4endl;
+  }
 }
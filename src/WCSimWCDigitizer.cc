@@ -13,6 +13,8 @@
 #include "WCSimDetectorConstruction.hh"
 #include "WCSimPmtInfo.hh"
 #include "WCSimDarkRateMessenger.hh"
+#include "WCSimDAQGeant4.hh"
+#include "WCSimDAQParallel.hh"
 
 #include <vector>
 // for memset
@@ -36,7 +38,7 @@ WCSimWCDigitizerBase::WCSimWCDigitizerBase(G4String name,
 					   WCSimWCDAQMessenger* myMessenger,
 					   DigitizerType_t digitype)
   :G4VDigitizerModule(name), myDetector(inDetector), DAQMessenger(myMessenger), DigitizerType(digitype),
-   DigitizerClassName("")
+   NThreads(0), DigitizerClassName("")
 {
   G4String colName = "WCDigitizedStoreCollection";
   collectionName.push_back(colName);
@@ -59,6 +61,10 @@ void WCSimWCDigitizerBase::GetVariables()
   DigitizerIntegrationWindow = GetDefaultIntegrationWindow();
   DigitizerTimingPrecision   = GetDefaultTimingPrecision();
   DigitizerPEPrecision       = GetDefaultPEPrecision();
+  WaveformSampleWidth        = GetDefaultWaveformSampleWidth();
+  WaveformNPhases            = GetDefaultWaveformNPhases();
+  WaveformThreshold          = GetDefaultWaveformThreshold();
+  WaveformNoise              = GetDefaultWaveformNoise();
 
   //read the .mac file to override them
   if(DAQMessenger != NULL) {
@@ -75,6 +81,12 @@ void WCSimWCDigitizerBase::GetVariables()
   G4cout << "Using digitizer integration window " << DigitizerIntegrationWindow << " ns" << G4endl;
   G4cout << "Using digitizer time resolution "    << DigitizerTimingPrecision   << " ns" << G4endl;
   G4cout << "Using digitizer charge resolution "  << DigitizerPEPrecision       << " p.e." << G4endl;
+  if(DigitizerType == kDigitizerWaveform) {
+    G4cout << "Using waveform sampling period "        << WaveformSampleWidth << " ns" << G4endl;
+    G4cout << "Using waveform pulse template phases "  << WaveformNPhases     << G4endl;
+    G4cout << "Using waveform discriminator threshold " << WaveformThreshold  << " single p.e. pulse heights" << G4endl;
+    G4cout << "Using waveform noise "                  << WaveformNoise       << " single p.e. pulse heights" << G4endl;
+  }
 }
 
 void WCSimWCDigitizerBase::Digitize()
@@ -105,20 +117,52 @@ void WCSimWCDigitizerBase::Digitize()
 
 }
 
-bool WCSimWCDigitizerBase::AddNewDigit(int tube, int gate, float digihittime, float peSmeared, std::vector<int> digi_comp)
+void WCSimWCDigitizerBase::FillDAQHits(WCSimWCDigitsCollection* WCHCPMT)
 {
-  //digitised hit information does not have infinite precision
-  //so need to round the charge and time information
-  double digihittime_d = Truncate(digihittime, DigitizerTimingPrecision);
-  double peSmeared_d   = Truncate(peSmeared,   DigitizerPEPrecision);
+  //We must first sort hits by PMT in time.  This is very important as the digitizers
+  //assume that each hit is in time order from lowest to highest.
+  //Each PMT is sorted on its own, so this can be threaded
+  if(NThreads)
+    WCSimDAQParallel::For(WCHCPMT->entries(), 16, NThreads, [&](size_t first, size_t last) {
+	for(size_t i = first; i < last; i++)
+	  (*WCHCPMT)[i]->SortArrayByHitTime();
+      });
+  else
+    for (G4int i = 0 ; i < WCHCPMT->entries() ; i++)
+      (*WCHCPMT)[i]->SortArrayByHitTime();
+
+  DAQHits.Clear();
+  for (G4int i = 0 ; i < WCHCPMT->entries() ; i++) {
+    WCSimWCDigi * pmthits = (*WCHCPMT)[i];
+    DAQHits.AddPMT(pmthits->GetTubeID());
+    for ( G4int ip = 0 ; ip < pmthits->GetTotalPe() ; ip++)
+      DAQHits.AddHit(pmthits->GetTime(ip), pmthits->GetPe(ip));
+  }
+}
 
+void WCSimWCDigitizerBase::StoreDAQDigits()
+{
+  //gate is the position of the digit on its PMT
+  int last_pmt = -1;
+  int gate = 0;
+  for(size_t id = 0; id < DAQDigits.size(); id++) {
+    WCSimDAQDigit & digit = DAQDigits[id];
+    if(digit.pmt != last_pmt) {
+      last_pmt = digit.pmt;
+      gate = 0;
+    }
+    AddNewDigit(DAQHits.tube[digit.pmt], gate++, digit.time, digit.charge, digit.composition);
+  }
+}
+
+void WCSimWCDigitizerBase::AddNewDigit(int tube, int gate, float digihittime, float peSmeared, std::vector<int> & digi_comp)
+{
   //gate is not a trigger, but just the position of the digit in the array
   //inside the WCSimWCDigi object
 #ifdef WCSIMWCDIGITIZER_VERBOSE
   if(tube < NPMTS_VERBOSE) {
     G4cout<<"Adding hit "<<gate<<" in tube "<<tube
-	  << " with time " << digihittime_d << " charge " << peSmeared_d
-	  << " (truncated from t: " << digihittime << " q: " << peSmeared << ")"
+	  << " with time " << digihittime << " charge " << peSmeared
 	  << " (made of " << digi_comp.size() << " raw hits with IDs ";
     for(unsigned int iv = 0; iv < digi_comp.size(); iv++)
       G4cout << " " << digi_comp[iv] << ",";
@@ -126,40 +170,28 @@ bool WCSimWCDigitizerBase::AddNewDigit(int tube, int gate, float digihittime, fl
   }
 #endif
 
-  //use un-truncated peSmeared here, so that truncation does not affect the test
-  if (peSmeared > 0.0) {
-      if ( DigiStoreHitMap[tube] == 0) {
-	WCSimWCDigi* Digi = new WCSimWCDigi();
-	Digi->SetTubeID(tube);
-	Digi->SetPe(gate,peSmeared_d);
-	Digi->AddPe(digihittime_d);
-	Digi->SetTime(gate,digihittime_d);
-	Digi->AddDigiCompositionInfo(digi_comp);
-	DigiStoreHitMap[tube] = DigiStore->insert(Digi);
+  if ( DigiStoreHitMap[tube] == 0) {
+    WCSimWCDigi* Digi = new WCSimWCDigi();
+    Digi->SetTubeID(tube);
+    Digi->SetPe(gate,peSmeared);
+    Digi->AddPe(digihittime);
+    Digi->SetTime(gate,digihittime);
+    Digi->AddDigiCompositionInfo(digi_comp);
+    DigiStoreHitMap[tube] = DigiStore->insert(Digi);
 #ifdef WCSIMWCDIGITIZER_VERBOSE
-	if(tube < NPMTS_VERBOSE)
-	  G4cout << " NEW HIT" << G4endl;
-#endif
-      }
-      else {
-	(*DigiStore)[DigiStoreHitMap[tube]-1]->SetPe(gate,peSmeared_d);
-	(*DigiStore)[DigiStoreHitMap[tube]-1]->SetTime(gate,digihittime_d);
-	(*DigiStore)[DigiStoreHitMap[tube]-1]->AddPe(digihittime_d);
-	(*DigiStore)[DigiStoreHitMap[tube]-1]->AddDigiCompositionInfo(digi_comp);
-#ifdef WCSIMWCDIGITIZER_VERBOSE
-	if(tube < NPMTS_VERBOSE)
-	  G4cout << " DEJA VU" << G4endl;
+    if(tube < NPMTS_VERBOSE)
+      G4cout << " NEW HIT" << G4endl;
 #endif
-      }
-      return true;
-  }//peSmeared > 0
+  }
   else {
+    (*DigiStore)[DigiStoreHitMap[tube]-1]->SetPe(gate,peSmeared);
+    (*DigiStore)[DigiStoreHitMap[tube]-1]->SetTime(gate,digihittime);
+    (*DigiStore)[DigiStoreHitMap[tube]-1]->AddPe(digihittime);
+    (*DigiStore)[DigiStoreHitMap[tube]-1]->AddDigiCompositionInfo(digi_comp);
 #ifdef WCSIMWCDIGITIZER_VERBOSE
     if(tube < NPMTS_VERBOSE)
-      G4cout << "DIGIT REJECTED with charge " << peSmeared_d
-	     << " time " << digihittime_d << G4endl;
+      G4cout << " DEJA VU" << G4endl;
 #endif
-    return false;
   }
 }
 
@@ -170,6 +202,10 @@ void WCSimWCDigitizerBase::SaveOptionsToOutput(WCSimRootOptions * wcopt)
   wcopt->SetDigitizerIntegrationWindow(DigitizerIntegrationWindow);
   wcopt->SetDigitizerTimingPrecision(DigitizerTimingPrecision);
   wcopt->SetDigitizerPEPrecision(DigitizerPEPrecision);
+  wcopt->SetWaveformSampleWidth(WaveformSampleWidth);
+  wcopt->SetWaveformNPhases(WaveformNPhases);
+  wcopt->SetWaveformThreshold(WaveformThreshold);
+  wcopt->SetWaveformNoise(WaveformNoise);
 }
 
 
@@ -195,178 +231,21 @@ void WCSimWCDigitizerSKI::DigitizeHits(WCSimWCDigitsCollection* WCHCPMT) {
   //Get the PMT info for hit time smearing
   G4String WCIDCollectionName = myDetector->GetIDCollectionName();
   WCSimPMTObject * PMT = myDetector->GetPMTPointer(WCIDCollectionName);
+  WCSimDAQG4Random random;
+  WCSimDAQG4PMTResponse response(PMT);
+
+  //The integration itself is done by the DAQ library, on arrays of the time-sorted hits of each PMT
+  DAQDigitizer.SetDeadTime         (DigitizerDeadTime);
+  DAQDigitizer.SetIntegrationWindow(DigitizerIntegrationWindow);
+  DAQDigitizer.SetTimingPrecision  (DigitizerTimingPrecision);
+  DAQDigitizer.SetPEPrecision      (DigitizerPEPrecision);
+  FillDAQHits(WCHCPMT);
+  if(NThreads)
+    DAQDigitizer.Digitize(DAQHits, WCSimDAQG4Random::Seed(), NThreads, response, DAQDigits);
+  else
+    DAQDigitizer.Digitize(DAQHits, random, response, DAQDigits);
+  StoreDAQDigits();
 
-  //loop over entires in WCHCPMT, each entry corresponds to
-  //the photons on one PMT
-  for (G4int i = 0 ; i < WCHCPMT->entries() ; i++)
-    {
-
-      //We must first sort hits by PMT in time.  This is very important as the code
-      //assumes that each hit is in time order from lowest to highest.
-      (*WCHCPMT)[i]->SortArrayByHitTime();
-      int tube = (*WCHCPMT)[i]->GetTubeID();
-#ifdef WCSIMWCDIGITIZER_VERBOSE
-      if(tube < NPMTS_VERBOSE) {
-	G4cout << "tube " << tube
-	       << " totalpe = " << (*WCHCPMT)[i]->GetTotalPe()
-	       << " times";
-	for(int ip = 0; ip < (*WCHCPMT)[i]->GetTotalPe(); ip++)
-	  G4cout << " " << (*WCHCPMT)[i]->GetTime(ip);
-	/*
-	  G4cout<<" parents =\t";
-	  for( G4int ip = 0 ; ip < (*WCHCPMT)[i]->GetTotalPe() ; ip++)
-	  G4cout << " " << (*WCHCPMT)[i]->GetParentID(ip);
-	*/
-	G4cout <<G4endl;
-      }
-#endif
-
-      //Sorting done.  Now we integrate the charge on each PMT.
-      // Integration occurs for DigitizerIntegrationWindow ns (user set)
-      // Digitizer is then dead for DigitizerDeadTime ns (user set)
-
-      //look over all hits on the PMT
-      //integrate charge and start digitizing
-      float intgr_start=0;
-      float upperlimit=0;
-      G4double efficiency = 0.985; // with skrn1pe (AP tuning) & 30% QE increase in stacking action
-
-      // Variables to store photon uniqueid that make up a digit
-      int digi_unique_id   = 0;
-      int photon_unique_id = 0;
-      std::vector<int> digi_comp; 
-
-      //loop over the hits on this PMT
-      for( G4int ip = 0 ; ip < (*WCHCPMT)[i]->GetTotalPe() ; ip++)
-	{
-	  float time = (*WCHCPMT)[i]->GetTime(ip);
-          float pe = (*WCHCPMT)[i]->GetPe(ip);
-
-	  //start the integration time as the time of the first hit
-	  //Hits must be sorted in time
-	  if(ip==0) {
-	    intgr_start=time;
-	    peSmeared = 0;
-	    //Set the limits of the integration window [intgr_start,upperlimit]                                                                                            
-	    upperlimit = intgr_start + DigitizerIntegrationWindow;
-	  }
-	  
-#ifdef WCSIMWCDIGITIZER_VERBOSE
-	  if(tube < NPMTS_VERBOSE)
-	    G4cout << "ip "    << ip
-		   << " pe "   << pe
-		   << " time " << time
-		   << " intgr_start " << intgr_start
-		   << " upperlimit "  << upperlimit
-		   << G4endl;
-#endif
-
-	  bool MakeDigit = false;
-	  if(time >= intgr_start && time <= upperlimit) {
-	    peSmeared += pe;
-	    photon_unique_id = ip;
-	    digi_comp.push_back(photon_unique_id);
-      
-#ifdef WCSIMWCDIGITIZER_VERBOSE
-	    if(tube < NPMTS_VERBOSE)
-	      G4cout<<"INFO: time "<<time<<" digi_id "<<digi_unique_id<<" p_id "<<photon_unique_id<<G4endl;
-#endif
-	    //if this is the last digit, make sure to make the digit
-	    if(ip + 1 == (*WCHCPMT)[i]->GetTotalPe()){
-	      MakeDigit = true;
-	    }
-	    
-	  }
-	  //if ensures we don't append the same digit multiple times while in the integration window
-	  else if(digi_comp.size()) {
-	    //this hit is outside the integration time window.
-	    //Charge integration is over.  The is now a DigitizerDeadTime ns dead
-	    //time period where no hits can be recorded
-	    MakeDigit = true;
-	  }
-	  
-	  //Make digit here
-	  if(MakeDigit) {
-	    int iflag;
-	    WCSimWCDigitizerSKI::Threshold(peSmeared,iflag);
-
-	    //Check if previous hit passed the threshold.  If so we will digitize the hit
-	    if(iflag == 0) {
-	      //apply time smearing
-	      float Q = (peSmeared > 0.5) ? peSmeared : 0.5;
-	      //digitize hit
-	      peSmeared *= efficiency;
-	      bool accepted = WCSimWCDigitizerBase::AddNewDigit(tube, digi_unique_id,
-								intgr_start + PMT->HitTimeSmearing(Q),
-								peSmeared, digi_comp);
-	      if(accepted) {
-		digi_unique_id++;
-	      }
-	      assert(digi_comp.size());
-	      digi_comp.clear();
-	    }
-	    else {
-	      //reject hit
-#ifdef WCSIMWCDIGITIZER_VERBOSE
-	      if(tube < NPMTS_VERBOSE)
-		G4cout << "DIGIT REJECTED with time " << intgr_start << G4endl;
-#endif
-	      digi_comp.clear();
-	    }
-	  }
-	  
-	  //Now try and deal with the next hit
-	  if(time > upperlimit && time <= upperlimit + DigitizerDeadTime) {
-	    //Now we need to reject hits that are after the integration
-	    //period to the end of the veto signal
-	    continue;
-	  }
-	  else if(time > upperlimit + DigitizerDeadTime){
-#ifdef WCSIMWCDIGITIZER_VERBOSE
-	    if(tube < NPMTS_VERBOSE)
-	      G4cout<<"*** PREPARING FOR >1 DIGI ***"<<G4endl;
-#endif
-	    //we now need to start integrating from the hit
-	    intgr_start=time;
-	    peSmeared = pe;
-	    //Set the limits of the integration window [intgr_start,upperlimit]
-	    upperlimit = intgr_start + DigitizerIntegrationWindow;
-
-	    //store the digi composition information
-	    photon_unique_id = ip;
-            digi_comp.push_back(photon_unique_id);
-
-	    //if this is the last hit we must handle the creation of the digit 
-	    //as the loop will not evaluate again
-	    if(ip+1 == (*WCHCPMT)[i]->GetTotalPe()) {
-	      int iflag;
-	      WCSimWCDigitizerSKI::Threshold(peSmeared,iflag);
-	      if(iflag == 0) {
-		//apply time smearing
-		float Q = (peSmeared > 0.5) ? peSmeared : 0.5;
-		//digitize hit
-		peSmeared *= efficiency;
-		bool accepted = WCSimWCDigitizerBase::AddNewDigit(tube, digi_unique_id,
-								  intgr_start + PMT->HitTimeSmearing(Q),
-								  peSmeared, digi_comp);
-		if(accepted) {
-		  digi_unique_id++;
-		}
-		assert(digi_comp.size());
-		digi_comp.clear();
-	      }
-	      else {
-		//reject hit
-#ifdef WCSIMWCDIGITIZER_VERBOSE
-		if(tube < NPMTS_VERBOSE)
-		  G4cout << "DIGIT REJECTED with time " << intgr_start << G4endl;
-#endif
-		digi_comp.clear();
-	      }
-	    }
-	  }
-	}//ip (totalpe)
-    }//i (WCHCPMT->entries())
   G4cout<<"WCSimWCDigitizerSKI::DigitizeHits END DigiStore->entries() " << DigiStore->entries() << "\n";
   
 #ifdef WCSIMWCDIGITIZER_VERBOSE
@@ -388,3 +267,43 @@ void WCSimWCDigitizerSKI::DigitizeHits(WCSimWCDigitsCollection* WCHCPMT) {
 #endif
 }
 
+
+WCSimWCDigitizerWaveform::WCSimWCDigitizerWaveform(G4String name,
+						   WCSimDetectorConstruction* myDetector,
+						   WCSimWCDAQMessenger* myMessenger)
+  : WCSimWCDigitizerBase(name, myDetector, myMessenger, kDigitizerWaveform)
+{
+  DigitizerClassName = "Waveform";
+  GetVariables();
+}
+
+WCSimWCDigitizerWaveform::~WCSimWCDigitizerWaveform(){
+}
+
+void WCSimWCDigitizerWaveform::DigitizeHits(WCSimWCDigitsCollection* WCHCPMT) {
+  G4cout << "WCSimWCDigitizerWaveform::DigitizeHits START WCHCPMT->entries() = " << WCHCPMT->entries() << G4endl;
+
+  //Get the PMT info for the transit time spread & pulse shape
+  G4String WCIDCollectionName = myDetector->GetIDCollectionName();
+  WCSimPMTObject * PMT = myDetector->GetPMTPointer(WCIDCollectionName);
+  WCSimDAQG4Random random;
+  WCSimDAQG4PMTResponse response(PMT);
+
+  //The waveforms are rendered & digitized by the DAQ library, from the time-sorted hits of each PMT
+  DAQDigitizer.SetDeadTime         (DigitizerDeadTime);
+  DAQDigitizer.SetIntegrationWindow(DigitizerIntegrationWindow);
+  DAQDigitizer.SetTimingPrecision  (DigitizerTimingPrecision);
+  DAQDigitizer.SetPEPrecision      (DigitizerPEPrecision);
+  DAQDigitizer.SetSampleWidth      (WaveformSampleWidth);
+  DAQDigitizer.SetNPhases          (WaveformNPhases);
+  DAQDigitizer.SetThreshold        (WaveformThreshold);
+  DAQDigitizer.SetNoise            (WaveformNoise);
+  FillDAQHits(WCHCPMT);
+  if(NThreads)
+    DAQDigitizer.Digitize(DAQHits, WCSimDAQG4Random::Seed(), NThreads, response, DAQDigits);
+  else
+    DAQDigitizer.Digitize(DAQHits, random, response, DAQDigits);
+  StoreDAQDigits();
+
+  G4cout<<"WCSimWCDigitizerWaveform::DigitizeHits END DigiStore->entries() " << DigiStore->entries() << "\n";
+}
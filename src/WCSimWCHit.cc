@@ -6,6 +6,7 @@
 #include "G4Colour.hh"
 #include "G4VisAttributes.hh"
 #include "G4RotationMatrix.hh"
+#include "Randomize.hh"
 #include <iomanip>
 
 #include "G4PhysicalConstants.hh"
@@ -118,6 +119,65 @@ void WCSimWCHit::Print()
   G4cout << "size: " << time.size() << G4endl;
 }
 
+namespace {
+  // Keep the entries of v at the indices picked
+  template <class T> void KeepPicked(std::vector<T> & v, const std::vector<size_t> & picked)
+  {
+    if(v.empty()) return; // optional photon truth that isn't saved
+    std::vector<T> kept(picked.size());
+    for(size_t i = 0; i < picked.size(); i++)
+      kept[i] = v[picked[i]];
+    v.swap(kept);
+  }
+}
+
+void WCSimWCHit::ResampleWeightedPe()
+{
+  if(photonWeight.empty()) return;
+
+  std::vector<G4double> cumulative(totalPe);
+  G4double sum = 0;
+  for(int i = 0; i < totalPe; i++) {
+    sum += photonWeight[i];
+    cumulative[i] = sum;
+  }
+
+  // pick the photons in the order they hit the tube
+  const G4int npe = CLHEP::RandPoisson::shoot(sum);
+  std::vector<size_t> picked(npe);
+  for(int i = 0; i < npe; i++) {
+    const size_t ip = std::upper_bound(cumulative.begin(), cumulative.end(), G4UniformRand() * sum) - cumulative.begin();
+    picked[i] = std::min(ip, (size_t)totalPe - 1);
+  }
+  std::sort(picked.begin(), picked.end());
+
+  KeepPicked(time, picked);
+  KeepPicked(primaryParentID, picked);
+  KeepPicked(photonStartTime, picked);
+  KeepPicked(photonStartPos, picked);
+  KeepPicked(photonEndPos, picked);
+  photonWeight.clear();
+
+  totalPe = npe;
+  if (totalPe > maxPe) 
+    maxPe = totalPe;
+}
+
+
+void WCSimWCHit::SortPeByTime()
+{
+  std::vector<size_t> order(totalPe);
+  for(int i = 0; i < totalPe; i++)
+    order[i] = i;
+  std::stable_sort(order.begin(), order.end(), [this](size_t a, size_t b) { return time[a] < time[b]; });
+
+  KeepPicked(time, order);
+  KeepPicked(primaryParentID, order);
+  KeepPicked(photonStartTime, order);
+  KeepPicked(photonStartPos, order);
+  KeepPicked(photonEndPos, order);
+  KeepPicked(photonWeight, order);
+}
 
 
 /*! \brief Convert HSV to RGB color space (from https://gist.github.com/fairlight1337/4935ae72bcbcc1ba5c72)
@@ -0,0 +1,171 @@
+#include "WCSimWCOverlay.hh"
+#include "WCSimOverlayMessenger.hh"
+#include "WCSimWCHit.hh"
+#include "G4RunManager.hh"
+#include "G4Poisson.hh"
+#include "G4ios.hh"
+#include "G4ThreeVector.hh"
+#include "Randomize.hh"
+
+#include "WCSimDetectorConstruction.hh"
+#include "WCSimRunAction.hh"
+
+#include <vector>
+#include <algorithm>
+
+WCSimWCOverlay::WCSimWCOverlay(G4String name,
+			       WCSimDetectorConstruction* inDetector)
+  :G4VDigitizerModule(name), WindowLow(-1000), WindowHigh(2000), myDetector(inDetector)
+{
+  //Get the user options
+  OverlayMessenger = new WCSimOverlayMessenger(this);
+}
+
+WCSimWCOverlay::~WCSimWCOverlay(){
+  delete OverlayMessenger;
+  OverlayMessenger = 0;
+  ClearSources();
+}
+
+bool WCSimWCOverlay::AddSource(OverlaySource & source)
+{
+  source.library = new WCSimHitLibrary();
+  if(!source.library->Open(source.filename)) {
+    delete source.library;
+    return false;
+  }
+  if(source.library->GetLevel() != WCSimHitLibrary::kPhotonHits || !source.library->GetNumEntries()) {
+    G4cerr << "WCSimWCOverlay: " << source.filename
+	   << " is not a library of photon hits, or is empty. It can not be overlaid" << G4endl;
+    delete source.library;
+    return false;
+  }
+  source.next = 0;
+  Sources.push_back(source);
+  return true;
+}
+
+void WCSimWCOverlay::AddRateSource(G4String filename, double rate)
+{
+  OverlaySource source;
+  source.filename = filename;
+  source.fixed    = false;
+  source.rate     = rate;
+  source.offset   = 0;
+  if(!AddSource(source))
+    exit(-1);
+}
+
+void WCSimWCOverlay::AddFixedSource(G4String filename, double offset)
+{
+  OverlaySource source;
+  source.filename = filename;
+  source.fixed    = true;
+  source.rate     = 0;
+  source.offset   = offset;
+  if(!AddSource(source))
+    exit(-1);
+}
+
+void WCSimWCOverlay::ClearSources()
+{
+  for(size_t i = 0; i < Sources.size(); i++)
+    delete Sources[i].library;
+  Sources.clear();
+}
+
+void WCSimWCOverlay::Overlay(WCSimWCHitsCollection* WCHC)
+{
+  if(Sources.empty())
+    return;
+  if(!WCHC) {
+    G4cerr << "WCSimWCOverlay: no hits collection in this event. Nothing overlaid" << G4endl;
+    return;
+  }
+
+  //Find the hit of each tube that already has one
+  HitIndex.assign(myDetector->Get_Pmts()->size() + 1, -1);
+  for(G4int i = 0; i < WCHC->entries(); i++)
+    HitIndex[(*WCHC)[i]->GetTubeID()] = i;
+
+  for(size_t is = 0; is < Sources.size(); is++) {
+    OverlaySource & source = Sources[is];
+    const uint64_t nentries = source.library->GetNumEntries();
+    if(source.fixed) {
+      OverlayEntry(WCHC, source, source.next, source.offset);
+      source.next = (source.next + 1) % nentries;
+    }
+    else {
+      //rate is in kHz, the window in ns
+      const double width = WindowHigh - WindowLow;
+      const G4long n = G4Poisson(source.rate * width * 1E-6);
+      for(G4long i = 0; i < n; i++) {
+	const uint64_t entry = std::min<uint64_t>(nentries - 1, (uint64_t)(G4UniformRand() * nentries));
+	OverlayEntry(WCHC, source, entry, WindowLow + G4UniformRand() * width);
+      }
+    }
+  }
+}
+
+void WCSimWCOverlay::OverlayEntry(WCSimWCHitsCollection* WCHC, const OverlaySource & source,
+				  uint64_t entry, double offset)
+{
+  //Only fill the optional photon truth that WCSimWCPMT will copy
+  WCSimRunAction* runAction = (WCSimRunAction*)G4RunManager::GetRunManager()->GetUserRunAction();
+  const bool savePhotonStartTime = runAction->GetSavePhotonStartTime();
+  const bool savePhotonStartPos  = runAction->GetSavePhotonStartPos();
+  const bool savePhotonEndPos    = runAction->GetSavePhotonEndPos();
+
+  const WCSimHitLibraryHit * hits = source.library->GetEntry(entry);
+  const uint64_t nhits = source.library->GetEntrySize(entry);
+  const int ntubes = HitIndex.size() - 1;
+  int nbad = 0;
+  for(uint64_t ih = 0; ih < nhits; ih++) {
+    const int tube = hits[ih].tube;
+    if(tube < 1 || tube > ntubes) {
+      nbad++;
+      continue;
+    }
+    if(HitIndex[tube] < 0) {
+      WCSimWCHit* hit = new WCSimWCHit();
+      const G4Transform3D & transform = myDetector->GetTubeTransform(tube);
+      hit->SetTubeID(tube);
+      hit->SetTrackID(0);
+      hit->SetEdep(0.);
+      hit->SetPos(transform.getTranslation());
+      hit->SetRot(transform.getRotation());
+      HitIndex[tube] = WCHC->insert(hit) - 1;
+    }
+    WCSimWCHit* hit = (*WCHC)[HitIndex[tube]];
+    const G4float time = hits[ih].time + offset;
+    hit->AddPe(time);
+    // The photons & their parent tracks belong to another event and are not saved in this one:
+    // their truth is set to the sentinels, rather than made up from the p.e. time & the PMT position
+    hit->AddParentID(kOverlayParentID);
+    if(savePhotonStartTime)
+      hit->AddPhotonStartTime(kOverlayPhotonTruth);
+    if(savePhotonStartPos)
+      hit->AddPhotonStartPos(G4ThreeVector(kOverlayPhotonTruth, kOverlayPhotonTruth, kOverlayPhotonTruth));
+    if(savePhotonEndPos)
+      hit->AddPhotonEndPos(G4ThreeVector(kOverlayPhotonTruth, kOverlayPhotonTruth, kOverlayPhotonTruth));
+  }
+  if(nbad)
+    G4cerr << "WCSimWCOverlay: " << nbad << " hits of entry " << entry << " of " << source.filename
+	   << " are on tubes that do not exist in this detector. Was the library made with another geometry?" << G4endl;
+}
+
+void WCSimWCOverlay::SaveOptionsToOutput(WCSimRootOptions * wcopt)
+{
+  std::vector<string> files;
+  std::vector<double> rates, offsets;
+  for(size_t is = 0; is < Sources.size(); is++) {
+    files.push_back(Sources[is].filename);
+    rates.push_back(Sources[is].fixed ? 0 : Sources[is].rate);
+    offsets.push_back(Sources[is].fixed ? Sources[is].offset : 0);
+  }
+  wcopt->SetOverlayFiles(files);
+  wcopt->SetOverlayRates(rates);
+  wcopt->SetOverlayOffsets(offsets);
+  wcopt->SetOverlayWindowLow(WindowLow);
+  wcopt->SetOverlayWindowHigh(WindowHigh);
+}
@@ -6,6 +6,7 @@
 #include "G4Event.hh"
 #include "G4SDManager.hh"
 #include "G4DigiManager.hh"
+#include "G4RunManager.hh"
 #include "G4ios.hh"
 #include "G4RotationMatrix.hh"
 #include "G4ThreeVector.hh"
@@ -13,11 +14,15 @@
 #include "WCSimDetectorConstruction.hh"
 #include "WCSimPmtInfo.hh"
 #include "WCSimPMTObject.hh"
+#include "WCSimRunAction.hh"
+#include "WCSimDAQGeant4.hh"
+#include "WCSimDAQParallel.hh"
 
 
 #include <vector>
 // for memset
 #include <cstring>
+#include <cfloat>
 
 
 extern "C" void skrn1pe_(float* );
@@ -25,7 +30,7 @@ extern "C" void skrn1pe_(float* );
 
 WCSimWCPMT::WCSimWCPMT(G4String name,
 				   WCSimDetectorConstruction* myDetector)
-  :G4VDigitizerModule(name)
+  :G4VDigitizerModule(name), NThreads(0), TimeLow(-DBL_MAX), TimeHigh(DBL_MAX)
 {
   G4String colName = "WCRawPMTSignalCollection";
   this->myDetector = myDetector;
@@ -43,17 +48,20 @@ G4double WCSimWCPMT::rn1pe(){
   G4String WCIDCollectionName = myDetector->GetIDCollectionName();
   WCSimPMTObject * PMT;
   PMT = myDetector->GetPMTPointer(WCIDCollectionName);
+  WCSimDAQG4Random random;
+  return rn1pe(PMT->Getqpe(), random);
+}
+
+G4double WCSimWCPMT::rn1pe(const G4float * qpe0, WCSimDAQRandom & random){
   G4int i;
-  G4double random = G4UniformRand();
-  G4double random2 = G4UniformRand(); 
-  G4float *qpe0;
-  qpe0 = PMT->Getqpe();
+  G4double random1 = random.Flat();
+  G4double random2 = random.Flat(); 
   for(i = 0; i < 501; i++){
     
-    if (random <= *(qpe0+i)) break;
+    if (random1 <= *(qpe0+i)) break;
   }
   if(i==500)
-    random = G4UniformRand();
+    random1 = random.Flat();
   
   return (G4double(i-50) + random2)/22.83;
   
@@ -92,88 +100,167 @@ void WCSimWCPMT::MakePeCorrection(WCSimWCHitsCollection* WCHC)
   // It works out that the pmts here are ordered !
   // pmts->at(i) has tubeid i+1
 
-  //Get the PMT info for hit time smearing
+  //Get the PMT info for the single p.e. charge
   G4String WCIDCollectionName = myDetector->GetIDCollectionName();
   WCSimPMTObject * PMT = myDetector->GetPMTPointer(WCIDCollectionName);
+  const G4float * qpe = PMT->Getqpe();
 
+  //Only copy the optional photon truth that was recorded by WCSimWCSD
+  WCSimRunAction* runAction = (WCSimRunAction*)G4RunManager::GetRunManager()->GetUserRunAction();
+  const bool savePhotonStartTime = runAction->GetSavePhotonStartTime();
+  const bool savePhotonStartPos  = runAction->GetSavePhotonStartPos();
+  const bool savePhotonEndPos    = runAction->GetSavePhotonEndPos();
+
+  //First make the digi of each hit tube, in hit order. This is not threaded, as G4Allocator isn't thread safe.
+  // hitsInDigi[d] holds the hits that go into the digi d of the collection
+  std::vector< std::vector<G4int> > hitsInDigi;
   for (G4int i=0; i < WCHC->entries(); i++)
     {
-
-      //G4double peCutOff = .3;
-      // MF, based on S.Mine's suggestion : global scaling factor applied to
-      // all the smeared charges.
-      // means that we need to increase the collected light by
-      // (efficiency-1)*100% to
-      // match K2K 1KT data  : maybe due to PMT curvature ?
-
-      //G4double efficiency = 0.985; // with skrn1pe (AP tuning) & 30% QE increase in stacking action
+      G4int first, last;
+      GetPeInTimeRange((*WCHC)[i], first, last);
+      if(first == last)
+	continue;
 
       // Get the information from the hit
       G4int   tube         = (*WCHC)[i]->GetTubeID();
-      G4double peSmeared = 0.0;
-      double time_PMT, time_true;
       G4int  track_id      = (*WCHC)[i]->GetTrackID();
-      
-      
-      // Set the position and rotation of the pmt (from WCSimWCAddDarkNoise.cc)
-      Float_t hit_pos[3];
-      Float_t hit_rot[3];
-      
-      WCSimPmtInfo* pmtinfo = (WCSimPmtInfo*)pmts->at( tube -1 );
-      hit_pos[0] = 10*pmtinfo->Get_transx()/CLHEP::cm;
-      hit_pos[1] = 10*pmtinfo->Get_transy()/CLHEP::cm;
-      hit_pos[2] = 10*pmtinfo->Get_transz()/CLHEP::cm;
-      hit_rot[0] = pmtinfo->Get_orienx();
-      hit_rot[1] = pmtinfo->Get_orieny();
-      hit_rot[2] = pmtinfo->Get_orienz();
-
-      G4ThreeVector pmt_orientation(hit_rot[0], hit_rot[1], hit_rot[2]);
-      G4ThreeVector pmt_position(hit_pos[0], hit_pos[1], hit_pos[2]);
-
-	  for (G4int ip =0; ip < (*WCHC)[i]->GetTotalPe(); ip++){
-	    time_true = (*WCHC)[i]->GetTime(ip);
-	    time_PMT  = time_true; //currently no PMT time smearing applied
-	    peSmeared = rn1pe();
-	    int parent_id = (*WCHC)[i]->GetParentID(ip);
-	    float photon_starttime = (*WCHC)[i]->GetPhotonStartTime(ip);
-	    G4ThreeVector photon_startpos = (*WCHC)[i]->GetPhotonStartPos(ip);
-	    G4ThreeVector photon_endpos = (*WCHC)[i]->GetPhotonEndPos(ip);
-	    
-	    if ( DigiHitMapPMT[tube] == 0) {
-	      WCSimWCDigi* Digi = new WCSimWCDigi();
-	      Digi->SetLogicalVolume((*WCHC)[0]->GetLogicalVolume());
-	      Digi->AddPe(time_PMT);
-	      Digi->SetTubeID(tube);
-	      Digi->SetPos(pmt_position);
-	      Digi->SetOrientation(pmt_orientation);
-	      Digi->SetPe(ip,peSmeared);
-	      Digi->SetTime(ip,time_PMT);
-	      Digi->SetTrackID(track_id);
-	      Digi->SetPreSmearTime(ip,time_true);
-	      Digi->SetParentID(ip,parent_id);
-	      Digi->SetPhotonStartTime(ip,photon_starttime);
-	      Digi->SetPhotonStartPos(ip,photon_startpos);
-	      Digi->SetPhotonEndPos(ip,photon_endpos);
-	      DigiHitMapPMT[tube] = DigitsCollection->insert(Digi);
-	    }	
-	    else {
-	      (*DigitsCollection)[DigiHitMapPMT[tube]-1]->AddPe(time_PMT);
-	      (*DigitsCollection)[DigiHitMapPMT[tube]-1]->SetLogicalVolume((*WCHC)[0]->GetLogicalVolume());
-	      (*DigitsCollection)[DigiHitMapPMT[tube]-1]->SetPe(ip,peSmeared);
-	      (*DigitsCollection)[DigiHitMapPMT[tube]-1]->SetTime(ip,time_PMT);
-	      (*DigitsCollection)[DigiHitMapPMT[tube]-1]->SetTubeID(tube); 
-	      (*DigitsCollection)[DigiHitMapPMT[tube]-1]->SetPos(pmt_position);
-	      (*DigitsCollection)[DigiHitMapPMT[tube]-1]->SetOrientation(pmt_orientation);
-	      (*DigitsCollection)[DigiHitMapPMT[tube]-1]->SetTrackID(track_id);
-	      (*DigitsCollection)[DigiHitMapPMT[tube]-1]->SetPreSmearTime(ip,time_true);
-	      (*DigitsCollection)[DigiHitMapPMT[tube]-1]->SetParentID(ip,parent_id);
-	      (*DigitsCollection)[DigiHitMapPMT[tube]-1]->SetPhotonStartTime(ip,photon_starttime);
-	      (*DigitsCollection)[DigiHitMapPMT[tube]-1]->SetPhotonStartPos(ip,photon_startpos);
-	      (*DigitsCollection)[DigiHitMapPMT[tube]-1]->SetPhotonEndPos(ip,photon_endpos);
-	    }
-      
-	  } // Loop over hits in each PMT
+
+      if ( DigiHitMapPMT[tube] == 0) {
+	// Set the position and rotation of the pmt (from WCSimWCAddDarkNoise.cc)
+	Float_t hit_pos[3];
+	Float_t hit_rot[3];
+
+	WCSimPmtInfo* pmtinfo = (WCSimPmtInfo*)pmts->at( tube -1 );
+	hit_pos[0] = 10*pmtinfo->Get_transx()/CLHEP::cm;
+	hit_pos[1] = 10*pmtinfo->Get_transy()/CLHEP::cm;
+	hit_pos[2] = 10*pmtinfo->Get_transz()/CLHEP::cm;
+	hit_rot[0] = pmtinfo->Get_orienx();
+	hit_rot[1] = pmtinfo->Get_orieny();
+	hit_rot[2] = pmtinfo->Get_orienz();
+
+	G4ThreeVector pmt_orientation(hit_rot[0], hit_rot[1], hit_rot[2]);
+	G4ThreeVector pmt_position(hit_pos[0], hit_pos[1], hit_pos[2]);
+
+	WCSimWCDigi* Digi = new WCSimWCDigi();
+	Digi->SetLogicalVolume((*WCHC)[0]->GetLogicalVolume());
+	Digi->SetTubeID(tube);
+	Digi->SetPos(pmt_position);
+	Digi->SetOrientation(pmt_orientation);
+	Digi->SetTrackID(track_id);
+	DigiHitMapPMT[tube] = DigitsCollection->insert(Digi);
+	hitsInDigi.push_back(std::vector<G4int>());
+      }
+      hitsInDigi[DigiHitMapPMT[tube]-1].push_back(i);
     }// Loop over PMTs
+
+  //Then give each photoelectron its charge
+  if(!NThreads) {
+    WCSimDAQG4Random random;
+    for (G4int i=0; i < WCHC->entries(); i++)
+      if(DigiHitMapPMT[(*WCHC)[i]->GetTubeID()]) //i.e. the tube has p.e. in the time range
+	AddPhotoelectrons((*WCHC)[i], (*DigitsCollection)[DigiHitMapPMT[(*WCHC)[i]->GetTubeID()]-1], qpe, random,
+			  savePhotonStartTime, savePhotonStartPos, savePhotonEndPos);
+  }
+  else {
+    const uint64_t seed = WCSimDAQG4Random::Seed();
+    WCSimDAQParallel::For(hitsInDigi.size(), 16, NThreads, [&](size_t first, size_t last) {
+	for(size_t d = first; d < last; d++) {
+	  WCSimWCDigi* Digi = (*DigitsCollection)[d];
+	  WCSimDAQRandomStream random(seed, Digi->GetTubeID());
+	  for(size_t ih = 0; ih < hitsInDigi[d].size(); ih++)
+	    AddPhotoelectrons((*WCHC)[hitsInDigi[d][ih]], Digi, qpe, random,
+			      savePhotonStartTime, savePhotonStartPos, savePhotonEndPos);
+	}
+      });
+  }
+}
+
+void WCSimWCPMT::AddPhotoelectrons(WCSimWCHit * hit, WCSimWCDigi * Digi, const G4float * qpe, WCSimDAQRandom & random,
+				   bool savePhotonStartTime, bool savePhotonStartPos, bool savePhotonEndPos)
+{
+  //G4double peCutOff = .3;
+  // MF, based on S.Mine's suggestion : global scaling factor applied to
+  // all the smeared charges.
+  // means that we need to increase the collected light by
+  // (efficiency-1)*100% to
+  // match K2K 1KT data  : maybe due to PMT curvature ?
+
+  //G4double efficiency = 0.985; // with skrn1pe (AP tuning) & 30% QE increase in stacking action
+
+  G4double peSmeared = 0.0;
+  double time_PMT, time_true;
+
+  G4int first, last;
+  GetPeInTimeRange(hit, first, last);
+  for (G4int ip = first; ip < last; ip++){
+    time_true = hit->GetTime(ip);
+    time_PMT  = time_true; //currently no PMT time smearing applied
+    peSmeared = rn1pe(qpe, random);
+    int parent_id = hit->GetParentID(ip);
+
+    Digi->AddPe(time_PMT);
+    //the index of the p.e. in the digi
+    const G4int id = Digi->GetTotalPe() - 1;
+    Digi->SetPe(id,peSmeared);
+    Digi->SetTime(id,time_PMT);
+    Digi->SetPreSmearTime(id,time_true);
+    Digi->SetParentID(id,parent_id);
+    if(savePhotonStartTime)
+      Digi->SetPhotonStartTime(id,hit->GetPhotonStartTime(ip));
+    if(savePhotonStartPos)
+      Digi->SetPhotonStartPos(id,hit->GetPhotonStartPos(ip));
+    if(savePhotonEndPos)
+      Digi->SetPhotonEndPos(id,hit->GetPhotonEndPos(ip));
+  } // Loop over hits in each PMT
 }
 
+void WCSimWCPMT::GetPeInTimeRange(WCSimWCHit * hit, G4int & first, G4int & last)
+{
+  first = (TimeLow  == -DBL_MAX) ? 0                  : hit->GetFirstPeAfter(TimeLow);
+  last  = (TimeHigh ==  DBL_MAX) ? hit->GetTotalPe() : hit->GetFirstPeAfter(TimeHigh);
+}
+
+
 
+void WCSimWCPMT::AddRawSignal(const WCSimHitLibraryHit* hits, uint64_t nhits)
+{
+  std::vector<WCSimPmtInfo*> *pmts = myDetector->Get_Pmts();
+  const int ntubes = pmts->size();
+  int nbad = 0;
+
+  for (uint64_t ih = 0; ih < nhits; ih++)
+    {
+      G4int tube = hits[ih].tube;
+      if(tube < 1 || tube > ntubes) {
+	nbad++;
+	continue;
+      }
+      if(hits[ih].time < TimeLow || hits[ih].time >= TimeHigh)
+	continue;
+
+      if ( DigiHitMapPMT[tube] == 0) {
+	WCSimPmtInfo* pmtinfo = (WCSimPmtInfo*)pmts->at( tube -1 );
+	G4ThreeVector pmt_position(10*pmtinfo->Get_transx()/CLHEP::cm,
+				   10*pmtinfo->Get_transy()/CLHEP::cm,
+				   10*pmtinfo->Get_transz()/CLHEP::cm);
+	G4ThreeVector pmt_orientation(pmtinfo->Get_orienx(), pmtinfo->Get_orieny(), pmtinfo->Get_orienz());
+	WCSimWCDigi* Digi = new WCSimWCDigi();
+	Digi->SetTubeID(tube);
+	Digi->SetPos(pmt_position);
+	Digi->SetOrientation(pmt_orientation);
+	Digi->SetTrackID(0);
+	DigiHitMapPMT[tube] = DigitsCollection->insert(Digi);
+      }
+
+      // The signal was already put through the PMT response when it was saved
+      WCSimWCDigi* Digi = (*DigitsCollection)[DigiHitMapPMT[tube]-1];
+      Digi->AddPe(hits[ih].time);
+      const G4int ip = Digi->GetTotalPe() - 1;
+      Digi->SetPe(ip,hits[ih].charge);
+      Digi->SetTime(ip,hits[ih].time);
+      Digi->SetPreSmearTime(ip,hits[ih].time);
+      Digi->SetParentID(ip,hits[ih].parentID);
+    }
+  if(nbad)
+    G4cerr << "WCSimWCPMT::AddRawSignal: " << nbad << " signals are on tubes that do not exist in this detector" << G4endl;
+}
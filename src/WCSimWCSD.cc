@@ -16,6 +16,7 @@
 
 #include "WCSimDetectorConstruction.hh"
 #include "WCSimTrackInformation.hh"
+#include "WCSimRunAction.hh"
 
 #include "WCSimSteppingAction.hh"
 
@@ -203,6 +204,7 @@ G4bool WCSimWCSD::ProcessHits(G4Step* aStep, G4TouchableHistory*)
        //Since volumeName is the same as the SD name, this works. 
        G4SDManager* SDman = G4SDManager::GetSDMpointer();
        G4RunManager* Runman = G4RunManager::GetRunManager();
+       WCSimRunAction* runAction = (WCSimRunAction*)Runman->GetUserRunAction();
        G4int collectionID = SDman->GetCollectionID(volumeName);
        const G4Event* currentEvent = Runman->GetCurrentEvent();
        G4HCofThisEvent* HCofEvent = currentEvent->GetHCofThisEvent();
@@ -226,24 +228,22 @@ G4bool WCSimWCSD::ProcessHits(G4Step* aStep, G4TouchableHistory*)
 	   
 	   // Set the hitMap value to the collection hit number
 	   PMTHitMap[replicaNumber] = hitsCollection->insert( newHit );
-	   (*hitsCollection)[PMTHitMap[replicaNumber]-1]->AddPe(hitTime);
-	   (*hitsCollection)[PMTHitMap[replicaNumber]-1]->AddParentID(primParentID);
-	   (*hitsCollection)[PMTHitMap[replicaNumber]-1]->AddPhotonStartTime(photonStartTime);
-	   (*hitsCollection)[PMTHitMap[replicaNumber]-1]->AddPhotonStartPos(photonStartPos);
-	   (*hitsCollection)[PMTHitMap[replicaNumber]-1]->AddPhotonEndPos(worldPosition);
 	   
 	   //     if ( particleDefinition != G4OpticalPhoton::OpticalPhotonDefinition() )
 	   //       newHit->Print();
 	     
 	 }
-       else {
-	 (*hitsCollection)[PMTHitMap[replicaNumber]-1]->AddPe(hitTime);
-	 (*hitsCollection)[PMTHitMap[replicaNumber]-1]->AddParentID(primParentID);
-	 (*hitsCollection)[PMTHitMap[replicaNumber]-1]->AddPhotonStartTime(photonStartTime);
-	 (*hitsCollection)[PMTHitMap[replicaNumber]-1]->AddPhotonStartPos(photonStartPos);
-	 (*hitsCollection)[PMTHitMap[replicaNumber]-1]->AddPhotonEndPos(worldPosition);
-	 
-       }
+
+       // Only record the optional photon truth that will be saved (see /WCSimIO/)
+       WCSimWCHit* theHit = (*hitsCollection)[PMTHitMap[replicaNumber]-1];
+       theHit->AddPe(hitTime, aStep->GetTrack()->GetWeight());
+       theHit->AddParentID(primParentID);
+       if(runAction->GetSavePhotonStartTime())
+	 theHit->AddPhotonStartTime(photonStartTime);
+       if(runAction->GetSavePhotonStartPos())
+	 theHit->AddPhotonStartPos(photonStartPos);
+       if(runAction->GetSavePhotonEndPos())
+	 theHit->AddPhotonEndPos(worldPosition);
      }
   }
 
@@ -252,7 +252,21 @@ G4bool WCSimWCSD::ProcessHits(G4Step* aStep, G4TouchableHistory*)
 
 void WCSimWCSD::EndOfEvent(G4HCofThisEvent* HCE)
 {
-
+  // Photon weighting (/process/optical/photonWeight): turn the weights
+  // into p.e., and drop the tubes left without any
+  WCSimWCHitsCollection* weightedCollection = (WCSimWCHitsCollection*)HCE->GetHC(HCID);
+  if (weightedCollection) {
+    std::vector<WCSimWCHit*>* hits = weightedCollection->GetVector();
+    size_t nkept = 0;
+    for (size_t i = 0; i < hits->size(); i++) {
+      (*hits)[i]->ResampleWeightedPe();
+      if ((*hits)[i]->GetTotalPe())
+	(*hits)[nkept++] = (*hits)[i];
+      else
+	delete (*hits)[i];
+    }
+    hits->resize(nkept);
+  }
  
   if (verboseLevel>0) 
   { 
@@ -277,13 +291,7 @@ void WCSimWCSD::EndOfEvent(G4HCofThisEvent* HCE)
       }
       }*/
 
-    /* Detailed debug:
-    G4cout << "Through mPMTLV " << WCSimSteppingAction::n_photons_through_mPMTLV << G4endl;
-    G4cout << "Through Acrylic " << WCSimSteppingAction::n_photons_through_acrylic << G4endl;
-    G4cout << "Through Gel " << WCSimSteppingAction::n_photons_through_gel << G4endl;
-    G4cout << "On Blacksheet " << WCSimSteppingAction::n_photons_on_blacksheet << G4endl;
-    G4cout << "On small PMT " << WCSimSteppingAction::n_photons_on_smallPMT << G4endl;
-    */
+    // The optical photon steps by volume are counted with /WCSimIO/OpticalProfile
   } 
 }
 
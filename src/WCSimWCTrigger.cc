@@ -12,9 +12,15 @@
 
 #include "WCSimDetectorConstruction.hh"
 #include "WCSimPmtInfo.hh"
+#include "WCSimGeometryTable.hh"
 #include "WCSimDarkRateMessenger.hh"
+#include "WCSimRunAction.hh"
+#include "G4RunManager.hh"
 
 #include <vector>
+#include <algorithm>
+#include <cmath>
+#include <cfloat>
 // for memset
 #include <cstring>
 
@@ -29,7 +35,19 @@
 #endif
 
 //const double WCSimWCTriggerBase::offset = 950.0; // ns. apply offset to the digit time
-const double WCSimWCTriggerBase::LongTime = 1E6; // ns = 1ms. event time
+
+namespace {
+  //orders indices into the sorted view by (time, tube)
+  struct SortedDigitTimeTubeOrder {
+    const std::vector<WCSimWCTriggerBase::SortedDigit> & digits;
+    SortedDigitTimeTubeOrder(const std::vector<WCSimWCTriggerBase::SortedDigit> & d) : digits(d) {}
+    bool operator()(size_t a, size_t b) const {
+      if(digits[a].time != digits[b].time)
+	return digits[a].time < digits[b].time;
+      return digits[a].tube < digits[b].tube;
+    }
+  };
+}
 
 
 WCSimWCTriggerBase::WCSimWCTriggerBase(G4String name,
@@ -49,6 +67,12 @@ WCSimWCTriggerBase::WCSimWCTriggerBase(G4String name,
   }
 
   digitizeCalled = false;
+  localNeighbourhoodsBuilt = false;
+  tofGridBuilt = false;
+  timeSliceLow  = -DBL_MAX;
+  timeSliceHigh =  DBL_MAX;
+  nextTimeSlice = 0;
+  timeSliceStarted = false;
 }
 
 WCSimWCTriggerBase::~WCSimWCTriggerBase(){
@@ -63,6 +87,20 @@ void WCSimWCTriggerBase::GetVariables()
   ndigitsWindow            = GetDefaultNDigitsWindow();
   ndigitsPreTriggerWindow  = GetDefaultNDigitsPreTriggerWindow();
   ndigitsPostTriggerWindow = GetDefaultNDigitsPostTriggerWindow();
+  localNHitsThreshold         = GetDefaultLocalNHitsThreshold();
+  localNHitsWindow            = GetDefaultLocalNHitsWindow();
+  localNHitsNeighbourRadius   = GetDefaultLocalNHitsNeighbourRadius();
+  localNHitsPreTriggerWindow  = GetDefaultLocalNHitsPreTriggerWindow();
+  localNHitsPostTriggerWindow = GetDefaultLocalNHitsPostTriggerWindow();
+  tofScanThreshold         = GetDefaultTOFScanThreshold();
+  tofScanWindow            = GetDefaultTOFScanWindow();
+  tofScanGridSpacing       = GetDefaultTOFScanGridSpacing();
+  tofScanNThreads          = GetDefaultTOFScanNThreads();
+  tofScanMaxTableSize      = GetDefaultTOFScanMaxTableSize();
+  tofScanPreTriggerWindow  = GetDefaultTOFScanPreTriggerWindow();
+  tofScanPostTriggerWindow = GetDefaultTOFScanPostTriggerWindow();
+  timeSliceLength          = GetDefaultTimeSliceLength();
+  timeSlicesPerChunk       = GetDefaultTimeSlicesPerChunk();
   
   offset = GetDefaultTriggerOffset();
 
@@ -83,6 +121,21 @@ void WCSimWCTriggerBase::GetVariables()
 	 << "Using NDigits trigger window " << ndigitsWindow << " ns" << G4endl
 	 << "Using NDigits event pretrigger window " << ndigitsPreTriggerWindow << " ns" << G4endl
 	 << "Using NDigits event posttrigger window " << ndigitsPostTriggerWindow << " ns" << G4endl
+	 << "Using LocalNHits threshold " << localNHitsThreshold << G4endl
+	 << "Using LocalNHits trigger window " << localNHitsWindow << " ns" << G4endl
+	 << "Using LocalNHits neighbourhood radius " << localNHitsNeighbourRadius << " cm"
+	 << (localNHitsNeighbourRadius > 0 ? "" : " (i.e. neighbourhoods are mPMTs)") << G4endl
+	 << "Using LocalNHits event pretrigger window " << localNHitsPreTriggerWindow << " ns" << G4endl
+	 << "Using LocalNHits event posttrigger window " << localNHitsPostTriggerWindow << " ns" << G4endl
+	 << "Using TOFScan threshold " << tofScanThreshold << G4endl
+	 << "Using TOFScan trigger window " << tofScanWindow << " ns" << G4endl
+	 << "Using TOFScan vertex grid spacing " << tofScanGridSpacing << " cm" << G4endl
+	 << "Using TOFScan threads " << tofScanNThreads << (tofScanNThreads ? "" : " (i.e. one per core)") << G4endl
+	 << "Using TOFScan TOF table size limit " << tofScanMaxTableSize << " MB" << G4endl
+	 << "Using TOFScan event pretrigger window " << tofScanPreTriggerWindow << " ns" << G4endl
+	 << "Using TOFScan event posttrigger window " << tofScanPostTriggerWindow << " ns" << G4endl
+	 << "Using continuous readout time slice length " << timeSliceLength << " ns" << G4endl
+	 << "Using continuous readout time slices per chunk " << timeSlicesPerChunk << G4endl
 	 << "Using trigger offset " << offset << "ns" << G4endl;
   if(saveFailuresMode == 0)
     G4cout << "Saving only triggered digits" << G4endl;
@@ -103,6 +156,12 @@ int WCSimWCTriggerBase::GetPreTriggerWindow(TriggerType_t t)
   case kTriggerNDigitsTest:
     return ndigitsPreTriggerWindow;
     break;
+  case kTriggerLocalNHits:
+    return localNHitsPreTriggerWindow;
+    break;
+  case kTriggerTOFScan:
+    return tofScanPreTriggerWindow;
+    break;
   case kTriggerFailure:
     return saveFailuresPreTriggerWindow;
     break;
@@ -121,6 +180,12 @@ int WCSimWCTriggerBase::GetPostTriggerWindow(TriggerType_t t)
   case kTriggerNDigitsTest:
     return ndigitsPostTriggerWindow;
     break;
+  case kTriggerLocalNHits:
+    return localNHitsPostTriggerWindow;
+    break;
+  case kTriggerTOFScan:
+    return tofScanPostTriggerWindow;
+    break;
   case kTriggerFailure:
     return saveFailuresPostTriggerWindow;
     break;
@@ -174,13 +239,42 @@ void WCSimWCTriggerBase::Digitize()
 
   // Do the work  
   if (WCDCPMT) {
+    BuildSortedDigits(WCDCPMT);
     DoTheWork(WCDCPMT);
+    //call FillDigitsCollection() whether any triggers are found or not
+    // (what's saved depends on saveFailuresMode)
+    FillDigitsCollection(WCDCPMT);
   }
   
   StoreDigiCollection(DigitsCollection);
 }
 
-void WCSimWCTriggerBase::AlgNDigits(WCSimWCDigitsCollection* WCDCPMT, bool remove_hits, bool test)
+void WCSimWCTriggerBase::BuildSortedDigits(WCSimWCDigitsCollection* WCDCPMT)
+{
+  //Flatten the digits of all PMTs into a single array, sorted by time
+  // This is done once per event; all trigger algorithms then read this view,
+  // rather than looping over all PMTs for every trigger window
+  size_t ndigits = 0;
+  for (G4int i = 0 ; i < WCDCPMT->entries() ; i++)
+    ndigits += (*WCDCPMT)[i]->GetTotalPe();
+  SortedDigits.reserve(ndigits);
+
+  SortedDigit sd;
+  for (G4int i = 0 ; i < WCDCPMT->entries() ; i++) {
+    sd.pmt = i;
+    sd.tube = (*WCDCPMT)[i]->GetTubeID();
+    for ( G4int ip = 0 ; ip < (*WCDCPMT)[i]->GetTotalPe() ; ip++) {
+      sd.time  = (*WCDCPMT)[i]->GetTime(ip);
+      sd.digit = ip;
+      SortedDigits.push_back(sd);
+    }
+  }
+  //stable, so that digits at the same time stay in PMT order
+  WCSimDAQTrigger::SortByTime(SortedDigits);
+  DigitMasks.assign(SortedDigits.size(), 0);
+}
+
+void WCSimWCTriggerBase::AlgNDigits(unsigned int ignore_mask, bool test)
 {
 
   //if test is true, we run the algorithm with 1/2 the threshold, and kTriggerNDigitsTest
@@ -192,104 +286,355 @@ void WCSimWCTriggerBase::AlgNDigits(WCSimWCDigitsCollection* WCDCPMT, bool remov
     this_triggerType = kTriggerNDigitsTest;
   }
 
+  G4cout << "WCSimWCTriggerBase::AlgNDigits. Number of digits in input digit collection: " << SortedDigits.size() << G4endl;
+
   //Now we will try to find triggers
-  //loop over PMTs, and Digits in each PMT.  If ndigits > Threshhold in a time window, then we have a trigger
+  //slide a window along the time-sorted digits (see WCSimDAQTrigger::NDigits())
+  int ntrig = WCSimDAQTrigger::NDigits(SortedDigits, DigitMasks, ignore_mask,
+				       this_ndigitsThreshold, ndigitsWindow, GetPostTriggerWindow(this_triggerType),
+				       TriggerTimes, TriggerInfos);
+  TriggerTypes.resize(TriggerTimes.size(), this_triggerType);
 
-  int ntrig = 0;
-  int window_start_time = 0;
-  int window_end_time   = WCSimWCTriggerBase::LongTime - ndigitsWindow;
-  int window_step_size  = 5; //step the search window along this amount if no trigger is found
-  float lasthit;
-  std::vector<G4float> digit_times;
-  bool first_loop = true;
-
-  G4cout << "WCSimWCTriggerBase::AlgNDigits. Number of entries in input digit collection: " << WCDCPMT->entries() << G4endl;
-#ifdef WCSIMWCTRIGGER_VERBOSE
-  int temp_total_pe = 0;
-  for (G4int i = 0 ; i < WCDCPMT->entries() ; i++) {
-    temp_total_pe += (*WCDCPMT)[i]->GetTotalPe();
+  G4cout << "Found " << ntrig << " NDigit triggers" << G4endl;
+}
+
+void WCSimWCTriggerBase::BuildLocalNeighbourhoods()
+{
+  //The neighbourhoods come from the geometry table written by WCSimDetectorConstruction
+  WCSimGeometryTable table;
+  if(!table.Open(myDetector->GetGeometryTableFileName())) {
+    G4cerr << "WCSimWCTriggerBase::BuildLocalNeighbourhoods() Could not read the geometry table "
+	   << myDetector->GetGeometryTableFileName() << ". Exiting..." << G4endl;
+    exit(-1);
   }
-  G4cout << "WCSimWCTriggerBase::AlgNDigits. " << temp_total_pe << " total p.e. input" << G4endl;
-#endif
+  const unsigned int npmt = table.GetNumPMT();
+  const int32_t * tubeID = table.GetTubeID();
+  int maxtube = 0;
+  for(unsigned int i = 0; i < npmt; i++)
+    maxtube = std::max(maxtube, (int)tubeID[i]);
+
+  //the neighbourhoods of each tube, before compressing
+  std::vector< std::vector<int> > groups(maxtube + 1);
+  LocalGroupID.clear();
+
+  if(localNHitsNeighbourRadius <= 0) {
+    //one neighbourhood per mPMT
+    const int32_t * mPMTID = table.GetmPMTID();
+    std::map<int,int> groupOfmPMT;
+    for(unsigned int i = 0; i < npmt; i++) {
+      std::map<int,int>::iterator it = groupOfmPMT.find(mPMTID[i]);
+      if(it == groupOfmPMT.end()) {
+	it = groupOfmPMT.insert(std::pair<int,int>(mPMTID[i], LocalGroupID.size())).first;
+	LocalGroupID.push_back(mPMTID[i]);
+      }
+      groups[tubeID[i]].push_back(it->second);
+    }
+    if(LocalGroupID.size() == 1)
+      G4cout << "WCSimWCTriggerBase::BuildLocalNeighbourhoods() WARNING all PMTs are in the same mPMT."
+	     << " Use /DAQ/TriggerLocalNHits/NeighbourRadius for a geometry without mPMTs" << G4endl;
+  }
+  else {
+    //one neighbourhood per PMT: all the PMTs within the radius of it (including itself)
+    // Tube a is in the neighbourhood of b if b is in the neighbourhood of a, so the list of
+    // neighbourhoods a tube is in is also its list of neighbours.
+    // Find them by hashing the PMTs into cubes of side the radius, so only the 27 surrounding cubes are searched
+    const double * x = table.GetPositionX();
+    const double * y = table.GetPositionY();
+    const double * z = table.GetPositionZ();
+    const double r = localNHitsNeighbourRadius;
+    const long long ncells = 1 << 20;
+    std::map<long long, std::vector<unsigned int> > cells;
+    std::vector<long long> cell_of_pmt(npmt * 3);
+    for(unsigned int i = 0; i < npmt; i++) {
+      cell_of_pmt[3*i]   = (long long)floor(x[i] / r) + ncells / 2;
+      cell_of_pmt[3*i+1] = (long long)floor(y[i] / r) + ncells / 2;
+      cell_of_pmt[3*i+2] = (long long)floor(z[i] / r) + ncells / 2;
+      cells[(cell_of_pmt[3*i] * ncells + cell_of_pmt[3*i+1]) * ncells + cell_of_pmt[3*i+2]].push_back(i);
+    }
+    LocalGroupID.resize(npmt);
+    for(unsigned int i = 0; i < npmt; i++) {
+      LocalGroupID[i] = tubeID[i];
+      for(int ix = -1; ix <= 1; ix++) {
+	for(int iy = -1; iy <= 1; iy++) {
+	  for(int iz = -1; iz <= 1; iz++) {
+	    std::map<long long, std::vector<unsigned int> >::const_iterator cell =
+	      cells.find(((cell_of_pmt[3*i] + ix) * ncells + cell_of_pmt[3*i+1] + iy) * ncells + cell_of_pmt[3*i+2] + iz);
+	    if(cell == cells.end())
+	      continue;
+	    for(size_t ic = 0; ic < cell->second.size(); ic++) {
+	      const unsigned int j = cell->second[ic];
+	      const double dx = x[i] - x[j], dy = y[i] - y[j], dz = z[i] - z[j];
+	      if(dx*dx + dy*dy + dz*dz <= r*r)
+		groups[tubeID[i]].push_back(j);
+	    }
+	  }//iz
+	}//iy
+      }//ix
+    }//i
+  }
+
+  //compress
+  LocalGroupStart.assign(maxtube + 2, 0);
+  LocalGroupList.clear();
+  size_t nlinks = 0;
+  for(int t = 0; t <= maxtube; t++) {
+    LocalGroupStart[t] = nlinks;
+    nlinks += groups[t].size();
+    LocalGroupList.insert(LocalGroupList.end(), groups[t].begin(), groups[t].end());
+  }
+  LocalGroupStart[maxtube + 1] = nlinks;
+
+  G4cout << "WCSimWCTriggerBase::BuildLocalNeighbourhoods() Built " << LocalGroupID.size()
+	 << " LocalNHits neighbourhoods, with on average " << (npmt ? (double)nlinks / npmt : 0.)
+	 << " per PMT" << G4endl;
+  localNeighbourhoodsBuilt = true;
+}
+
+void WCSimWCTriggerBase::AlgLocalNHits(unsigned int ignore_mask)
+{
+  if(!localNeighbourhoodsBuilt)
+    BuildLocalNeighbourhoods();
+
+  const size_t ndigits = SortedDigits.size();
+  const int ntubes = LocalGroupStart.size() - 1;
+  int ntrig = 0;
+
+  G4cout << "WCSimWCTriggerBase::AlgLocalNHits. Number of digits in input digit collection: " << ndigits << G4endl;
+
+  //number of digits on each tube in the window, and number of hit tubes in each neighbourhood in the window
+  std::vector<int> tube_count(ntubes, 0);
+  std::vector<int> group_count(LocalGroupID.size(), 0);
+
+  //the digits in the window are [window_first, window_last]
+  // as both edges only ever move forward, each digit is added to & removed from the counts at most once
+  size_t window_first = 0;
+  for(size_t window_last = 0; window_last < ndigits; window_last++) {
+    if(DigitMasks[window_last] & ignore_mask)
+      continue;
+    const SortedDigit & newdigit = SortedDigits[window_last];
+    if(newdigit.tube < 0 || newdigit.tube >= ntubes)
+      continue;
 
-  // the upper time limit is set to the final possible full trigger window
-  while(window_start_time <= window_end_time) {
-    int n_digits = 0;
-    float triggertime; //save each digit time, because the trigger time is the time of the first hit above threshold
-    bool triggerfound = false;
-    digit_times.clear();
-    
-    //Loop over each PMT
-    for (G4int i = 0 ; i < WCDCPMT->entries() ; i++) {
-      //int tube=(*WCDCPMT)[i]->GetTubeID();
-      //Loop over each Digit in this PMT
-      for ( G4int ip = 0 ; ip < (*WCDCPMT)[i]->GetTotalPe() ; ip++) {
-	G4float digit_time = (*WCDCPMT)[i]->GetTime(ip);
-	//hit in trigger window?
-	if(digit_time >= window_start_time && digit_time <= (window_start_time + ndigitsWindow)) {
-	  n_digits++;
-	  digit_times.push_back(digit_time);
-	}
-	//G4cout << digit_time << G4endl;
-	//get the time of the last hit (to make the loop shorter)
-	if(first_loop && (digit_time > lasthit))
-	  lasthit = digit_time;
-      }//loop over Digits
-    }//loop over PMTs
-
-    //if over threshold, issue trigger
-    if(n_digits > this_ndigitsThreshold) {
-      ntrig++;
-      //The trigger time is the time of the first hit above threshold
-      std::sort(digit_times.begin(), digit_times.end());
-      triggertime = digit_times[this_ndigitsThreshold];
-      triggertime -= (int)triggertime % 5;
-      TriggerTimes.push_back(triggertime);
-      TriggerTypes.push_back(this_triggerType);
-      TriggerInfos.push_back(std::vector<Float_t>(1, n_digits));
-      triggerfound = true;
+    //remove the digits that are now too early
+    for(; SortedDigits[window_first].time < newdigit.time - localNHitsWindow; window_first++) {
+      const SortedDigit & olddigit = SortedDigits[window_first];
+      if((DigitMasks[window_first] & ignore_mask) || olddigit.tube < 0 || olddigit.tube >= ntubes)
+	continue;
+      if(--tube_count[olddigit.tube] == 0)
+	for(int ig = LocalGroupStart[olddigit.tube]; ig < LocalGroupStart[olddigit.tube + 1]; ig++)
+	  group_count[LocalGroupList[ig]]--;
     }
 
+    //add the new digit. Only count a tube once, however many digits it has in the window
+    if(tube_count[newdigit.tube]++)
+      continue;
+    int triggergroup = -1;
+    for(int ig = LocalGroupStart[newdigit.tube]; ig < LocalGroupStart[newdigit.tube + 1]; ig++) {
+      const int group = LocalGroupList[ig];
+      if(++group_count[group] > localNHitsThreshold && triggergroup < 0)
+	triggergroup = group;
+    }
+    if(triggergroup < 0)
+      continue;
+
+    //over threshold, issue trigger
+    ntrig++;
+    float triggertime = newdigit.time;
+    triggertime -= (int)triggertime % 5;
+    std::vector<Float_t> triggerinfo;
+    triggerinfo.push_back(group_count[triggergroup]);
+    triggerinfo.push_back(LocalGroupID[triggergroup]);
+    TriggerTimes.push_back(triggertime);
+    TriggerTypes.push_back(kTriggerLocalNHits);
+    TriggerInfos.push_back(triggerinfo);
+
 #ifdef WCSIMWCTRIGGER_VERBOSE
-    if(n_digits)
-      G4cout << n_digits << " digits found in 200nsec trigger window ["
-	     << window_start_time << ", " << window_start_time + ndigitsWindow
-	     << "]. Threshold is: " << this_ndigitsThreshold << G4endl;
+    G4cout << group_count[triggergroup] << " hit PMTs found in neighbourhood " << LocalGroupID[triggergroup]
+	   << " in " << localNHitsWindow << "nsec trigger window ending at " << newdigit.time
+	   << ". Threshold is: " << localNHitsThreshold << G4endl;
 #endif
 
-    //move onto the next go through the timing loop
-    if(triggerfound) {
-      window_start_time = triggertime + GetPostTriggerWindow(TriggerTypes.back());
-    }//triggerfound
-    else {
-      window_start_time += window_step_size;
-    }
+    //empty the window, and start again after the posttrigger window
+    std::fill(tube_count.begin(), tube_count.end(), 0);
+    std::fill(group_count.begin(), group_count.end(), 0);
+    const float restart_time = triggertime + GetPostTriggerWindow(kTriggerLocalNHits);
+    while(window_last + 1 < ndigits && SortedDigits[window_last + 1].time < restart_time)
+      window_last++;
+    window_first = window_last + 1;
+  }
+
+  G4cout << "Found " << ntrig << " LocalNHits triggers" << G4endl;
+}
+
+void WCSimWCTriggerBase::BuildTOFGrid()
+{
+  //The PMT positions come from the geometry table written by WCSimDetectorConstruction
+  WCSimGeometryTable table;
+  if(!table.Open(myDetector->GetGeometryTableFileName())) {
+    G4cerr << "WCSimWCTriggerBase::BuildTOFGrid() Could not read the geometry table "
+	   << myDetector->GetGeometryTableFileName() << ". Exiting..." << G4endl;
+    exit(-1);
+  }
+  if(tofScanGridSpacing <= 0) {
+    G4cerr << "WCSimWCTriggerBase::BuildTOFGrid() TOFScan grid spacing must be positive. Exiting..." << G4endl;
+    exit(-1);
+  }
+  const unsigned int npmt = table.GetNumPMT();
+  const int32_t * tubeID = table.GetTubeID();
+  int maxtube = 0;
+  for(unsigned int i = 0; i < npmt; i++)
+    maxtube = std::max(maxtube, (int)tubeID[i]);
+  TOFRowOfTube.assign(maxtube + 1, -1);
+  for(unsigned int i = 0; i < npmt; i++)
+    TOFRowOfTube[tubeID[i]] = i;
+
+  const double maxbytes = tofScanMaxTableSize * 1048576.;
+  if(!TOFGrid.Build(npmt, table.GetPositionX(), table.GetPositionY(), table.GetPositionZ(), tofScanGridSpacing,
+		    WCSimTOFGrid::kDefaultLightSpeed, maxbytes > 0 ? (size_t)maxbytes : 0)) {
+    const size_t nvertices = WCSimTOFGrid::GetNumVertices(npmt, table.GetPositionX(), table.GetPositionY(),
+							  table.GetPositionZ(), tofScanGridSpacing);
+    G4cerr << "WCSimWCTriggerBase::BuildTOFGrid() A TOFScan grid with spacing " << tofScanGridSpacing << " cm has "
+	   << nvertices << " vertices: its TOF table would use " << nvertices * npmt * sizeof(float) / 1048576.
+	   << " MB, more than the limit of " << tofScanMaxTableSize << " MB."
+	   << " Use a larger /DAQ/TriggerTOFScan/GridSpacing, or raise /DAQ/TriggerTOFScan/MaxTableSize. Exiting..." << G4endl;
+    exit(-1);
+  }
+
+  G4cout << "WCSimWCTriggerBase::BuildTOFGrid() Built a TOFScan grid of " << TOFGrid.GetNumVertices()
+	 << " vertices with spacing " << tofScanGridSpacing << " cm. TOF table uses "
+	 << TOFGrid.GetTableSize() / 1048576. << " MB" << G4endl;
+  tofGridBuilt = true;
+}
+
+void WCSimWCTriggerBase::AlgTOFScan(unsigned int ignore_mask)
+{
+  if(!tofGridBuilt)
+    BuildTOFGrid();
+
+  //the digits to scan, as arrays of time & PMT row in the TOF grid
+  const size_t ndigits = SortedDigits.size();
+  std::vector<float> times;
+  std::vector<int>   rows;
+  times.reserve(ndigits);
+  rows.reserve(ndigits);
+  for(size_t id = 0; id < ndigits; id++) {
+    const SortedDigit & sd = SortedDigits[id];
+    if((DigitMasks[id] & ignore_mask) || sd.tube < 0 || sd.tube >= (int)TOFRowOfTube.size() || TOFRowOfTube[sd.tube] < 0)
+      continue;
+    times.push_back(sd.time);
+    rows.push_back(TOFRowOfTube[sd.tube]);
+  }
+
+  G4cout << "WCSimWCTriggerBase::AlgTOFScan. Number of digits in input digit collection: " << ndigits << G4endl;
+
+  //find the windows above threshold, in time order
+  std::vector<WCSimTOFGrid::Candidate> candidates;
+  if(times.size())
+    TOFGrid.Scan(&times[0], &rows[0], times.size(), tofScanWindow, tofScanThreshold, tofScanNThreads, candidates);
+
+  //issue a trigger for each, skipping those inside the posttrigger window of the previous trigger.
+  //The candidate times are vertex times: move them back to detector time, as for the other triggers,
+  //so the pre/posttrigger windows select the digits of the event
+  int ntrig = 0;
+  float next_trigger_allowed = -FLT_MAX;
+  for(size_t ic = 0; ic < candidates.size(); ic++) {
+    const WCSimTOFGrid::Candidate & c = candidates[ic];
+    float triggertime = c.time + TOFGrid.GetMinTOF(c.vertex);
+    if(triggertime < next_trigger_allowed)
+      continue;
+    ntrig++;
+    triggertime -= (int)triggertime % 5;
+    std::vector<Float_t> triggerinfo;
+    triggerinfo.push_back(c.count);
+    triggerinfo.push_back(TOFGrid.GetVertexX(c.vertex));
+    triggerinfo.push_back(TOFGrid.GetVertexY(c.vertex));
+    triggerinfo.push_back(TOFGrid.GetVertexZ(c.vertex));
+    triggerinfo.push_back(c.time);
+    TriggerTimes.push_back(triggertime);
+    TriggerTypes.push_back(kTriggerTOFScan);
+    TriggerInfos.push_back(triggerinfo);
+    next_trigger_allowed = triggertime + GetPostTriggerWindow(kTriggerTOFScan);
 
-    //shorten the loop using the time of the last hit
-    if(first_loop) {
 #ifdef WCSIMWCTRIGGER_VERBOSE
-      G4cout << "Last hit found to be at " << lasthit
-	     << ". Changing window_end_time from " << window_end_time
-	     << " to " << lasthit - (ndigitsWindow - 10)
-	     << G4endl;
+    G4cout << c.count << " digits found in " << tofScanWindow << "nsec TOF-corrected trigger window starting at "
+	   << c.time << " (vertex time) for vertex (" << triggerinfo[1] << ", " << triggerinfo[2] << ", " << triggerinfo[3]
+	   << "). Threshold is: " << tofScanThreshold << G4endl;
 #endif
-      window_end_time = lasthit - (ndigitsWindow - 10);
-      first_loop = false;
+  }
+
+  G4cout << "Found " << ntrig << " TOFScan triggers" << G4endl;
+}
+
+void WCSimWCTriggerBase::AlgTimeSlices(WCSimWCDigitsCollection* WCDCPMT)
+{
+  //only the digits in [timeSliceLow, timeSliceHigh)
+  size_t first = 0, last = SortedDigits.size();
+  while(first < last && SortedDigits[first].time < timeSliceLow)
+    first++;
+  while(last > first && SortedDigits[last - 1].time >= timeSliceHigh)
+    last--;
+  G4cout << "WCSimWCTriggerBase::AlgTimeSlices. Number of digits in input digit collection: " << last - first << G4endl;
+  if(first == last)
+    return;
+  if(timeSliceLength <= 0) {
+    G4cerr << "WCSimWCTriggerBase::AlgTimeSlices() Time slice length must be positive. Exiting..." << G4endl;
+    exit(-1);
+  }
+
+  WCSimRunAction* runAction = (WCSimRunAction*)G4RunManager::GetRunManager()->GetUserRunAction();
+
+  //start after the last slice written by an earlier chunk of the event, so the empty slices in between are written too
+  const int first_slice = timeSliceStarted ? nextTimeSlice : (int)floor(SortedDigits[first].time / timeSliceLength);
+  const int last_slice  = (int)floor(SortedDigits[last - 1].time / timeSliceLength);
+
+  //only one slice is held at a time
+  std::vector<size_t> slice_digits;
+  std::vector<float>  times, charges;
+  std::vector<int>    tubes;
+  size_t id = first;
+  for(int islice = first_slice; islice <= last_slice; islice++) {
+    const double slice_end = (islice + 1) * (double)timeSliceLength;
+    slice_digits.clear();
+    for(; id < last && SortedDigits[id].time < slice_end; id++)
+      slice_digits.push_back(id);
+    //already in time order; this orders digits at the same time by tube
+    std::sort(slice_digits.begin(), slice_digits.end(), SortedDigitTimeTubeOrder(SortedDigits));
+
+    times.clear();
+    charges.clear();
+    tubes.clear();
+    for(size_t is = 0; is < slice_digits.size(); is++) {
+      const SortedDigit & sd = SortedDigits[slice_digits[is]];
+      times.push_back(sd.time);
+      charges.push_back((*WCDCPMT)[sd.pmt]->GetPe(sd.digit));
+      tubes.push_back(sd.tube);
     }
+    runAction->FillTimeSlice(islice, islice * (double)timeSliceLength, timeSliceLength, times, charges, tubes);
   }
-  
-  G4cout << "Found " << ntrig << " NDigit triggers" << G4endl;
-  //call FillDigitsCollection() whether any triggers are found or not
-  // (what's saved depends on saveFailuresMode)
-  FillDigitsCollection(WCDCPMT, remove_hits, this_triggerType);
+  nextTimeSlice = last_slice + 1;
+  timeSliceStarted = true;
+
+  G4cout << "Wrote " << last_slice - first_slice + 1 << " continuous readout time slices of "
+	 << timeSliceLength << " ns" << G4endl;
 }
 
-void WCSimWCTriggerBase::FillDigitsCollection(WCSimWCDigitsCollection* WCDCPMT, bool remove_hits, TriggerType_t save_triggerType)
+void WCSimWCTriggerBase::MaskDigitsInTriggerWindows(unsigned int first_trigger, unsigned int stage_mask)
 {
-  //Adds the digits within the trigger window to the output WCSimWCDigitsCollection
-  // optionally removes digits from the input digits collection (when running different Alg* methods concurently) 
-  // so they are not used in subsequent trigger decisions or saved twice
-  //Also, only save digits of a specific type (again for when running different Alg* methods concurently)
+  for(unsigned int itrigger = first_trigger; itrigger < TriggerTimes.size(); itrigger++) {
+    SortedDigit lower;
+    lower.time = TriggerTimes[itrigger] + GetPreTriggerWindow(TriggerTypes[itrigger]);
+    const float upperbound = TriggerTimes[itrigger] + GetPostTriggerWindow(TriggerTypes[itrigger]);
+    std::vector<SortedDigit>::iterator it =
+      std::lower_bound(SortedDigits.begin(), SortedDigits.end(), lower, WCSimDAQTrigger::CompareTime);
+    for(; it != SortedDigits.end() && it->time <= upperbound; ++it)
+      DigitMasks[it - SortedDigits.begin()] |= stage_mask;
+  }
+}
+
+void WCSimWCTriggerBase::FillDigitsCollection(WCSimWCDigitsCollection* WCDCPMT)
+{
+  //Adds the digits within the trigger windows (of all the trigger algorithms) to the output WCSimWCDigitsCollection
+  // Each digit is saved at most once, in the earliest trigger window it is in
 
   // Add dummy triggers / exit without saving triggers as required
   //
@@ -306,108 +651,77 @@ void WCSimWCTriggerBase::FillDigitsCollection(WCSimWCDigitsCollection* WCDCPMT,
     TriggerTypes.push_back(kTriggerFailure);
     TriggerTimes.push_back(saveFailuresTime);
     TriggerInfos.push_back(std::vector<Float_t>(1, -1));
-    save_triggerType = kTriggerFailure;
   }
 
   //make sure the triggers are in time order
   SortTriggersByTime();
 
-  //Loop over trigger times
-  for(unsigned int itrigger = 0; itrigger < TriggerTimes.size(); itrigger++) {
-    TriggerType_t triggertype = TriggerTypes[itrigger];
-    //check if we've already saved this trigger
-    if(triggertype != save_triggerType && save_triggerType != kTriggerUndefined)
-      continue;
-    float         triggertime = TriggerTimes[itrigger];
-    std::vector<Float_t> triggerinfo = TriggerInfos[itrigger];
-
-    //these are the boundary of the trigger gate: we want to add all digits within these bounds to the output collection
-    float lowerbound = triggertime + GetPreTriggerWindow(triggertype);
-    float upperbound = triggertime + GetPostTriggerWindow(triggertype);
-    //need to check for double-counting - check if the previous upperbound is above the lowerbound
-    if(itrigger) {
-      float upperbound_previous = TriggerTimes[itrigger - 1] + GetPostTriggerWindow(TriggerTypes[itrigger - 1]);
-      if(upperbound_previous > lowerbound) {
-	//also need to check whether the previous upperbound is above the lowerbound
-	//(different trigger windows for different trigger types can mean this trigger is completely contained within another)
-	// if it is, we skip it
-	if(upperbound_previous >= upperbound)
-	  continue;
-	lowerbound = upperbound_previous;
-      }
-    }
-
 #ifdef WCSIMWCTRIGGER_VERBOSE
-    G4cout << "Saving trigger " << itrigger << " of type " << WCSimEnumerations::EnumAsString(triggertype)
-	   << " in time range [" << lowerbound << ", " << upperbound << "]"
-	   << " with trigger time " << triggertime
+  for(unsigned int itrigger = 0; itrigger < TriggerTimes.size(); itrigger++) {
+    G4cout << "Saving trigger " << itrigger << " of type " << WCSimEnumerations::EnumAsString(TriggerTypes[itrigger])
+	   << " with trigger time " << TriggerTimes[itrigger]
 	   << " and additional trigger info";
-    for(std::vector<Float_t>::iterator it = triggerinfo.begin(); it != triggerinfo.end(); ++it)
+    for(std::vector<Float_t>::iterator it = TriggerInfos[itrigger].begin(); it != TriggerInfos[itrigger].end(); ++it)
       G4cout << " " << *it;
     G4cout << G4endl;
+  }
 #endif
 
-    //loop over PMTs
-    for (G4int i = 0; i < WCDCPMT->entries(); i++) {
-      int tube=(*WCDCPMT)[i]->GetTubeID();
-      //loop over digits in this PMT
-      for ( G4int ip = 0; ip < (*WCDCPMT)[i]->GetTotalPe(); ip++){
-	G4float digit_time  = (*WCDCPMT)[i]->GetTime(ip);
-	if(digit_time >= lowerbound && digit_time <= upperbound) {
-	  //hit in event window
-	  //add it to DigitsCollection
-
-	  //first apply time offsets
-	  float peSmeared = (*WCDCPMT)[i]->GetPe(ip);
-	  G4double digihittime = -triggertime
-	    + WCSimWCTriggerBase::offset
-	    + digit_time;
-
-	  //get the composition information for the triggered digit
-	  std::vector<int> triggered_composition = (*WCDCPMT)[i]->GetDigiCompositionInfo(ip);
+  //find the digits in the trigger windows (see WCSimDAQTrigger::SelectTriggeredDigits())
+  std::vector<int> pretrigger_windows, posttrigger_windows;
+  for(unsigned int itrigger = 0; itrigger < TriggerTimes.size(); itrigger++) {
+    pretrigger_windows .push_back(GetPreTriggerWindow (TriggerTypes[itrigger]));
+    posttrigger_windows.push_back(GetPostTriggerWindow(TriggerTypes[itrigger]));
+  }
+  std::vector<WCSimDAQTrigger::TriggeredDigit> triggered_digits;
+  WCSimDAQTrigger::SelectTriggeredDigits(SortedDigits, TriggerTimes, pretrigger_windows, posttrigger_windows,
+					 multiDigitsPerTrigger, WCSimWCTriggerBase::offset, triggered_digits);
+
+  //add them to the output collection
+  for(size_t itd = 0; itd < triggered_digits.size(); itd++) {
+    const int itrigger = triggered_digits[itd].trigger;
+    const SortedDigit & sd = SortedDigits[triggered_digits[itd].digit];
+    WCSimWCDigi * pmtdigits = (*WCDCPMT)[sd.pmt];
+    int tube = pmtdigits->GetTubeID();
+    float peSmeared = pmtdigits->GetPe(sd.digit);
+    G4double digihittime = triggered_digits[itd].time;
+
+    //get the composition information for the triggered digit
+    std::vector<int> triggered_composition = pmtdigits->GetDigiCompositionInfo(sd.digit);
 
 #ifdef WCSIMWCTRIGGER_VERBOSE
-	  G4cout << "Saving digit on PMT " << tube
-		 << " time " << digihittime
-		 << " pe "   << peSmeared
-		 << " digicomp";
-	  for(unsigned int iv = 0; iv < triggered_composition.size(); iv++)
-	    G4cout << " " << triggered_composition[iv];
-	  G4cout << G4endl;
+    G4cout << "Saving digit on PMT " << tube
+	   << " in trigger " << itrigger
+	   << " time " << digihittime
+	   << " pe "   << peSmeared
+	   << " digicomp";
+    for(unsigned int iv = 0; iv < triggered_composition.size(); iv++)
+      G4cout << " " << triggered_composition[iv];
+    G4cout << G4endl;
 #endif
-	  assert(triggered_composition.size());
-
-	  //add hit
-	  if ( DigiHitMap[tube] == 0) {
-	    //this PMT has no digits saved yet; create a new WCSimWCDigiTrigger
-	    WCSimWCDigiTrigger* Digi = new WCSimWCDigiTrigger();
-	    Digi->SetTubeID(tube);
-	    Digi->AddGate  (itrigger);
-	    Digi->SetTime  (itrigger,digihittime);
-	    Digi->SetPe    (itrigger,peSmeared);
-	    Digi->AddPe    ();
-	    Digi->AddDigiCompositionInfo(itrigger,triggered_composition);
-	    DigiHitMap[tube] = DigitsCollection->insert(Digi);
-	  }
-	  else {
-	    //this PMT has digits saved already; add information to the WCSimWCDigiTrigger
-	    (*DigitsCollection)[DigiHitMap[tube]-1]->AddGate(itrigger);
-	    (*DigitsCollection)[DigiHitMap[tube]-1]->SetTime(itrigger, digihittime);
-	    (*DigitsCollection)[DigiHitMap[tube]-1]->SetPe  (itrigger, peSmeared);
-	    (*DigitsCollection)[DigiHitMap[tube]-1]->AddPe  ();
-	    (*DigitsCollection)[DigiHitMap[tube]-1]->AddDigiCompositionInfo(itrigger,triggered_composition);
-	  }
-	  if(remove_hits)
-	    (*WCDCPMT)[i]->RemoveDigitizedGate(ip);
-
-	  //we've found a digit on this PMT. If we're restricting to just 1 digit per trigger window (e.g. SKI)
-	  // then ignore later digits and break. This takes us to the next PMT
-	  if(!multiDigitsPerTrigger)
-	    break;
-	}//digits within trigger window
-      }//loop over Digits
-    }//loop over PMTs
-  }//loop over Triggers
+    assert(triggered_composition.size());
+
+    //add hit
+    if ( DigiHitMap[tube] == 0) {
+      //this PMT has no digits saved yet; create a new WCSimWCDigiTrigger
+      WCSimWCDigiTrigger* Digi = new WCSimWCDigiTrigger();
+      Digi->SetTubeID(tube);
+      Digi->AddGate  (itrigger);
+      Digi->SetTime  (itrigger,digihittime);
+      Digi->SetPe    (itrigger,peSmeared);
+      Digi->AddPe    ();
+      Digi->AddDigiCompositionInfo(itrigger,triggered_composition);
+      DigiHitMap[tube] = DigitsCollection->insert(Digi);
+    }
+    else {
+      //this PMT has digits saved already; add information to the WCSimWCDigiTrigger
+      (*DigitsCollection)[DigiHitMap[tube]-1]->AddGate(itrigger);
+      (*DigitsCollection)[DigiHitMap[tube]-1]->SetTime(itrigger, digihittime);
+      (*DigitsCollection)[DigiHitMap[tube]-1]->SetPe  (itrigger, peSmeared);
+      (*DigitsCollection)[DigiHitMap[tube]-1]->AddPe  ();
+      (*DigitsCollection)[DigiHitMap[tube]-1]->AddDigiCompositionInfo(itrigger,triggered_composition);
+    }
+  }//loop over triggered digits
   G4cout << "WCSimWCTriggerBase::FillDigitsCollection. Number of entries in output digit collection: " << DigitsCollection->entries() << G4endl;
 
 }
@@ -423,6 +737,20 @@ void WCSimWCTriggerBase::SaveOptionsToOutput(WCSimRootOptions * wcopt)
   wcopt->SetNDigitsPreTriggerWindow(ndigitsPreTriggerWindow);;
   wcopt->SetNDigitsPostTriggerWindow(ndigitsPostTriggerWindow);;
   wcopt->SetTriggerOffset(offset);
+  //localnhits
+  wcopt->SetLocalNHitsThreshold(localNHitsThreshold);
+  wcopt->SetLocalNHitsWindow(localNHitsWindow);
+  wcopt->SetLocalNHitsNeighbourRadius(localNHitsNeighbourRadius);
+  wcopt->SetLocalNHitsPreTriggerWindow(localNHitsPreTriggerWindow);
+  wcopt->SetLocalNHitsPostTriggerWindow(localNHitsPostTriggerWindow);
+  //tofscan
+  wcopt->SetTOFScanThreshold(tofScanThreshold);
+  wcopt->SetTOFScanWindow(tofScanWindow);
+  wcopt->SetTOFScanGridSpacing(tofScanGridSpacing);
+  wcopt->SetTOFScanPreTriggerWindow(tofScanPreTriggerWindow);
+  wcopt->SetTOFScanPostTriggerWindow(tofScanPostTriggerWindow);
+  //continuous
+  wcopt->SetTimeSliceLength(timeSliceLength);
   //savefailures
   wcopt->SetSaveFailuresMode(saveFailuresMode);;
   wcopt->SetSaveFailuresTime(saveFailuresTime);;
@@ -432,6 +760,45 @@ void WCSimWCTriggerBase::SaveOptionsToOutput(WCSimRootOptions * wcopt)
 
 
 
+// *******************************************
+// TRIGGER REGISTRY
+// *******************************************
+
+WCSimWCTriggerRegistry & WCSimWCTriggerRegistry::Instance()
+{
+  //function static, so it exists before the WCSIM_REGISTER_TRIGGER statics use it
+  static WCSimWCTriggerRegistry registry;
+  return registry;
+}
+
+bool WCSimWCTriggerRegistry::Register(G4String choice, WCSimWCTriggerCreator creator)
+{
+  if(creators.find(choice) != creators.end()) {
+    G4cerr << "WCSimWCTriggerRegistry::Register() Trigger " << choice << " is already registered. Exiting..." << G4endl;
+    exit(-1);
+  }
+  creators[choice] = creator;
+  return true;
+}
+
+WCSimWCTriggerBase* WCSimWCTriggerRegistry::Create(G4String choice, G4String name,
+						   WCSimDetectorConstruction* myDetector,
+						   WCSimWCDAQMessenger* myMessenger) const
+{
+  std::map<G4String, WCSimWCTriggerCreator>::const_iterator it = creators.find(choice);
+  if(it == creators.end())
+    return NULL;
+  return (it->second)(name, myDetector, myMessenger);
+}
+
+G4String WCSimWCTriggerRegistry::GetChoices() const
+{
+  G4String choices;
+  for(std::map<G4String, WCSimWCTriggerCreator>::const_iterator it = creators.begin(); it != creators.end(); ++it)
+    choices += it->first + " ";
+  return choices;
+}
+
 // *******************************************
 // CONTAINER CLASS
 // *******************************************
@@ -511,12 +878,13 @@ WCSimWCTriggerNDigits::~WCSimWCTriggerNDigits()
 {
 }
 
-void WCSimWCTriggerNDigits::DoTheWork(WCSimWCDigitsCollection* WCDCPMT) {
+void WCSimWCTriggerNDigits::DoTheWork(WCSimWCDigitsCollection* /*WCDCPMT*/) {
   //Apply an NDigits trigger
-  bool remove_hits = false;
-  AlgNDigits(WCDCPMT, remove_hits);
+  AlgNDigits(0);
 }
 
+WCSIM_REGISTER_TRIGGER("NDigits", WCSimWCTriggerNDigits)
+
 // *******************************************
 // DERIVED CLASS
 // *******************************************
@@ -534,19 +902,97 @@ WCSimWCTriggerNDigits2::~WCSimWCTriggerNDigits2(){
 }
 
 
-void WCSimWCTriggerNDigits2::DoTheWork(WCSimWCDigitsCollection* WCDCPMT) {
+void WCSimWCTriggerNDigits2::DoTheWork(WCSimWCDigitsCollection* /*WCDCPMT*/) {
   //This calls 2 trigger algorithms; the second algorithm is called on hits that failed the first algorithm
-  //(for a second trigger working on hits that passed a pretrigger, FillDigitsCollection() needs to have a new option)
+  // i.e. those outside the readout windows of the first algorithm's triggers
+  //No copy of the input is made; the digits used by the first stage are masked instead
+  const unsigned int kNDigitsStage = 1 << 0;
 
-  //Make a copy of the input DigitsCollection, so we can remove hits from the copy
-  WCSimWCDigitsCollection* WCDCPMTCopy = new WCSimWCDigitsCollection(*WCDCPMT);
-  
   //Apply an NDigits trigger
-  bool remove_hits = true;
-  AlgNDigits(WCDCPMTCopy, remove_hits);
+  unsigned int first_trigger = TriggerTimes.size();
+  AlgNDigits(0);
+  MaskDigitsInTriggerWindows(first_trigger, kNDigitsStage);
 
   //Apply an NDigits trigger with a lower threshold & different saved trigger type
-  remove_hits = false;
   bool ndigits_test = true;
-  AlgNDigits(WCDCPMTCopy, remove_hits, ndigits_test);
+  AlgNDigits(kNDigitsStage, ndigits_test);
+}
+
+WCSIM_REGISTER_TRIGGER("NDigits2", WCSimWCTriggerNDigits2)
+
+// *******************************************
+// DERIVED CLASS
+// *******************************************
+
+WCSimWCTriggerLocalNHits::WCSimWCTriggerLocalNHits(G4String name,
+						   WCSimDetectorConstruction* myDetector,
+						   WCSimWCDAQMessenger* myMessenger)
+  :WCSimWCTriggerBase(name, myDetector, myMessenger)
+{
+  triggerClassName = "LocalNHits";
+  GetVariables();
 }
+
+WCSimWCTriggerLocalNHits::~WCSimWCTriggerLocalNHits()
+{
+}
+
+void WCSimWCTriggerLocalNHits::DoTheWork(WCSimWCDigitsCollection* /*WCDCPMT*/) {
+  //Apply a local NHits trigger
+  AlgLocalNHits(0);
+}
+
+WCSIM_REGISTER_TRIGGER("LocalNHits", WCSimWCTriggerLocalNHits)
+
+// *******************************************
+// DERIVED CLASS
+// *******************************************
+
+WCSimWCTriggerTOFScan::WCSimWCTriggerTOFScan(G4String name,
+					     WCSimDetectorConstruction* myDetector,
+					     WCSimWCDAQMessenger* myMessenger)
+  :WCSimWCTriggerBase(name, myDetector, myMessenger)
+{
+  triggerClassName = "TOFScan";
+  GetVariables();
+}
+
+WCSimWCTriggerTOFScan::~WCSimWCTriggerTOFScan()
+{
+}
+
+void WCSimWCTriggerTOFScan::DoTheWork(WCSimWCDigitsCollection* /*WCDCPMT*/) {
+  //Apply a TOF-corrected vertex scanning trigger
+  AlgTOFScan(0);
+}
+
+WCSIM_REGISTER_TRIGGER("TOFScan", WCSimWCTriggerTOFScan)
+
+// *******************************************
+// DERIVED CLASS
+// *******************************************
+
+WCSimWCTriggerContinuous::WCSimWCTriggerContinuous(G4String name,
+						   WCSimDetectorConstruction* myDetector,
+						   WCSimWCDAQMessenger* myMessenger)
+  :WCSimWCTriggerBase(name, myDetector, myMessenger)
+{
+  triggerClassName = "Continuous";
+  GetVariables();
+  //the failed trigger gate would hold all the digits of the event
+  if(saveFailuresMode) {
+    G4cout << "SaveFailures is ignored by the Continuous readout" << G4endl;
+    saveFailuresMode = 0;
+  }
+}
+
+WCSimWCTriggerContinuous::~WCSimWCTriggerContinuous()
+{
+}
+
+void WCSimWCTriggerContinuous::DoTheWork(WCSimWCDigitsCollection* WCDCPMT) {
+  //Write all digits in time slices. No trigger decision is made
+  AlgTimeSlices(WCDCPMT);
+}
+
+WCSIM_REGISTER_TRIGGER("Continuous", WCSimWCTriggerContinuous)